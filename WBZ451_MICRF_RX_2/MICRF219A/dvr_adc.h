@@ -49,7 +49,7 @@
 void DVR_ADC_init( void );
 void DVR_ADC_enable( void );
 void DVR_ADC_disable( void );
-void DVR_ADC_setCallback( void (* fpCallbackFunction)( uint16_t adcVolts_mV ) );
+void DVR_ADC_setCallback( void (* fpCallbackFunction)( uint16_t adcCode ) );
 void DVR_ADC_processConversion( void );
 void DVR_ADC_isr( ADCHS_CHANNEL_NUM channel, uintptr_t context );
 
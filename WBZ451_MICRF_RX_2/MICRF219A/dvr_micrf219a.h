@@ -21,13 +21,14 @@
  * MICROCHIP PROVIDES THIS SOFTWARE CONDITIONALLY UPON YOUR ACCEPTANCE OF THESE TERMS. 
  **********************************************************************************************************************/
 #ifndef DVR_MICRF_219A_H
-#define DVR_MICRF220_219A_H
+#define DVR_MICRF_219A_H
 
 /* ****************************************************************************************************************** */
 /* INCLUDE FILES */
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "dvr_prof.h"
 
 /* ****************************************************************************************************************** */
 /* GLOBAL DEFINTION */
@@ -36,10 +37,94 @@
 /* MACRO DEFINITIONS */
 
 #define MICRF_ENABLE_RSSI   1   /* Set to 1 if RSSI is to be used. */
+#define MICRF_ENABLE_CAPTURE 1  /* Set to 1 to capture the raw samples of the data pin, for troubleshooting. */
+#define MICRF_ENABLE_LQI    1   /* Set to 1 to measure the slicer quality of every frame, see MICRF_getFrameQuality */
+#define MICRF_CAPTURE_SIZE  ((uint16_t)1024)    /* Capture ring, run-length entries.  Must be a power of 2. */
+#define MICRF_RSSI_ADC_BITS     12                  /* Resolution of the RSSI ADC input, 8 to 15 */
+#define MICRF_RSSI_ADC_VREF_mV  ((int32_t)3000)     /* Full scale of the RSSI ADC input */
 
 /* ****************************************************************************************************************** */
 /* TYPE DEFINITIONS */
 
+/* Rate profiles.  Each profile sets the sample timer prescaler/period and the number of samples per bit together.  The
+ * transmitter (MICRF114 driver) uses the same enumeration, so both ends can be selected with the same index. */
+typedef enum
+{
+    eMICRF_RATE_500BPS = 0,     // Legacy rate, ~500bps (1k chips/s), 10 samples per chip
+    eMICRF_RATE_1KBPS,          // 1kbps (2k chips/s), 10 samples per chip
+    eMICRF_RATE_2KBPS,          // 2kbps (4k chips/s), 8 samples per chip
+    eMICRF_RATE_4KBPS,          // 4kbps (8k chips/s), 6 samples per chip
+    eMICRF_RATE_CNT             // Number of rate profiles, must be last
+}eMICRF_rate_t;
+
+/* Paths through MICRF_sampleTimerISR() that are profiled separately when DVR_PROF_ON is 1. */
+typedef enum
+{
+    eMICRF_PROF_IDLE = 0,       // Slice in the middle of a bit
+    eMICRF_PROF_HUNT,           // Auto-baud, measuring the training
+    eMICRF_PROF_BIT,            // Last slice of a bit, voting and preamble check
+    eMICRF_PROF_BYTE,           // 16 bits collected, Manchester decode
+    eMICRF_PROF_FRAME,          // End of a frame, the message callback is called
+    eMICRF_PROF_SQUELCH,        // Squelch closed, the slicer is skipped
+    eMICRF_PROF_CNT             // Number of paths, must be last
+}eMICRF_prof_t;
+
+typedef struct
+{
+    uint32_t syncs;             // Preambles detected
+    uint32_t shortFrames;       // Frames that ended before RX_MINIMUM_PACKET_SIZE bytes were decoded, dropped
+    uint32_t frames;            // Frames passed to the message callback
+}MICRF_linkStats_t;             // Frame detection counters, see MICRF_getLinkStats
+
+#if MICRF_ENABLE_LQI == 1
+typedef struct
+{
+    uint16_t chips;             // Chips (half bits) sliced after the preamble
+    uint8_t  marginPct;         // Average vote margin of the chips, 100 = all the samples of every chip agreed
+    uint8_t  timingCnt;         // Slicer timing corrections (skipped or extra slice) after the preamble, saturates
+    uint8_t  trainChips;        // Training chips before the preamble that were checked, 0 to 16 (fewer after a lock)
+    uint8_t  trainErrors;       // Checked training chips that were wrong
+}MICRF_frameQuality_t;          // Slicer quality of the last frame, see MICRF_getFrameQuality
+#endif
+
+#if MICRF_ENABLE_RSSI == 1
+typedef struct
+{
+    uint16_t code[2];           // RSSI ADC codes measured at the two input levels (MICRF_getRssiRawxxx)
+    int8_t   dBm[2];            // The two input levels, dBm
+}MICRF_rssiCal_t;               // Two-point RSSI calibration, see MICRF_setRssiCal
+#endif
+
+#if MICRF_ENABLE_CAPTURE == 1
+/* Capture triggers, can be combined. */
+#define MICRF_CAP_TRIG_SYNC     ((uint8_t)0x01)     /* The preamble was found */
+#define MICRF_CAP_TRIG_CRC      ((uint8_t)0x02)     /* The receiver rejected a message (CRC) */
+#define MICRF_CAP_TRIG_MANUAL   ((uint8_t)0x80)     /* MICRF_captureTrigger() called by the application */
+
+/* Every capture entry is a run of samples at the same level: bit 7 = level, bits 6-0 = samples - 1. */
+#define MICRF_CAP_ENTRY_LEVEL(x)    ((uint8_t)((x) >> 7))
+#define MICRF_CAP_ENTRY_SAMPLES(x)  ((uint8_t)(((x) & 0x7F) + 1))
+
+typedef enum
+{
+    eMICRF_CAP_OFF = 0,         // Not capturing
+    eMICRF_CAP_ARMED,           // Capturing, waiting for a trigger
+    eMICRF_CAP_TRIGGERED,       // Capturing the samples after the trigger
+    eMICRF_CAP_FROZEN           // Done, the ring can be read
+}eMICRF_capState_t;
+
+typedef struct
+{
+    eMICRF_capState_t eState;   // Capture state
+    uint8_t  trigger;           // Trigger that fired, MICRF_CAP_TRIG_xxx
+    uint8_t  eRate;             // Rate profile when frozen, eMICRF_rate_t
+    bool     bAutoBaud;         // Auto-baud mode when frozen
+    uint16_t len;               // Entries in the ring
+    uint16_t trigIdx;           // Entry (from the oldest) that was being captured when the trigger fired
+    uint16_t freezeCnt;         // Incremented every time a capture is frozen
+}MICRF_captureInfo_t;
+#endif
+
 /* ****************************************************************************************************************** */
 /* CONSTANTS */
 
@@ -82,6 +167,135 @@ void   MICRF_setMessageCallback( void (* messageHandler)( uint8_t *pData, uint8_
  */
 void   MICRF_rxEnable( bool bEnable );
 
+/**
+ * MICRF_setRateProfile - Selects the rate profile (sample timer prescaler/period and samples per bit).  If the receiver
+ *                        is running, the sample timer is re-programmed and any partially received message is dropped.
+ *
+ * @see:  eMICRF_rate_t
+ *
+ * @param  eMICRF_rate_t eRate - Rate profile to use
+ *
+ * @return bool - true = profile applied, false = invalid profile
+ */
+bool   MICRF_setRateProfile( eMICRF_rate_t eRate );
+
+/**
+ * MICRF_getRateProfile - Returns the rate profile currently in use.
+ *
+ * @see:  eMICRF_rate_t
+ *
+ * @param  None
+ *
+ * @return eMICRF_rate_t - Current rate profile
+ */
+eMICRF_rate_t MICRF_getRateProfile( void );
+
+/**
+ * MICRF_getBitRate - Returns the nominal data bit rate of a rate profile.
+ *
+ * @see:  eMICRF_rate_t
+ *
+ * @param  eMICRF_rate_t eRate - Rate profile
+ *
+ * @return uint16_t - Nominal data rate in bits/second, 0 if the profile is invalid
+ */
+uint16_t MICRF_getBitRate( eMICRF_rate_t eRate );
+
+/**
+ * MICRF_setAutoBaud - Enables or disables the auto-baud mode.  The receiver measures the training of each frame and
+ *                     locks to the transmitter's rate.  While enabled, the rate profile is not used.
+ *
+ * @see:  MICRF_getRxBitRate
+ *
+ * @param  bool bEnable - true = auto-baud, false = use the rate profile
+ *
+ * @return None
+ */
+void   MICRF_setAutoBaud( bool bEnable );
+
+/**
+ * MICRF_getAutoBaud - Returns true if the auto-baud mode is enabled.
+ *
+ * @see:  N/A
+ *
+ * @param  None
+ *
+ * @return bool - true = auto-baud enabled
+ */
+bool   MICRF_getAutoBaud( void );
+
+/**
+ * MICRF_getRxBitRate - Returns the data rate the receiver is running at.  In auto-baud mode, this is the detected rate
+ *                      of the current frame, so call it from the message callback.
+ *
+ * @see:  MICRF_setMessageCallback
+ *
+ * @param  None
+ *
+ * @return uint16_t - Data rate in bits/second
+ */
+uint16_t MICRF_getRxBitRate( void );
+
+/**
+ * MICRF_getProfile - Returns the execution time statistics of a path through the sample ISR, in CPU cycles.
+ *
+ * @see:  DVR_PROF_ON
+ *
+ * @param  eMICRF_prof_t ePath - ISR path
+ * @param  profStat_t *pStat - Location to store the statistics
+ *
+ * @return bool - false if profiling isn't built in (DVR_PROF_ON is 0) or the path is invalid
+ */
+bool   MICRF_getProfile( eMICRF_prof_t ePath, profStat_t *pStat );
+
+/**
+ * MICRF_clearProfile - Clears the execution time statistics of all paths.
+ *
+ * @see:  N/A
+ *
+ * @param  None
+ *
+ * @return None
+ */
+void   MICRF_clearProfile( void );
+
+/**
+ * MICRF_getLinkStats - Returns the frame detection counters.  syncs - frames is the number of preambles that didn't
+ *                      lead to a frame (false syncs, frames cut short by noise or by another preamble).
+ *
+ * @see:  N/A
+ *
+ * @param  MICRF_linkStats_t *pStats - Location to store the counters
+ *
+ * @return None
+ */
+void   MICRF_getLinkStats( MICRF_linkStats_t *pStats );
+
+/**
+ * MICRF_clearLinkStats - Clears the frame detection counters.
+ *
+ * @see:  N/A
+ *
+ * @param  None
+ *
+ * @return None
+ */
+void   MICRF_clearLinkStats( void );
+
+#if MICRF_ENABLE_LQI == 1
+/**
+ * MICRF_getFrameQuality - Returns the slicer quality of the frame passed to the message callback.  Only valid in the
+ *                         callback, the next preamble clears it.
+ *
+ * @see:  MICRF_setMessageCallback
+ *
+ * @param  MICRF_frameQuality_t *pQuality - Location to store the quality
+ *
+ * @return None
+ */
+void   MICRF_getFrameQuality( MICRF_frameQuality_t *pQuality );
+#endif
+
 #if MICRF_ENABLE_RSSI == 1
 /**
  * MICRF_getRssiNoiseFloor - Reads the latest noise floor value.
@@ -105,6 +319,65 @@ int8_t MICRF_getRssiNoiseFloor( void );
  */
 int8_t MICRF_getRssiLastReceived( void );
 
+/**
+ * MICRF_getRssiRawNoiseFloor - Reads the latest noise floor value as an ADC code, to calibrate the RSSI.
+ *
+ * @see:  MICRF_setRssiCal
+ *
+ * @param  None
+ * 
+ * @return uint16_t - ADC code
+ */
+uint16_t MICRF_getRssiRawNoiseFloor( void );
+
+/**
+ * MICRF_getRssiRawLastReceived - Returns the RSSI of the last message as an ADC code, to calibrate the RSSI.
+ *
+ * @see:  MICRF_setRssiCal
+ *
+ * @param  None
+ * 
+ * @return uint16_t - ADC code
+ */
+uint16_t MICRF_getRssiRawLastReceived( void );
+
+/**
+ * MICRF_setRssiCal - Sets the two-point calibration of the RSSI input.  The datasheet curve is scaled and shifted to
+ *                    go through both points.  The calibration is kept if the module is re-initialized.
+ *
+ * @see:  MICRF_getRssiRawNoiseFloor, MICRF_getRssiRawLastReceived
+ *
+ * @param  const MICRF_rssiCal_t *pCal - Calibration, NULL for the datasheet curve
+ * 
+ * @return bool - false if the calibration is rejected (level outside -110 to -50dBm, same levels, or the code not
+ *                increasing with the level)
+ */
+bool   MICRF_setRssiCal( const MICRF_rssiCal_t *pCal );
+
+/**
+ * MICRF_setSquelch - Sets the RSSI squelch.  While closed, the sample ISR skips the slicer.  It opens on a RSSI sample
+ *                    thresholdDb above the noise floor and closes a few samples after the last one.  The setting is
+ *                    kept if the module is re-initialized.
+ *
+ * @see:  MICRF_getSquelchOpen
+ *
+ * @param  uint8_t thresholdDb - RSSI above the noise floor that opens the squelch, 0 = off
+ * 
+ * @return None
+ */
+void   MICRF_setSquelch( uint8_t thresholdDb );
+
+/**
+ * MICRF_getSquelchOpen - Returns true if the slicer is running, false if the squelch skips it.
+ *
+ * @see:  MICRF_setSquelch
+ *
+ * @param  None
+ * 
+ * @return bool
+ */
+bool   MICRF_getSquelchOpen( void );
+
 /**
  * MICRF_getReceivingMsgDataStatus - Returns true if receiving data, false if looking for data.
  *
@@ -123,12 +396,63 @@ bool   MICRF_getReceivingMsgDataStatus( void );
  *
  * @see:  N/A
  *
- * @param  uint16_t adcVolts_mV - ADC reading of the RSSI analog input pin converted to mV.
+ * @param  uint16_t adcCode - Raw ADC reading of the RSSI analog input pin, MICRF_RSSI_ADC_BITS bits.
  * 
  * @return None
  */
-void   MICRF_setAdcValue( uint16_t adcVolts_mV );
+void   MICRF_setAdcValue( uint16_t adcCode );
 
 #endif
 
+#if MICRF_ENABLE_CAPTURE == 1
+/**
+ * MICRF_captureArm - Starts capturing the raw samples of the data pin into the capture ring, run-length compressed.
+ *                    Once one of the triggers fires, postCnt more entries are captured and the ring is frozen.
+ *
+ * @see:  MICRF_captureRead
+ *
+ * @param  uint8_t triggers - MICRF_CAP_TRIG_xxx, 0 = stop capturing
+ * @param  uint16_t postCnt - Entries captured after the trigger, 1 to MICRF_CAPTURE_SIZE
+ *
+ * @return None
+ */
+void   MICRF_captureArm( uint8_t triggers, uint16_t postCnt );
+
+/**
+ * MICRF_captureTrigger - Fires a trigger from outside the ISR (e.g. the receiver's CRC check).  Ignored unless the
+ *                        trigger is armed.
+ *
+ * @see:  MICRF_captureArm
+ *
+ * @param  uint8_t trigger - MICRF_CAP_TRIG_CRC or MICRF_CAP_TRIG_MANUAL
+ *
+ * @return None
+ */
+void   MICRF_captureTrigger( uint8_t trigger );
+
+/**
+ * MICRF_captureGetInfo - Returns the capture state.
+ *
+ * @see:  N/A
+ *
+ * @param  MICRF_captureInfo_t *pInfo - Location to store the state
+ *
+ * @return None
+ */
+void   MICRF_captureGetInfo( MICRF_captureInfo_t *pInfo );
+
+/**
+ * MICRF_captureRead - Copies entries out of a frozen capture, the oldest entry is at offset 0.
+ *
+ * @see:  MICRF_CAP_ENTRY_LEVEL, MICRF_CAP_ENTRY_SAMPLES
+ *
+ * @param  uint16_t offset - 1st entry to copy
+ * @param  uint8_t *pDst - Destination
+ * @param  uint16_t cnt - Maximum number of entries to copy
+ *
+ * @return uint16_t - Entries copied, 0 if the capture isn't frozen or offset is past the end
+ */
+uint16_t MICRF_captureRead( uint16_t offset, uint8_t *pDst, uint16_t cnt );
+#endif
+
 #endif  /* MICRF220_219A_H */
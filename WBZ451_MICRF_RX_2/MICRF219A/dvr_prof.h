@@ -0,0 +1,74 @@
+/* ****************************************************************************************************************** */
+/***********************************************************************************************************************
+ *
+ * Filename: dvr_prof.h
+ *
+ * Contents: APIs for the ISR profiling module (DWT cycle counter).
+ *
+ ***********************************************************************************************************************
+ *  2023 Microchip Technology Inc. and its subsidiaries.  You may use this software and any derivatives exclusively
+ * with Microchip products. 
+ * 
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS
+ * SOFTWARE, INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A PARTICULAR
+ * PURPOSE, OR ITS INTERACTION WITH MICROCHIP PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION. 
+ * IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE,
+ * COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF
+ * THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON
+ * ALL CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, THAT YOU HAVE PAID
+ * DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ * 
+ * MICROCHIP PROVIDES THIS SOFTWARE CONDITIONALLY UPON YOUR ACCEPTANCE OF THESE TERMS. 
+ **********************************************************************************************************************/
+#ifndef DVR_PROF_H
+#define DVR_PROF_H
+
+/* ****************************************************************************************************************** */
+/* INCLUDE FILES */
+
+#include <stdint.h>
+
+/* ****************************************************************************************************************** */
+/* GLOBAL DEFINTION */
+
+/* ****************************************************************************************************************** */
+/* MACRO DEFINITIONS */
+
+#ifndef DVR_PROF_ON
+#define DVR_PROF_ON         0   /* Set to 1 (or build with -DDVR_PROF_ON=1) to measure the radio ISRs in CPU cycles. */
+#endif
+
+#define DVR_PROF_HIST_BINS  ((uint8_t)16)   /* Bin n counts 2^(n-1) to 2^n - 1 cycles, the last bin everything above */
+
+#if DVR_PROF_ON == 1
+#define DVR_PROF_CYCLES()   (DWT->CYCCNT)   /* Free running CPU cycle counter, needs definitions.h */
+#else
+#define DVR_PROF_CYCLES()   ((uint32_t)0)
+#endif
+
+/* ****************************************************************************************************************** */
+/* TYPE DEFINITIONS */
+
+typedef struct
+{
+    uint32_t    cnt;                        // Number of times the path ran
+    uint32_t    min;                        // Fewest cycles
+    uint32_t    max;                        // Most cycles
+    uint64_t    sum;                        // Total cycles, for the average
+    uint32_t    hist[DVR_PROF_HIST_BINS];   // log2 histogram
+}profStat_t;                                // Execution time of one ISR path
+
+/* ****************************************************************************************************************** */
+/* CONSTANTS */
+
+/* ****************************************************************************************************************** */
+/* GLOBAL VARIABLES */
+
+/* ****************************************************************************************************************** */
+/* FUNCTION PROTOTYPES */
+
+void     DVR_PROF_init( void );
+void     DVR_PROF_record( profStat_t *pStat, uint32_t cycles );
+uint32_t DVR_PROF_average( const profStat_t *pStat );
+
+#endif  /* DVR_PROF_H */
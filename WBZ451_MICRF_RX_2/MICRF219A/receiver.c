@@ -31,6 +31,7 @@
 #include "receiver.h"
 #include "dvr_micrf219a.h"
 #include <string.h>
+#include <stddef.h>
 #include "dvr_crc.h"
 #include "definitions.h"
 // </editor-fold>
@@ -40,6 +41,12 @@
 /* MACRO DEFINITIONS */
 
 #define PROTOCOL            ((uint8_t)1)
+#define PROTOCOL_FRAG       ((uint8_t)2)    /* Packet is a fragment of a message, see RX_getMessage */
+#define PROTOCOL_SEQ        ((uint8_t)3)    /* Same as PROTOCOL, the 1st data byte is a sequence number */
+#define FRAG_HDR_SIZE       ((uint8_t)2)    /* [message ID][index:4 | count - 1:4] */
+
+#define RX_TIME_MS()        ((uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS))  /* Time base for the reassembly */
+#define RX_TIME_MS_ISR()    ((uint32_t)(xTaskGetTickCountFromISR() * portTICK_PERIOD_MS))  /* Same, at interrupt level */
 
 /* This is used due to the way the PIC10/12/16/18 creates call-graphs for RAM memory.  The 8-Bit PICs do not fair well
  * with reentrant code.  So, care must be taken to ensure libraries are not called at interrupt level and non-interrupt
@@ -66,8 +73,47 @@ typedef struct
     rxPacket_t packet;
     int8_t     msgRssi;
     int8_t     noiseRssi;
+    uint16_t   bitRate;
+    uint8_t    lqi;                // Link quality indicator, see lqiCompute
+    uint32_t   rxMs;               // Time the driver passed the frame on, for the decode latency
 }rxData_t;
 #pragma pack()
+
+#if RX_SESSION_ON == 1
+typedef enum
+{
+    eSESSION_EMPTY = 0,                     // Never used, ends a probe sequence
+    eSESSION_USED,                          // Holds a transmitter
+    eSESSION_DELETED                        // Transmitter evicted, the probe sequence continues past it
+}eSessionState_t;
+
+typedef struct
+{
+    rxSession_t info;                       // Information returned to the application
+    uint8_t     state;                      // eSessionState_t, written last so the ISR never sees a partial entry
+    bool        bSeqValid;                  // lastSeq has been set (a protocol 3 frame has been received)
+}sessionEntry_t;                            // Open addressing hash table entry, keyed by serial number
+#endif
+
+#if RX_REASSEMBLY_ON == 1
+typedef struct
+{
+    bool        bUsed;                      // Slot holds a message
+    bool        bComplete;                  // All fragments received, waiting for RX_getMessage()
+    serialNum_t serialNum;                  // Serial number of the transmitter
+    uint8_t     msgId;                      // Message ID set by the transmitter
+    uint8_t     fragCnt;                    // Number of fragments in the message
+    uint16_t    fragMap;                    // Bit n is set when fragment n has been received
+    uint16_t    len;                        // Message length, known once the last fragment is received
+    uint32_t    firstMs;                    // Time the 1st fragment was received
+    uint32_t    lastMs;                     // Time the latest fragment was received
+    int8_t      msgRssi;
+    int8_t      noiseRssi;
+    uint16_t    bitRate;
+    uint8_t     lqi;
+    uint8_t     data[RX_MESSAGE_MAX_SIZE];
+}reasmSlot_t;                               // Message being reassembled
+#endif
 // </editor-fold>
 
 // <editor-fold defaultstate="collapsed" desc="Local Function Prototypes">
@@ -75,6 +121,23 @@ typedef struct
 /* FUNCTION PROTOTYPES */
 
 void RX_messageReceived( uint8_t *pData, uint8_t cnt );
+#if RX_ENG_DATA_ON == 1
+#if MICRF_ENABLE_LQI == 1
+static uint8_t lqiCompute( void );
+#endif
+static void    engRecord( void );
+static uint8_t engRssiBin( int8_t rssi );
+#endif
+#if RX_REASSEMBLY_ON == 1
+static void reasmFragment( void );
+static void reasmExpire( uint32_t timeMs );
+#endif
+#if RX_SESSION_ON == 1
+static bool    sessionUpdate( bool bHasSeq );
+static uint8_t sessionHash( const void *pSn );
+static int16_t sessionFind( const void *pSn );
+static int16_t sessionInsert( const void *pSn );
+#endif
 
 // </editor-fold>
 
@@ -88,12 +151,23 @@ void RX_messageReceived( uint8_t *pData, uint8_t cnt );
 /* ****************************************************************************************************************** */
 /* FILE VARIABLE DEFINITIONS */
 
-static rxData_t   rxData_;
-static rxPacket_t rxPacketBuffer_;
+static rxData_t   rxData_;                 // Frame being processed, a copy of rxDataBuffer_
+static rxData_t   rxDataBuffer_;            // Filled by the ISR while bDataReady_ is false
 static volatile bool       bDataReady_;     // Set true when data is ready
 
 #if RX_ENG_DATA_ON == 1
 static volatile engData_t  engData_;
+static uint32_t            engLastMs_;      // Time of the last good frame
+#endif
+
+#if RX_SESSION_ON == 1
+static sessionEntry_t sessions_[RX_SESSION_TABLE_SIZE];
+static volatile bool  bAllowlist_;          // Only accept transmitters on the allowlist
+#endif
+
+#if RX_REASSEMBLY_ON == 1
+static reasmSlot_t    reasm_[RX_REASSEMBLY_SLOTS];
+static rxReasmStats_t reasmStats_;
 #endif
 
 // </editor-fold>
@@ -120,11 +194,19 @@ static volatile engData_t  engData_;
 void RX_init( void )
 {
     MICRF_init();                                   // Initialize the driver
+    MICRF_setAutoBaud(RX_AUTO_BAUD_ON == 1);        // Lock to the transmitter's rate or use the rate profile
     MICRF_rxEnable(true);                           // Enable the driver
     MICRF_setMessageCallback(RX_messageReceived);   // Set the call back function when a possible message is captured.
     
 #if RX_ENG_DATA_ON == 1    
-    (void)memset((void *)&engData_, 0, sizeof(engData_));   // Clear the receiver buffer
+    RX_clearEngData();
+#endif
+#if RX_SESSION_ON == 1
+    RX_clearSessions();
+#endif
+#if RX_REASSEMBLY_ON == 1
+    (void)memset((void *)&reasm_, 0, sizeof(reasm_));       // No messages being reassembled
+    RX_clearReassemblyStats();
 #endif
 }
 /* ****************************************************************************************************************** */
@@ -152,26 +234,59 @@ bool RX_process( rxDataPacket_t *pRxDataPacket )
     
     if (bDataReady_)    // Is data ready?
     {
-        (void)memcpy((void *)&rxData_.packet, (void *)&rxPacketBuffer_, sizeof(rxData_.packet)); // Cpy buf to data pckt
+        // Copy the packet with its RSSI, rate, LQI and time, the ISR fills the buffer again once bDataReady_ is false
+        (void)memcpy((void *)&rxData_, (void *)&rxDataBuffer_, sizeof(rxData_));
         bDataReady_ = false;
         (void)memcpy(&rxData_.packet.crc, &rxData_.packet.data[rxData_.packet.cnt], sizeof(rxData_.packet.crc));
         if (rxData_.packet.crc == 
             crc16( &rxData_.packet, 1 + sizeof(rxData_.packet.serialNum) + rxData_.packet.cnt))
         {
-            if (PROTOCOL == rxData_.packet.protocolVer)
+#if RX_ENG_DATA_ON == 1
+            engRecord();
+#endif
+            if ((PROTOCOL == rxData_.packet.protocolVer) || (PROTOCOL_SEQ == rxData_.packet.protocolVer))
             {
-                /* Note:  The customer may wish to check the serial number.  For the demo, SN is just ignored. */
-                
-                pRxDataPacket->cnt = rxData_.packet.cnt;
-                pRxDataPacket->msgRssi = rxData_.msgRssi;
-                pRxDataPacket->noiseRssi = rxData_.noiseRssi;
-                (void)memcpy(&pRxDataPacket->serialNum, &rxData_.packet.serialNum, sizeof(pRxDataPacket->serialNum));
-                (void)memcpy(&pRxDataPacket->data[0], &rxData_.packet.data[0], rxData_.packet.cnt);
-                bRetVal = true;
+                uint8_t seqCnt = (PROTOCOL_SEQ == rxData_.packet.protocolVer) ? 1 : 0;  // Protocol 3 has a seq. number
+                bool    bNewFrame = (rxData_.packet.cnt >= seqCnt);
+
+#if RX_SESSION_ON == 1
+                bNewFrame = bNewFrame && sessionUpdate(0 != seqCnt);    // Drop repeated copies of a frame
+#endif
+                if (bNewFrame)
+                {
+                    pRxDataPacket->cnt = rxData_.packet.cnt - seqCnt;
+                    pRxDataPacket->seq = (0 != seqCnt) ? rxData_.packet.data[0] : 0;
+                    pRxDataPacket->msgRssi = rxData_.msgRssi;
+                    pRxDataPacket->noiseRssi = rxData_.noiseRssi;
+                    pRxDataPacket->bitRate = rxData_.bitRate;
+                    pRxDataPacket->lqi = rxData_.lqi;
+                    pRxDataPacket->rxMs = rxData_.rxMs;
+                    (void)memcpy(&pRxDataPacket->serialNum, &rxData_.packet.serialNum, sizeof(pRxDataPacket->serialNum));
+                    (void)memcpy(&pRxDataPacket->data[0], &rxData_.packet.data[seqCnt], pRxDataPacket->cnt);
+                    bRetVal = true;
+#if RX_ENG_DATA_ON == 1                
+                    engData_.validPackets++;
+#endif
+                }
+#if RX_ENG_DATA_ON == 1                
+                else
+                {
+                    engData_.duplicates++;
+                }
+#endif
+            }
+#if RX_REASSEMBLY_ON == 1
+            else if (PROTOCOL_FRAG == rxData_.packet.protocolVer)
+            {   // A fragment isn't returned as a packet.  Once the message is complete, RX_getMessage() returns it.
+#if RX_SESSION_ON == 1
+                (void)sessionUpdate(false);         // Repeated fragments are dropped by the reassembly
+#endif
+                reasmFragment();
 #if RX_ENG_DATA_ON == 1                
                 engData_.validPackets++;
 #endif
             }
+#endif
 #if RX_ENG_DATA_ON == 1            
             else
             {
@@ -179,12 +294,15 @@ bool RX_process( rxDataPacket_t *pRxDataPacket )
             }
 #endif            
         }
-#if RX_ENG_DATA_ON == 1        
         else
         {
+#if RX_ENG_DATA_ON == 1        
             engData_.crcFailures++;
-        }
 #endif
+#if MICRF_ENABLE_CAPTURE == 1
+            MICRF_captureTrigger(MICRF_CAP_TRIG_CRC);   // Freeze the raw samples of the bad message
+#endif
+        }
     }
     return(bRetVal);
 }
@@ -237,80 +355,973 @@ void RX_disable( void )
 /* ****************************************************************************************************************** */
 // </editor-fold>
 
-#if RX_ENG_DATA_ON == 1
+// <editor-fold defaultstate="collapsed" desc="bool RX_setRateProfile( eMICRF_rate_t eRate )">
+/***********************************************************************************************************************
+ *
+ * Function Name: RX_setRateProfile
+ *
+ * Purpose: Selects the receiver rate profile.  The transmitter must be set to the same profile.
+ *
+ * Arguments: eMICRF_rate_t eRate
+ *
+ * Returns: bool - true = Success, false = invalid profile
+ *
+ * Side Effects: A message being received is dropped.
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+bool RX_setRateProfile( eMICRF_rate_t eRate )
+{
+    return(MICRF_setRateProfile(eRate));
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
 
-// <editor-fold defaultstate="collapsed" desc="void RX_getEngData( engData_t *pEngData )">
+// <editor-fold defaultstate="collapsed" desc="eMICRF_rate_t RX_getRateProfile( void )">
 /***********************************************************************************************************************
  *
- * Function Name: RX_getEngData
+ * Function Name: RX_getRateProfile
  *
- * Purpose: Retrieves the engineering data.
+ * Purpose: Returns the receiver rate profile
  *
- * Arguments: engData_t *pEngData
+ * Arguments: None
+ *
+ * Returns: eMICRF_rate_t
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: Yes
+ *
+ **********************************************************************************************************************/
+eMICRF_rate_t RX_getRateProfile( void )
+{
+    return(MICRF_getRateProfile());
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="void RX_setAutoBaud( bool bEnable )">
+/***********************************************************************************************************************
+ *
+ * Function Name: RX_setAutoBaud
+ *
+ * Purpose: Enables or disables the auto-baud mode.  In auto-baud mode, the receiver locks to the rate of each
+ *          transmitter from its training bytes, so transmitters at different rates can be received.
+ *
+ * Arguments: bool bEnable
  *
  * Returns: None
  *
- * Side Effects: The timer for the radio RX detection will be disabled
+ * Side Effects: A message being received is dropped.
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+void RX_setAutoBaud( bool bEnable )
+{
+    MICRF_setAutoBaud(bEnable);
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="bool RX_getAutoBaud( void )">
+/***********************************************************************************************************************
+ *
+ * Function Name: RX_getAutoBaud
+ *
+ * Purpose: Returns true if the auto-baud mode is enabled.
+ *
+ * Arguments: None
+ *
+ * Returns: bool
+ *
+ * Side Effects: None
  *
  * Reentrant Code: Yes
  *
  **********************************************************************************************************************/
-void RX_getEngData( engData_t *pEngData )
+bool RX_getAutoBaud( void )
 {
-    (void)memcpy(pEngData, (void *)&engData_, sizeof(engData_));
+    return(MICRF_getAutoBaud());
 }
 /* ****************************************************************************************************************** */
 // </editor-fold>
 
-#endif
+#if RX_SESSION_ON == 1
+// <editor-fold defaultstate="collapsed" desc="bool RX_getSession( uint8_t idx, rxSession_t *pSession )">
+/***********************************************************************************************************************
+ *
+ * Function Name: RX_getSession
+ *
+ * Purpose: Returns the information of the transmitter at a table index.  Iterate idx from 0 to
+ *          RX_SESSION_TABLE_SIZE - 1 to list all transmitters.
+ *
+ * Arguments: uint8_t idx, rxSession_t *pSession
+ *
+ * Returns: bool - true = transmitter at idx, false = no transmitter at idx
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+bool RX_getSession( uint8_t idx, rxSession_t *pSession )
+{
+    bool bRetVal = false;
 
+    if ((idx < RX_SESSION_TABLE_SIZE) && (eSESSION_USED == sessions_[idx].state))
+    {
+        (void)memcpy(pSession, &sessions_[idx].info, sizeof(rxSession_t));
+        bRetVal = true;
+    }
+    return(bRetVal);
+}
 /* ****************************************************************************************************************** */
-/* Local Functions */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="bool RX_findSession( serialNum_t sn, rxSession_t *pSession )">
+/***********************************************************************************************************************
+ *
+ * Function Name: RX_findSession
+ *
+ * Purpose: Returns the information of a transmitter.
+ *
+ * Arguments: serialNum_t sn, rxSession_t *pSession
+ *
+ * Returns: bool - true = found, false = the transmitter isn't in the table
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+bool RX_findSession( serialNum_t sn, rxSession_t *pSession )
+{
+    int16_t idx = sessionFind(&sn);
 
+    if (idx >= 0)
+    {
+        (void)memcpy(pSession, &sessions_[idx].info, sizeof(rxSession_t));
+    }
+    return(idx >= 0);
+}
 /* ****************************************************************************************************************** */
-/* Event Handlers */
+// </editor-fold>
 
-// <editor-fold defaultstate="collapsed" desc="void RX_messageReceived( uint8_t *pData, uint8_t cnt )">
+// <editor-fold defaultstate="collapsed" desc="bool RX_allowSerial( serialNum_t sn )">
 /***********************************************************************************************************************
  *
- * Function Name: RX_messageReceived
+ * Function Name: RX_allowSerial
  *
- * Purpose: This function will be called at interrupt level.  This function needs to be kept to minimum CPU cycles.  If
- *          the buffer is empty and the count is valid, copy the data to the primary buffer.  This allows another
- *          message to be processed in the event the application hasn't processed the last message.
+ * Purpose: Adds a transmitter to the allowlist.  Allowed transmitters are never evicted from the table.
  *
- * Arguments: uint8_t *pData, uint8_t cnt
+ * Arguments: serialNum_t sn
  *
- * Returns: N/A
+ * Returns: bool - true = Success, false = the table is full of allowed transmitters
  *
- * Side Effects: N/A
+ * Side Effects: None
  *
  * Reentrant Code: No
  *
  **********************************************************************************************************************/
-void RX_messageReceived( uint8_t *pData, uint8_t cnt )
+bool RX_allowSerial( serialNum_t sn )
 {
-    if (!bDataReady_)    // Don't collect unless the data in the buffer has already been copied.
+    int16_t idx = sessionInsert(&sn);
+
+    if (idx >= 0)
+    {
+        sessions_[idx].info.bAllowed = true;
+    }
+    return(idx >= 0);
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="void RX_setAllowlist( bool bEnable )">
+/***********************************************************************************************************************
+ *
+ * Function Name: RX_setAllowlist
+ *
+ * Purpose: Enables or disables the allowlist.  When enabled, RX_messageReceived() drops the frames of transmitters that
+ *          are not on the allowlist, so they don't use the buffer, the copy or the CRC.
+ *
+ * Arguments: bool bEnable
+ *
+ * Returns: None
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: Yes
+ *
+ **********************************************************************************************************************/
+void RX_setAllowlist( bool bEnable )
+{
+    bAllowlist_ = bEnable;
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="void RX_clearSessions( void )">
+/***********************************************************************************************************************
+ *
+ * Function Name: RX_clearSessions
+ *
+ * Purpose: Clears the transmitter table, including the allowlist.  The allowlist is disabled.
+ *
+ * Arguments: None
+ *
+ * Returns: None
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+void RX_clearSessions( void )
+{
+    bAllowlist_ = false;
+    (void)memset((void *)&sessions_, 0, sizeof(sessions_));
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+#endif
+
+#if RX_REASSEMBLY_ON == 1
+// <editor-fold defaultstate="collapsed" desc="bool RX_getMessage( rxMessage_t *pMsg )">
+/***********************************************************************************************************************
+ *
+ * Function Name: RX_getMessage
+ *
+ * Purpose: Returns a reassembled message.  The fragments are collected by RX_process(), so call this after it.
+ *
+ * Arguments: rxMessage_t *pMsg - Location to store the message
+ *
+ * Returns: bool - true a message is complete, false - no message
+ *
+ * Side Effects: Messages that haven't received a fragment within RX_REASSEMBLY_TIMEOUT_MS are dropped.
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+bool RX_getMessage( rxMessage_t *pMsg )
+{
+    bool    bRetVal = false;
+    uint8_t i;
+
+    reasmExpire(RX_TIME_MS());
+    for (i = 0; i < RX_REASSEMBLY_SLOTS; i++)
     {
-        if (cnt <= sizeof(rxPacketBuffer_)) // Is the count valid (will the source data fit in the buffer)?
+        if (reasm_[i].bUsed && reasm_[i].bComplete)
         {
-#if PIC_8_BIT == 1
-            /* If using an 8-bit PIC micro, use a for-loop to copy the data over.  Using memcpy creates reentrant code
-             * which the 8-bit PICs have an issue with (call graph). */
-            uint8_t *pRxPacketBuffer = (uint8_t *)&rxPacketBuffer_;
-            
-            while(cnt--)
-            {
-                *pRxPacketBuffer++ = *pData++; // Copy the source data to the buffer
-            }
-#else            
-            (void)memcpy(&rxPacketBuffer_, pData, cnt);     // Copy the source data to the buffer
+            (void)memcpy(&pMsg->serialNum, &reasm_[i].serialNum, sizeof(pMsg->serialNum));
+            pMsg->msgId = reasm_[i].msgId;
+            pMsg->len = reasm_[i].len;
+            pMsg->msgRssi = reasm_[i].msgRssi;
+            pMsg->noiseRssi = reasm_[i].noiseRssi;
+            pMsg->bitRate = reasm_[i].bitRate;
+            pMsg->lqi = reasm_[i].lqi;
+            pMsg->latencyMs = reasm_[i].lastMs - reasm_[i].firstMs;
+            (void)memcpy(&pMsg->data[0], &reasm_[i].data[0], reasm_[i].len);
+            reasm_[i].bUsed = false;    // Free the slot
+            bRetVal = true;
+            break;
+        }
+    }
+    return(bRetVal);
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="void RX_getReassemblyStats( rxReasmStats_t *pStats )">
+/***********************************************************************************************************************
+ *
+ * Function Name: RX_getReassemblyStats
+ *
+ * Purpose: Returns the reassembly statistics.  The completion rate is completed / started and the average latency is
+ *          latencySumMs / completed.
+ *
+ * Arguments: rxReasmStats_t *pStats - Location to store the statistics
+ *
+ * Returns: None
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+void RX_getReassemblyStats( rxReasmStats_t *pStats )
+{
+    (void)memcpy(pStats, &reasmStats_, sizeof(reasmStats_));
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="void RX_clearReassemblyStats( void )">
+/***********************************************************************************************************************
+ *
+ * Function Name: RX_clearReassemblyStats
+ *
+ * Purpose: Clears the reassembly statistics.
+ *
+ * Arguments: None
+ *
+ * Returns: None
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+void RX_clearReassemblyStats( void )
+{
+    (void)memset(&reasmStats_, 0, sizeof(reasmStats_));
+    reasmStats_.latencyMinMs = UINT32_MAX;
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
 #endif
-            
-#if MICRF_ENABLE_RSSI == 1   
-            rxData_.msgRssi = MICRF_getRssiLastReceived();  // Get the RSSI of the message
-            rxData_.noiseRssi = MICRF_getRssiNoiseFloor();  // Get the RSSI of the NoiseFloor
+
+#if RX_ENG_DATA_ON == 1
+
+// <editor-fold defaultstate="collapsed" desc="void RX_getEngData( engData_t *pEngData )">
+/***********************************************************************************************************************
+ *
+ * Function Name: RX_getEngData
+ *
+ * Purpose: Retrieves the engineering data.
+ *
+ * Arguments: engData_t *pEngData
+ *
+ * Returns: None
+ *
+ * Side Effects: The timer for the radio RX detection will be disabled
+ *
+ * Reentrant Code: Yes
+ *
+ **********************************************************************************************************************/
+void RX_getEngData( engData_t *pEngData )
+{
+    MICRF_linkStats_t linkStats;
+
+    (void)memcpy(pEngData, (void *)&engData_, sizeof(engData_));
+    MICRF_getLinkStats(&linkStats);
+    pEngData->syncs = linkStats.syncs;
+    pEngData->shortFrames = linkStats.shortFrames;
+    pEngData->frames = linkStats.frames;
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="void RX_clearEngData( void )">
+/***********************************************************************************************************************
+ *
+ * Function Name: RX_clearEngData
+ *
+ * Purpose: Clears the engineering data and the frame detection counters of the driver.
+ *
+ * Arguments: None
+ *
+ * Returns: None
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+void RX_clearEngData( void )
+{
+    (void)memset((void *)&engData_, 0, sizeof(engData_));
+    engData_.gapMinMs = UINT32_MAX;
+    MICRF_clearLinkStats();
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+#endif
+
+/* ****************************************************************************************************************** */
+/* Local Functions */
+
+#if MICRF_ENABLE_LQI == 1
+// <editor-fold defaultstate="collapsed" desc="static uint8_t lqiCompute( void )">
+/***********************************************************************************************************************
+ *
+ * Function Name: lqiCompute
+ *
+ * Purpose: Computes the link quality indicator of the frame the driver just passed on, from its RSSI above the noise
+ *          floor (in rxData_), the vote margin of the chips, the slicer timing corrections and the training chip
+ *          errors.  See RX_LQI_xxx.
+ *
+ * Arguments: None
+ *
+ * Returns: uint8_t - Link quality indicator, 0 to 100
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: No
+ *
+ * Note:  Called from the driver message callback (ISR), the only place the frame quality is valid.
+ *
+ **********************************************************************************************************************/
+static uint8_t lqiCompute( void )
+{
+    MICRF_frameQuality_t quality;
+    uint32_t lqi;
+    uint32_t timingPer100 = 0;
+#if MICRF_ENABLE_RSSI == 1
+    int16_t  snr = (int16_t)rxData_.msgRssi - (int16_t)rxData_.noiseRssi;   // dB above the noise floor
+#endif
+
+    MICRF_getFrameQuality(&quality);
+
+    lqi = ((uint32_t)quality.marginPct * RX_LQI_MARGIN_WEIGHT) / 100u;
+
+    if (0u != quality.chips)
+    {
+        timingPer100 = ((uint32_t)quality.timingCnt * 100u) / quality.chips;
+    }
+    if (timingPer100 < RX_LQI_TIMING_ZERO_PER100)
+    {
+        lqi += (RX_LQI_TIMING_WEIGHT * (RX_LQI_TIMING_ZERO_PER100 - timingPer100)) / RX_LQI_TIMING_ZERO_PER100;
+    }
+
+    if (quality.trainErrors < RX_LQI_TRAIN_ZERO_ERRORS)
+    {
+        lqi += (RX_LQI_TRAIN_WEIGHT * (RX_LQI_TRAIN_ZERO_ERRORS - (uint32_t)quality.trainErrors)) /
+               RX_LQI_TRAIN_ZERO_ERRORS;
+    }
+
+#if MICRF_ENABLE_RSSI == 1
+    if (snr >= RX_LQI_SNR_FULL_DB)
+    {
+        lqi += RX_LQI_SNR_WEIGHT;
+    }
+    else if (snr > 0)
+    {
+        lqi += (RX_LQI_SNR_WEIGHT * (uint32_t)snr) / RX_LQI_SNR_FULL_DB;
+    }
+#else
+    lqi = (lqi * 100u) / (100u - RX_LQI_SNR_WEIGHT);   // No RSSI, scale the other parts to 100
+#endif
+
+    return (lqi > 100u) ? 100u : (uint8_t)lqi;
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+#endif
+
+#if RX_ENG_DATA_ON == 1
+// <editor-fold defaultstate="collapsed" desc="static void engRecord( void )">
+/***********************************************************************************************************************
+ *
+ * Function Name: engRecord
+ *
+ * Purpose: Adds the frame in rxData_, which passed the CRC, to the histograms, inter-arrival and decode latency.
+ *
+ * Arguments: None
+ *
+ * Returns: None
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+static void engRecord( void )
+{
+    uint32_t timeMs = RX_TIME_MS();
+    uint32_t latencyMs = timeMs - rxData_.rxMs;
+    uint32_t gapMs = timeMs - engLastMs_;
+    uint8_t  bin = 0;
+
+    if (0 != engData_.goodFrames)
+    {
+        while ((0 != (gapMs >> (bin + 4))) && (bin < (RX_ENG_GAP_BINS - 1)))
+        {
+            bin++;
+        }
+        engData_.gapHist[bin]++;
+        engData_.gapSumMs += gapMs;
+        if (gapMs < engData_.gapMinMs)
+        {
+            engData_.gapMinMs = gapMs;
+        }
+        if (gapMs > engData_.gapMaxMs)
+        {
+            engData_.gapMaxMs = gapMs;
+        }
+    }
+    engLastMs_ = timeMs;
+    engData_.goodFrames++;
+    engData_.latencySumMs += latencyMs;
+    if (latencyMs > engData_.latencyMaxMs)
+    {
+        engData_.latencyMaxMs = latencyMs;
+    }
+    engData_.lenHist[rxData_.packet.cnt / (16 / RX_ENG_LEN_BINS)]++;
+#if MICRF_ENABLE_RSSI == 1
+    engData_.rssiHist[engRssiBin(rxData_.msgRssi)]++;
+    engData_.noiseHist[engRssiBin(rxData_.noiseRssi)]++;
+#endif
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="static uint8_t engRssiBin( int8_t rssi )">
+/***********************************************************************************************************************
+ *
+ * Function Name: engRssiBin
+ *
+ * Purpose: Returns the RSSI histogram bin of a value.
+ *
+ * Arguments: int8_t rssi - dBm
+ *
+ * Returns: uint8_t - 0 below RX_ENG_RSSI_MIN_DBM, RX_ENG_RSSI_BINS - 1 for everything above the range
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: Yes
+ *
+ **********************************************************************************************************************/
+static uint8_t engRssiBin( int8_t rssi )
+{
+    int16_t bin = 0;
+
+    if (rssi >= RX_ENG_RSSI_MIN_DBM)
+    {
+        bin = 1 + ((rssi - RX_ENG_RSSI_MIN_DBM) / RX_ENG_RSSI_STEP_DB);
+    }
+    return((uint8_t)((bin < RX_ENG_RSSI_BINS) ? bin : (RX_ENG_RSSI_BINS - 1)));
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+#endif
+
+#if RX_SESSION_ON == 1
+// <editor-fold defaultstate="collapsed" desc="static bool sessionUpdate( bool bHasSeq )">
+/***********************************************************************************************************************
+ *
+ * Function Name: sessionUpdate
+ *
+ * Purpose: Updates the table entry of the transmitter of the packet in rxData_, adding it if needed.  A frame with the
+ *          same sequence number as the last frame, within RX_SESSION_DUP_WINDOW_MS, is a repeated copy.
+ *
+ * Arguments: bool bHasSeq - The 1st data byte is a sequence number
+ *
+ * Returns: bool - true = new frame, false = repeated copy, drop it
+ *
+ * Side Effects: A transmitter that isn't on the allowlist may be evicted to make room.
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+static bool sessionUpdate( bool bHasSeq )
+{
+    sessionEntry_t *pEntry;
+    uint32_t       timeMs = RX_TIME_MS();
+    int16_t        idx = sessionInsert(&rxData_.packet.serialNum);
+    bool           bRetVal = true;
+
+    if (idx < 0)
+    {
+        return(true);   // Table full of allowed transmitters, can't track this one
+    }
+    pEntry = &sessions_[idx];
+    if (bHasSeq)
+    {
+        if (pEntry->bSeqValid && (pEntry->info.lastSeq == rxData_.packet.data[0]) &&
+            ((timeMs - pEntry->info.lastSeenMs) < RX_SESSION_DUP_WINDOW_MS))
+        {
+            pEntry->info.duplicates++;
+            bRetVal = false;
+        }
+        pEntry->info.lastSeq = rxData_.packet.data[0];
+        pEntry->bSeqValid = true;
+    }
+    if (bRetVal)
+    {
+        pEntry->info.frames++;
+        pEntry->info.lqiSum += rxData_.lqi;
+        if ((1 == pEntry->info.frames) || (rxData_.lqi < pEntry->info.minLqi))
+        {
+            pEntry->info.minLqi = rxData_.lqi;
+        }
+    }
+    pEntry->info.lastRssi = rxData_.msgRssi;
+    pEntry->info.lastLqi = rxData_.lqi;
+    pEntry->info.lastSeenMs = timeMs;
+    return(bRetVal);
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="static uint8_t sessionHash( const void *pSn )">
+/***********************************************************************************************************************
+ *
+ * Function Name: sessionHash
+ *
+ * Purpose: Returns the home index of a serial number.  FNV-1a over the bytes, so serialNum_t can be any size.
+ *
+ * Arguments: const void *pSn - Serial number
+ *
+ * Returns: uint8_t - Table index
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: Yes
+ *
+ **********************************************************************************************************************/
+static uint8_t sessionHash( const void *pSn )
+{
+    const uint8_t *pByte = (const uint8_t *)pSn;
+    uint32_t      hash = 2166136261UL;
+    uint8_t       i;
+
+    for (i = 0; i < sizeof(serialNum_t); i++)
+    {
+        hash = (hash ^ pByte[i]) * 16777619UL;
+    }
+    return((uint8_t)(hash & (RX_SESSION_TABLE_SIZE - 1)));
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="static int16_t sessionFind( const void *pSn )">
+/***********************************************************************************************************************
+ *
+ * Function Name: sessionFind
+ *
+ * Purpose: Looks up a serial number, linear probing from its home index.
+ *
+ * Arguments: const void *pSn - Serial number, may be unaligned (packet buffer)
+ *
+ * Returns: int16_t - Table index, -1 if not found
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: Yes (read only, also called at interrupt level)
+ *
+ **********************************************************************************************************************/
+static int16_t sessionFind( const void *pSn )
+{
+    uint8_t idx = sessionHash(pSn);
+    uint8_t i;
+
+    for (i = 0; i < RX_SESSION_TABLE_SIZE; i++)
+    {
+        if (eSESSION_EMPTY == sessions_[idx].state)
+        {
+            break;
+        }
+        if ((eSESSION_USED == sessions_[idx].state) &&
+            (0 == memcmp(&sessions_[idx].info.serialNum, pSn, sizeof(serialNum_t))))
+        {
+            return((int16_t)idx);
+        }
+        idx = (idx + 1) & (RX_SESSION_TABLE_SIZE - 1);
+    }
+    return(-1);
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="static int16_t sessionInsert( const void *pSn )">
+/***********************************************************************************************************************
+ *
+ * Function Name: sessionInsert
+ *
+ * Purpose: Returns the entry of a serial number, adding it if needed.  When the table is full, the transmitter not on
+ *          the allowlist that hasn't been heard from the longest is evicted.
+ *
+ * Arguments: const void *pSn - Serial number
+ *
+ * Returns: int16_t - Table index, -1 if the table is full of allowed transmitters
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+static int16_t sessionInsert( const void *pSn )
+{
+    int16_t  found = sessionFind(pSn);
+    uint32_t timeMs;
+    uint8_t  idx;
+    uint8_t  i;
+
+    if (found >= 0)
+    {
+        return(found);
+    }
+    // Not in the table, take the 1st free entry of the probe sequence.
+    idx = sessionHash(pSn);
+    for (i = 0; i < RX_SESSION_TABLE_SIZE; i++)
+    {
+        if (eSESSION_USED != sessions_[idx].state)
+        {
+            found = (int16_t)idx;
+            break;
+        }
+        idx = (idx + 1) & (RX_SESSION_TABLE_SIZE - 1);
+    }
+    if (found < 0)
+    {   // Table is full.  The probe sequence covers the whole table, so any evicted entry can be used.
+        timeMs = RX_TIME_MS();
+        for (i = 0; i < RX_SESSION_TABLE_SIZE; i++)
+        {
+            if (!sessions_[i].info.bAllowed && ((found < 0) ||
+                ((timeMs - sessions_[i].info.lastSeenMs) > (timeMs - sessions_[found].info.lastSeenMs))))
+            {
+                found = (int16_t)i;
+            }
+        }
+        if (found < 0)
+        {
+            return(-1);
+        }
+    }
+    sessions_[found].state = eSESSION_DELETED;  // Not visible to the ISR while it's being written
+    (void)memset(&sessions_[found].info, 0, sizeof(rxSession_t));
+    sessions_[found].bSeqValid = false;
+    (void)memcpy(&sessions_[found].info.serialNum, pSn, sizeof(serialNum_t));
+    sessions_[found].state = eSESSION_USED;
+    return(found);
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+#endif
+
+#if RX_REASSEMBLY_ON == 1
+// <editor-fold defaultstate="collapsed" desc="static void reasmFragment( void )">
+/***********************************************************************************************************************
+ *
+ * Function Name: reasmFragment
+ *
+ * Purpose: Stores the fragment in rxData_ in the reassembly slot of its message.  A new message takes a free slot or,
+ *          if none are free, the slot of the message that has been waiting the longest for a fragment.
+ *
+ * Arguments: None
+ *
+ * Returns: None
+ *
+ * Side Effects: Updates the reassembly statistics.
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+static void reasmFragment( void )
+{
+    reasmSlot_t *pSlot = NULL;
+    uint32_t    timeMs = RX_TIME_MS();
+    uint32_t    latencyMs;
+    uint8_t     msgId = rxData_.packet.data[0];
+    uint8_t     fragIdx = rxData_.packet.data[1] >> 4;
+    uint8_t     fragCnt = (uint8_t)((rxData_.packet.data[1] & 0x0F) + 1);
+    uint8_t     payloadCnt;
+    uint8_t     i;
+
+    // Only the last fragment may be short.
+    if ((rxData_.packet.cnt <= FRAG_HDR_SIZE) || (fragIdx >= fragCnt))
+    {
+        reasmStats_.invalid++;
+        return;
+    }
+    payloadCnt = rxData_.packet.cnt - FRAG_HDR_SIZE;
+    if ((payloadCnt > RX_FRAG_PAYLOAD_SIZE) || ((fragIdx != (fragCnt - 1)) && (payloadCnt != RX_FRAG_PAYLOAD_SIZE)))
+    {
+        reasmStats_.invalid++;
+        return;
+    }
+
+    reasmExpire(timeMs);
+    for (i = 0; i < RX_REASSEMBLY_SLOTS; i++)   // Is the message already being reassembled?
+    {
+        if (reasm_[i].bUsed && (reasm_[i].msgId == msgId) &&
+            (0 == memcmp(&reasm_[i].serialNum, &rxData_.packet.serialNum, sizeof(reasm_[i].serialNum))))
+        {
+            pSlot = &reasm_[i];
+            break;
+        }
+    }
+    if (NULL != pSlot)
+    {
+        if (pSlot->bComplete || (0 != (pSlot->fragMap & (1U << fragIdx))))
+        {   // Repeated fragment, or the message is complete and waiting for the application.
+            reasmStats_.duplicates++;
+            return;
+        }
+        if (pSlot->fragCnt != fragCnt)
+        {
+            reasmStats_.invalid++;
+            return;
+        }
+    }
+    else
+    {
+        for (i = 0; i < RX_REASSEMBLY_SLOTS; i++)   // New message, find a free slot
+        {
+            if (!reasm_[i].bUsed)
+            {
+                pSlot = &reasm_[i];
+                break;
+            }
+        }
+        if (NULL == pSlot)
+        {   // No free slots, drop the incomplete message that has been waiting the longest.
+            for (i = 0; i < RX_REASSEMBLY_SLOTS; i++)
+            {
+                if (!reasm_[i].bComplete && ((NULL == pSlot) || ((timeMs - reasm_[i].lastMs) > (timeMs - pSlot->lastMs))))
+                {
+                    pSlot = &reasm_[i];
+                }
+            }
+            if (NULL == pSlot)
+            {   // All slots have complete messages, the application hasn't called RX_getMessage().  Drop this one.
+                reasmStats_.dropped++;
+                return;
+            }
+            reasmStats_.evicted++;
+        }
+        (void)memset(pSlot, 0, sizeof(reasmSlot_t));
+        pSlot->bUsed = true;
+        (void)memcpy(&pSlot->serialNum, &rxData_.packet.serialNum, sizeof(pSlot->serialNum));
+        pSlot->msgId = msgId;
+        pSlot->fragCnt = fragCnt;
+        pSlot->firstMs = timeMs;
+        reasmStats_.started++;
+    }
+
+    (void)memcpy(&pSlot->data[fragIdx * RX_FRAG_PAYLOAD_SIZE], &rxData_.packet.data[FRAG_HDR_SIZE], payloadCnt);
+    pSlot->fragMap |= (uint16_t)(1U << fragIdx);
+    pSlot->lastMs = timeMs;
+    pSlot->msgRssi = rxData_.msgRssi;
+    pSlot->noiseRssi = rxData_.noiseRssi;
+    pSlot->lqi = rxData_.lqi;
+    pSlot->bitRate = rxData_.bitRate;
+    if (fragIdx == (fragCnt - 1))
+    {
+        pSlot->len = (uint16_t)((fragIdx * RX_FRAG_PAYLOAD_SIZE) + payloadCnt);
+    }
+    if (pSlot->fragMap == (uint16_t)((1UL << fragCnt) - 1))
+    {
+        pSlot->bComplete = true;
+        latencyMs = pSlot->lastMs - pSlot->firstMs;
+        reasmStats_.completed++;
+        reasmStats_.latencySumMs += latencyMs;
+        if (latencyMs < reasmStats_.latencyMinMs)
+        {
+            reasmStats_.latencyMinMs = latencyMs;
+        }
+        if (latencyMs > reasmStats_.latencyMaxMs)
+        {
+            reasmStats_.latencyMaxMs = latencyMs;
+        }
+    }
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="static void reasmExpire( uint32_t timeMs )">
+/***********************************************************************************************************************
+ *
+ * Function Name: reasmExpire
+ *
+ * Purpose: Drops the incomplete messages that haven't received a fragment within RX_REASSEMBLY_TIMEOUT_MS.
+ *
+ * Arguments: uint32_t timeMs - Current time
+ *
+ * Returns: None
+ *
+ * Side Effects: Updates the reassembly statistics.
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+static void reasmExpire( uint32_t timeMs )
+{
+    uint8_t i;
+
+    for (i = 0; i < RX_REASSEMBLY_SLOTS; i++)
+    {
+        if (reasm_[i].bUsed && !reasm_[i].bComplete && ((timeMs - reasm_[i].lastMs) > RX_REASSEMBLY_TIMEOUT_MS))
+        {
+            reasm_[i].bUsed = false;
+            reasmStats_.timedOut++;
+        }
+    }
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+#endif
+
+/* ****************************************************************************************************************** */
+/* Event Handlers */
+
+// <editor-fold defaultstate="collapsed" desc="void RX_messageReceived( uint8_t *pData, uint8_t cnt )">
+/***********************************************************************************************************************
+ *
+ * Function Name: RX_messageReceived
+ *
+ * Purpose: This function will be called at interrupt level.  This function needs to be kept to minimum CPU cycles.  If
+ *          the buffer is empty and the count is valid, copy the data to the primary buffer.  This allows another
+ *          message to be processed in the event the application hasn't processed the last message.
+ *
+ * Arguments: uint8_t *pData, uint8_t cnt
+ *
+ * Returns: N/A
+ *
+ * Side Effects: N/A
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+void RX_messageReceived( uint8_t *pData, uint8_t cnt )
+{
+#if RX_SESSION_ON == 1
+    if (bAllowlist_)    // Drop foreign transmitters now, before the copy and the CRC.
+    {
+        int16_t idx = -1;
+
+        if (cnt >= (offsetof(rxPacket_t, serialNum) + sizeof(serialNum_t)))
+        {
+            idx = sessionFind(&pData[offsetof(rxPacket_t, serialNum)]);
+        }
+        if ((idx < 0) || !sessions_[idx].info.bAllowed)
+        {
+#if RX_ENG_DATA_ON == 1        
+            engData_.serialRejected++;
+#endif
+            return;
+        }
+    }
+#endif
+    if (!bDataReady_)    // Don't collect unless the data in the buffer has already been copied.
+    {
+        if (cnt <= sizeof(rxDataBuffer_.packet)) // Is the count valid (will the source data fit in the buffer)?
+        {
+#if PIC_8_BIT == 1
+            /* If using an 8-bit PIC micro, use a for-loop to copy the data over.  Using memcpy creates reentrant code
+             * which the 8-bit PICs have an issue with (call graph). */
+            uint8_t *pRxPacketBuffer = (uint8_t *)&rxDataBuffer_.packet;
+            
+            while(cnt--)
+            {
+                *pRxPacketBuffer++ = *pData++; // Copy the source data to the buffer
+            }
+#else            
+            (void)memcpy(&rxDataBuffer_.packet, pData, cnt); // Copy the source data to the buffer
+#endif
+            
+#if MICRF_ENABLE_RSSI == 1   
+            rxDataBuffer_.msgRssi = MICRF_getRssiLastReceived();    // Get the RSSI of the message
+            rxDataBuffer_.noiseRssi = MICRF_getRssiNoiseFloor();    // Get the RSSI of the NoiseFloor
+#endif
+            rxDataBuffer_.bitRate = MICRF_getRxBitRate();   // Rate of this message (auto-baud may change it)
+#if MICRF_ENABLE_LQI == 1
+            rxDataBuffer_.lqi = lqiCompute();               // Only valid here, the next preamble clears it
 #endif
+            rxDataBuffer_.rxMs = RX_TIME_MS_ISR();
             bDataReady_ = true;                             // Set the flag that indicates we have a msg to process.
         }
 #if RX_ENG_DATA_ON == 1        
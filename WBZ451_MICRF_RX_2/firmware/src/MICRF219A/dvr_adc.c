@@ -24,7 +24,7 @@
  ***********************************************************************************************************************
  *
  * Notes:  This ADC driver is simply an example of what a customer may use.  The ADC is NOT the intent of the demo.
- *         This module is created simply to convert the ADC reading from raw ADC counts to mV and send the data to the
+ *         This module is created simply to pass the raw ADC reading (counts) of the RSSI pin to the
  *         receiver module.  How the customer does this may vary.
  * 
  **********************************************************************************************************************/
@@ -63,7 +63,6 @@
 static bool     bProcessAdcResult_ = false;
 static void (*fpAdcCallBack_)(uint16_t);
 uint16_t adcValue = 0;
-uint16_t mV = 0;
         
 // </editor-fold>
 
@@ -140,14 +139,14 @@ void DVR_ADC_disable( void )
 /* ****************************************************************************************************************** */
 // </editor-fold>
 
-// <editor-fold defaultstate="collapsed" desc="void DVR_ADC_setCallback( void (* fpCallbackFunction)( uint16_t adcVolts_mV ) )">
+// <editor-fold defaultstate="collapsed" desc="void DVR_ADC_setCallback( void (* fpCallbackFunction)( uint16_t adcCode ) )">
 /***********************************************************************************************************************
  *
  * Function Name: DVR_ADC_setCallback
  *
  * Purpose: Sets a call-back function when the data has been processed.
  *
- * Arguments: void (* fpCallbackFunction)( uint16_t adcVolts_mV )
+ * Arguments: void (* fpCallbackFunction)( uint16_t adcCode )
  *
  * Returns: None
  *
@@ -158,7 +157,7 @@ void DVR_ADC_disable( void )
  * Notes:  Call back at non-interrupt level!
  *
  **********************************************************************************************************************/
-void DVR_ADC_setCallback( void (* fpCallbackFunction)( uint16_t adcVolts_mV ) )
+void DVR_ADC_setCallback( void (* fpCallbackFunction)( uint16_t adcCode ) )
 {
     fpAdcCallBack_ = fpCallbackFunction;
 }
@@ -186,8 +185,7 @@ void DVR_ADC_processConversion( void )
     if (bProcessAdcResult_)
     {
         bProcessAdcResult_ = false;        
-        mV = (adcValue * 3000) / 4095; // Convert the ADC value to mV  
-        fpAdcCallBack_(mV);
+        fpAdcCallBack_(adcValue);       // Raw ADC counts, converted to dBm by the MICRF219A driver
     }
 }
 /* ****************************************************************************************************************** */
@@ -54,17 +54,50 @@
 /* ****************************************************************************************************************** */
 /* MACRO DEFINITIONS */
 
-/* The macro below is used with the Sample Timer to set the bit rate.  */
-#define RX_SAMPLES_PER_BIT      ((uint8_t)10)           /* Sample rate based on the timer call-back. */
+/* The samples per bit are set by the rate profile, see rateProfiles_[].  */
 #define RX_DATA_ARRAY_SIZE      ((uint8_t)50)           /* Largest amount of decoded manchester data allowed */
 #define RX_MINIMUM_PACKET_SIZE  ((uint8_t)3)            /* Minimum number of bytes to be considered a message */
 #define PREAMBLE                ((uint16_t)0xAA3A)      /* Contains the last byte of training and the preamble. */
+#define TRAINING                ((uint16_t)0xAAAA)      /* The 16 chips of training before PREAMBLE */
+#define TRAINING_CHIPS          ((uint8_t)32)           /* Chips sliced for a full TRAINING check (with PREAMBLE) */
 
-/* This is custom per project.  The values below work for the demo.  This timer value along with RX_SAMPLES_PER_BIT is 
- * used to set the bit rate. */
+/* This is custom per project.  The values below work for the demo.  The timer prescaler and period along with the
+ * samples per bit are used to set the bit rate, see rateProfiles_[]. */
 
 #define SAMPLE_TIMER_START()    TC0_TimerStart()                               /* Used to start the timer */
 #define SAMPLE_TIMER_STOP()     TC0_TimerStop()                                /* Used to stop the timer */
+#define SAMPLE_TIMER_PERIOD_SET(x)  TC0_Timer16bitPeriodSet(x)                 /* Sets the timer period (CC0) */
+/* The prescaler is enable protected, only change it while the timer is stopped. */
+#define SAMPLE_TIMER_PRESCALER_SET(x) TC0_REGS->COUNT16.TC_CTRLA = \
+            ((TC0_REGS->COUNT16.TC_CTRLA & ~TC_CTRLA_PRESCALER_Msk) | TC_CTRLA_PRESCALER(x))
+
+/* Auto-baud.  While hunting, the pin is sampled at a fixed rate and the run lengths of the 0xAA training are measured.
+ * Once AUTOBAUD_RUN_CNT runs agree, the sample timer is locked to the measured rate for that frame.  The prescaler is
+ * fixed in auto-baud mode, so only the period has to change from the ISR. */
+#define AUTOBAUD_PRESCALER      TC_CTRLA_PRESCALER_DIV16_Val    /* 48MHz / 16 = 3MHz timer clock */
+#define AUTOBAUD_TIMER_HZ       ((uint32_t)3000000)             /* Timer clock with AUTOBAUD_PRESCALER */
+#define AUTOBAUD_HUNT_PERIOD    ((uint16_t)62)                  /* 47619Hz hunt sample rate */
+#define AUTOBAUD_RUN_CNT        ((uint8_t)8)                    /* Runs (chips) measured, must be even */
+#define AUTOBAUD_PAIR_MIN       ((uint16_t)4)                   /* A chip must be at least 2 hunt samples long */
+#define AUTOBAUD_TICKS_MIN      ((uint16_t)240)                 /* Fastest chip, 12.5k chips/s, ISR budget */
+#define AUTOBAUD_LOCK_TIMEOUT   ((uint8_t)128)                  /* Bits to find the preamble once locked */
+
+#if DVR_PROF_ON == 1
+#define PROF_PATH(x)            eProfPath = (x)                 /* Path the ISR took, the deepest one is recorded */
+#else
+#define PROF_PATH(x)
+#endif
+
+#if MICRF_ENABLE_LQI == 1
+#define TIMING_CORRECTED()      rxVars_.rxData.timingCnt++      /* Slicer timing adjusted, for the frame quality */
+#else
+#define TIMING_CORRECTED()
+#endif
+
+#if MICRF_ENABLE_CAPTURE == 1
+#define CAPTURE_RUN_MAX         ((uint8_t)128)                  /* Longest run of one capture entry, in samples */
+#define CAPTURE_IDX_MASK        ((uint16_t)(MICRF_CAPTURE_SIZE - 1))
+#endif
 
 /* RSSI information is NOT needed for data reception.  The RSSI can be useful when troubleshooting or diags. */
 /* MICRF_ENABLE_RSSI is defined in the dvr_micrf220_219a.h file.  */
@@ -77,21 +110,30 @@
 #define ARRAYIDXCNT(x)          (sizeof(x)/sizeof(x[0]))
 #endif
 
-/* This data is taken directly from the MICRF220_219A datasheet, page 4.  These macros are for converting the ADC mV value
- * to dBm.  The output to dBm is fairly accurate, but it doesn't follow the curve on the datasheet exactly.  It will
- * give the user a fairly good idea of dBm.  */
-#define RSSI_MIN_mV             ((int16_t)500)              /* 0.5 Volts at -110dBm */
+/* RSSI pin voltage vs. RF input level (rssiCurve_mV_), taken from the MICRF220_219A datasheet, page 4.  The RSSI
+ * output is flat below RSSI_MIN_dBm and saturates above RSSI_MAX_dBm. */
 #define RSSI_MIN_dBm            ((int8_t)-110)
-#define RSSI_MAX_mV             ((int16_t)2000)             /* 2.0 Volts at -50dBm */
 #define RSSI_MAX_dBm            ((int8_t)-50)
-#define RSSI_RANGE_mV           ((int16_t)(RSSI_MAX_mV - RSSI_MIN_mV))
-#define RSSI_dBm_RANGE_100x     ((int16_t)(((int16_t)RSSI_MAX_dBm - RSSI_MIN_dBm)) * 100)
-#define dBm_PER_VOLT_100x       ((int8_t)(RSSI_dBm_RANGE_100x / RSSI_RANGE_mV))
-#define RSSI_mV_TO_dBm(x)       ((int8_t)(RSSI_MIN_dBm + (((x - RSSI_MIN_mV) * dBm_PER_VOLT_100x) / 100)))
+#define RSSI_CURVE_STEP_dB      ((int8_t)10)                /* rssiCurve_mV_ has a point every 10dB from RSSI_MIN_dBm */
+#define RSSI_CURVE_PTS          ((uint8_t)(((RSSI_MAX_dBm - RSSI_MIN_dBm) / RSSI_CURVE_STEP_dB) + 1))
+#define RSSI_ADC_MAX            ((int32_t)((1 << MICRF_RSSI_ADC_BITS) - 1))
+#define RSSI_mV_TO_CODE(x)      ((int32_t)((((int32_t)(x) * RSSI_ADC_MAX) + (MICRF_RSSI_ADC_VREF_mV / 2)) / \
+                                           MICRF_RSSI_ADC_VREF_mV))
+
+/* ADC code to dBm lookup table, built from the curve (and the calibration) by rssiBuildTable().  Every entry covers
+ * 2^RSSI_TABLE_SHIFT ADC codes. */
+#define RSSI_TABLE_SIZE         ((uint16_t)256)
+#define RSSI_TABLE_SHIFT        (MICRF_RSSI_ADC_BITS - 8)
 
-#define RSSI_AVE_CNT            ((uint8_t)16)               /* Running average indecies, number of samples. */
-#define RSSI_NF_CNT             ((uint8_t)10)               /* Number of ADC samples before logging RSSI sample. */
+/* RSSI averages, exponential with a weight of 1/2^shift.  The message average is cumulative until 2^shift samples are
+ * in, so it doesn't start from 0.  The noise floor starts from its 1st sample and falls faster than it rises, it
+ * follows the quiet samples, not the average.  The shifts must be 7 or less. */
+#define RSSI_EWMA_FRAC          8                           /* Fraction bits of the averages */
+#define RSSI_MSG_SHIFT          3                           /* Message, time constant of 8 samples */
+#define RSSI_NF_RISE_SHIFT      7                           /* Noise floor going up, 128 samples */
+#define RSSI_NF_FALL_SHIFT      4                           /* Noise floor going down, 16 samples */
 #define RSSI_NF_CNT_AFTER_DATA  ((uint8_t)250)              /* Number of ADC samples before logging RSSI sample. */
+#define SQUELCH_HOLD_CNT        ((uint8_t)8)                /* RSSI samples below the threshold before the squelch closes */
 
 #endif
 
@@ -108,12 +150,18 @@
 #if MICRF_ENABLE_RSSI == 1                  /* MICRF_ENABLE_RSSI is defined in the dvr_micrf220_219a.h file.  */
 typedef struct
 {
-    uint32_t arraySum;                      // Sum of all of array_mV.
-    uint16_t array_mV[RSSI_AVE_CNT];        // Contains an array of the RSSI in mV
-    int16_t  rssiAve_mV;                    // Contains the running average of the RSSI array.
-    uint8_t  arrayIdx;                      // Contains the index to store the next sample in array_mV
-    uint8_t  noiseFloorCnt;                 // Only take noise floor readings every xxx times.
+    int32_t  ave;                           // Average of the ADC codes, RSSI_EWMA_FRAC fraction bits
+    uint8_t  cnt;                           // Samples in the average, up to the weight (see rssiTrack)
+    uint8_t  noiseFloorCnt;                 // Noise floor only: samples to skip after a message
 }rssi_t;                                    // Contains all of the RSSI data
+
+typedef struct
+{
+    uint8_t  thresholdDb;                   // Open on a RSSI sample this far above the noise floor, 0 = squelch off
+    uint8_t  holdCnt;                       // RSSI samples left before closing
+    bool     bOpen;                         // The slicer runs, always true with the squelch off
+    bool     bRestart;                      // Set on closing, the ISR resets the slicer on the 1st slice after opening
+}squelch_t;                                 // Skips the slicer on an idle channel, see MICRF_setSquelch
 #endif
 
 typedef struct
@@ -128,19 +176,74 @@ typedef struct
     bool        bCollectData;               // Indicates if data is being collected
     bool        bSkipSlice;                 // Indication to skip a sample, used to adjust the timing for sync
     bool        bLogMsgRssi;                // Is the ADC value detecting noise or a message
+#if MICRF_ENABLE_LQI == 1
+    uint16_t    trainWord;                  // Chips shifted out of manchesterWord, the training at the preamble
+    uint8_t     chipCnt;                    // Chips sliced since the slicer started, up to TRAINING_CHIPS
+    uint8_t     trainChips;                 // Chips of trainWord checked at the preamble
+    uint8_t     trainErrors;                // Wrong chips of trainWord at the preamble
+    uint16_t    marginSum;                  // Vote margins (|2 x logicHighCnt - samplesPerBit|) since the preamble
+    uint16_t    timingCnt;                  // Slicer timing corrections since the preamble
+#endif
 }rxData_t;                                  // Contains all data for collecting a message
 
+typedef struct
+{
+    uint8_t     runs[AUTOBAUD_RUN_CNT];     // Circular buffer of the last run lengths, in hunt samples
+    uint8_t     runIdx;                     // Next entry in runs
+    uint8_t     runCnt;                     // Number of valid entries in runs
+    uint8_t     runLen;                     // Length of the current run, 0 until the first edge
+    uint8_t     lastState;                  // Pin state of the current run
+    uint8_t     lockedBits;                 // Bits since the lock, used for the preamble timeout
+    bool        bEnabled;                   // Auto-baud mode
+    bool        bHunting;                   // Measuring the training (true) or locked to a transmitter (false)
+}autoBaud_t;                                // Contains all data for the auto-baud detection
+
 typedef struct
 {
 #if MICRF_ENABLE_RSSI == 1                      /* MICRF_ENABLE_RSSI is defined in the dvr_micrf220_219a.h file.  */
     rssi_t      rssiNoiseFloor;                 /* Contains all of the RSSI values */
     rssi_t      rssiMessage;                    /* Contains all of the RSSI values */
+    squelch_t   squelch;                        /* RSSI squelch */
 #endif
     rxData_t    rxData;                         /* Contains all of received data information */
     void (*pRxFunctionPtr)(uint8_t *, uint8_t); /* Function that gets called when a message is received */
+    autoBaud_t  autoBaud;                       /* Auto-baud detection */
+    eMICRF_rate_t eRate;                        /* Rate profile in use */
+    uint8_t     samplesPerBit;                  /* Samples per bit of the rate profile in use (or the locked rate) */
+    uint16_t    bitRate;                        /* Data rate the slicer is running at, bits/second */
     bool        bRxEnabled;                     /* Enable or disable the RX module */
+    MICRF_linkStats_t stats;                    /* Frame detection counters */
 }rxVars_t;
 
+#if MICRF_ENABLE_CAPTURE == 1
+typedef struct
+{
+    uint8_t     ring[MICRF_CAPTURE_SIZE];       /* Run-length entries, see MICRF_CAP_ENTRY_xxx */
+    uint32_t    pushed;                         /* Entries written since armed */
+    uint32_t    trigPushed;                     /* Value of pushed when the trigger fired */
+    uint16_t    head;                           /* Next entry to write */
+    uint16_t    len;                            /* Entries in the ring */
+    uint16_t    postCnt;                        /* Entries to capture after the trigger */
+    uint16_t    postLeft;                       /* Entries left to capture after the trigger */
+    uint16_t    freezeCnt;                      /* Captures frozen */
+    uint8_t     runLevel;                       /* Level of the run being counted */
+    uint8_t     runLen;                         /* Samples in the run being counted, 0 = none yet */
+    uint8_t     triggers;                       /* Armed triggers, MICRF_CAP_TRIG_xxx */
+    uint8_t     trigger;                        /* Trigger that fired */
+    uint8_t     eRate;                          /* Rate profile when frozen */
+    bool        bAutoBaud;                      /* Auto-baud mode when frozen */
+    eMICRF_capState_t eState;                   /* Capture state */
+}capture_t;                                     /* Raw sample capture */
+#endif
+
+typedef struct
+{
+    uint16_t    bitRate;                        /* Nominal data rate, bits/second */
+    uint8_t     prescaler;                      /* TC_CTRLA_PRESCALER_xxx_Val */
+    uint16_t    period;                         /* Timer period (CC0) */
+    uint8_t     samplesPerBit;                  /* Samples per Manchester bit, must be even */
+}rateProfile_t;                                 /* Sample timer settings for a rate profile */
+
 // </editor-fold>
 
 // <editor-fold defaultstate="collapsed" desc="Local Function Prototypes">
@@ -148,6 +251,22 @@ typedef struct
 /* FUNCTION PROTOTYPES */
 
 void MICRF_sampleTimerISR( TC_TIMER_STATUS status, uintptr_t context );  // Technically, this is a global function, but only accessed by the interrupt.
+static void sampleTimerConfig( void );
+static void autoBaudHunt( void );
+static void autoBaudMeasure( uint8_t sliceInputState );
+#if MICRF_ENABLE_CAPTURE == 1
+static void captureSample( uint8_t sliceInputState );
+static void captureFire( uint8_t trigger );
+#endif
+#if MICRF_ENABLE_RSSI == 1
+static int32_t rssiCurveCode( int8_t dBm );
+static void rssiBuildTable( void );
+static void squelchUpdate( uint16_t adcCode );
+static void rssiTrack( volatile rssi_t *pRssi, uint16_t adcCode, uint8_t shift );
+#endif
+#if MICRF_ENABLE_LQI == 1
+static void lqiSync( void );
+#endif
 
 // </editor-fold>
 
@@ -155,6 +274,21 @@ void MICRF_sampleTimerISR( TC_TIMER_STATUS status, uintptr_t context );  // Tech
 /* ****************************************************************************************************************** */
 /* CONSTANTS */
 
+/* TC0 is clocked at 48MHz.  Sample rate = 48MHz / prescaler / (period + 1).  Chip rate = sample rate / samples per bit.
+ * The data rate is half of the chip rate (Manchester).  The MICRF114 driver has the matching transmit table. */
+static const rateProfile_t rateProfiles_[eMICRF_RATE_CNT] =
+{
+    {  500, TC_CTRLA_PRESCALER_DIV256_Val,  17, 10 },  /* 10417Hz sample, 1042 chips/s (legacy) */
+    { 1000, TC_CTRLA_PRESCALER_DIV16_Val,  149, 10 },  /* 20000Hz sample, 2000 chips/s */
+    { 2000, TC_CTRLA_PRESCALER_DIV16_Val,   93,  8 },  /* 31915Hz sample, 3989 chips/s */
+    { 4000, TC_CTRLA_PRESCALER_DIV16_Val,   62,  6 },  /* 47619Hz sample, 7937 chips/s */
+};
+
+#if MICRF_ENABLE_RSSI == 1
+/* RSSI pin voltage at RSSI_MIN_dBm, RSSI_MIN_dBm + 10dB, ... RSSI_MAX_dBm.  Must be increasing. */
+static const uint16_t rssiCurve_mV_[RSSI_CURVE_PTS] = { 500, 750, 1000, 1250, 1500, 1750, 2000 };
+#endif
+
 // </editor-fold>
 
 // <editor-fold defaultstate="collapsed" desc="File Variables - Static">
@@ -162,6 +296,17 @@ void MICRF_sampleTimerISR( TC_TIMER_STATUS status, uintptr_t context );  // Tech
 /* FILE VARIABLE DEFINITIONS */
 
 static volatile rxVars_t rxVars_;   // Contains all of the local data this module uses.
+#if MICRF_ENABLE_CAPTURE == 1
+static volatile capture_t capture_; // Raw sample capture, not cleared by MICRF_init()
+#endif
+#if DVR_PROF_ON == 1
+static volatile profStat_t prof_[eMICRF_PROF_CNT];  // ISR execution times, not cleared by MICRF_init()
+#endif
+#if MICRF_ENABLE_RSSI == 1
+static int8_t   rssiTable_[RSSI_TABLE_SIZE];        // dBm of every 2^RSSI_TABLE_SHIFT ADC codes
+static MICRF_rssiCal_t rssiCal_;                    // Board calibration, not cleared by MICRF_init()
+static bool     bRssiCal_ = false;                  // rssiCal_ is in use
+#endif
 
 // </editor-fold>
 
@@ -183,12 +328,32 @@ static volatile rxVars_t rxVars_;   // Contains all of the local data this modul
  *
  * Reentrant Code: No
  *
+ * Note:  The rate profile, the auto-baud mode and the squelch will not be lost if the module is re-initialized.
+ *
  **********************************************************************************************************************/
 void MICRF_init( void )
 {
+    eMICRF_rate_t eRate = rxVars_.eRate;                // Re-initializing the module will not lose the rate profile.
+    bool bAutoBaud = rxVars_.autoBaud.bEnabled;         // ... or the auto-baud mode.
+#if MICRF_ENABLE_RSSI == 1
+    uint8_t squelchDb = rxVars_.squelch.thresholdDb;    // ... or the squelch.
+#endif
+
     RX_DATA_PIN_CFG();                                  // Configure the RX data pin as an input
+    DVR_PROF_init();                                    // Start the cycle counter (if profiling is built in)
     (void)memset((void *)&rxVars_, 0, sizeof(rxVars_)); // Clear all of the variables
     rxVars_.pRxFunctionPtr = NULL;                      // Set the function point to NULL
+    rxVars_.eRate = eRate;                              // Restore the rate profile
+    rxVars_.samplesPerBit = rateProfiles_[eRate].samplesPerBit;
+    rxVars_.bitRate = rateProfiles_[eRate].bitRate;
+    rxVars_.autoBaud.bEnabled = bAutoBaud;
+    rxVars_.autoBaud.bHunting = bAutoBaud;
+#if MICRF_ENABLE_RSSI == 1
+    rssiBuildTable();                                   // dBm lookup table, with the calibration if any
+    rxVars_.squelch.thresholdDb = squelchDb;
+    rxVars_.squelch.holdCnt = SQUELCH_HOLD_CNT;
+    rxVars_.squelch.bOpen = true;                       // Open until the channel is found idle
+#endif
 }
 /* ****************************************************************************************************************** */
 // </editor-fold>
@@ -213,8 +378,7 @@ void MICRF_init( void )
  **********************************************************************************************************************/
 int8_t MICRF_getRssiNoiseFloor( void )
 {
-    int8_t myVal = RSSI_mV_TO_dBm(rxVars_.rssiNoiseFloor.rssiAve_mV);
-    return(myVal);
+    return(rssiTable_[MICRF_getRssiRawNoiseFloor() >> RSSI_TABLE_SHIFT]);
 }
 /* ****************************************************************************************************************** */
 // </editor-fold>
@@ -237,7 +401,152 @@ int8_t MICRF_getRssiNoiseFloor( void )
  **********************************************************************************************************************/
 int8_t MICRF_getRssiLastReceived( void )
 {
-    return(RSSI_mV_TO_dBm(rxVars_.rssiMessage.rssiAve_mV));
+    return(rssiTable_[MICRF_getRssiRawLastReceived() >> RSSI_TABLE_SHIFT]);
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="uint16_t MICRF_getRssiRawNoiseFloor( void )">
+/***********************************************************************************************************************
+ *
+ * Function Name: MICRF_getRssiRawNoiseFloor
+ *
+ * Purpose: Reads the latest noise floor value as an ADC code, used to calibrate the RSSI.
+ *
+ * Arguments: None
+ *
+ * Returns: uint16_t - Noise floor, ADC code
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: Yes
+ *
+ **********************************************************************************************************************/
+uint16_t MICRF_getRssiRawNoiseFloor( void )
+{
+    return((uint16_t)(rxVars_.rssiNoiseFloor.ave >> RSSI_EWMA_FRAC));
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="uint16_t MICRF_getRssiRawLastReceived( void )">
+/***********************************************************************************************************************
+ *
+ * Function Name: MICRF_getRssiRawLastReceived
+ *
+ * Purpose: Reads the last successful received data's RSSI as an ADC code, used to calibrate the RSSI.
+ *
+ * Arguments: None
+ *
+ * Returns: uint16_t - Average of the last message samples, ADC code
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: Yes
+ *
+ **********************************************************************************************************************/
+uint16_t MICRF_getRssiRawLastReceived( void )
+{
+    return((uint16_t)(rxVars_.rssiMessage.ave >> RSSI_EWMA_FRAC));
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="bool MICRF_setRssiCal( const MICRF_rssiCal_t *pCal )">
+/***********************************************************************************************************************
+ *
+ * Function Name: MICRF_setRssiCal
+ *
+ * Purpose: Sets the two-point calibration of the RSSI input.  The datasheet curve is scaled and shifted so it goes
+ *          through both measured points, which corrects the gain and the offset of the board (RSSI pin load, ADC
+ *          reference).
+ *
+ * Arguments: const MICRF_rssiCal_t *pCal - Calibration, NULL to go back to the datasheet curve
+ *
+ * Returns: bool - false if the calibration is rejected (level outside RSSI_MIN_dBm to RSSI_MAX_dBm, both levels the
+ *          same, or the code not increasing with the level).  The calibration in use is not changed.
+ *
+ * Side Effects: Rebuilds the dBm lookup table.
+ *
+ * Reentrant Code: No
+ *
+ * Note:  The calibration will not be lost if the module is re-initialized.
+ *
+ **********************************************************************************************************************/
+bool MICRF_setRssiCal( const MICRF_rssiCal_t *pCal )
+{
+    if (pCal == NULL)
+    {
+        bRssiCal_ = false;
+    }
+    else
+    {
+        if ((pCal->dBm[0] < RSSI_MIN_dBm) || (pCal->dBm[0] > RSSI_MAX_dBm) ||
+            (pCal->dBm[1] < RSSI_MIN_dBm) || (pCal->dBm[1] > RSSI_MAX_dBm) || (pCal->dBm[0] == pCal->dBm[1]) ||
+            ((pCal->dBm[1] > pCal->dBm[0]) != (pCal->code[1] > pCal->code[0])) || (pCal->code[0] == pCal->code[1]) ||
+            (pCal->code[0] > RSSI_ADC_MAX) || (pCal->code[1] > RSSI_ADC_MAX))
+        {
+            return(false);
+        }
+        rssiCal_ = *pCal;
+        bRssiCal_ = true;
+    }
+    rssiBuildTable();
+    return(true);
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="void MICRF_setSquelch( uint8_t thresholdDb )">
+/***********************************************************************************************************************
+ *
+ * Function Name: MICRF_setSquelch
+ *
+ * Purpose: Sets the RSSI squelch.  While the squelch is closed, the sample ISR only checks it and returns: no voting,
+ *          preamble compare or training measurement is done.  MICRF_setAdcValue() opens it as soon as a RSSI sample
+ *          is thresholdDb above the noise floor and closes it SQUELCH_HOLD_CNT samples after the last one (never while
+ *          a message is being received).
+ *
+ * Arguments: uint8_t thresholdDb - RSSI above the noise floor that opens the squelch, 0 = off (the slicer always runs)
+ *
+ * Returns: None
+ *
+ * Side Effects: The squelch is opened, it closes once the channel is found idle.
+ *
+ * Reentrant Code: No
+ *
+ * Note:  The RSSI ADC must be running (MICRF_setAdcValue() called every few bits), or the squelch would never open
+ *        again.  A signal less than thresholdDb above the noise floor is not received.
+ *
+ **********************************************************************************************************************/
+void MICRF_setSquelch( uint8_t thresholdDb )
+{
+    rxVars_.squelch.holdCnt = SQUELCH_HOLD_CNT;
+    rxVars_.squelch.bOpen = true;
+    rxVars_.squelch.thresholdDb = thresholdDb;
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="bool MICRF_getSquelchOpen( void )">
+/***********************************************************************************************************************
+ *
+ * Function Name: MICRF_getSquelchOpen
+ *
+ * Purpose: Returns true if the slicer is running, false if the squelch skips it.
+ *
+ * Arguments: None
+ *
+ * Returns: bool
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: Yes
+ *
+ **********************************************************************************************************************/
+bool MICRF_getSquelchOpen( void )
+{
+    return(rxVars_.squelch.bOpen || rxVars_.rxData.bCollectData);
 }
 /* ****************************************************************************************************************** */
 // </editor-fold>
@@ -265,62 +574,59 @@ bool MICRF_getReceivingMsgDataStatus( void )
 /* ****************************************************************************************************************** */
 // </editor-fold>
 
-// <editor-fold defaultstate="collapsed" desc="void MICRF_setAdcValue( uint16_t adcVolts_mV )">
+// <editor-fold defaultstate="collapsed" desc="void MICRF_setAdcValue( uint16_t adcCode )">
 /***********************************************************************************************************************
  *
  * Function Name: MICRF_setAdcValue
  *
  * Purpose: This function should be called with the latest ADC reading every 4 bits worth of data.  For example, if the
  *          bit rate is 2KHz, then this function should be called 2KHz / 4 = 500Hz or 2mS.  The module will store the 
- *          calculated data in an array to perform a running average.
+ *          calculated data in a running average.
  *
- * Arguments: uint16_t adcVolts_mV - This function is expecting the voltage * 1000.  For example 1.234V would be 1234mV
+ * Arguments: uint16_t adcCode - Raw ADC reading of the RSSI pin, MICRF_RSSI_ADC_BITS bits, full scale is
+ *                                 MICRF_RSSI_ADC_VREF_mV
  *
  * Returns: None
  *
- * Side Effects: Adds the ADC mV value to the array.
+ * Side Effects: Adds the ADC code to the message or noise floor average.  Opens or closes the squelch.
  *
  * Reentrant Code: No
  *
  * Notes:  For the demo, the ADC is triggered by the timer.  The ADC ISR is located in this module.  For the customer,
- *         the ADC may be other conversions.  So, it is up to the customer to configure their ADC, convert the ADC value
- *         to mV and call this function.
+ *         the ADC may be other conversions.  So, it is up to the customer to configure their ADC and call this
+ *         function with the raw result.  The average is only converted to dBm when it is read.
  * 
  **********************************************************************************************************************/
-void MICRF_setAdcValue( uint16_t adcVolts_mV )
+void MICRF_setAdcValue( uint16_t adcCode )
 {
+    if (0 != rxVars_.squelch.thresholdDb)
+    {
+        squelchUpdate(adcCode);
+    }
     if (rxVars_.rxData.bLogMsgRssi && rxVars_.rxData.bCollectData)  // Is the RSSI value for the Data Message?
-    {   // Check bounds on the index before doing anything!
-        if (rxVars_.rssiMessage.arrayIdx >= ARRAYIDXCNT(rxVars_.rssiMessage.array_mV))  
-        { 
-            rxVars_.rssiMessage.arrayIdx = 0;
-        }
-        // Compute the RSSI average
-        rxVars_.rssiMessage.arraySum = (rxVars_.rssiMessage.arraySum + adcVolts_mV) - 
-                                       rxVars_.rssiMessage.array_mV[rxVars_.rssiMessage.arrayIdx];
-        rxVars_.rssiMessage.array_mV[rxVars_.rssiMessage.arrayIdx] = adcVolts_mV;
-        rxVars_.rssiMessage.rssiAve_mV = rxVars_.rssiMessage.arraySum / ARRAYIDXCNT(rxVars_.rssiMessage.array_mV);
-        rxVars_.rssiMessage.arrayIdx++;
+    {
+        rssiTrack(&rxVars_.rssiMessage, adcCode, RSSI_MSG_SHIFT);
         // Add a delay after collecting data to allow the RSSI on the MICRF220_219A to settle.
         rxVars_.rssiNoiseFloor.noiseFloorCnt = RSSI_NF_CNT_AFTER_DATA;  
     }
     else if (!rxVars_.rxData.bCollectData)  // If not collecting data, collect noise floor data
     {
-        if (0 == rxVars_.rssiNoiseFloor.noiseFloorCnt--)    // slow down the noise floor collection by using this cntr.
+        rxVars_.rssiMessage.cnt = 0;        // The next message starts a new average, the last one can still be read
+        if (0 != rxVars_.rssiNoiseFloor.noiseFloorCnt)
         {
-            rxVars_.rssiNoiseFloor.noiseFloorCnt = RSSI_NF_CNT; // Reset the counter value.
-            // Check bounds on the index before doing anything!
-            if (rxVars_.rssiNoiseFloor.arrayIdx >= ARRAYIDXCNT(rxVars_.rssiNoiseFloor.array_mV))  
-            {   // Reset the index!
-                rxVars_.rssiNoiseFloor.arrayIdx = 0;
-            }
-            // Compute the RSSI average
-            rxVars_.rssiNoiseFloor.arraySum = (rxVars_.rssiNoiseFloor.arraySum + adcVolts_mV) - 
-                                              rxVars_.rssiNoiseFloor.array_mV[rxVars_.rssiNoiseFloor.arrayIdx];
-            rxVars_.rssiNoiseFloor.array_mV[rxVars_.rssiNoiseFloor.arrayIdx] = adcVolts_mV;
-            rxVars_.rssiNoiseFloor.rssiAve_mV = rxVars_.rssiNoiseFloor.arraySum / 
-                                                ARRAYIDXCNT(rxVars_.rssiNoiseFloor.array_mV);
-            rxVars_.rssiNoiseFloor.arrayIdx++;
+            rxVars_.rssiNoiseFloor.noiseFloorCnt--;
+        }
+        else if (0 == rxVars_.rssiNoiseFloor.cnt)
+        {   // 1st sample since MICRF_init(), taken as is.  No cumulative start for the noise floor, it would learn a
+            // message on the air at start-up as the floor.  It only rises at the slow rate.
+            rxVars_.rssiNoiseFloor.ave = (int32_t)adcCode << RSSI_EWMA_FRAC;
+            rxVars_.rssiNoiseFloor.cnt = UINT8_MAX;
+        }
+        else
+        {
+            rssiTrack(&rxVars_.rssiNoiseFloor, adcCode,
+                      (((int32_t)adcCode << RSSI_EWMA_FRAC) < rxVars_.rssiNoiseFloor.ave) ?
+                      RSSI_NF_FALL_SHIFT : RSSI_NF_RISE_SHIFT);
         }
     }
 }
@@ -374,9 +680,11 @@ void MICRF_rxEnable( bool bEnable )
 {
     if (bEnable)
     {
-        rxVars_.bRxEnabled = true;  // Set the flag that indicates the module is enabled
         MICRF_init();               // Initialize the module
-        TC0_TimerCallbackRegister(MICRF_sampleTimerISR, (uintptr_t)NULL); // Set the ISR callback 
+        rxVars_.bRxEnabled = true;  // Set the flag that indicates the module is enabled (after init, it clears it)
+        TC0_TimerCallbackRegister(MICRF_sampleTimerISR, (uintptr_t)NULL); // Set the ISR callback
+        SAMPLE_TIMER_STOP();        // The prescaler can only be changed while the timer is stopped
+        sampleTimerConfig();        // Program the timer for the rate profile
         SAMPLE_TIMER_START();       // Start the timer for sampling
 #if MICRF_ENABLE_RSSI == 1          /* MICRF_ENABLE_RSSI is defined in the dvr_micrf220_219a.h file.  */
         DVR_ADC_setCallback(MICRF_setAdcValue);         // Set the ADC callback
@@ -395,146 +703,1156 @@ void MICRF_rxEnable( bool bEnable )
 /* ****************************************************************************************************************** */
 // </editor-fold>
 
-/* ****************************************************************************************************************** */
-/* Local Functions */
-
-/* ****************************************************************************************************************** */
-/* Event Handlers */
-
-// <editor-fold defaultstate="collapsed" desc="void MICRF_sampleTimerISR( void )">
+// <editor-fold defaultstate="collapsed" desc="bool MICRF_setRateProfile( eMICRF_rate_t eRate )">
 /***********************************************************************************************************************
  *
- * Function Name: MICRF_sampleTimerISR
+ * Function Name: MICRF_setRateProfile
  *
- * Purpose: Must be called at a rate of x times the data rate, see RX_SAMPLES_PER_BIT macro.  The number of samples per
- *          bit has been tested between 4 and 20 times.  The value must be an even number.
+ * Purpose: Selects the rate profile.  The sample timer prescaler, period and the samples per bit are changed together.
  *
- * Arguments: None
+ * Arguments: eMICRF_rate_t eRate
  *
- * Returns: N/A
+ * Returns: bool - true = profile applied, false = invalid profile
  *
- * Side Effects: The callback function will be called if a possible message has been received.
+ * Side Effects: If the receiver is enabled, the sample timer is stopped, re-programmed and re-started.  Any message
+ *               being received is dropped.
  *
  * Reentrant Code: No
- * 
- * Note:  This driver does not decode the message in any way.  Therefore, the customer can implement any protocol they 
- *        wish without modifying this code.
  *
  **********************************************************************************************************************/
-void MICRF_sampleTimerISR(TC_TIMER_STATUS status, uintptr_t context)
+bool MICRF_setRateProfile( eMICRF_rate_t eRate )
 {
-    uint8_t sliceInputState = RX_DATA_PIN;      // Get the sample from the RX input pin immediately!  Do this first!
-    bool    bOnBitBoundary = false;             // Assume the slice for the bit is not complete.
-    
-    if (!rxVars_.rxData.bSkipSlice)             // Skip a slice last time the bit boundary was ahead of the slicer.
+    bool bRetVal = false;
+
+    if (eRate < eMICRF_RATE_CNT)    // Validate the profile
     {
-        rxVars_.rxData.logicHighCnt += sliceInputState; // logicHighCnt will be used to "vote" if bit was high or low.
-        if (0 == rxVars_.rxData.sliceCnt)               // Is this the first slice?
-        {   // Store the 1st slice state.
-            rxVars_.rxData.sliceInputStateFirst = sliceInputState;  // Used to compute if timing needs to be adjusted.
-        }
-        rxVars_.rxData.sliceCnt++;
-        if (rxVars_.rxData.sliceCnt >= RX_SAMPLES_PER_BIT)  // Check if this is the last slice for the bit
-        { // The last slice (sample) has been taken.  Now, process the results!
-            rxVars_.rxData.sliceCnt = 0;        // Reset the sliceCnt
-            rxVars_.rxData.manchesterWord <<= 1;// Left shift the Manchester word.
-            if (rxVars_.rxData.logicHighCnt >= (RX_SAMPLES_PER_BIT / 2))    // Voting, is the bit high or low?
-            {   // The bit is high
-                rxVars_.rxData.manchesterWord |= 1; // High bit, set the LSB to high (1).
-                // Is the sampling centered around a bit.  For example, if there are 10 samples per bit, we want all 10
-                // samples to read the bit and NOT read a part of one bit and a part of another.  Noise and signal
-                // strength can affect the bit timing.  So, if only the first slice was not a 1 and the last slick was
-                // a one, assume we a little too slow.  So, grab the next sample now.  This will effectively speed up
-                // the slicer by one time slice (or sample).
-                if ((0 == sliceInputState) && (0 != rxVars_.rxData.sliceInputStateFirst))
-                {   // Vote was high, however, last bit was 0.  So, assume this sample is a part of the next bit.
-                    rxVars_.rxData.logicHighCnt += sliceInputState;
-                    rxVars_.rxData.sliceCnt++;
-                    rxVars_.rxData.sliceInputStateFirst = sliceInputState;
-                }
-                else if ((0 == rxVars_.rxData.sliceInputStateFirst) && (0 != sliceInputState))
-                {
-                    // if only the first slice was a 1 and the last slick was a 0, assume we a little too quick.  So,
-                    // skip the next sample.  This will effectively slow down the slicer by 1 slice time (or sample).
-                    rxVars_.rxData.bSkipSlice = true;
-                }
-            }
-            else
-            {
-                if ((1 == sliceInputState) && (1 != rxVars_.rxData.sliceInputStateFirst)) // See notes for the 1 bit.
-                {
-                    rxVars_.rxData.logicHighCnt += sliceInputState;
-                    rxVars_.rxData.sliceCnt++;
-                    rxVars_.rxData.sliceInputStateFirst = sliceInputState;
-                }
-                else if ((1 == rxVars_.rxData.sliceInputStateFirst) && (1 != sliceInputState))
-                {
-                    rxVars_.rxData.bSkipSlice = true;
-                }
-            }
-            bOnBitBoundary = true;                  // We're on a bit boundary (or close).  Set the sliceDone.
-            rxVars_.rxData.logicHighCnt = 0;        // Reset the voting variable.
+        if (rxVars_.bRxEnabled)
+        {
+            SAMPLE_TIMER_STOP();    // The ISR must not run while the slicer is being changed
         }
-
-        /* If we're on a bit boundary AND the preamble matches the received word, then indicate we're going to start
-         * processing data.  Even though we're processing data, we're always going to look for another valid preamble.
-         * Since the preamble contains invalid Manchester data, we can re-start collecting data. */
-        if (bOnBitBoundary && (PREAMBLE == rxVars_.rxData.manchesterWord))
+        rxVars_.eRate = eRate;
+        if (!rxVars_.autoBaud.bEnabled) // In auto-baud mode the profile is only used once auto-baud is disabled.
         {
-            rxVars_.rxData.bCollectData = true;     // Indicate we're now collecting data
-            rxVars_.rxData.dataIdx = 0;             // Start collecting data at the 1st index.
-            rxVars_.rxData.bitCnt = 0;              // Reset the bit counter, we're now sync'd
+            rxVars_.samplesPerBit = rateProfiles_[eRate].samplesPerBit;
+            rxVars_.bitRate = rateProfiles_[eRate].bitRate;
         }
-        else if (bOnBitBoundary && rxVars_.rxData.bCollectData) // On a bit boundary and we're collecting data?
+        // Start looking for the preamble again, the slicer state is meaningless at the new rate.
+        (void)memset((void *)&rxVars_.rxData, 0, sizeof(rxVars_.rxData));
+        if (rxVars_.bRxEnabled)
         {
-            bool    bSendMsg = false;   // Assume we don't have enough data to send the message
-            
-            // If the Manchester coding is violated, don't bother doing anything else, just try to send the data.
-            if (0 != rxVars_.rxData.dataIdx)    // Until the 1st byte has been received, don't check.  
-            {   // Just get the 3 ls bits in the lsb variable.
-                uint8_t lsb = (uint8_t)((uint8_t)rxVars_.rxData.manchesterWord & 7);
-                
-                if ((7 == lsb) || (0 == lsb))   // Are the LSBs 000 or 111, these are not valid a Manchester bits.
-                {  // Now, we're going to try to send the message.  There is no need to try to decode the next bytes.
-                    bSendMsg = true;    
-                }
-            }
-            if (!bSendMsg)  // Need to process the incoming bits/bytes of data.
-            {
-                rxVars_.rxData.bitCnt++;            // We're going to process the next bit
-                if (rxVars_.rxData.bitCnt >= 16)    // Have we collected 16-bits (a word)?
-                {   // Yes, process the 16-bits of data
-                    rxVars_.rxData.bitCnt = 0;      // Reset bit count.  Prepare to collect the next 16-bits.
-                    // Swap the bytes (convert the endianess)
-                    rxVars_.rxData.manchesterWord = (rxVars_.rxData.manchesterWord >> 8) | 
-                                                    (rxVars_.rxData.manchesterWord << 8);
-                    // Try to decode the Manchester data.  Convert 16-bits back to 8-bits.
-                    if (ME_decode((void *)&rxVars_.rxData.data[rxVars_.rxData.dataIdx], 
-                                   (void *)&rxVars_.rxData.manchesterWord,
-                                   sizeof(rxVars_.rxData.manchesterWord)))
-                    {  // Decoded properly
-                        rxVars_.rxData.bLogMsgRssi = true;  // Collecting data, log RSSI (all RSSI samples are for msg.)
-                        rxVars_.rxData.dataIdx++;           // Point the next buffer entry
-                        if (rxVars_.rxData.dataIdx >= sizeof(rxVars_.rxData.data))  // At the end of the buffer?
-                        {  // No more data will fit, try to send what we have.
-                            bSendMsg = true;
-                        }
-                    }
-                    else
-                    {   // Manchester decoding failed.  So, assume we collected all available data.  Try to send it.
-                        bSendMsg = true;
-                    }
-                }
-            }
-            if (bSendMsg) // Time to send message?
-            {  // Lets pass the message to the receiver module to validate and decode
-                rxVars_.rxData.bCollectData = false;    // No longer collecting data.  
-                rxVars_.rxData.bLogMsgRssi = false;     // The new RSSI values are now for measuring the noise floor.
-                // Is the function pointer valid AND the enough data was collected?
-                if ((NULL != rxVars_.pRxFunctionPtr) && (rxVars_.rxData.dataIdx >= RX_MINIMUM_PACKET_SIZE))
-                {  // All looks good, call the function.
-                    rxVars_.pRxFunctionPtr((void *)&rxVars_.rxData.data[0], rxVars_.rxData.dataIdx);
-                }
+            sampleTimerConfig();
+            SAMPLE_TIMER_START();
+        }
+        bRetVal = true;
+    }
+    return(bRetVal);
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="eMICRF_rate_t MICRF_getRateProfile( void )">
+/***********************************************************************************************************************
+ *
+ * Function Name: MICRF_getRateProfile
+ *
+ * Purpose: Returns the rate profile currently in use.
+ *
+ * Arguments: None
+ *
+ * Returns: eMICRF_rate_t
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: Yes
+ *
+ **********************************************************************************************************************/
+eMICRF_rate_t MICRF_getRateProfile( void )
+{
+    return(rxVars_.eRate);
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="uint16_t MICRF_getBitRate( eMICRF_rate_t eRate )">
+/***********************************************************************************************************************
+ *
+ * Function Name: MICRF_getBitRate
+ *
+ * Purpose: Returns the nominal data bit rate of a rate profile.
+ *
+ * Arguments: eMICRF_rate_t eRate
+ *
+ * Returns: uint16_t - bits/second, 0 if the profile is invalid
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: Yes
+ *
+ **********************************************************************************************************************/
+uint16_t MICRF_getBitRate( eMICRF_rate_t eRate )
+{
+    uint16_t bitRate = 0;
+
+    if (eRate < eMICRF_RATE_CNT)
+    {
+        bitRate = rateProfiles_[eRate].bitRate;
+    }
+    return(bitRate);
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="void MICRF_setAutoBaud( bool bEnable )">
+/***********************************************************************************************************************
+ *
+ * Function Name: MICRF_setAutoBaud
+ *
+ * Purpose: Enables or disables the auto-baud mode.  In auto-baud mode the receiver measures the 0xAA training of every
+ *          frame and locks the sample timer to the transmitter's rate for that frame.  When disabled, the rate profile
+ *          is used.
+ *
+ * Arguments: bool bEnable
+ *
+ * Returns: None
+ *
+ * Side Effects: If the receiver is enabled, the sample timer is stopped, re-programmed and re-started.  Any message
+ *               being received is dropped.
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+void MICRF_setAutoBaud( bool bEnable )
+{
+    if (rxVars_.bRxEnabled)
+    {
+        SAMPLE_TIMER_STOP();    // The ISR must not run while the slicer is being changed
+    }
+    rxVars_.autoBaud.bEnabled = bEnable;
+    rxVars_.autoBaud.bHunting = bEnable;
+    rxVars_.samplesPerBit = rateProfiles_[rxVars_.eRate].samplesPerBit;
+    rxVars_.bitRate = rateProfiles_[rxVars_.eRate].bitRate;
+    (void)memset((void *)&rxVars_.rxData, 0, sizeof(rxVars_.rxData));
+    if (rxVars_.bRxEnabled)
+    {
+        sampleTimerConfig();
+        SAMPLE_TIMER_START();
+    }
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="bool MICRF_getAutoBaud( void )">
+/***********************************************************************************************************************
+ *
+ * Function Name: MICRF_getAutoBaud
+ *
+ * Purpose: Returns true if the auto-baud mode is enabled.
+ *
+ * Arguments: None
+ *
+ * Returns: bool
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: Yes
+ *
+ **********************************************************************************************************************/
+bool MICRF_getAutoBaud( void )
+{
+    return(rxVars_.autoBaud.bEnabled);
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="uint16_t MICRF_getRxBitRate( void )">
+/***********************************************************************************************************************
+ *
+ * Function Name: MICRF_getRxBitRate
+ *
+ * Purpose: Returns the data rate the receiver is running at.  In auto-baud mode, this is the rate detected from the
+ *          training of the frame being received.  Call it from the message callback to get the rate of that message.
+ *
+ * Arguments: None
+ *
+ * Returns: uint16_t - bits/second
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: Yes
+ *
+ **********************************************************************************************************************/
+uint16_t MICRF_getRxBitRate( void )
+{
+    return(rxVars_.bitRate);
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="bool MICRF_getProfile( eMICRF_prof_t ePath, profStat_t *pStat )">
+/***********************************************************************************************************************
+ *
+ * Function Name: MICRF_getProfile
+ *
+ * Purpose: Returns the execution time statistics of a path through the sample ISR.
+ *
+ * Arguments: eMICRF_prof_t ePath - ISR path
+ *            profStat_t *pStat - Location to store the statistics
+ *
+ * Returns: bool - false if profiling isn't built in or the path is invalid, pStat is cleared
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: Yes.  The copy is repeated if the ISR updated the path while it was being copied.
+ *
+ **********************************************************************************************************************/
+bool MICRF_getProfile( eMICRF_prof_t ePath, profStat_t *pStat )
+{
+    (void)memset(pStat, 0, sizeof(*pStat));
+#if DVR_PROF_ON == 1
+    if (ePath < eMICRF_PROF_CNT)
+    {
+        do
+        {
+            (void)memcpy(pStat, (void *)&prof_[ePath], sizeof(*pStat));
+        } while (pStat->cnt != prof_[ePath].cnt);
+        return(true);
+    }
+#endif
+    return(false);
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="void MICRF_clearProfile( void )">
+/***********************************************************************************************************************
+ *
+ * Function Name: MICRF_clearProfile
+ *
+ * Purpose: Clears the execution time statistics of all paths through the sample ISR.
+ *
+ * Arguments: None
+ *
+ * Returns: None
+ *
+ * Side Effects: A path recorded while clearing may keep its old values.
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+void MICRF_clearProfile( void )
+{
+#if DVR_PROF_ON == 1
+    (void)memset((void *)prof_, 0, sizeof(prof_));
+#endif
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="void MICRF_getLinkStats( MICRF_linkStats_t *pStats )">
+/***********************************************************************************************************************
+ *
+ * Function Name: MICRF_getLinkStats
+ *
+ * Purpose: Returns the frame detection counters.
+ *
+ * Arguments: MICRF_linkStats_t *pStats - Location to store the counters
+ *
+ * Returns: None
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: Yes.  The copy is repeated if the ISR updated the counters while they were being copied.
+ *
+ **********************************************************************************************************************/
+void MICRF_getLinkStats( MICRF_linkStats_t *pStats )
+{
+    do
+    {
+        (void)memcpy(pStats, (void *)&rxVars_.stats, sizeof(*pStats));
+    } while ((pStats->syncs != rxVars_.stats.syncs) || (pStats->frames != rxVars_.stats.frames));
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="void MICRF_clearLinkStats( void )">
+/***********************************************************************************************************************
+ *
+ * Function Name: MICRF_clearLinkStats
+ *
+ * Purpose: Clears the frame detection counters.
+ *
+ * Arguments: None
+ *
+ * Returns: None
+ *
+ * Side Effects: A frame detected while clearing may be counted.
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+void MICRF_clearLinkStats( void )
+{
+    (void)memset((void *)&rxVars_.stats, 0, sizeof(rxVars_.stats));
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+#if MICRF_ENABLE_LQI == 1
+// <editor-fold defaultstate="collapsed" desc="void MICRF_getFrameQuality( MICRF_frameQuality_t *pQuality )">
+/***********************************************************************************************************************
+ *
+ * Function Name: MICRF_getFrameQuality
+ *
+ * Purpose: Returns the slicer quality of the frame passed to the message callback: the vote margin of the chips, the
+ *          timing corrections and the training chip errors right before the preamble.
+ *
+ * Arguments: MICRF_frameQuality_t *pQuality - Location to store the quality
+ *
+ * Returns: None
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: No
+ *
+ * Note:  Only valid in the message callback, the sample ISR clears the counters on the next preamble.
+ *
+ **********************************************************************************************************************/
+void MICRF_getFrameQuality( MICRF_frameQuality_t *pQuality )
+{
+    uint16_t chips = (uint16_t)((rxVars_.rxData.dataIdx * 16) + rxVars_.rxData.bitCnt);
+
+    pQuality->chips = chips;
+    pQuality->marginPct = (0 == chips) ? 0 :
+                          (uint8_t)(((uint32_t)rxVars_.rxData.marginSum * 100) / ((uint32_t)chips * rxVars_.samplesPerBit));
+    pQuality->timingCnt = (rxVars_.rxData.timingCnt > UINT8_MAX) ? UINT8_MAX : (uint8_t)rxVars_.rxData.timingCnt;
+    pQuality->trainChips = rxVars_.rxData.trainChips;
+    pQuality->trainErrors = rxVars_.rxData.trainErrors;
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+#endif
+
+#if MICRF_ENABLE_CAPTURE == 1
+// <editor-fold defaultstate="collapsed" desc="void MICRF_captureArm( uint8_t triggers, uint16_t postCnt )">
+/***********************************************************************************************************************
+ *
+ * Function Name: MICRF_captureArm
+ *
+ * Purpose: Clears the capture ring and starts capturing every sample the ISR takes.  Once one of the triggers fires,
+ *          postCnt more entries are captured and the ring is frozen until it is armed again.
+ *
+ * Arguments: uint8_t triggers - MICRF_CAP_TRIG_xxx, 0 = stop capturing
+ *            uint16_t postCnt - Entries captured after the trigger, limited to 1 to MICRF_CAPTURE_SIZE
+ *
+ * Returns: None
+ *
+ * Side Effects: A frozen capture is lost.
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+void MICRF_captureArm( uint8_t triggers, uint16_t postCnt )
+{
+    capture_.eState = eMICRF_CAP_OFF;   // The ISR leaves the capture alone while it is set up
+    capture_.pushed = 0;
+    capture_.trigPushed = 0;
+    capture_.head = 0;
+    capture_.len = 0;
+    capture_.runLen = 0;
+    capture_.trigger = 0;
+    capture_.triggers = triggers;
+    if (0 == postCnt)
+    {
+        postCnt = 1;
+    }
+    else if (postCnt > MICRF_CAPTURE_SIZE)
+    {
+        postCnt = MICRF_CAPTURE_SIZE;
+    }
+    capture_.postCnt = postCnt;
+    if (0 != triggers)
+    {
+        capture_.eState = eMICRF_CAP_ARMED;
+    }
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="void MICRF_captureTrigger( uint8_t trigger )">
+/***********************************************************************************************************************
+ *
+ * Function Name: MICRF_captureTrigger
+ *
+ * Purpose: Fires a trigger from outside the ISR, for example when the receiver rejects a message.
+ *
+ * Arguments: uint8_t trigger - MICRF_CAP_TRIG_xxx
+ *
+ * Returns: None
+ *
+ * Side Effects: None if the trigger isn't armed or the capture already triggered.
+ *
+ * Reentrant Code: No.  The sample ISR may fire the sync trigger at the same time, either one wins.
+ *
+ **********************************************************************************************************************/
+void MICRF_captureTrigger( uint8_t trigger )
+{
+    captureFire(trigger);
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="void MICRF_captureGetInfo( MICRF_captureInfo_t *pInfo )">
+/***********************************************************************************************************************
+ *
+ * Function Name: MICRF_captureGetInfo
+ *
+ * Purpose: Returns the capture state.  The rate profile and auto-baud mode are the ones in use when it was frozen, a
+ *          replay must use the same.
+ *
+ * Arguments: MICRF_captureInfo_t *pInfo - Location to store the state
+ *
+ * Returns: None
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: Yes
+ *
+ **********************************************************************************************************************/
+void MICRF_captureGetInfo( MICRF_captureInfo_t *pInfo )
+{
+    pInfo->eState = capture_.eState;
+    pInfo->trigger = capture_.trigger;
+    pInfo->eRate = capture_.eRate;
+    pInfo->bAutoBaud = capture_.bAutoBaud;
+    pInfo->len = capture_.len;
+    pInfo->trigIdx = 0;
+    if (eMICRF_CAP_FROZEN == capture_.eState)
+    {   // The oldest entry in the ring is entry (pushed - len) since armed.
+        pInfo->trigIdx = (uint16_t)(capture_.trigPushed - (capture_.pushed - capture_.len));
+    }
+    pInfo->freezeCnt = capture_.freezeCnt;
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="uint16_t MICRF_captureRead( uint16_t offset, uint8_t *pDst, uint16_t cnt )">
+/***********************************************************************************************************************
+ *
+ * Function Name: MICRF_captureRead
+ *
+ * Purpose: Copies entries out of a frozen capture, oldest first.
+ *
+ * Arguments: uint16_t offset - 1st entry to copy, 0 = oldest
+ *            uint8_t *pDst - Destination
+ *            uint16_t cnt - Maximum number of entries to copy
+ *
+ * Returns: uint16_t - Entries copied
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: Yes
+ *
+ **********************************************************************************************************************/
+uint16_t MICRF_captureRead( uint16_t offset, uint8_t *pDst, uint16_t cnt )
+{
+    uint16_t oldest = (uint16_t)(capture_.head - capture_.len) & CAPTURE_IDX_MASK;
+    uint16_t i;
+
+    if ((eMICRF_CAP_FROZEN != capture_.eState) || (offset >= capture_.len))
+    {
+        return(0);
+    }
+    if (cnt > (capture_.len - offset))
+    {
+        cnt = capture_.len - offset;
+    }
+    for (i = 0; i < cnt; i++)
+    {
+        pDst[i] = capture_.ring[(oldest + offset + i) & CAPTURE_IDX_MASK];
+    }
+    return(cnt);
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+#endif
+
+/* ****************************************************************************************************************** */
+/* Local Functions */
+
+// <editor-fold defaultstate="collapsed" desc="static void sampleTimerConfig( void )">
+/***********************************************************************************************************************
+ *
+ * Function Name: sampleTimerConfig
+ *
+ * Purpose: Programs the sample timer prescaler and period for the current rate profile.
+ *
+ * Arguments: None
+ *
+ * Returns: None
+ *
+ * Side Effects: The timer MUST be stopped before calling, the prescaler is enable protected.
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+static void sampleTimerConfig( void )
+{
+    if (rxVars_.autoBaud.bEnabled)
+    {
+        SAMPLE_TIMER_PRESCALER_SET(AUTOBAUD_PRESCALER);
+        autoBaudHunt();
+    }
+    else
+    {
+        SAMPLE_TIMER_PRESCALER_SET(rateProfiles_[rxVars_.eRate].prescaler);
+        SAMPLE_TIMER_PERIOD_SET(rateProfiles_[rxVars_.eRate].period);
+    }
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="static void autoBaudHunt( void )">
+/***********************************************************************************************************************
+ *
+ * Function Name: autoBaudHunt
+ *
+ * Purpose: Starts (or re-starts) measuring the training.  The sample timer is set to the hunt rate.
+ *
+ * Arguments: None
+ *
+ * Returns: None
+ *
+ * Side Effects: The slicer is reset.  Called from the ISR, the period is changed right after the overflow, so the
+ *               counter is always below the new period.
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+static void autoBaudHunt( void )
+{
+    (void)memset((void *)&rxVars_.rxData, 0, sizeof(rxVars_.rxData));
+    rxVars_.autoBaud.runIdx = 0;
+    rxVars_.autoBaud.runCnt = 0;
+    rxVars_.autoBaud.runLen = 0;
+    rxVars_.autoBaud.bHunting = true;
+    SAMPLE_TIMER_PERIOD_SET(AUTOBAUD_HUNT_PERIOD);
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="static void autoBaudMeasure( uint8_t sliceInputState )">
+/***********************************************************************************************************************
+ *
+ * Function Name: autoBaudMeasure
+ *
+ * Purpose: Measures the run lengths of the training.  Adjacent runs are one high and one low chip, so the runs are
+ *          checked in pairs, this cancels out the data slicer stretching the marks.  When every pair is within 25% of
+ *          the average, the sample timer is locked to the measured chip period.
+ *
+ * Arguments: uint8_t sliceInputState - Latest pin sample
+ *
+ * Returns: None
+ *
+ * Side Effects: Changes the sample timer period and the samples per bit when locking.
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+static void autoBaudMeasure( uint8_t sliceInputState )
+{
+    uint16_t pairs[AUTOBAUD_RUN_CNT / 2];
+    uint16_t sum = 0;
+    uint16_t ave;
+    uint32_t ticksPerChip;
+    uint8_t  i;
+    uint8_t  idx;
+
+    if (sliceInputState == rxVars_.autoBaud.lastState)
+    {   // Saturate, a long run will fail the check below
+        if ((0 != rxVars_.autoBaud.runLen) && (rxVars_.autoBaud.runLen < UINT8_MAX))
+        {
+            rxVars_.autoBaud.runLen++;
+        }
+        return;
+    }
+    rxVars_.autoBaud.lastState = sliceInputState;
+    if (0 == rxVars_.autoBaud.runLen)
+    {   // First edge since the hunt started.  The run before it started before the hunt, so its length is unknown.
+        rxVars_.autoBaud.runLen = 1;
+        return;
+    }
+    // Edge, store the run that just ended.
+    rxVars_.autoBaud.runs[rxVars_.autoBaud.runIdx] = rxVars_.autoBaud.runLen;
+    rxVars_.autoBaud.runIdx = (rxVars_.autoBaud.runIdx + 1) % AUTOBAUD_RUN_CNT;
+    rxVars_.autoBaud.runLen = 1;
+    if (rxVars_.autoBaud.runCnt < AUTOBAUD_RUN_CNT)
+    {
+        rxVars_.autoBaud.runCnt++;
+        return;
+    }
+
+    idx = rxVars_.autoBaud.runIdx;  // Oldest run
+    for (i = 0; i < ARRAYIDXCNT(pairs); i++)
+    {
+        pairs[i] = (uint16_t)rxVars_.autoBaud.runs[idx] + rxVars_.autoBaud.runs[(idx + 1) % AUTOBAUD_RUN_CNT];
+        idx = (idx + 2) % AUTOBAUD_RUN_CNT;
+        sum += pairs[i];
+    }
+    ave = sum / ARRAYIDXCNT(pairs);
+    if (ave < AUTOBAUD_PAIR_MIN)
+    {
+        return;
+    }
+    for (i = 0; i < ARRAYIDXCNT(pairs); i++)
+    {
+        if ((pairs[i] > (ave + (ave / 4))) || (pairs[i] < (ave - (ave / 4))))
+        {
+            return;     // Noise, not training
+        }
+    }
+
+    ticksPerChip = ((uint32_t)sum * (AUTOBAUD_HUNT_PERIOD + 1)) / AUTOBAUD_RUN_CNT;
+    if (ticksPerChip < AUTOBAUD_TICKS_MIN)
+    {
+        return;
+    }
+    // Same oversampling as the rate profiles: 10 samples up to 2k chips/s, 8 up to 4k chips/s and 6 above.
+    if (ticksPerChip >= (AUTOBAUD_TIMER_HZ / 2000))
+    {
+        rxVars_.samplesPerBit = 10;
+    }
+    else if (ticksPerChip >= (AUTOBAUD_TIMER_HZ / 4000))
+    {
+        rxVars_.samplesPerBit = 8;
+    }
+    else
+    {
+        rxVars_.samplesPerBit = 6;
+    }
+    if ((ticksPerChip / rxVars_.samplesPerBit) > ((uint32_t)UINT16_MAX + 1))
+    {
+        return;     // Slower than the 16-bit timer can sample
+    }
+    SAMPLE_TIMER_PERIOD_SET((uint16_t)((ticksPerChip / rxVars_.samplesPerBit) - 1));
+    rxVars_.bitRate = (uint16_t)(AUTOBAUD_TIMER_HZ / (2 * ticksPerChip));
+    rxVars_.autoBaud.lockedBits = 0;
+    rxVars_.autoBaud.bHunting = false;
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+#if MICRF_ENABLE_CAPTURE == 1
+// <editor-fold defaultstate="collapsed" desc="static void captureSample( uint8_t sliceInputState )">
+/***********************************************************************************************************************
+ *
+ * Function Name: captureSample
+ *
+ * Purpose: Adds a sample to the capture.  Samples are counted until the level changes (or the run is full), then the
+ *          run is written to the ring as one entry.
+ *
+ * Arguments: uint8_t sliceInputState - Level of the data pin
+ *
+ * Returns: None
+ *
+ * Side Effects: Freezes the capture once the entries after the trigger have been captured.
+ *
+ * Reentrant Code: No (called by the ISR)
+ *
+ **********************************************************************************************************************/
+static void captureSample( uint8_t sliceInputState )
+{
+    if ((sliceInputState == capture_.runLevel) && (0 != capture_.runLen) && (capture_.runLen < CAPTURE_RUN_MAX))
+    {
+        capture_.runLen++;
+        return;
+    }
+    if (0 != capture_.runLen)   // Store the run that ended
+    {
+        capture_.ring[capture_.head] = (uint8_t)((capture_.runLevel << 7) | (capture_.runLen - 1));
+        capture_.head = (capture_.head + 1) & CAPTURE_IDX_MASK;
+        capture_.pushed++;
+        if (capture_.len < MICRF_CAPTURE_SIZE)
+        {
+            capture_.len++;
+        }
+        if ((eMICRF_CAP_TRIGGERED == capture_.eState) && (0 == --capture_.postLeft))
+        {
+            capture_.eRate = (uint8_t)rxVars_.eRate;
+            capture_.bAutoBaud = rxVars_.autoBaud.bEnabled;
+            capture_.freezeCnt++;
+            capture_.eState = eMICRF_CAP_FROZEN;
+            return;
+        }
+    }
+    capture_.runLevel = sliceInputState;
+    capture_.runLen = 1;
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="static void captureFire( uint8_t trigger )">
+/***********************************************************************************************************************
+ *
+ * Function Name: captureFire
+ *
+ * Purpose: Starts capturing the entries after the trigger, if the trigger is armed.
+ *
+ * Arguments: uint8_t trigger - MICRF_CAP_TRIG_xxx
+ *
+ * Returns: None
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+static void captureFire( uint8_t trigger )
+{
+    if ((eMICRF_CAP_ARMED == capture_.eState) && (0 != (capture_.triggers & trigger)))
+    {
+        capture_.trigger = trigger;
+        capture_.trigPushed = capture_.pushed;
+        capture_.postLeft = capture_.postCnt;
+        capture_.eState = eMICRF_CAP_TRIGGERED;
+    }
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+#endif
+
+#if MICRF_ENABLE_RSSI == 1
+// <editor-fold defaultstate="collapsed" desc="static int32_t rssiCurveCode( int8_t dBm )">
+/***********************************************************************************************************************
+ *
+ * Function Name: rssiCurveCode
+ *
+ * Purpose: Returns the ADC code of the datasheet curve at a RF input level, interpolated between the curve points.
+ *
+ * Arguments: int8_t dBm - RF input level, RSSI_MIN_dBm to RSSI_MAX_dBm
+ *
+ * Returns: int32_t - ADC code
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: Yes
+ *
+ **********************************************************************************************************************/
+static int32_t rssiCurveCode( int8_t dBm )
+{
+    int16_t ofs_dB = (int16_t)dBm - RSSI_MIN_dBm;
+    uint8_t pt = (uint8_t)(ofs_dB / RSSI_CURVE_STEP_dB);
+    int32_t code = RSSI_mV_TO_CODE(rssiCurve_mV_[pt]);
+
+    if (pt < (RSSI_CURVE_PTS - 1))
+    {
+        code += ((RSSI_mV_TO_CODE(rssiCurve_mV_[pt + 1]) - code) * (ofs_dB % RSSI_CURVE_STEP_dB)) / RSSI_CURVE_STEP_dB;
+    }
+    return(code);
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="static void rssiBuildTable( void )">
+/***********************************************************************************************************************
+ *
+ * Function Name: rssiBuildTable
+ *
+ * Purpose: Fills rssiTable_ from the datasheet curve.  With a calibration, every curve point is first moved to
+ *          code = code0 + (curve code - curve code at dBm0) * (code1 - code0) / (curve code at dBm1 - curve code at
+ *          dBm0), so the curve goes through both measured points.  Between the points, the dBm is interpolated.
+ *
+ * Arguments: None
+ *
+ * Returns: None
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+static void rssiBuildTable( void )
+{
+    int32_t  code[RSSI_CURVE_PTS];
+    int32_t  center, span;
+    uint16_t idx;
+    uint8_t  pt;
+
+    for (pt = 0; pt < RSSI_CURVE_PTS; pt++)
+    {
+        code[pt] = RSSI_mV_TO_CODE(rssiCurve_mV_[pt]);
+    }
+    if (bRssiCal_)
+    {
+        int32_t ref0 = rssiCurveCode(rssiCal_.dBm[0]);
+        int32_t ref1 = rssiCurveCode(rssiCal_.dBm[1]);
+
+        for (pt = 0; pt < RSSI_CURVE_PTS; pt++)
+        {
+            code[pt] = (int32_t)rssiCal_.code[0] +
+                       (((code[pt] - ref0) * ((int32_t)rssiCal_.code[1] - rssiCal_.code[0])) / (ref1 - ref0));
+        }
+    }
+
+    pt = 0;
+    for (idx = 0; idx < RSSI_TABLE_SIZE; idx++)
+    {
+        center = ((int32_t)idx << RSSI_TABLE_SHIFT) + ((1 << RSSI_TABLE_SHIFT) / 2);   // Middle of the entry
+        while ((pt < (RSSI_CURVE_PTS - 1)) && (center >= code[pt + 1]))
+        {
+            pt++;
+        }
+        if (center <= code[0])
+        {
+            rssiTable_[idx] = RSSI_MIN_dBm;                 // Below the curve, the RSSI output is flat
+        }
+        else if (pt == (RSSI_CURVE_PTS - 1))
+        {
+            rssiTable_[idx] = RSSI_MAX_dBm;                 // Saturated
+        }
+        else
+        {
+            span = code[pt + 1] - code[pt];
+            rssiTable_[idx] = (int8_t)(RSSI_MIN_dBm + (pt * RSSI_CURVE_STEP_dB) +
+                                       ((((center - code[pt]) * RSSI_CURVE_STEP_dB) + (span / 2)) / span));
+        }
+    }
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="static void squelchUpdate( uint16_t adcCode )">
+/***********************************************************************************************************************
+ *
+ * Function Name: squelchUpdate
+ *
+ * Purpose: Opens the squelch on a RSSI sample thresholdDb above the noise floor, closes it SQUELCH_HOLD_CNT samples
+ *          after the last one.  It isn't closed while a message is being received.
+ *
+ * Arguments: uint16_t adcCode - RSSI sample
+ *
+ * Returns: None
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: No
+ *
+ * Note:  If the ISR finds a preamble between the bCollectData check and the close, it keeps running because it checks
+ *        bCollectData too.
+ *
+ **********************************************************************************************************************/
+static void squelchUpdate( uint16_t adcCode )
+{
+    if ((int16_t)rssiTable_[adcCode >> RSSI_TABLE_SHIFT] >=
+        ((int16_t)MICRF_getRssiNoiseFloor() + rxVars_.squelch.thresholdDb))
+    {
+        rxVars_.squelch.holdCnt = SQUELCH_HOLD_CNT;
+        rxVars_.squelch.bOpen = true;
+    }
+    else if (0 != rxVars_.squelch.holdCnt)
+    {
+        rxVars_.squelch.holdCnt--;
+    }
+    else if (rxVars_.squelch.bOpen && !rxVars_.rxData.bCollectData)
+    {
+        rxVars_.squelch.bRestart = true;    // The slicer state will be stale when the squelch opens again
+        rxVars_.squelch.bOpen = false;
+    }
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="static void rssiTrack( volatile rssi_t *pRssi, uint16_t adcCode, uint8_t shift )">
+/***********************************************************************************************************************
+ *
+ * Function Name: rssiTrack
+ *
+ * Purpose: Adds a sample to a RSSI average with a weight of 1/2^shift.  Until 2^shift samples are in, the weight is
+ *          1/count (a plain average), so a new average doesn't start from 0 and takes the 1st sample as is.
+ *
+ * Arguments: volatile rssi_t *pRssi - Average to update
+ *            uint16_t adcCode - RSSI sample
+ *            uint8_t shift - Time constant, 2^shift samples (7 or less)
+ *
+ * Returns: None
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+static void rssiTrack( volatile rssi_t *pRssi, uint16_t adcCode, uint8_t shift )
+{
+    int32_t weight = (int32_t)1 << shift;
+
+    if (pRssi->cnt < weight)
+    {
+        pRssi->cnt++;
+        weight = pRssi->cnt;
+    }
+    pRssi->ave += (((int32_t)adcCode << RSSI_EWMA_FRAC) - pRssi->ave) / weight;
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+#endif
+
+#if MICRF_ENABLE_LQI == 1
+// <editor-fold defaultstate="collapsed" desc="static void lqiSync( void )">
+/***********************************************************************************************************************
+ *
+ * Function Name: lqiSync
+ *
+ * Purpose: Starts the frame quality on a preamble: counts the wrong chips of the training right before it and clears
+ *          the vote margin and timing correction counters.
+ *
+ * Arguments: None
+ *
+ * Returns: None
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: No
+ *
+ * Note:  Called from the sample ISR.  Only the chips sliced since the slicer (re)started are checked, the rest of
+ *        trainWord is 0 after a hunt or a squelch restart.
+ *
+ **********************************************************************************************************************/
+static void lqiSync( void )
+{
+    uint8_t  checked = (uint8_t)(rxVars_.rxData.chipCnt - 16);     // manchesterWord holds the 16 chips of PREAMBLE
+    uint16_t errors = (uint16_t)(rxVars_.rxData.trainWord ^ TRAINING);
+
+    if (checked < 16)
+    {
+        errors &= (uint16_t)((1U << checked) - 1);
+    }
+    rxVars_.rxData.trainChips = checked;
+    rxVars_.rxData.trainErrors = 0;
+    while (0 != errors)                     // Usually 0 or a few bits
+    {
+        errors &= (uint16_t)(errors - 1);
+        rxVars_.rxData.trainErrors++;
+    }
+    rxVars_.rxData.marginSum = 0;
+    rxVars_.rxData.timingCnt = 0;
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+#endif
+
+/* ****************************************************************************************************************** */
+/* Event Handlers */
+
+// <editor-fold defaultstate="collapsed" desc="void MICRF_sampleTimerISR( void )">
+/***********************************************************************************************************************
+ *
+ * Function Name: MICRF_sampleTimerISR
+ *
+ * Purpose: Must be called at a rate of x times the data rate, see samplesPerBit in rateProfiles_[].  The number of
+ *          samples per bit has been tested between 4 and 20 times.  The value must be an even number.
+ *
+ * Arguments: None
+ *
+ * Returns: N/A
+ *
+ * Side Effects: The callback function will be called if a possible message has been received.
+ *
+ * Reentrant Code: No
+ * 
+ * Note:  This driver does not decode the message in any way.  Therefore, the customer can implement any protocol they 
+ *        wish without modifying this code.
+ *
+ **********************************************************************************************************************/
+void MICRF_sampleTimerISR(TC_TIMER_STATUS status, uintptr_t context)
+{
+    uint8_t sliceInputState = RX_DATA_PIN;      // Get the sample from the RX input pin immediately!  Do this first!
+    bool    bOnBitBoundary = false;             // Assume the slice for the bit is not complete.
+#if DVR_PROF_ON == 1
+    uint32_t profStart = DVR_PROF_CYCLES();     // After the pin is read, profiling must not move the sample time.
+    eMICRF_prof_t eProfPath = eMICRF_PROF_IDLE;
+#endif
+    
+#if MICRF_ENABLE_CAPTURE == 1
+    if ((eMICRF_CAP_ARMED == capture_.eState) || (eMICRF_CAP_TRIGGERED == capture_.eState))
+    {
+        captureSample(sliceInputState);
+    }
+#endif
+#if MICRF_ENABLE_RSSI == 1
+    if (!rxVars_.squelch.bOpen && !rxVars_.rxData.bCollectData)
+    {   // Squelch closed, nothing on the channel.  The slicer is skipped until the RSSI rises.
+        PROF_PATH(eMICRF_PROF_SQUELCH);
+    }
+    else if (rxVars_.squelch.bRestart)          // 1st slice since the squelch opened, start the slicer clean.
+    {
+        rxVars_.squelch.bRestart = false;
+        if (rxVars_.autoBaud.bEnabled)
+        {
+            autoBaudHunt();                     // Measure the training of the frame that opened the squelch
+        }
+        else
+        {
+            (void)memset((void *)&rxVars_.rxData, 0, sizeof(rxVars_.rxData));
+        }
+    }
+    else
+#endif
+    if (rxVars_.autoBaud.bHunting)              // Auto-baud, measuring the training.  The slicer isn't running yet.
+    {
+        autoBaudMeasure(sliceInputState);
+        PROF_PATH(eMICRF_PROF_HUNT);
+    }
+    else if (!rxVars_.rxData.bSkipSlice)        // Skip a slice last time the bit boundary was ahead of the slicer.
+    {
+        rxVars_.rxData.logicHighCnt += sliceInputState; // logicHighCnt will be used to "vote" if bit was high or low.
+        if (0 == rxVars_.rxData.sliceCnt)               // Is this the first slice?
+        {   // Store the 1st slice state.
+            rxVars_.rxData.sliceInputStateFirst = sliceInputState;  // Used to compute if timing needs to be adjusted.
+        }
+        rxVars_.rxData.sliceCnt++;
+        if (rxVars_.rxData.sliceCnt >= rxVars_.samplesPerBit)   // Check if this is the last slice for the bit
+        { // The last slice (sample) has been taken.  Now, process the results!
+            rxVars_.rxData.sliceCnt = 0;        // Reset the sliceCnt
+#if MICRF_ENABLE_LQI == 1
+            {   // Frame quality, a few cycles per chip: how clear the vote was, and the chips before the preamble
+                int8_t margin = (int8_t)((2 * rxVars_.rxData.logicHighCnt) - rxVars_.samplesPerBit);
+
+                rxVars_.rxData.marginSum += (uint16_t)((margin < 0) ? -margin : margin);
+                rxVars_.rxData.trainWord = (uint16_t)((rxVars_.rxData.trainWord << 1) |
+                                                      (rxVars_.rxData.manchesterWord >> 15));
+                if (rxVars_.rxData.chipCnt < TRAINING_CHIPS)
+                {
+                    rxVars_.rxData.chipCnt++;
+                }
+            }
+#endif
+            rxVars_.rxData.manchesterWord <<= 1;// Left shift the Manchester word.
+            if (rxVars_.rxData.logicHighCnt >= (rxVars_.samplesPerBit / 2)) // Voting, is the bit high or low?
+            {   // The bit is high
+                rxVars_.rxData.manchesterWord |= 1; // High bit, set the LSB to high (1).
+                // Is the sampling centered around a bit.  For example, if there are 10 samples per bit, we want all 10
+                // samples to read the bit and NOT read a part of one bit and a part of another.  Noise and signal
+                // strength can affect the bit timing.  So, if only the first slice was not a 1 and the last slick was
+                // a one, assume we a little too slow.  So, grab the next sample now.  This will effectively speed up
+                // the slicer by one time slice (or sample).
+                if ((0 == sliceInputState) && (0 != rxVars_.rxData.sliceInputStateFirst))
+                {   // Vote was high, however, last bit was 0.  So, assume this sample is a part of the next bit.
+                    rxVars_.rxData.logicHighCnt += sliceInputState;
+                    rxVars_.rxData.sliceCnt++;
+                    rxVars_.rxData.sliceInputStateFirst = sliceInputState;
+                    TIMING_CORRECTED();
+                }
+                else if ((0 == rxVars_.rxData.sliceInputStateFirst) && (0 != sliceInputState))
+                {
+                    // if only the first slice was a 1 and the last slick was a 0, assume we a little too quick.  So,
+                    // skip the next sample.  This will effectively slow down the slicer by 1 slice time (or sample).
+                    rxVars_.rxData.bSkipSlice = true;
+                    TIMING_CORRECTED();
+                }
+            }
+            else
+            {
+                if ((1 == sliceInputState) && (1 != rxVars_.rxData.sliceInputStateFirst)) // See notes for the 1 bit.
+                {
+                    rxVars_.rxData.logicHighCnt += sliceInputState;
+                    rxVars_.rxData.sliceCnt++;
+                    rxVars_.rxData.sliceInputStateFirst = sliceInputState;
+                    TIMING_CORRECTED();
+                }
+                else if ((1 == rxVars_.rxData.sliceInputStateFirst) && (1 != sliceInputState))
+                {
+                    rxVars_.rxData.bSkipSlice = true;
+                    TIMING_CORRECTED();
+                }
+            }
+            bOnBitBoundary = true;                  // We're on a bit boundary (or close).  Set the sliceDone.
+            PROF_PATH(eMICRF_PROF_BIT);
+            rxVars_.rxData.logicHighCnt = 0;        // Reset the voting variable.
+        }
+
+        /* If we're on a bit boundary AND the preamble matches the received word, then indicate we're going to start
+         * processing data.  Even though we're processing data, we're always going to look for another valid preamble.
+         * Since the preamble contains invalid Manchester data, we can re-start collecting data. */
+        if (bOnBitBoundary && (PREAMBLE == rxVars_.rxData.manchesterWord))
+        {
+            rxVars_.rxData.bCollectData = true;     // Indicate we're now collecting data
+            rxVars_.rxData.dataIdx = 0;             // Start collecting data at the 1st index.
+            rxVars_.rxData.bitCnt = 0;              // Reset the bit counter, we're now sync'd
+            rxVars_.stats.syncs++;
+#if MICRF_ENABLE_LQI == 1
+            lqiSync();
+#endif
+#if MICRF_ENABLE_CAPTURE == 1
+            captureFire(MICRF_CAP_TRIG_SYNC);
+#endif
+        }
+        else if (bOnBitBoundary && rxVars_.autoBaud.bEnabled && !rxVars_.rxData.bCollectData)
+        {   // Locked to a transmitter, but no preamble yet.  If it doesn't show up, it was a false lock.
+            if (++rxVars_.autoBaud.lockedBits >= AUTOBAUD_LOCK_TIMEOUT)
+            {
+                autoBaudHunt();
+            }
+        }
+        else if (bOnBitBoundary && rxVars_.rxData.bCollectData) // On a bit boundary and we're collecting data?
+        {
+            bool    bSendMsg = false;   // Assume we don't have enough data to send the message
+            
+            // If the Manchester coding is violated, don't bother doing anything else, just try to send the data.
+            if (0 != rxVars_.rxData.dataIdx)    // Until the 1st byte has been received, don't check.  
+            {   // Just get the 3 ls bits in the lsb variable.
+                uint8_t lsb = (uint8_t)((uint8_t)rxVars_.rxData.manchesterWord & 7);
+                
+                if ((7 == lsb) || (0 == lsb))   // Are the LSBs 000 or 111, these are not valid a Manchester bits.
+                {  // Now, we're going to try to send the message.  There is no need to try to decode the next bytes.
+                    bSendMsg = true;    
+                }
+            }
+            if (!bSendMsg)  // Need to process the incoming bits/bytes of data.
+            {
+                rxVars_.rxData.bitCnt++;            // We're going to process the next bit
+                if (rxVars_.rxData.bitCnt >= 16)    // Have we collected 16-bits (a word)?
+                {   // Yes, process the 16-bits of data
+                    rxVars_.rxData.bitCnt = 0;      // Reset bit count.  Prepare to collect the next 16-bits.
+                    PROF_PATH(eMICRF_PROF_BYTE);
+                    // Swap the bytes (convert the endianess)
+                    rxVars_.rxData.manchesterWord = (rxVars_.rxData.manchesterWord >> 8) | 
+                                                    (rxVars_.rxData.manchesterWord << 8);
+                    // Try to decode the Manchester data.  Convert 16-bits back to 8-bits.
+                    if (ME_decode((void *)&rxVars_.rxData.data[rxVars_.rxData.dataIdx], 
+                                   (void *)&rxVars_.rxData.manchesterWord,
+                                   sizeof(rxVars_.rxData.manchesterWord)))
+                    {  // Decoded properly
+                        rxVars_.rxData.bLogMsgRssi = true;  // Collecting data, log RSSI (all RSSI samples are for msg.)
+                        rxVars_.rxData.dataIdx++;           // Point the next buffer entry
+                        if (rxVars_.rxData.dataIdx >= sizeof(rxVars_.rxData.data))  // At the end of the buffer?
+                        {  // No more data will fit, try to send what we have.
+                            bSendMsg = true;
+                        }
+                    }
+                    else
+                    {   // Manchester decoding failed.  So, assume we collected all available data.  Try to send it.
+                        bSendMsg = true;
+                    }
+                }
+            }
+            if (bSendMsg) // Time to send message?
+            {  // Lets pass the message to the receiver module to validate and decode
+                PROF_PATH(eMICRF_PROF_FRAME);
+                rxVars_.rxData.bCollectData = false;    // No longer collecting data.  
+                rxVars_.rxData.bLogMsgRssi = false;     // The new RSSI values are now for measuring the noise floor.
+                // Is the function pointer valid AND the enough data was collected?
+                if ((NULL != rxVars_.pRxFunctionPtr) && (rxVars_.rxData.dataIdx >= RX_MINIMUM_PACKET_SIZE))
+                {  // All looks good, call the function.
+                    rxVars_.stats.frames++;
+                    rxVars_.pRxFunctionPtr((void *)&rxVars_.rxData.data[0], rxVars_.rxData.dataIdx);
+                }
+                else if (rxVars_.rxData.dataIdx < RX_MINIMUM_PACKET_SIZE)
+                {
+                    rxVars_.stats.shortFrames++;
+                }
+                if (rxVars_.autoBaud.bEnabled)  // The lock is only for this frame, measure the next one.
+                {
+                    autoBaudHunt();
+                }
           }
         }
     }
@@ -542,6 +1860,9 @@ void MICRF_sampleTimerISR(TC_TIMER_STATUS status, uintptr_t context)
     {
         rxVars_.rxData.bSkipSlice = false;  // Stop skipping slices!
     }
+#if DVR_PROF_ON == 1
+    DVR_PROF_record((profStat_t *)&prof_[eProfPath], DVR_PROF_CYCLES() - profStart);
+#endif
 }
 /* ****************************************************************************************************************** */
 // </editor-fold>
@@ -0,0 +1,147 @@
+// <editor-fold defaultstate="collapsed" desc="File Header">
+/***********************************************************************************************************************
+ *
+ * Filename:   dvr_prof.c
+ *
+ * Global Designator: DVR_PROF_
+ *
+ * Contents: Execution time statistics of the radio ISRs, measured with the DWT cycle counter of the Cortex-M4.  The
+ *           drivers read DVR_PROF_CYCLES() on entry and record the difference on exit, per path through the ISR.  The
+ *           interrupt entry/exit and the Harmony TC0 handler are not included.
+ * 
+ ***********************************************************************************************************************
+ *  2023 Microchip Technology Inc. and its subsidiaries.  You may use this software and any derivatives exclusively
+ * with Microchip products. 
+ * 
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS
+ * SOFTWARE, INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A PARTICULAR
+ * PURPOSE, OR ITS INTERACTION WITH MICROCHIP PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION. 
+ * IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE,
+ * COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF
+ * THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON
+ * ALL CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, THAT YOU HAVE PAID
+ * DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ * 
+ * MICROCHIP PROVIDES THIS SOFTWARE CONDITIONALLY UPON YOUR ACCEPTANCE OF THESE TERMS. 
+ **********************************************************************************************************************/
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="Include Files">
+/* ****************************************************************************************************************** */
+/* INCLUDE FILES */
+
+#include "dvr_prof.h"
+#include "definitions.h"
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="Macro Definitions">
+/* ****************************************************************************************************************** */
+/* MACRO DEFINITIONS */
+
+// </editor-fold>
+
+/* ****************************************************************************************************************** */
+/* FUNCTION DEFINITIONS */
+
+// <editor-fold defaultstate="collapsed" desc="void DVR_PROF_init( void )">
+/***********************************************************************************************************************
+ *
+ * Function Name: DVR_PROF_init
+ *
+ * Purpose: Starts the DWT cycle counter.
+ *
+ * Arguments: None
+ *
+ * Returns: None
+ *
+ * Side Effects: Enables the trace block (DEMCR.TRCENA).  Nothing if DVR_PROF_ON is 0.
+ *
+ * Reentrant Code: Yes
+ *
+ **********************************************************************************************************************/
+void DVR_PROF_init( void )
+{
+#if DVR_PROF_ON == 1
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="void DVR_PROF_record( profStat_t *pStat, uint32_t cycles )">
+/***********************************************************************************************************************
+ *
+ * Function Name: DVR_PROF_record
+ *
+ * Purpose: Adds one execution time to the statistics of a path.
+ *
+ * Arguments: profStat_t *pStat - Statistics of the path
+ *            uint32_t cycles - Cycles the path took
+ *
+ * Returns: None
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: No (called by the ISR that owns pStat)
+ *
+ **********************************************************************************************************************/
+void DVR_PROF_record( profStat_t *pStat, uint32_t cycles )
+{
+    uint8_t bin = 0;
+
+    if ((0 == pStat->cnt) || (cycles < pStat->min))
+    {
+        pStat->min = cycles;
+    }
+    if (cycles > pStat->max)
+    {
+        pStat->max = cycles;
+    }
+    pStat->cnt++;
+    pStat->sum += cycles;
+    if (0 != cycles)
+    {
+        bin = (uint8_t)(32 - __builtin_clz(cycles));    // Number of bits, CLZ is one instruction on the M4
+    }
+    if (bin >= DVR_PROF_HIST_BINS)
+    {
+        bin = DVR_PROF_HIST_BINS - 1;
+    }
+    pStat->hist[bin]++;
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="uint32_t DVR_PROF_average( const profStat_t *pStat )">
+/***********************************************************************************************************************
+ *
+ * Function Name: DVR_PROF_average
+ *
+ * Purpose: Returns the average execution time of a path.
+ *
+ * Arguments: const profStat_t *pStat - Statistics of the path
+ *
+ * Returns: uint32_t - Average cycles, 0 if the path never ran
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: Yes
+ *
+ **********************************************************************************************************************/
+uint32_t DVR_PROF_average( const profStat_t *pStat )
+{
+    return((0 != pStat->cnt) ? (uint32_t)(pStat->sum / pStat->cnt) : 0);
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+/* ****************************************************************************************************************** */
+/* Local Functions */
+
+/* ****************************************************************************************************************** */
+/* Event Handlers */
+
+/* ****************************************************************************************************************** */
+/* Unit Test Code */
@@ -28,6 +28,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "dvr_micrf219a.h"
 
 /* ****************************************************************************************************************** */
 /* GLOBAL DEFINTION */
@@ -36,6 +37,44 @@
 /* MACRO DEFINITIONS */
 
 #define RX_ENG_DATA_ON      1
+#define RX_AUTO_BAUD_ON     1   /* Set to 1 to lock to the transmitter's rate (training) instead of the rate profile */
+#define RX_REASSEMBLY_ON    1   /* Set to 1 to reassemble messages sent in fragments (see RX_getMessage) */
+#define RX_SESSION_ON       1   /* Set to 1 to track each transmitter, drop repeated frames and support an allowlist */
+
+#if RX_REASSEMBLY_ON == 1
+/* A fragment uses 2 bytes of the packet data for the fragment header: [message ID][index:4 | count - 1:4] */
+#define RX_FRAG_PAYLOAD_SIZE        13                                      /* Message bytes per fragment */
+#define RX_FRAG_MAX                 16                                      /* Fragments per message */
+#define RX_MESSAGE_MAX_SIZE         (RX_FRAG_PAYLOAD_SIZE * RX_FRAG_MAX)    /* Largest message, 208 bytes */
+#define RX_REASSEMBLY_SLOTS         2                                       /* Messages reassembled at the same time */
+#define RX_REASSEMBLY_TIMEOUT_MS    ((uint32_t)2000)                        /* Max. time between fragments */
+#endif
+
+#if RX_ENG_DATA_ON == 1
+#define RX_ENG_RSSI_BINS            8       /* RSSI histograms: bin 0 < MIN, bin n = MIN + (n - 1) * STEP .. + STEP - 1 */
+#define RX_ENG_RSSI_MIN_DBM         (-110)
+#define RX_ENG_RSSI_STEP_DB         10
+#define RX_ENG_LEN_BINS             4       /* Frame length histogram, 4 data bytes per bin */
+#define RX_ENG_GAP_BINS             12      /* Inter-arrival histogram: bin 0 < 16 mS, bin n = 2^(n+3) .. 2^(n+4) - 1 mS */
+#endif
+
+#if MICRF_ENABLE_LQI == 1
+/* Link quality indicator (LQI) of a frame, 0 to 100: the sum of the parts below, each one full at its limit.  Without
+ * the RSSI, the other parts are scaled to 100. */
+#define RX_LQI_SNR_WEIGHT           40      /* Message RSSI above the noise floor ... */
+#define RX_LQI_SNR_FULL_DB          30      /* ... full at this many dB */
+#define RX_LQI_MARGIN_WEIGHT        30      /* Average vote margin of the chips, full at 100% */
+#define RX_LQI_TIMING_WEIGHT        15      /* Slicer timing corrections, full at none ... */
+#define RX_LQI_TIMING_ZERO_PER100   10      /* ... 0 at this many per 100 chips */
+#define RX_LQI_TRAIN_WEIGHT         15      /* Training chips before the preamble, full when all are right ... */
+#define RX_LQI_TRAIN_ZERO_ERRORS    4       /* ... 0 at this many wrong chips */
+#endif
+
+#if RX_SESSION_ON == 1
+#define RX_SESSION_TABLE_BITS       4                                       /* Table size is a power of 2 */
+#define RX_SESSION_TABLE_SIZE       (1U << RX_SESSION_TABLE_BITS)           /* Transmitters tracked at once */
+#define RX_SESSION_DUP_WINDOW_MS    ((uint32_t)5000)    /* A repeated sequence number older than this is a new frame */
+#endif
 
 /* ****************************************************************************************************************** */
 /* TYPE DEFINITIONS */
@@ -51,8 +90,57 @@ typedef struct
     uint8_t  data[15];          // Data to be sent
     int8_t   msgRssi;           // RSSI of the last message sent
     int8_t   noiseRssi;         // Noise floor 
+    uint16_t bitRate;           // Data rate the message was received at, bits/second
+    uint8_t  seq;               // Sequence number, repeated copies of a frame have the same sequence number
+    uint8_t  lqi;               // Link quality indicator, 0 to 100 (0 if MICRF_ENABLE_LQI is 0), see RX_LQI_xxx
+    uint32_t rxMs;              // Time the frame was received, mS since start-up
 }rxDataPacket_t;                // Received packet format
 
+#if RX_REASSEMBLY_ON == 1
+typedef struct
+{
+    uint16_t serialNum;         // Serial number of the transmitter
+    uint8_t  msgId;             // Message ID set by the transmitter
+    uint16_t len;               // Number of data bytes in the message
+    uint8_t  data[RX_MESSAGE_MAX_SIZE];
+    int8_t   msgRssi;           // RSSI of the last fragment
+    int8_t   noiseRssi;         // Noise floor
+    uint16_t bitRate;           // Data rate of the last fragment, bits/second
+    uint8_t  lqi;               // Link quality indicator of the last fragment
+    uint32_t latencyMs;         // Time from the 1st fragment received to the message being complete
+}rxMessage_t;                   // Reassembled message
+
+typedef struct
+{
+    uint32_t  started;          // Messages with at least one fragment received
+    uint32_t  completed;        // Messages with all fragments received.  Completion rate = completed / started
+    uint32_t  timedOut;         // Messages dropped, no fragment within RX_REASSEMBLY_TIMEOUT_MS
+    uint32_t  evicted;          // Messages dropped to make room for a new message
+    uint32_t  dropped;          // New messages dropped, every slot holds a complete message not read yet
+    uint32_t  duplicates;       // Fragments received more than once
+    uint32_t  invalid;          // Fragments with an invalid fragment header
+    uint32_t  latencyMinMs;     // Reassembly latency of the completed messages
+    uint32_t  latencyMaxMs;
+    uint32_t  latencySumMs;     // Average = latencySumMs / completed
+}rxReasmStats_t;
+#endif
+
+#if RX_SESSION_ON == 1
+typedef struct
+{
+    serialNum_t serialNum;      // Serial number of the transmitter
+    uint8_t     lastSeq;        // Sequence number of the last frame
+    int8_t      lastRssi;       // RSSI of the last frame
+    uint8_t     lastLqi;        // Link quality indicator of the last frame
+    uint8_t     minLqi;         // Lowest link quality indicator of the frames
+    uint32_t    lqiSum;         // Average link quality indicator = lqiSum / frames
+    uint32_t    frames;         // Frames received (fragments included), repeated copies excluded
+    uint32_t    duplicates;     // Repeated copies dropped
+    uint32_t    lastSeenMs;     // Time the last frame was received
+    bool        bAllowed;       // On the allowlist
+}rxSession_t;                   // Information kept for each transmitter
+#endif
+
 #if RX_ENG_DATA_ON == 1
 typedef struct
 {
@@ -61,6 +149,21 @@ typedef struct
     uint32_t  protocolFailures;
     uint32_t  bufferOverflow;
     uint32_t  cntFailure;
+    uint32_t  duplicates;       // Repeated copies of a frame dropped
+    uint32_t  serialRejected;   // Frames dropped by the allowlist
+    uint32_t  syncs;            // Preambles detected by the driver
+    uint32_t  shortFrames;      // Frames dropped by the driver, too short to be a packet
+    uint32_t  frames;           // Frames passed by the driver to the receiver
+    uint32_t  goodFrames;       // Frames that passed the CRC.  The histograms and times below are of these frames.
+    uint32_t  rssiHist[RX_ENG_RSSI_BINS];   // Message RSSI
+    uint32_t  noiseHist[RX_ENG_RSSI_BINS];  // Noise floor
+    uint32_t  lenHist[RX_ENG_LEN_BINS];     // Data bytes (count field of the packet)
+    uint32_t  gapHist[RX_ENG_GAP_BINS];     // Time since the previous good frame
+    uint32_t  gapMinMs;
+    uint32_t  gapMaxMs;
+    uint32_t  gapSumMs;         // Average = gapSumMs / (goodFrames - 1)
+    uint32_t  latencyMaxMs;     // Decode latency, end of the frame (driver callback) to RX_process()
+    uint32_t  latencySumMs;     // Average = latencySumMs / goodFrames
 }engData_t;
 #endif
 
@@ -128,4 +231,155 @@ void RX_disable( void );
  */
 void RX_getEngData( engData_t *pEngData );
 
+/**
+ * RX_clearEngData - Clears the engineering data, including the frame detection counters of the driver.
+ *
+ * @see:  RX_getEngData
+ *
+ * @param  None
+ * 
+ * @return None
+ */
+void RX_clearEngData( void );
+
+/**
+ * RX_setRateProfile - Selects the receiver rate profile (bit rate and oversampling)
+ *
+ * @see:  eMICRF_rate_t
+ *
+ * @param  eMICRF_rate_t eRate - Rate profile to use
+ * 
+ * @return bool - true = Success, false = invalid profile
+ */
+bool RX_setRateProfile( eMICRF_rate_t eRate );
+
+/**
+ * RX_getRateProfile - Returns the receiver rate profile
+ *
+ * @see:  eMICRF_rate_t
+ *
+ * @param  None
+ * 
+ * @return eMICRF_rate_t - Rate profile in use
+ */
+eMICRF_rate_t RX_getRateProfile( void );
+
+/**
+ * RX_setAutoBaud - Enables or disables the auto-baud mode.  When enabled, the rate profile is not used.
+ *
+ * @see:  RX_AUTO_BAUD_ON
+ *
+ * @param  bool bEnable - true = auto-baud, false = use the rate profile
+ * 
+ * @return None
+ */
+void RX_setAutoBaud( bool bEnable );
+
+#if RX_SESSION_ON == 1
+/**
+ * RX_getSession - Returns the information of a transmitter.  Iterate idx from 0 to RX_SESSION_TABLE_SIZE - 1 to list
+ *                 all transmitters.
+ *
+ * @see:  RX_findSession
+ *
+ * @param  uint8_t idx - Table index
+ * @param  rxSession_t *pSession - Location to store the information
+ * 
+ * @return bool - true = transmitter at idx, false = no transmitter at idx
+ */
+bool RX_getSession( uint8_t idx, rxSession_t *pSession );
+
+/**
+ * RX_findSession - Returns the information of a transmitter.
+ *
+ * @see:  N/A
+ *
+ * @param  serialNum_t sn - Serial number of the transmitter
+ * @param  rxSession_t *pSession - Location to store the information
+ * 
+ * @return bool - true = found, false = the transmitter isn't in the table
+ */
+bool RX_findSession( serialNum_t sn, rxSession_t *pSession );
+
+/**
+ * RX_allowSerial - Adds a transmitter to the allowlist.
+ *
+ * @see:  RX_setAllowlist
+ *
+ * @param  serialNum_t sn - Serial number of the transmitter
+ * 
+ * @return bool - true = Success, false = the table is full of allowed transmitters
+ */
+bool RX_allowSerial( serialNum_t sn );
+
+/**
+ * RX_setAllowlist - Enables or disables the allowlist.  When enabled, frames of transmitters not on the allowlist are
+ *                   dropped by the driver callback, before they're copied and the CRC is checked.
+ *
+ * @see:  RX_allowSerial
+ *
+ * @param  bool bEnable - true = allowlist only, false = all transmitters
+ * 
+ * @return None
+ */
+void RX_setAllowlist( bool bEnable );
+
+/**
+ * RX_clearSessions - Clears the transmitter table, including the allowlist.
+ *
+ * @see:  N/A
+ *
+ * @param  None
+ * 
+ * @return None
+ */
+void RX_clearSessions( void );
+#endif
+
+#if RX_REASSEMBLY_ON == 1
+/**
+ * RX_getMessage - Returns a reassembled message.  Call after RX_process(), fragments are collected by RX_process().
+ *
+ * @see:  RX_process
+ *
+ * @param  rxMessage_t *pMsg - Location to store the message
+ * 
+ * @return bool - true a message is complete, false - no message
+ */
+bool RX_getMessage( rxMessage_t *pMsg );
+
+/**
+ * RX_getReassemblyStats - Returns the reassembly statistics (completion rate and latency).
+ *
+ * @see:  N/A
+ *
+ * @param  rxReasmStats_t *pStats - Location to store the statistics
+ * 
+ * @return None
+ */
+void RX_getReassemblyStats( rxReasmStats_t *pStats );
+
+/**
+ * RX_clearReassemblyStats - Clears the reassembly statistics.
+ *
+ * @see:  N/A
+ *
+ * @param  None
+ * 
+ * @return None
+ */
+void RX_clearReassemblyStats( void );
+#endif
+
+/**
+ * RX_getAutoBaud - Returns true if the auto-baud mode is enabled.
+ *
+ * @see:  N/A
+ *
+ * @param  None
+ * 
+ * @return bool - true = auto-baud enabled
+ */
+bool RX_getAutoBaud( void );
+
 #endif  /* RECEIVER_H */
@@ -58,6 +58,8 @@
 #include "ble_dis/ble_dis.h"
 #include "app_ble_conn_handler.h"
 #include "app_ble_sensor.h"
+#include "app_micrf.h"
+#include "app_log.h"
 #include "app_adv.h"
 #include "system/console/sys_console.h"
 #include "ble_otaps/ble_otaps.h"
@@ -69,7 +71,7 @@
 #include <stdio.h>
 
 rxDataPacket_t rxPacket;                        // Populated by RX_process() if data is ready.
-engData_t      engData;                         // Contains engineering data from RX_getEngData() module.
+rxMessage_t    rxMessage;                       // Populated by RX_getMessage() once a fragmented message is complete.
 uint32_t       txCnt;
 char result[4];
 // *****************************************************************************
@@ -202,6 +204,10 @@ static void APP_Init(void)
 
     APP_TRPS_Sensor_Init();
     
+    APP_MICRF_Init();
+    
+    APP_LOG_Init();
+    
     APP_OTA_HDL_Init();
     
     wbz451_silicon_revision = 	DSU_REGS->DSU_DID;	
@@ -324,6 +330,22 @@ void APP_Tasks ( void )
                 {
                     APP_OTA_Reboot_Handler(); 
                 } 
+                else if(p_appMsg->msgId== APP_TIMER_BLE_CONN_MSG)
+                {
+                    APP_BLE_ConnMgrTimerHandler();
+                }
+                else if(p_appMsg->msgId== APP_MSG_TRPS_NTF_FLUSH)
+                {
+                    APP_TRPS_NotifyFlush();
+                }
+                else if(p_appMsg->msgId== APP_TIMER_ADV_TLM_MSG)
+                {
+                    APP_ADV_TlmTimerHandler();
+                }
+                else if(p_appMsg->msgId== APP_MSG_OTA_FLASH)
+                {
+                    APP_OTA_HDL_FlashTask();
+                }
                 else if(p_appMsg->msgId== APP_TOUCH_USART_READ_MSG)
                 {                    
                     APP_RGB_Handler(txCnt);                    
@@ -340,25 +362,52 @@ void APP_Tasks ( void )
                 else if( p_appMsg->msgId == APP_MSG_MICRF_DATA_EVT)
                 {
                     APP_Msg_T appMsg;           
-                    if (RX_process(&rxPacket))                  // Check if there is an RF packet received
+                    bool bFrame;
+                    // Check if there is an RF packet received.  Every frame goes to the BLE gateway, benchmark frames are
+                    // only counted and firmware broadcast frames decoded, not displayed.
+                    bFrame = RX_process(&rxPacket);
+                    if (bFrame)
+                    {
+                        APP_MICRF_GatewayFrame(&rxPacket);
+                        APP_MICRF_AdvFrame(&rxPacket);
+                    }
+                    if (bFrame && !APP_MICRF_BenchFrame(&rxPacket) &&
+                        !APP_OTA_HDL_BcastFrame(rxPacket.data, rxPacket.cnt))
                     {
                         (void)memcpy(&txCnt, &rxPacket.data[0], sizeof(txCnt));  
-                        sprintf(result, "%ld", txCnt);
-                        SYS_CONSOLE_MESSAGE("\n\r");
-                        SYS_CONSOLE_PRINT("Received Data: %ld\n\r",txCnt); // Display the data received
+                        result[0] = (char)('0' + ((txCnt / 1000) % 10));  // RGB + On/Off digits, see APP_RGB_Handler()
+                        result[1] = (char)('0' + ((txCnt / 100) % 10));
+                        result[2] = (char)('0' + ((txCnt / 10) % 10));
+                        result[3] = (char)('0' + (txCnt % 10));
+                        APP_LOG(APP_LOG_RX_PACKET, txCnt, rxPacket.serialNum, rxPacket.seq); // Display the data and the transmitter
                             
                         #if MICRF_ENABLE_RSSI == 1
-                        SYS_CONSOLE_PRINT("Message RSSI/Noise RSSI: %d/%d\n\r",rxPacket.msgRssi, rxPacket.noiseRssi); // Display the RSSI values
+                        APP_LOG(APP_LOG_RX_RSSI, rxPacket.msgRssi, rxPacket.noiseRssi, rxPacket.bitRate); // Display the RSSI values and the detected data rate
                         #endif
 
-                        #if RX_ENG_DATA_ON == 1                    
-                        RX_getEngData(&engData);      // Get the engineering data
-                        SYS_CONSOLE_PRINT("Valid Pkt:%ld,Cnt Fail:%d,CRC Fail:%d,Protocol Fail:%d,Buf:%d\n\r",engData.validPackets,engData.cntFailure,engData.crcFailures,engData.protocolFailures,engData.bufferOverflow);// Display only the number of packets received
+                        #if (MICRF_ENABLE_LQI == 1) && (RX_SESSION_ON == 1)
+                        {
+                            rxSession_t session;
+
+                            if (RX_findSession(rxPacket.serialNum, &session) && (0 != session.frames))
+                            {   // Link quality of the frame and of the transmitter so far
+                                APP_LOG(APP_LOG_RX_LQI, rxPacket.lqi, session.lqiSum / session.frames, session.minLqi);
+                            }
+                        }
                         #endif
 
                         appMsg.msgId = APP_TOUCH_USART_READ_MSG;
                         OSAL_QUEUE_Send(&appData.appQueue, &appMsg, 0);
                     }
+                    if (RX_getMessage(&rxMessage))    // Check if a fragmented message is complete
+                    {
+                        APP_LOG(APP_LOG_RX_MESSAGE, rxMessage.msgId, rxMessage.len, rxMessage.serialNum, rxMessage.latencyMs);
+                    }
+                    #if MICRF_ENABLE_CAPTURE == 1
+                    APP_MICRF_CaptureDump();          // Dump a frozen raw sample capture to the console
+                    #endif
+                    APP_MICRF_StatsNotify();          // Send the next page of the receiver statistics
+                    APP_MICRF_GatewayFlush();         // Forward the received frames to the central
                     appMsg.msgId = APP_MSG_MICRF_DATA_EVT;
                     OSAL_QUEUE_Send(&appData.appQueue, &appMsg, 0);                  
                 }
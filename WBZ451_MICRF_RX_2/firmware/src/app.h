@@ -104,6 +104,10 @@ typedef enum APP_MsgId_T
     APP_MSG_TRS_BLE_SENSOR_INT,
     APP_TIMER_OTA_TIMEOUT_MSG,
     APP_TIMER_OTA_REBOOT_MSG,
+    APP_TIMER_BLE_CONN_MSG,
+    APP_MSG_TRPS_NTF_FLUSH,
+    APP_TIMER_ADV_TLM_MSG,
+    APP_MSG_OTA_FLASH,
     APP_TOUCH_USART_READ_MSG,
     APP_TOUCH_USART_WRITE_MSG,
     APP_MSG_MICRF_ADC_EVT,
@@ -64,6 +64,15 @@
 #define APP_ADV_DEFAULT_INTERVAL                                        0x0200
 /** @} */
 
+/**@defgroup APP_ADV_TLM APP_ADV_TLM
+ * @brief Link telemetry of the receiver appended to the service data, for scanners that do not connect.  The payload
+ *        is refreshed every APP_ADV_TLM_PERIOD_MS, only the bytes that changed are patched and the stack is only
+ *        given the payload when one did.
+ * @{ */
+#define APP_ADV_TLM_ON                                                  1
+#define APP_ADV_TLM_PERIOD_MS                                           1000       /**< Unit: ms. */
+/** @} */
+
 /**@defgroup APP_ADV_TYPE APP_ADV_TYPE
 * @brief The definition of the advertising type
 * @{ */
@@ -127,5 +136,7 @@ void APP_ADV_Init(void);
 void APP_ADV_Start(void);
 void APP_BLE_Adv_TimerHandler(void);
 void APP_ADV_Stop(void);
+void APP_ADV_Refresh(void);
+void APP_ADV_TlmTimerHandler(void);
 void APP_UpdateLocalName(uint8_t devNameLen, uint8_t *p_devName);
 #endif
@@ -49,6 +49,8 @@
 #include "app_ble_handler.h"
 #include "system/console/sys_console.h"
 #include "../app_ble_conn_handler.h"
+#include "../app_trps.h"
+#include "../app_micrf.h"
 
 // *****************************************************************************
 // *****************************************************************************
@@ -82,8 +84,7 @@ void APP_BleGapEvtHandler(BLE_GAP_Event_T *p_event)
 
         case BLE_GAP_EVT_DISCONNECTED:
         {
-            /* TODO: implement your application code.*/
-
+            APP_MICRF_GatewayDisconnect(p_event->eventField.evtDisconnect.connHandle);
         }
         break;
 
@@ -131,7 +132,7 @@ void APP_BleGapEvtHandler(BLE_GAP_Event_T *p_event)
 
         case BLE_GAP_EVT_TX_BUF_AVAILABLE:
         {
-            /* TODO: implement your application code.*/
+            APP_TRPS_NotifyFlush();
         }
         break;
 
@@ -342,7 +343,7 @@ void APP_GattEvtHandler(GATT_Event_T *p_event)
 
         case GATTS_EVT_WRITE:
         {
-            /* TODO: implement your application code.*/
+            APP_BLE_ConnMgrRx(p_event->eventField.onWrite.connHandle, p_event->eventField.onWrite.writeDataLength);
         }
         break;
 
@@ -360,7 +361,7 @@ void APP_GattEvtHandler(GATT_Event_T *p_event)
 
         case ATT_EVT_UPDATE_MTU:
         {
-            /* TODO: implement your application code.*/
+            APP_BLE_ConnMgrMtu(p_event->eventField.onUpdateMTU.connHandle, p_event->eventField.onUpdateMTU.exchangedMTU);
         }
         break;
 
@@ -47,6 +47,7 @@
 #include <stdint.h>
 #include "ble_trsps/ble_trsps.h"
 #include "app_trps.h"
+#include "app_micrf.h"
 
 
 // *****************************************************************************
@@ -74,7 +75,7 @@ void APP_TrspsEvtHandler(BLE_TRSPS_Event_T *p_event)
         
         case BLE_TRSPS_EVT_TX_STATUS:
         {
-            /* TODO: implement your application code.*/
+            APP_MICRF_GatewayTxStatus(p_event->eventField.onTxStatus.connHandle, p_event->eventField.onTxStatus.status);
         }
         break;
 
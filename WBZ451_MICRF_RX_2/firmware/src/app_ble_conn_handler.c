@@ -48,12 +48,17 @@
 #include <stdint.h>
 #include "app_ble_conn_handler.h"
 #include "ble_dm/ble_dm.h"
+#include "gatt.h"
 #include "app_timer/app_timer.h"
+#include "app_ota/app_ota_handler.h"
+#include "app_error_defs.h"
 #include "app_adv.h"
 #include "app_trps.h"
 #include "app_ble_sensor.h"
 #include "peripheral/gpio/plib_gpio.h"
 #include "system/console/sys_console.h"
+#include "FreeRTOS.h"
+#include "task.h"
 
 // *****************************************************************************
 // *****************************************************************************
@@ -74,13 +79,60 @@
 // *****************************************************************************
 // *****************************************************************************
 static APP_BLE_ConnList_T                   s_bleConnList[BLE_GAP_MAX_LINK_NBR];
-static APP_BLE_ConnList_T                   *sp_currentBleLink = NULL;
+static APP_BLE_LinkState_T                  s_advState;         /**< Advertising state, the links have their own */
 
 // *****************************************************************************
 // *****************************************************************************
 // Section: Functions
 // *****************************************************************************
 // *****************************************************************************
+/* Ask the central for the interval profile of mode.  The result comes with BLE_GAP_EVT_CONN_PARAM_UPDATE. */
+static void APP_BLE_ConnMgrRequest(APP_BLE_ConnList_T *p_bleConn, APP_BLE_ConnMode_T mode)
+{
+    BLE_DM_ConnParamUpdate_T params;
+
+    if (mode == APP_BLE_CONN_MODE_FAST)
+    {
+        params.intervalMin = APP_BLE_CONN_FAST_INTERVAL_MIN;
+        params.intervalMax = APP_BLE_CONN_FAST_INTERVAL_MAX;
+        params.latency = APP_BLE_CONN_FAST_LATENCY;
+        params.timeout = APP_BLE_CONN_FAST_TIMEOUT;
+    }
+    else
+    {
+        params.intervalMin = APP_BLE_CONN_SLOW_INTERVAL_MIN;
+        params.intervalMax = APP_BLE_CONN_SLOW_INTERVAL_MAX;
+        params.latency = APP_BLE_CONN_SLOW_LATENCY;
+        params.timeout = APP_BLE_CONN_SLOW_TIMEOUT;
+    }
+    if (BLE_DM_ConnectionParameterUpdate(p_bleConn->connData.handle, &params) == APP_RES_SUCCESS)
+    {
+        p_bleConn->mgr.modeReq = mode;
+        p_bleConn->mgr.updateWait = APP_BLE_CONN_UPDATE_WINDOWS;
+    }
+}
+
+/* Clear the counters of a new link and negotiate the 2M PHY and a larger ATT MTU.  The Data Length Extension is left
+ * to the stack, which runs the LL length update itself; APP_BLE_CONN_MTU is sized to fill the 251 byte payload. */
+static void APP_BLE_ConnMgrStart(APP_BLE_ConnList_T *p_bleConn)
+{
+    memset(&p_bleConn->mgr, 0, sizeof(p_bleConn->mgr));
+    memset(&p_bleConn->stats, 0, sizeof(p_bleConn->stats));
+    p_bleConn->mgr.mode = APP_BLE_CONN_MODE_CENTRAL;
+    p_bleConn->mgr.txPhy = BLE_GAP_PHY_TYPE_LE_1M;
+    p_bleConn->mgr.rxPhy = BLE_GAP_PHY_TYPE_LE_1M;
+    p_bleConn->mgr.attMtu = BLE_ATT_DEFAULT_MTU_LEN;
+
+#if APP_BLE_CONN_MGR_ON == 1
+    BLE_GAP_SetPhy(p_bleConn->connData.handle, BLE_GAP_PHY_OPTION_2M, BLE_GAP_PHY_OPTION_2M, BLE_GAP_PHY_PREF_NO);
+    (void)GATTC_ExchangeMTURequest(p_bleConn->connData.handle, APP_BLE_CONN_MTU);   // Most centrals start it first
+#endif
+    if (!APP_TIMER_IsTimerExisted(APP_TIMER_BLE_CONN))
+    {
+        APP_TIMER_SetTimer(APP_TIMER_BLE_CONN, APP_BLE_CONN_MGR_PERIOD_MS, true);
+    }
+}
+
 static void APP_ClearConnListByConnHandle(uint16_t connHandle)
 {
     uint8_t i;
@@ -124,6 +176,144 @@ APP_BLE_ConnList_T *APP_GetConnInfoByConnHandle(uint16_t connHandle)
     return NULL;
 }
 
+/* Count a notification to the central, see APP_BLE_ConnMgrRx() for the latency */
+void APP_BLE_ConnMgrTx(uint16_t connHandle, uint16_t len)
+{
+    APP_BLE_ConnList_T *p_bleConn = APP_GetConnInfoByConnHandle(connHandle);
+    uint32_t latMs;
+
+    if ((connHandle == 0) || (p_bleConn == NULL))
+    {
+        return;
+    }
+    p_bleConn->stats.txBytes += len;
+    p_bleConn->stats.txPackets++;
+    p_bleConn->mgr.windowTx += len;
+    if (p_bleConn->mgr.latPending)
+    {
+        p_bleConn->mgr.latPending = false;
+        latMs = (xTaskGetTickCount() * portTICK_PERIOD_MS) - p_bleConn->mgr.latStartMs;
+        p_bleConn->stats.latLastMs = (latMs > UINT16_MAX) ? UINT16_MAX : (uint16_t)latMs;
+        if (p_bleConn->stats.latLastMs > p_bleConn->stats.latMaxMs)
+        {
+            p_bleConn->stats.latMaxMs = p_bleConn->stats.latLastMs;
+        }
+        p_bleConn->stats.latSumMs += p_bleConn->stats.latLastMs;
+        p_bleConn->stats.latCnt++;
+    }
+}
+
+/* Count a write of the central.  The request latency runs from here to the next notification, which is the time the
+ * application takes to answer; the air time depends on the connection interval. */
+void APP_BLE_ConnMgrRx(uint16_t connHandle, uint16_t len)
+{
+    APP_BLE_ConnList_T *p_bleConn = APP_GetConnInfoByConnHandle(connHandle);
+
+    if ((connHandle == 0) || (p_bleConn == NULL))
+    {
+        return;
+    }
+    p_bleConn->stats.rxBytes += len;
+    p_bleConn->stats.rxPackets++;
+    p_bleConn->mgr.windowRx += len;
+    if (!p_bleConn->mgr.latPending)
+    {
+        p_bleConn->mgr.latPending = true;
+        p_bleConn->mgr.latStartMs = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    }
+
+#if APP_BLE_CONN_MGR_ON == 1
+    /* The central is talking to us, leave the low power interval now instead of at the end of the window */
+    if ((p_bleConn->mgr.mode == APP_BLE_CONN_MODE_SLOW) && (p_bleConn->mgr.updateWait == 0) &&
+        (APP_OTA_HDL_GetOTAMode() == APP_OTA_MODE_IDLE))
+    {
+        p_bleConn->mgr.idleWindows = 0;
+        APP_BLE_ConnMgrRequest(p_bleConn, APP_BLE_CONN_MODE_FAST);
+    }
+#endif
+}
+
+/* ATT MTU exchanged, ATT_EVT_UPDATE_MTU */
+void APP_BLE_ConnMgrMtu(uint16_t connHandle, uint16_t mtu)
+{
+    APP_BLE_ConnList_T *p_bleConn = APP_GetConnInfoByConnHandle(connHandle);
+
+    if ((connHandle != 0) && (p_bleConn != NULL))
+    {
+        p_bleConn->mgr.attMtu = mtu;
+    }
+}
+
+/* End of a traffic window, APP_TIMER_BLE_CONN.  A busy link gets the low latency interval, a link idle for
+ * APP_BLE_CONN_IDLE_WINDOWS the low power one.  An update the central refuses is not retried until the traffic asks
+ * for the other profile, and the intervals are left alone while OTA runs (APP_OTA_HDL_Prepare() sets its own). */
+void APP_BLE_ConnMgrTimerHandler(void)
+{
+    APP_BLE_ConnList_T *p_bleConn;
+    uint32_t bytes;
+    uint8_t i, links = 0;
+
+    for (i = 0; i < BLE_GAP_MAX_LINK_NBR; i++)
+    {
+        p_bleConn = &s_bleConnList[i];
+        if ((p_bleConn->connData.handle == 0) || (p_bleConn->linkState != APP_BLE_STATE_CONNECTED))
+        {
+            continue;
+        }
+        links++;
+
+        bytes = p_bleConn->mgr.windowTx * 1000U / APP_BLE_CONN_MGR_PERIOD_MS;
+        p_bleConn->stats.txBps = (bytes > UINT16_MAX) ? UINT16_MAX : (uint16_t)bytes;
+        bytes = p_bleConn->mgr.windowRx * 1000U / APP_BLE_CONN_MGR_PERIOD_MS;
+        p_bleConn->stats.rxBps = (bytes > UINT16_MAX) ? UINT16_MAX : (uint16_t)bytes;
+        bytes = (uint32_t)p_bleConn->stats.txBps + p_bleConn->stats.rxBps;
+        if (bytes > p_bleConn->stats.peakBps)
+        {
+            p_bleConn->stats.peakBps = (bytes > UINT16_MAX) ? UINT16_MAX : (uint16_t)bytes;
+        }
+        bytes = p_bleConn->mgr.windowTx + p_bleConn->mgr.windowRx;
+        p_bleConn->mgr.windowTx = 0;
+        p_bleConn->mgr.windowRx = 0;
+
+        if (bytes >= APP_BLE_CONN_FAST_BYTES)
+        {
+            p_bleConn->mgr.idleWindows = 0;
+        }
+        else if (p_bleConn->mgr.idleWindows < APP_BLE_CONN_IDLE_WINDOWS)
+        {
+            p_bleConn->mgr.idleWindows++;
+        }
+
+        if (p_bleConn->mgr.updateWait != 0)
+        {
+            if (--p_bleConn->mgr.updateWait == 0)
+            {   // No answer, take it as refused
+                p_bleConn->mgr.mode = p_bleConn->mgr.modeReq;
+            }
+            continue;
+        }
+#if APP_BLE_CONN_MGR_ON == 1
+        if (APP_OTA_HDL_GetOTAMode() != APP_OTA_MODE_IDLE)
+        {
+            continue;
+        }
+        if ((p_bleConn->mgr.idleWindows == 0) && (p_bleConn->mgr.mode != APP_BLE_CONN_MODE_FAST))
+        {
+            APP_BLE_ConnMgrRequest(p_bleConn, APP_BLE_CONN_MODE_FAST);
+        }
+        else if ((p_bleConn->mgr.idleWindows >= APP_BLE_CONN_IDLE_WINDOWS) && (p_bleConn->mgr.mode != APP_BLE_CONN_MODE_SLOW))
+        {
+            APP_BLE_ConnMgrRequest(p_bleConn, APP_BLE_CONN_MODE_SLOW);
+        }
+#endif
+    }
+
+    if (links == 0)
+    {
+        APP_TIMER_StopTimer(APP_TIMER_BLE_CONN);
+    }
+}
+
 uint16_t APP_GetConnHandleByIndex(uint8_t index)
 {
     if (index < BLE_GAP_MAX_LINK_NBR)
@@ -165,16 +355,36 @@ void APP_BleGapConnEvtHandler(BLE_GAP_Event_T *p_event)
                 for(idx=(GAP_MAX_BD_ADDRESS_LEN-1); idx>=0; idx--)
                     SYS_CONSOLE_PRINT("%02x", p_bleConn->connData.remoteAddr.addr[idx]);
                 SYS_CONSOLE_PRINT("\n\r[BLE] Connection Handle: %d\n\r",p_bleConn->connData.handle);
+
+                APP_BLE_ConnMgrStart(p_bleConn);
                 
                 APP_TIMER_StopTimer(APP_TIMER_ADV_CTRL);
                 USER_LED_Clear();                
                                
+                /* Advertising stopped with the connection */
+                APP_SetBleState(APP_BLE_STATE_STANDBY);
+#if APP_BLE_CONN_MULTI_ON == 1
+                if (APP_GetFreeConnList() != NULL)
+                {
+                    APP_ADV_Start();
+                }
+#endif
             }
         }
         break;
 
         case BLE_GAP_EVT_DISCONNECTED:
         {
+            p_bleConn = APP_GetConnInfoByConnHandle(p_event->eventField.evtDisconnect.connHandle);
+            if (p_bleConn)
+            {
+                SYS_CONSOLE_PRINT("[BLE] Link %d: tx %lu B, rx %lu B, peak %u B/s, latency avg %lu max %u ms, PHY %d/%d, MTU %d\n\r",
+                                  p_bleConn->connData.handle, p_bleConn->stats.txBytes, p_bleConn->stats.rxBytes,
+                                  p_bleConn->stats.peakBps,
+                                  (p_bleConn->stats.latCnt != 0) ? (p_bleConn->stats.latSumMs / p_bleConn->stats.latCnt) : 0,
+                                  p_bleConn->stats.latMaxMs, p_bleConn->mgr.txPhy, p_bleConn->mgr.rxPhy, p_bleConn->mgr.attMtu);
+            }
+
             //Clear connection list
             APP_ClearConnListByConnHandle(p_event->eventField.evtDisconnect.connHandle);
             SYS_CONSOLE_PRINT("[BLE] Disconnected Handle: %d\n\r",p_event->eventField.evtDisconnect.connHandle);                
@@ -202,6 +412,20 @@ void APP_BleGapConnEvtHandler(BLE_GAP_Event_T *p_event)
                     p_bleConn->connData.connInterval            = p_event->eventField.evtConnParamUpdate.connParam.intervalMin;
                     p_bleConn->connData.connLatency             = p_event->eventField.evtConnParamUpdate.connParam.latency;
                     p_bleConn->connData.supervisionTimeout      = p_event->eventField.evtConnParamUpdate.connParam.supervisionTimeout;
+                    p_bleConn->stats.paramUpdates++;
+                    /* Not ours (OTA or the central), re-evaluated at the next window */
+                    p_bleConn->mgr.mode = (p_bleConn->mgr.updateWait != 0) ? p_bleConn->mgr.modeReq : APP_BLE_CONN_MODE_CENTRAL;
+                    p_bleConn->mgr.updateWait = 0;
+                }
+            }
+            else
+            {
+                p_bleConn = APP_GetConnInfoByConnHandle(p_event->eventField.evtConnParamUpdate.connHandle);
+
+                if (p_bleConn && (p_bleConn->mgr.updateWait != 0))
+                {   // Refused, see APP_BLE_ConnMgrTimerHandler()
+                    p_bleConn->mgr.mode = p_bleConn->mgr.modeReq;
+                    p_bleConn->mgr.updateWait = 0;
                 }
             }
         }
@@ -268,7 +492,13 @@ void APP_BleGapConnEvtHandler(BLE_GAP_Event_T *p_event)
 
         case BLE_GAP_EVT_PHY_UPDATE:
         {
-            /* TODO: implement your application code.*/
+            p_bleConn = APP_GetConnInfoByConnHandle(p_event->eventField.evtPhyUpdate.connHandle);
+
+            if (p_bleConn && (p_event->eventField.evtPhyUpdate.status == 0))
+            {
+                p_bleConn->mgr.txPhy = p_event->eventField.evtPhyUpdate.txPhy;
+                p_bleConn->mgr.rxPhy = p_event->eventField.evtPhyUpdate.rxPhy;
+            }
         }
         break;
 
@@ -321,19 +551,33 @@ void APP_BleGapConnEvtHandler(BLE_GAP_Event_T *p_event)
 
 APP_BLE_LinkState_T APP_GetBleState(void)
 {
-    return (sp_currentBleLink->linkState);
+    uint8_t i;
+
+    for (i = 0; i < BLE_GAP_MAX_LINK_NBR; i++)
+    {
+        if (s_bleConnList[i].linkState == APP_BLE_STATE_CONNECTED)
+        {
+            return APP_BLE_STATE_CONNECTED;
+        }
+    }
+    return s_advState;
 }
 
 void APP_SetBleState(APP_BLE_LinkState_T state)
 {
-    sp_currentBleLink->linkState = state;
+    s_advState = state;
+}
+
+APP_BLE_LinkState_T APP_GetAdvState(void)
+{
+    return s_advState;
 }
 
 void APP_InitConnList(void)
 {
     uint8_t i;
 
-    sp_currentBleLink = &s_bleConnList[0];       
+    s_advState = APP_BLE_STATE_STANDBY;
     
     for (i = 0; i < BLE_GAP_MAX_LINK_NBR; i++)
     {
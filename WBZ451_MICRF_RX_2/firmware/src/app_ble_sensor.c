@@ -205,7 +205,7 @@ void APP_TRPS_Sensor_Button_Handler(void)
     }
     else
     {       
-        APP_ADV_Init();  
+        APP_ADV_Refresh();  
     }
 }
 
@@ -250,7 +250,7 @@ void APP_TRPS_Sensor_TimerHandler(void)
         {
             if( (tempBack > (lastAdvTemp + 1)) || (tempBack < (lastAdvTemp-1)) )  //+/- 1C above, only then update advertisement payload
             {       
-                APP_ADV_Init();
+                APP_ADV_Refresh();
                 lastAdvTemp = tempBack;                
             }
         }
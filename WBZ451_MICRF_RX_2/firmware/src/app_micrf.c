@@ -0,0 +1,910 @@
+/*******************************************************************************
+  Application MICRF Control Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_micrf.c
+
+  Summary:
+    This file contains the Application MICRF receiver control functions for this project.
+
+  Description:
+    This file contains the TRPS vendor command set used to select the MICRF
+    rate profile and to read the per profile throughput/PER benchmark results.
+ *******************************************************************************/
+
+//DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2023 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+//DOM-IGNORE-END
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdint.h>
+#include <string.h>
+#include "definitions.h"
+#include "system/console/sys_console.h"
+#include "app_trps.h"
+#include "app_micrf.h"
+#include "app_ble_conn_handler.h"
+#include "app_error_defs.h"
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Local Variables
+// *****************************************************************************
+// *****************************************************************************
+
+/**@brief Benchmark results of one rate profile */
+typedef struct
+{
+    uint16_t    rxCnt;          /**< Frames received */
+    uint16_t    total;          /**< Frames sent, as reported by the transmitter */
+    uint16_t    lastSeq;        /**< Sequence number of the last frame */
+    uint32_t    firstTick;      /**< Tick count of the first frame */
+    uint32_t    lastTick;       /**< Tick count of the last frame */
+} APP_MICRF_BenchStat_T;
+
+/**@brief PDS items of the application.  PDS_DECLARE_FILE() needs an identifier, not an expression. */
+typedef enum
+{
+    APP_MICRF_PDS_RSSI_CAL_ID = (PDS_MODULE_APP_OFFSET),    /**< MICRF_rssiCal_t */
+} APP_MICRF_PdsItem_T;
+
+static APP_MICRF_BenchStat_T s_benchStat[eMICRF_RATE_CNT];
+static APP_MICRF_RateRsp_T   s_rateRsp;
+static APP_MICRF_BenchRsp_T  s_benchRsp;
+static APP_MICRF_ReasmRsp_T  s_reasmRsp;
+static APP_MICRF_CapInfoRsp_T s_capInfoRsp;
+static APP_MICRF_CapReadRsp_T s_capReadRsp;
+static APP_MICRF_ProfRsp_T  s_profRsp;
+static APP_MICRF_ProfHistRsp_T s_profHistRsp;
+static APP_MICRF_StatsNfy_T s_statsNfy;
+static uint8_t  s_statsPages;           /**< MICRF_STATS_GET_RSP, pages in the statistics block */
+static uint8_t  s_statsPage;            /**< Next page to notify, APP_MICRF_STATS_PAGE_IDLE = not sending */
+static uint32_t s_statsPeriodTicks;     /**< Statistics sent every ... ticks, 0 = on request only */
+static uint32_t s_statsNextTick;        /**< Tick count the next periodic block is due */
+#if RX_ENG_DATA_ON == 1
+static APP_MICRF_StatsBlock_T s_statsBlock;
+#endif
+static APP_MICRF_RssiCalRsp_T s_rssiCalRsp;
+#if MICRF_ENABLE_RSSI == 1
+static MICRF_rssiCal_t s_rssiCalMeas;   /**< Points measured by MICRF_RSSI_CAL_SET_CMD */
+static MICRF_rssiCal_t s_rssiCal;       /**< Calibration in use, PDS item APP_MICRF_PDS_RSSI_CAL_ID */
+#endif
+static uint8_t  s_rssiCalPoints;        /**< See APP_MICRF_RssiCalRsp_T points */
+
+#if APP_MICRF_GW_ON == 1
+/**@brief A frame waiting in the gateway backlog */
+typedef struct
+{
+    uint8_t     len;            /**< Bytes of rec in use */
+    APP_MICRF_GwRecord_T rec;
+} APP_MICRF_GwEntry_T;
+
+static APP_MICRF_GwEntry_T s_gwBacklog[APP_MICRF_GW_BACKLOG];
+static uint16_t s_gwHead;               /**< Frames added to the backlog */
+static uint16_t s_gwTail;               /**< Frames sent */
+static uint32_t s_gwDropped;            /**< Frames dropped on a full backlog, not reported yet */
+static uint32_t s_gwOldestTick;         /**< Tick count the oldest frame of the backlog was added */
+static uint16_t s_gwConnHandle;         /**< Connection of the central with the data channel open, its MTU is in
+                                             APP_BLE_ConnList_T.mgr */
+static uint8_t  s_gwBatchSeq;           /**< Sequence number of the next notification */
+static bool     s_gwOpen;               /**< Central has the data channel notifications on */
+#endif
+
+static uint16_t s_tlmSerialNum;         /**< Last frame, for the advertising telemetry */
+static int8_t   s_tlmMsgRssi;
+static int8_t   s_tlmNoiseRssi;
+static uint8_t  s_tlmLqi;
+static uint16_t s_tlmFrames;            /**< Good frames, wraps */
+
+static uint16_t s_capDumpFreezeCnt;     /**< Last capture dumped to the console */
+static uint16_t s_capDumpOffset;        /**< Next entry to dump, UINT16_MAX = not dumping */
+
+/**@brief Console names of the ISR paths, eMICRF_prof_t order */
+static const char * const s_profPathName[eMICRF_PROF_CNT] = { "idle", "hunt", "bit", "byte", "frame", "squelch" };
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Global Variables
+// *****************************************************************************
+// *****************************************************************************
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Functions
+// *****************************************************************************
+// *****************************************************************************
+static uint8_t APP_MICRF_Rate_Set(uint8_t *p_cmd);
+static uint8_t APP_MICRF_Rate_Get(uint8_t *p_cmd);
+static uint8_t APP_MICRF_Bench_Get(uint8_t *p_cmd);
+static uint8_t APP_MICRF_Bench_Reset(uint8_t *p_cmd);
+static uint8_t APP_MICRF_Reasm_Get(uint8_t *p_cmd);
+static uint8_t APP_MICRF_Reasm_Reset(uint8_t *p_cmd);
+static uint8_t APP_MICRF_Cap_Arm(uint8_t *p_cmd);
+static uint8_t APP_MICRF_Cap_Info(uint8_t *p_cmd);
+static uint8_t APP_MICRF_Cap_Read(uint8_t *p_cmd);
+static uint8_t APP_MICRF_Prof_Get(uint8_t *p_cmd);
+static uint8_t APP_MICRF_Prof_Hist(uint8_t *p_cmd);
+static uint8_t APP_MICRF_Prof_Reset(uint8_t *p_cmd);
+static uint8_t APP_MICRF_Stats_Get(uint8_t *p_cmd);
+static uint8_t APP_MICRF_Stats_Reset(uint8_t *p_cmd);
+static uint8_t APP_MICRF_RssiCal_Set(uint8_t *p_cmd);
+static uint8_t APP_MICRF_RssiCal_Clear(uint8_t *p_cmd);
+
+APP_TRPS_CmdResp_T appTrpsMicrfCmdResp[] = 
+{
+    MICRF_DEFINE_CTRL_CMD_RESP()
+};
+
+APP_TRPS_NotifyData_T appTrpsMicrfNotify[] = 
+{
+    MICRF_DEFINE_CTRL_NOTIFY()
+};
+
+/* Select the receiver rate profile through Mobile app */
+static uint8_t APP_MICRF_Rate_Set(uint8_t *p_cmd)
+{
+    if (!RX_setRateProfile((eMICRF_rate_t)p_cmd[3]))
+    {
+        return INVALID_PARAMETER;
+    }
+    SYS_CONSOLE_PRINT("[MICRF] Rate %d bps\n\r", MICRF_getBitRate(RX_getRateProfile()));
+    return SUCCESS;
+}
+
+/* Read the receiver rate profile through Mobile app */
+static uint8_t APP_MICRF_Rate_Get(uint8_t *p_cmd)
+{
+    eMICRF_rate_t eRate = RX_getRateProfile();
+    uint16_t bitRate = MICRF_getBitRate(eRate);
+
+    s_rateRsp.profile = (uint8_t)eRate;
+    s_rateRsp.bitRateMsb = (uint8_t)(bitRate >> 8);
+    s_rateRsp.bitRateLsb = (uint8_t)bitRate;
+    return SUCCESS;
+}
+
+/* Read the benchmark results of the profile in p_cmd[3] through Mobile app */
+static uint8_t APP_MICRF_Bench_Get(uint8_t *p_cmd)
+{
+    APP_MICRF_BenchStat_T *p_stat;
+    uint16_t per = 0, goodput = 0;
+    uint32_t elapsedMs;
+
+    memset(&s_benchRsp, 0, sizeof(s_benchRsp));
+    if (p_cmd[3] >= eMICRF_RATE_CNT)
+    {
+        return INVALID_PARAMETER;
+    }
+    p_stat = &s_benchStat[p_cmd[3]];
+
+    if ((p_stat->total != 0) && (p_stat->rxCnt <= p_stat->total))
+    {
+        per = (uint16_t)(((uint32_t)(p_stat->total - p_stat->rxCnt) * 1000) / p_stat->total);
+    }
+    // Throughput is measured from the 1st to the last frame, so the 1st frame's payload is not counted.
+    elapsedMs = (p_stat->lastTick - p_stat->firstTick) * portTICK_PERIOD_MS;
+    if ((p_stat->rxCnt > 1) && (elapsedMs != 0))
+    {
+        goodput = (uint16_t)(((uint32_t)(p_stat->rxCnt - 1) * APP_MICRF_BENCH_FRAME_LEN * 8 * 1000) / elapsedMs);
+    }
+
+    s_benchRsp.profile = p_cmd[3];
+    s_benchRsp.rxCntMsb = (uint8_t)(p_stat->rxCnt >> 8);
+    s_benchRsp.rxCntLsb = (uint8_t)p_stat->rxCnt;
+    s_benchRsp.totalMsb = (uint8_t)(p_stat->total >> 8);
+    s_benchRsp.totalLsb = (uint8_t)p_stat->total;
+    s_benchRsp.perMsb = (uint8_t)(per >> 8);
+    s_benchRsp.perLsb = (uint8_t)per;
+    s_benchRsp.goodputMsb = (uint8_t)(goodput >> 8);
+    s_benchRsp.goodputLsb = (uint8_t)goodput;
+    return SUCCESS;
+}
+
+/* Clear the benchmark results of all profiles through Mobile app */
+static uint8_t APP_MICRF_Bench_Reset(uint8_t *p_cmd)
+{
+    memset(s_benchStat, 0, sizeof(s_benchStat));
+    return SUCCESS;
+}
+
+/* Read the reassembly statistics through Mobile app */
+static uint8_t APP_MICRF_Reasm_Get(uint8_t *p_cmd)
+{
+    rxReasmStats_t stats;
+    uint16_t completion = 0, latencyAve = 0;
+
+    RX_getReassemblyStats(&stats);
+    if (stats.started != 0)
+    {
+        completion = (uint16_t)(((uint64_t)stats.completed * 1000) / stats.started);
+    }
+    if (stats.completed != 0)
+    {
+        latencyAve = (uint16_t)(stats.latencySumMs / stats.completed);
+    }
+
+    s_reasmRsp.startedMsb = (uint8_t)(stats.started >> 8);
+    s_reasmRsp.startedLsb = (uint8_t)stats.started;
+    s_reasmRsp.completedMsb = (uint8_t)(stats.completed >> 8);
+    s_reasmRsp.completedLsb = (uint8_t)stats.completed;
+    s_reasmRsp.timedOutMsb = (uint8_t)(stats.timedOut >> 8);
+    s_reasmRsp.timedOutLsb = (uint8_t)stats.timedOut;
+    s_reasmRsp.completionMsb = (uint8_t)(completion >> 8);
+    s_reasmRsp.completionLsb = (uint8_t)completion;
+    s_reasmRsp.latencyAveMsb = (uint8_t)(latencyAve >> 8);
+    s_reasmRsp.latencyAveLsb = (uint8_t)latencyAve;
+    s_reasmRsp.latencyMaxMsb = (uint8_t)(stats.latencyMaxMs >> 8);
+    s_reasmRsp.latencyMaxLsb = (uint8_t)stats.latencyMaxMs;
+    return SUCCESS;
+}
+
+/* Clear the reassembly statistics through Mobile app */
+static uint8_t APP_MICRF_Reasm_Reset(uint8_t *p_cmd)
+{
+    RX_clearReassemblyStats();
+    return SUCCESS;
+}
+
+/* Arm the raw sample capture through Mobile app: [3] = triggers (0 = stop), [4..5] = entries after the trigger */
+static uint8_t APP_MICRF_Cap_Arm(uint8_t *p_cmd)
+{
+    MICRF_captureArm(p_cmd[3], ((uint16_t)p_cmd[4] << 8) | p_cmd[5]);
+    s_capDumpOffset = UINT16_MAX;
+    return SUCCESS;
+}
+
+/* Read the capture state through Mobile app */
+static uint8_t APP_MICRF_Cap_Info(uint8_t *p_cmd)
+{
+    MICRF_captureInfo_t info;
+
+    MICRF_captureGetInfo(&info);
+    s_capInfoRsp.state = (uint8_t)info.eState;
+    s_capInfoRsp.trigger = info.trigger;
+    s_capInfoRsp.profile = info.eRate;
+    s_capInfoRsp.autoBaud = info.bAutoBaud ? 1 : 0;
+    s_capInfoRsp.lenMsb = (uint8_t)(info.len >> 8);
+    s_capInfoRsp.lenLsb = (uint8_t)info.len;
+    s_capInfoRsp.trigIdxMsb = (uint8_t)(info.trigIdx >> 8);
+    s_capInfoRsp.trigIdxLsb = (uint8_t)info.trigIdx;
+    s_capInfoRsp.freezeCnt = (uint8_t)info.freezeCnt;
+    return SUCCESS;
+}
+
+/* Read a block of a frozen capture through Mobile app: [3..4] = offset of the 1st entry */
+static uint8_t APP_MICRF_Cap_Read(uint8_t *p_cmd)
+{
+    uint16_t offset = ((uint16_t)p_cmd[3] << 8) | p_cmd[4];
+
+    memset(&s_capReadRsp, 0, sizeof(s_capReadRsp));
+    s_capReadRsp.offsetMsb = p_cmd[3];
+    s_capReadRsp.offsetLsb = p_cmd[4];
+    s_capReadRsp.cnt = (uint8_t)MICRF_captureRead(offset, s_capReadRsp.data, APP_MICRF_CAP_READ_MAX);
+    return SUCCESS;
+}
+
+/* Store a 32 bit value MSB first */
+static void APP_MICRF_PutU32(uint8_t *p_dst, uint32_t val)
+{
+    p_dst[0] = (uint8_t)(val >> 24);
+    p_dst[1] = (uint8_t)(val >> 16);
+    p_dst[2] = (uint8_t)(val >> 8);
+    p_dst[3] = (uint8_t)val;
+}
+
+/* Read the ISR execution time of the path in p_cmd[3] through Mobile app.  Prints all paths to the console too. */
+static uint8_t APP_MICRF_Prof_Get(uint8_t *p_cmd)
+{
+    profStat_t stat;
+    uint32_t min, ave;
+
+    if (p_cmd[3] >= eMICRF_PROF_CNT)
+    {
+        return INVALID_PARAMETER;
+    }
+    if (!MICRF_getProfile((eMICRF_prof_t)p_cmd[3], &stat))
+    {
+        return OPERATION_FAILED;    // Profiling not built in, DVR_PROF_ON
+    }
+    min = (stat.min > UINT16_MAX) ? UINT16_MAX : stat.min;
+    ave = DVR_PROF_average(&stat);
+    ave = (ave > UINT16_MAX) ? UINT16_MAX : ave;
+
+    s_profRsp.path = p_cmd[3];
+    APP_MICRF_PutU32(s_profRsp.cnt, stat.cnt);
+    s_profRsp.minMsb = (uint8_t)(min >> 8);
+    s_profRsp.minLsb = (uint8_t)min;
+    s_profRsp.aveMsb = (uint8_t)(ave >> 8);
+    s_profRsp.aveLsb = (uint8_t)ave;
+    APP_MICRF_PutU32(s_profRsp.max, stat.max);
+    APP_MICRF_ProfilePrint();
+    return SUCCESS;
+}
+
+/* Read a block of the ISR histogram through Mobile app: [3] = path, [4] = 1st bin */
+static uint8_t APP_MICRF_Prof_Hist(uint8_t *p_cmd)
+{
+    profStat_t stat;
+    uint8_t i;
+
+    if (p_cmd[3] >= eMICRF_PROF_CNT)
+    {
+        return INVALID_PARAMETER;
+    }
+    if (!MICRF_getProfile((eMICRF_prof_t)p_cmd[3], &stat))
+    {
+        return OPERATION_FAILED;
+    }
+    memset(&s_profHistRsp, 0, sizeof(s_profHistRsp));
+    s_profHistRsp.path = p_cmd[3];
+    s_profHistRsp.first = p_cmd[4];
+    for (i = 0; (i < APP_MICRF_PROF_HIST_MAX) && ((p_cmd[4] + i) < DVR_PROF_HIST_BINS); i++)
+    {
+        APP_MICRF_PutU32(s_profHistRsp.bins[i], stat.hist[p_cmd[4] + i]);
+    }
+    return SUCCESS;
+}
+
+/* Clear the ISR execution times through Mobile app */
+static uint8_t APP_MICRF_Prof_Reset(uint8_t *p_cmd)
+{
+    MICRF_clearProfile();
+    return SUCCESS;
+}
+
+#if RX_ENG_DATA_ON == 1
+/* Store n 32 bit counters MSB first */
+static void APP_MICRF_PutHist(uint8_t (*p_dst)[4], const uint32_t *p_hist, uint8_t n)
+{
+    uint8_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        APP_MICRF_PutU32(p_dst[i], p_hist[i]);
+    }
+}
+
+/* Take a snapshot of the receiver statistics in s_statsBlock and print the summary to the console */
+static void APP_MICRF_StatsSnapshot(void)
+{
+    engData_t engData;
+    uint32_t gapMin = 0, gapAve = 0, latencyAve = 0;
+
+    RX_getEngData(&engData);
+    if (engData.goodFrames > 1)
+    {
+        gapMin = engData.gapMinMs;
+        gapAve = engData.gapSumMs / (engData.goodFrames - 1);
+    }
+    if (engData.goodFrames != 0)
+    {
+        latencyAve = engData.latencySumMs / engData.goodFrames;
+    }
+
+    memset(&s_statsBlock, 0, sizeof(s_statsBlock));
+    s_statsBlock.version = APP_MICRF_STATS_VERSION;
+    s_statsBlock.rssiBins = RX_ENG_RSSI_BINS;
+    s_statsBlock.rssiMinDbm = RX_ENG_RSSI_MIN_DBM;
+    s_statsBlock.rssiStepDb = RX_ENG_RSSI_STEP_DB;
+    s_statsBlock.lenBins = RX_ENG_LEN_BINS;
+    s_statsBlock.gapBins = RX_ENG_GAP_BINS;
+    APP_MICRF_PutU32(s_statsBlock.validPackets, engData.validPackets);
+    APP_MICRF_PutU32(s_statsBlock.crcFailures, engData.crcFailures);
+    APP_MICRF_PutU32(s_statsBlock.protocolFailures, engData.protocolFailures);
+    APP_MICRF_PutU32(s_statsBlock.cntFailures, engData.cntFailure);
+    APP_MICRF_PutU32(s_statsBlock.bufferOverflows, engData.bufferOverflow);
+    APP_MICRF_PutU32(s_statsBlock.duplicates, engData.duplicates);
+    APP_MICRF_PutU32(s_statsBlock.serialRejected, engData.serialRejected);
+    APP_MICRF_PutU32(s_statsBlock.syncs, engData.syncs);
+    APP_MICRF_PutU32(s_statsBlock.shortFrames, engData.shortFrames);
+    APP_MICRF_PutU32(s_statsBlock.frames, engData.frames);
+    APP_MICRF_PutU32(s_statsBlock.goodFrames, engData.goodFrames);
+    APP_MICRF_PutU32(s_statsBlock.gapMinMs, gapMin);
+    APP_MICRF_PutU32(s_statsBlock.gapAveMs, gapAve);
+    APP_MICRF_PutU32(s_statsBlock.gapMaxMs, engData.gapMaxMs);
+    APP_MICRF_PutU32(s_statsBlock.latencyAveMs, latencyAve);
+    APP_MICRF_PutU32(s_statsBlock.latencyMaxMs, engData.latencyMaxMs);
+    APP_MICRF_PutHist(s_statsBlock.rssiHist, engData.rssiHist, RX_ENG_RSSI_BINS);
+    APP_MICRF_PutHist(s_statsBlock.noiseHist, engData.noiseHist, RX_ENG_RSSI_BINS);
+    APP_MICRF_PutHist(s_statsBlock.lenHist, engData.lenHist, RX_ENG_LEN_BINS);
+    APP_MICRF_PutHist(s_statsBlock.gapHist, engData.gapHist, RX_ENG_GAP_BINS);
+
+    SYS_CONSOLE_PRINT("[MICRF] Valid Pkt:%ld,Sync:%ld,Short:%ld,CRC Fail:%ld,Protocol Fail:%ld,Cnt Fail:%ld,Buf:%ld,Dup:%ld,Rejected:%ld\n\r",
+                      engData.validPackets, engData.syncs, engData.shortFrames, engData.crcFailures,
+                      engData.protocolFailures, engData.cntFailure, engData.bufferOverflow, engData.duplicates,
+                      engData.serialRejected);
+    SYS_CONSOLE_PRINT("[MICRF] Gap %ld/%ld/%ld mS, Latency %ld/%ld mS\n\r", gapMin, gapAve, engData.gapMaxMs,
+                      latencyAve, engData.latencyMaxMs);
+}
+#endif
+
+/* Send the receiver statistics block through Mobile app: [3] = period in seconds, 0 = once.  The block is sent in
+ * MICRF_STATS_NFY pages by APP_MICRF_StatsNotify(). */
+static uint8_t APP_MICRF_Stats_Get(uint8_t *p_cmd)
+{
+#if RX_ENG_DATA_ON == 1
+    APP_MICRF_StatsSnapshot();
+    s_statsPages = (uint8_t)APP_MICRF_STATS_PAGES;
+    s_statsPage = 0;
+    s_statsPeriodTicks = ((uint32_t)p_cmd[3] * 1000) / portTICK_PERIOD_MS;
+    s_statsNextTick = xTaskGetTickCount() + s_statsPeriodTicks;
+    return SUCCESS;
+#else
+    return OPERATION_FAILED;
+#endif
+}
+
+/* Clear the receiver statistics through Mobile app */
+static uint8_t APP_MICRF_Stats_Reset(uint8_t *p_cmd)
+{
+#if RX_ENG_DATA_ON == 1
+    RX_clearEngData();
+#endif
+    return SUCCESS;
+}
+
+#if MICRF_ENABLE_RSSI == 1
+PDS_DECLARE_FILE(APP_MICRF_PDS_RSSI_CAL_ID, sizeof(MICRF_rssiCal_t), &s_rssiCal, FILE_INTEGRITY_CONTROL_MARK);
+#endif
+
+/* Measure one point of the RSSI calibration through Mobile app: [3] = point 0/1, [4] = RF level in dBm (signed),
+ * [5] = APP_MICRF_RSSI_CAL_SRC_xxx.  Once both points are measured, the calibration is applied and stored. */
+static uint8_t APP_MICRF_RssiCal_Set(uint8_t *p_cmd)
+{
+#if MICRF_ENABLE_RSSI == 1
+    uint8_t point = p_cmd[3];
+    uint16_t code;
+
+    if ((point > 1) || (p_cmd[5] > APP_MICRF_RSSI_CAL_SRC_NOISE))
+    {
+        return INVALID_PARAMETER;
+    }
+    code = (p_cmd[5] == APP_MICRF_RSSI_CAL_SRC_NOISE) ? MICRF_getRssiRawNoiseFloor() : MICRF_getRssiRawLastReceived();
+    s_rssiCalMeas.code[point] = code;
+    s_rssiCalMeas.dBm[point] = (int8_t)p_cmd[4];
+    s_rssiCalPoints |= (uint8_t)(1 << point);
+    s_rssiCalRsp.codeMsb = (uint8_t)(code >> 8);
+    s_rssiCalRsp.codeLsb = (uint8_t)code;
+    SYS_CONSOLE_PRINT("[MICRF] RSSI cal point %d: %d dBm = ADC %d\n\r", point, (int8_t)p_cmd[4], code);
+    if ((s_rssiCalPoints & 0x03) == 0x03)
+    {
+        if (!MICRF_setRssiCal(&s_rssiCalMeas))
+        {   // The calibration in use (if any) is kept
+            s_rssiCalPoints &= APP_MICRF_RSSI_CAL_APPLIED;
+            s_rssiCalRsp.points = s_rssiCalPoints;
+            return OPERATION_FAILED;
+        }
+        s_rssiCal = s_rssiCalMeas;
+        (void)PDS_Store(APP_MICRF_PDS_RSSI_CAL_ID);     // Written by the idle task
+        s_rssiCalPoints = APP_MICRF_RSSI_CAL_APPLIED;
+        SYS_CONSOLE_MESSAGE("[MICRF] RSSI calibration applied\n\r");
+    }
+    s_rssiCalRsp.points = s_rssiCalPoints;
+    return SUCCESS;
+#else
+    return OPERATION_FAILED;
+#endif
+}
+
+/* Go back to the datasheet RSSI curve through Mobile app, the stored calibration is erased */
+static uint8_t APP_MICRF_RssiCal_Clear(uint8_t *p_cmd)
+{
+#if MICRF_ENABLE_RSSI == 1
+    (void)MICRF_setRssiCal(NULL);
+    (void)PDS_Delete(APP_MICRF_PDS_RSSI_CAL_ID);
+#endif
+    s_rssiCalPoints = 0;
+    return SUCCESS;
+}
+
+/* Send the next page of the statistics block, called from the application task.  A new block is taken every
+ * s_statsPeriodTicks while connected. */
+void APP_MICRF_StatsNotify(void)
+{
+#if RX_ENG_DATA_ON == 1
+    uint16_t offset, len;
+
+    if (APP_GetBleState() != APP_BLE_STATE_CONNECTED)
+    {
+        s_statsPage = APP_MICRF_STATS_PAGE_IDLE;
+        s_statsPeriodTicks = 0;     // Periodic statistics stop on a disconnection
+        return;
+    }
+    if (APP_TRPS_IsNotificationPending(APP_TRP_VENDOR_OPCODE_MICRF, MICRF_STATS_NFY))
+    {
+        return;                     // s_statsNfy is read when the queued page is sent
+    }
+    if (s_statsPage == APP_MICRF_STATS_PAGE_IDLE)
+    {
+        if ((s_statsPeriodTicks == 0) || ((int32_t)(xTaskGetTickCount() - s_statsNextTick) < 0))
+        {
+            return;
+        }
+        APP_MICRF_StatsSnapshot();
+        s_statsPage = 0;
+        s_statsNextTick += s_statsPeriodTicks;
+    }
+    offset = (uint16_t)s_statsPage * APP_MICRF_STATS_PAGE_LEN;
+    len = sizeof(s_statsBlock) - offset;
+    if (len > APP_MICRF_STATS_PAGE_LEN)
+    {
+        len = APP_MICRF_STATS_PAGE_LEN;
+    }
+    memset(&s_statsNfy, 0, sizeof(s_statsNfy));
+    s_statsNfy.page = s_statsPage;
+    s_statsNfy.pages = (uint8_t)APP_MICRF_STATS_PAGES;
+    memcpy(s_statsNfy.data, (uint8_t *)&s_statsBlock + offset, len);
+    if (APP_TRPS_SendNotification(APP_TRP_VENDOR_OPCODE_MICRF, MICRF_STATS_NFY) == APP_RES_SUCCESS)
+    {   // Otherwise the control channel is closed, the page is sent again on the next call
+        s_statsPage++;
+        if (s_statsPage >= APP_MICRF_STATS_PAGES)
+        {
+            s_statsPage = APP_MICRF_STATS_PAGE_IDLE;
+        }
+    }
+#endif
+}
+
+/* Queue a received frame for the central, called from the application task.  Frames are only kept while the data
+ * channel is open, a full backlog drops the new frame. */
+void APP_MICRF_GatewayFrame(const rxDataPacket_t *p_packet)
+{
+#if APP_MICRF_GW_ON == 1
+    APP_MICRF_GwEntry_T *p_entry;
+    uint8_t cnt;
+
+    if (!s_gwOpen)
+    {
+        return;
+    }
+    if ((uint16_t)(s_gwHead - s_gwTail) >= APP_MICRF_GW_BACKLOG)
+    {
+        s_gwDropped++;
+        return;
+    }
+    if (s_gwHead == s_gwTail)
+    {
+        s_gwOldestTick = xTaskGetTickCount();
+    }
+    cnt = (p_packet->cnt < sizeof(p_entry->rec.data)) ? p_packet->cnt : (uint8_t)sizeof(p_entry->rec.data);
+    p_entry = &s_gwBacklog[s_gwHead % APP_MICRF_GW_BACKLOG];
+    p_entry->rec.serialNumMsb = (uint8_t)(p_packet->serialNum >> 8);
+    p_entry->rec.serialNumLsb = (uint8_t)p_packet->serialNum;
+    p_entry->rec.seq = p_packet->seq;
+    p_entry->rec.msgRssi = p_packet->msgRssi;
+    p_entry->rec.noiseRssi = p_packet->noiseRssi;
+    p_entry->rec.lqi = p_packet->lqi;
+    APP_MICRF_PutU32(p_entry->rec.rxMs, p_packet->rxMs);
+    p_entry->rec.cnt = cnt;
+    memcpy(p_entry->rec.data, p_packet->data, cnt);
+    p_entry->len = APP_MICRF_GW_REC_HDR_LEN + cnt;
+    s_gwHead++;
+#else
+    (void)p_packet;
+#endif
+}
+
+/* Send the backlog to the central, as many frames per notification as the MTU allows, called from the application
+ * task.  A partly filled notification waits APP_MICRF_GW_HOLD_MS for more frames.  When the stack is busy, the
+ * frames stay in the backlog and are sent on a later call. */
+void APP_MICRF_GatewayFlush(void)
+{
+#if APP_MICRF_GW_ON == 1
+    const APP_MICRF_GwEntry_T *p_entry;
+    APP_BLE_ConnList_T *p_bleConn = NULL;
+    uint8_t  ntf[APP_MICRF_GW_NTF_MAX];
+    uint16_t maxLen, len, tail;
+    uint16_t result;
+
+    if (s_gwOpen)
+    {
+        p_bleConn = APP_GetConnInfoByConnHandle(s_gwConnHandle);
+        if ((p_bleConn == NULL) || (p_bleConn->linkState != APP_BLE_STATE_CONNECTED))
+        {
+            s_gwOpen = false;       // Disconnected, the next central opens the data channel again
+        }
+    }
+    if (!s_gwOpen)
+    {
+        s_gwTail = s_gwHead;
+        s_gwDropped = 0;
+        return;
+    }
+    maxLen = p_bleConn->mgr.attMtu - ATT_HANDLE_VALUE_HEADER_SIZE;
+    if (maxLen > sizeof(ntf))
+    {
+        maxLen = sizeof(ntf);
+    }
+    while (s_gwHead != s_gwTail)
+    {
+        len = APP_MICRF_GW_BATCH_HDR_LEN;
+        tail = s_gwTail;
+        while (tail != s_gwHead)
+        {
+            p_entry = &s_gwBacklog[tail % APP_MICRF_GW_BACKLOG];
+            if ((len + p_entry->len) > maxLen)
+            {
+                break;
+            }
+            memcpy(&ntf[len], &p_entry->rec, p_entry->len);
+            len += p_entry->len;
+            tail++;
+        }
+        if (tail == s_gwTail)
+        {   // Longer than the MTU allows, the default MTU only fits frames of up to 7 data bytes
+            s_gwTail++;
+            s_gwDropped++;
+            continue;
+        }
+        if ((tail == s_gwHead) && ((len + APP_MICRF_GW_REC_HDR_LEN) <= maxLen) &&
+            ((xTaskGetTickCount() - s_gwOldestTick) < (APP_MICRF_GW_HOLD_MS / portTICK_PERIOD_MS)))
+        {
+            return;                 // Room for more, wait for the next frame
+        }
+        ntf[0] = s_gwBatchSeq;
+        ntf[1] = (s_gwDropped > UINT8_MAX) ? UINT8_MAX : (uint8_t)s_gwDropped;
+        result = BLE_TRSPS_SendData(s_gwConnHandle, len, ntf);
+        if ((result == APP_RES_OOM) || (result == APP_RES_NO_RESOURCE) || (result == APP_RES_BUSY))
+        {
+            return;                 // Back-pressure, the batch is built again on the next call
+        }
+        if (result != APP_RES_SUCCESS)
+        {
+            s_gwOpen = false;       // Data channel closed
+            SYS_CONSOLE_PRINT("[MICRF] Gateway off, link %d notification error 0x%x\n\r", s_gwConnHandle, result);
+            return;
+        }
+        APP_BLE_ConnMgrTx(s_gwConnHandle, len);
+        s_gwBatchSeq++;
+        s_gwDropped = 0;
+        s_gwTail = tail;
+        s_gwOldestTick = xTaskGetTickCount();
+    }
+#endif
+}
+
+/* Data channel notifications turned on or off by a central, BLE_TRSPS_EVT_TX_STATUS.  The last central that turns
+ * them on gets the frames. */
+void APP_MICRF_GatewayTxStatus(uint16_t connHandle, uint8_t status)
+{
+#if APP_MICRF_GW_ON == 1
+    APP_BLE_ConnList_T *p_bleConn;
+
+    if (status == BLE_TRSPS_STATUS_TX_OPENED)
+    {
+        p_bleConn = APP_GetConnInfoByConnHandle(connHandle);
+        s_gwConnHandle = connHandle;
+        s_gwOpen = ((p_bleConn != NULL) && (p_bleConn->linkState == APP_BLE_STATE_CONNECTED));
+        if (s_gwOpen)
+        {
+            SYS_CONSOLE_PRINT("[MICRF] Gateway on, link %d MTU %d\n\r", connHandle, p_bleConn->mgr.attMtu);
+        }
+    }
+    else if (connHandle == s_gwConnHandle)
+    {
+        s_gwOpen = false;
+    }
+#else
+    (void)connHandle;
+    (void)status;
+#endif
+}
+
+/* Link disconnected, BLE_GAP_EVT_DISCONNECTED */
+void APP_MICRF_GatewayDisconnect(uint16_t connHandle)
+{
+#if APP_MICRF_GW_ON == 1
+    if (s_gwOpen && (connHandle == s_gwConnHandle))
+    {
+        s_gwOpen = false;           // The next central opens the data channel again
+        SYS_CONSOLE_PRINT("[MICRF] Gateway off, link %d disconnected\n\r", connHandle);
+    }
+#else
+    (void)connHandle;
+#endif
+}
+
+/* Print the ISR execution time of each path to the console, CPU cycles:
+ *   [PROF] <path> cnt=<n> min=<c> ave=<c> max=<c> hist=<bin>:<count> ...
+ * Bin n holds 2^(n-1) to 2^n - 1 cycles, empty bins are left out. */
+void APP_MICRF_ProfilePrint(void)
+{
+    profStat_t stat;
+    uint8_t path, bin;
+
+    for (path = 0; path < eMICRF_PROF_CNT; path++)
+    {
+        if (!MICRF_getProfile((eMICRF_prof_t)path, &stat))
+        {
+            return;
+        }
+        SYS_CONSOLE_PRINT("[PROF] %s cnt=%lu min=%lu ave=%lu max=%lu hist=", s_profPathName[path],
+                          (unsigned long)stat.cnt, (unsigned long)stat.min,
+                          (unsigned long)DVR_PROF_average(&stat), (unsigned long)stat.max);
+        for (bin = 0; bin < DVR_PROF_HIST_BINS; bin++)
+        {
+            if (stat.hist[bin] != 0)
+            {
+                SYS_CONSOLE_PRINT(" %d:%lu", bin, (unsigned long)stat.hist[bin]);
+            }
+        }
+        SYS_CONSOLE_PRINT("\n\r");
+    }
+}
+
+/* Dump a newly frozen capture to the console, one line per call so the console buffer keeps up.  The format is read
+ * by the host replay (host_sim/micrf_replay):
+ *   MICRF-CAP 1 profile=<p> autobaud=<0|1> trigger=<t> len=<entries> trig=<entry>
+ *   <entries in hex, oldest first>
+ *   MICRF-CAP END */
+void APP_MICRF_CaptureDump(void)
+{
+    MICRF_captureInfo_t info;
+    uint8_t entries[APP_MICRF_CAP_LINE_LEN];
+    uint16_t cnt, i;
+
+    MICRF_captureGetInfo(&info);
+    if ((info.eState != eMICRF_CAP_FROZEN) || ((s_capDumpOffset == UINT16_MAX) && (info.freezeCnt == s_capDumpFreezeCnt)))
+    {
+        return;
+    }
+    if (s_capDumpOffset == UINT16_MAX)
+    {
+        s_capDumpFreezeCnt = info.freezeCnt;
+        s_capDumpOffset = 0;
+        SYS_CONSOLE_PRINT("\n\rMICRF-CAP 1 profile=%d autobaud=%d trigger=%d len=%d trig=%d\n\r",
+                          info.eRate, info.bAutoBaud ? 1 : 0, info.trigger, info.len, info.trigIdx);
+        return;
+    }
+    cnt = MICRF_captureRead(s_capDumpOffset, entries, sizeof(entries));
+    if (cnt == 0)
+    {
+        SYS_CONSOLE_PRINT("MICRF-CAP END\n\r");
+        s_capDumpOffset = UINT16_MAX;   // Stays frozen for MICRF_CAP_READ_CMD until armed again
+        return;
+    }
+    for (i = 0; i < cnt; i++)
+    {
+        SYS_CONSOLE_PRINT("%02x", entries[i]);
+    }
+    SYS_CONSOLE_PRINT("\n\r");
+    s_capDumpOffset += cnt;
+}
+
+/* Count a benchmark frame.  Returns false if the packet is not a benchmark frame. */
+bool APP_MICRF_BenchFrame(const rxDataPacket_t *p_packet)
+{
+    APP_MICRF_BenchStat_T *p_stat;
+    uint16_t seq, total;
+
+    if ((p_packet->cnt != APP_MICRF_BENCH_FRAME_LEN) || (p_packet->data[0] != APP_MICRF_BENCH_MAGIC) ||
+        (p_packet->data[1] >= eMICRF_RATE_CNT))
+    {
+        return false;
+    }
+    p_stat = &s_benchStat[p_packet->data[1]];
+    seq = ((uint16_t)p_packet->data[2] << 8) | p_packet->data[3];
+    total = ((uint16_t)p_packet->data[4] << 8) | p_packet->data[5];
+
+    if ((p_stat->rxCnt == 0) || (seq < p_stat->lastSeq) || (total != p_stat->total))
+    {   // 1st frame of a new run, restart the results for this profile
+        memset(p_stat, 0, sizeof(APP_MICRF_BenchStat_T));
+        p_stat->total = total;
+        p_stat->firstTick = xTaskGetTickCount();
+    }
+    else if (seq == p_stat->lastSeq)
+    {   // Repeated frame, already counted
+        return true;
+    }
+    p_stat->rxCnt++;
+    p_stat->lastSeq = seq;
+    p_stat->lastTick = xTaskGetTickCount();
+
+    if (seq == (total - 1))
+    {
+        SYS_CONSOLE_PRINT("[MICRF] Bench %d bps: %d/%d\n\r", MICRF_getBitRate((eMICRF_rate_t)p_packet->data[1]),
+                          p_stat->rxCnt, p_stat->total);
+        APP_MICRF_ProfilePrint();
+    }
+    return true;
+}
+
+/* Init MICRF Specific */
+/* Keep the last frame for the advertising telemetry, called for every received frame */
+void APP_MICRF_AdvFrame(const rxDataPacket_t *p_packet)
+{
+    s_tlmSerialNum = p_packet->serialNum;
+    s_tlmMsgRssi = p_packet->msgRssi;
+    s_tlmNoiseRssi = p_packet->noiseRssi;
+    s_tlmLqi = p_packet->lqi;
+    s_tlmFrames++;
+}
+
+/* Fill the APP_MICRF_ADV_TLM_LEN bytes of link telemetry of the advertising payload */
+void APP_MICRF_AdvTelemetry(uint8_t *p_data)
+{
+    uint16_t errors = 0;
+    uint8_t idx = 0;
+#if RX_ENG_DATA_ON == 1
+    engData_t engData;
+
+    RX_getEngData(&engData);
+    errors = (uint16_t)(engData.crcFailures + engData.protocolFailures + engData.cntFailure);
+#endif
+
+    p_data[idx++] = APP_MICRF_TLM_SERIAL;
+    p_data[idx++] = (uint8_t)(s_tlmSerialNum >> 8);
+    p_data[idx++] = (uint8_t)s_tlmSerialNum;
+    p_data[idx++] = APP_MICRF_TLM_RSSI;
+    p_data[idx++] = (uint8_t)s_tlmMsgRssi;
+    p_data[idx++] = (uint8_t)s_tlmNoiseRssi;
+    p_data[idx++] = APP_MICRF_TLM_LQI;
+    p_data[idx++] = s_tlmLqi;
+    p_data[idx++] = APP_MICRF_TLM_FRAMES;
+    p_data[idx++] = (uint8_t)(s_tlmFrames >> 8);
+    p_data[idx++] = (uint8_t)s_tlmFrames;
+    p_data[idx++] = APP_MICRF_TLM_ERRORS;
+    p_data[idx++] = (uint8_t)(errors >> 8);
+    p_data[idx++] = (uint8_t)errors;
+}
+
+void APP_MICRF_Init(void)
+{
+    memset(s_benchStat, 0, sizeof(s_benchStat));
+    s_capDumpOffset = UINT16_MAX;
+    s_statsPage = APP_MICRF_STATS_PAGE_IDLE;
+    s_statsPeriodTicks = 0;
+    s_rssiCalPoints = 0;
+#if APP_MICRF_GW_ON == 1
+    s_gwHead = 0;
+    s_gwTail = 0;
+    s_gwDropped = 0;
+    s_gwOpen = false;
+#endif
+    MICRF_captureArm(APP_MICRF_CAP_TRIGGERS, APP_MICRF_CAP_POST_CNT);
+#if MICRF_ENABLE_RSSI == 1
+    /* The driver keeps the calibration when RX_init() initializes it */
+    if (PDS_IsAbleToRestore(APP_MICRF_PDS_RSSI_CAL_ID) && PDS_Restore(APP_MICRF_PDS_RSSI_CAL_ID) &&
+        MICRF_setRssiCal(&s_rssiCal))
+    {
+        s_rssiCalPoints = APP_MICRF_RSSI_CAL_APPLIED;
+        SYS_CONSOLE_PRINT("[MICRF] RSSI calibration: %d dBm = ADC %d, %d dBm = ADC %d\n\r", s_rssiCal.dBm[0],
+                          s_rssiCal.code[0], s_rssiCal.dBm[1], s_rssiCal.code[1]);
+    }
+    MICRF_setSquelch(APP_MICRF_SQUELCH_DB);
+#endif
+
+    /* Init TRPS profile with MICRF specific command structure*/
+    APP_TRPS_Init(APP_TRP_VENDOR_OPCODE_MICRF,appTrpsMicrfCmdResp,appTrpsMicrfNotify,MICRF_CMD_RESP_LST_SIZE,MICRF_NOTIFY_LST_SIZE);
+}
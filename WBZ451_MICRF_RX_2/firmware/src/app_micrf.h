@@ -0,0 +1,370 @@
+/*******************************************************************************
+  Application MICRF Control Header File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_micrf.h
+
+  Summary:
+    This file contains the Application MICRF receiver control functions for this project.
+
+  Description:
+    This file contains the TRPS vendor command set used to select the MICRF
+    rate profile and to read the per profile throughput/PER benchmark results.
+ *******************************************************************************/
+
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2023 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+
+#ifndef APP_MICRF_H
+#define APP_MICRF_H
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include "gatt.h"
+#include "app_trps.h"
+#include "MICRF219A/receiver.h"
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+
+// Define for MICRF Ctrl Commands
+
+#define APP_TRP_VENDOR_OPCODE_MICRF  0x8B
+//  Defines MICRF Control Command Set APP_TRPS_CTRL_CMD
+#define    MICRF_RATE_SET_CMD       0x10
+#define    MICRF_RATE_GET_CMD       0x11
+#define    MICRF_BENCH_GET_CMD      0x12
+#define    MICRF_BENCH_RESET_CMD    0x13
+#define    MICRF_REASM_GET_CMD      0x14
+#define    MICRF_REASM_RESET_CMD    0x15
+#define    MICRF_CAP_ARM_CMD        0x16
+#define    MICRF_CAP_INFO_CMD       0x17
+#define    MICRF_CAP_READ_CMD       0x18
+#define    MICRF_PROF_GET_CMD       0x19
+#define    MICRF_PROF_HIST_CMD      0x1A
+#define    MICRF_PROF_RESET_CMD     0x1B
+#define    MICRF_STATS_GET_CMD      0x1C
+#define    MICRF_STATS_RESET_CMD    0x1D
+#define    MICRF_RSSI_CAL_SET_CMD   0x1E
+#define    MICRF_RSSI_CAL_CLEAR_CMD 0x1F
+
+
+//  Defines MICRF Response Command Set APP_TRPS_CTRL_RSP
+#define    MICRF_RATE_SET_RSP       0x20
+#define    MICRF_RATE_GET_RSP       0x21
+#define    MICRF_BENCH_GET_RSP      0x22
+#define    MICRF_BENCH_RESET_RSP    0x23
+#define    MICRF_REASM_GET_RSP      0x24
+#define    MICRF_REASM_RESET_RSP    0x25
+#define    MICRF_CAP_ARM_RSP        0x26
+#define    MICRF_CAP_INFO_RSP       0x27
+#define    MICRF_CAP_READ_RSP       0x28
+#define    MICRF_PROF_GET_RSP       0x29
+#define    MICRF_PROF_HIST_RSP      0x2A
+#define    MICRF_PROF_RESET_RSP     0x2B
+#define    MICRF_STATS_GET_RSP      0x2C
+#define    MICRF_STATS_RESET_RSP    0x2D
+#define    MICRF_RSSI_CAL_SET_RSP   0x2E
+#define    MICRF_RSSI_CAL_CLEAR_RSP 0x2F
+
+
+//  Defines MICRF Response Command length APP_TRPS_CTRL_RSP_LENGTH
+#define    MICRF_RATE_SET_RSP_LEN   0x0
+#define    MICRF_RATE_GET_RSP_LEN   0x3
+#define    MICRF_BENCH_GET_RSP_LEN  0x9
+#define    MICRF_BENCH_RESET_RSP_LEN 0x0
+#define    MICRF_REASM_GET_RSP_LEN  0xC
+#define    MICRF_REASM_RESET_RSP_LEN 0x0
+#define    MICRF_CAP_ARM_RSP_LEN    0x0
+#define    MICRF_CAP_INFO_RSP_LEN   0x9
+#define    MICRF_CAP_READ_RSP_LEN   0x11
+#define    MICRF_PROF_GET_RSP_LEN   0xD
+#define    MICRF_PROF_HIST_RSP_LEN  0xE
+#define    MICRF_PROF_RESET_RSP_LEN 0x0
+#define    MICRF_STATS_GET_RSP_LEN  0x1
+#define    MICRF_STATS_RESET_RSP_LEN 0x0
+#define    MICRF_RSSI_CAL_SET_RSP_LEN 0x3
+#define    MICRF_RSSI_CAL_CLEAR_RSP_LEN 0x0
+
+//  Defines MICRF Notify Command Set APP_TRPS_CTRL_NOTIFY
+#define    MICRF_STATS_NFY          0x30
+
+//  Defines MICRF Notify Command length APP_TRPS_CTRL_NOTIFY_LENGTH
+#define    MICRF_STATS_NFY_LEN      0x12
+
+//  Raw sample capture: armed at start-up on a rejected message, [Post MSB][Post LSB] entries after the trigger
+#define    APP_MICRF_CAP_TRIGGERS       MICRF_CAP_TRIG_CRC
+#define    APP_MICRF_CAP_POST_CNT       64
+#define    APP_MICRF_CAP_READ_MAX       14      /**< Entries per MICRF_CAP_READ_RSP */
+#define    APP_MICRF_CAP_LINE_LEN       32      /**< Entries per console line of the dump */
+
+//  ISR profiling (DVR_PROF_ON): [Path] for MICRF_PROF_GET_CMD, [Path][1st bin] for MICRF_PROF_HIST_CMD
+#define    APP_MICRF_PROF_HIST_MAX      3       /**< Histogram bins per MICRF_PROF_HIST_RSP */
+
+//  Receiver statistics (RX_ENG_DATA_ON): [Period] in seconds for MICRF_STATS_GET_CMD, 0 = send once
+#define    APP_MICRF_STATS_VERSION      1
+#define    APP_MICRF_STATS_PAGE_LEN     16      /**< Bytes of the statistics block per MICRF_STATS_NFY */
+#define    APP_MICRF_STATS_PAGE_IDLE    0xFF    /**< No statistics block being sent */
+
+//  RSSI calibration: [Point 0/1][Level dBm][Source] for MICRF_RSSI_CAL_SET_CMD.  The RSSI ADC code is taken from the
+//  last message (a transmitter at a known level) or the noise floor (a carrier at a known level).  Once both points
+//  are measured, the calibration is applied and stored in PDS.
+#define    APP_MICRF_RSSI_CAL_SRC_MSG   0
+#define    APP_MICRF_RSSI_CAL_SRC_NOISE 1
+#define    APP_MICRF_RSSI_CAL_APPLIED   0x80    /**< APP_MICRF_RssiCalRsp_T points, calibration in use */
+
+//  RSSI squelch: the sample ISR skips the slicer while the RSSI stays within this many dB of the noise floor, 0 = off
+#define    APP_MICRF_SQUELCH_DB         3
+
+//  Sub-GHz to BLE gateway: every received frame is forwarded on the TRP data channel while the central has its
+//  notifications on.  Frames are packed into one notification up to the MTU:
+//    [Batch seq][Frames dropped since the last batch, saturated] followed by APP_MICRF_GwRecord_T records, each
+//    APP_MICRF_GW_REC_HDR_LEN bytes plus cnt data bytes.
+//  While the stack is busy, frames wait in a backlog of APP_MICRF_GW_BACKLOG frames, new frames are dropped when full.
+#define    APP_MICRF_GW_ON              1
+#define    APP_MICRF_GW_BACKLOG         32      /**< Frames waiting for the BLE link */
+#define    APP_MICRF_GW_HOLD_MS         10      /**< A partly filled notification waits this long for more frames */
+#define    APP_MICRF_GW_BATCH_HDR_LEN   2
+#define    APP_MICRF_GW_REC_HDR_LEN     11      /**< APP_MICRF_GwRecord_T without the data */
+#define    APP_MICRF_GW_NTF_MAX         (BLE_ATT_MAX_MTU_LEN - ATT_HANDLE_VALUE_HEADER_SIZE)
+
+//  Benchmark frame sent by the transmitter: [Magic][Profile][Seq MSB][Seq LSB][Total MSB][Total LSB]
+#define    APP_MICRF_BENCH_MAGIC        0xB5
+#define    APP_MICRF_BENCH_FRAME_LEN    6
+//  Link telemetry appended to the service data of the advertising payload (APP_ADV_TLM_ON), tag and value fields like
+//  the sensor fields before them.  Counters are the 16 lsb, they wrap.
+#define    APP_MICRF_TLM_SERIAL         0x50    /**< [Serial MSB][Serial LSB] of the last frame */
+#define    APP_MICRF_TLM_RSSI           0x51    /**< [Message RSSI][Noise floor] of the last frame, dBm */
+#define    APP_MICRF_TLM_LQI            0x52    /**< [LQI] of the last frame */
+#define    APP_MICRF_TLM_FRAMES         0x53    /**< [Good frames MSB][LSB] */
+#define    APP_MICRF_TLM_ERRORS         0x54    /**< [Rejected frames MSB][LSB], CRC, protocol and count failures */
+#define    APP_MICRF_ADV_TLM_LEN        14
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+
+/**@brief The structure contains the rate profile response. */
+typedef struct __attribute__ ((packed))
+{
+    uint8_t    profile;             /**< Rate profile, eMICRF_rate_t */
+    uint8_t    bitRateMsb;          /**< Nominal bit rate, bits/second */
+    uint8_t    bitRateLsb;
+} APP_MICRF_RateRsp_T;
+
+/**@brief The structure contains the benchmark response of one rate profile. */
+typedef struct __attribute__ ((packed))
+{
+    uint8_t    profile;             /**< Rate profile, eMICRF_rate_t */
+    uint8_t    rxCntMsb;            /**< Number of benchmark frames received */
+    uint8_t    rxCntLsb;
+    uint8_t    totalMsb;            /**< Number of benchmark frames the transmitter sent */
+    uint8_t    totalLsb;
+    uint8_t    perMsb;              /**< Packet error rate, 1/1000 */
+    uint8_t    perLsb;
+    uint8_t    goodputMsb;          /**< Payload throughput, bits/second */
+    uint8_t    goodputLsb;
+} APP_MICRF_BenchRsp_T;
+
+/**@brief The structure contains the reassembly statistics response. */
+typedef struct __attribute__ ((packed))
+{
+    uint8_t    startedMsb;          /**< Messages with at least one fragment received */
+    uint8_t    startedLsb;
+    uint8_t    completedMsb;        /**< Messages with all fragments received */
+    uint8_t    completedLsb;
+    uint8_t    timedOutMsb;         /**< Messages dropped on the reassembly timeout */
+    uint8_t    timedOutLsb;
+    uint8_t    completionMsb;       /**< Completion rate, 1/1000 */
+    uint8_t    completionLsb;
+    uint8_t    latencyAveMsb;       /**< Average reassembly latency, mS */
+    uint8_t    latencyAveLsb;
+    uint8_t    latencyMaxMsb;       /**< Maximum reassembly latency, mS */
+    uint8_t    latencyMaxLsb;
+} APP_MICRF_ReasmRsp_T;
+
+/**@brief The structure contains the capture state response. */
+typedef struct __attribute__ ((packed))
+{
+    uint8_t    state;               /**< eMICRF_capState_t */
+    uint8_t    trigger;             /**< Trigger that fired, MICRF_CAP_TRIG_xxx */
+    uint8_t    profile;             /**< Rate profile when frozen */
+    uint8_t    autoBaud;            /**< Auto-baud mode when frozen */
+    uint8_t    lenMsb;              /**< Entries captured */
+    uint8_t    lenLsb;
+    uint8_t    trigIdxMsb;          /**< Entry being captured when the trigger fired */
+    uint8_t    trigIdxLsb;
+    uint8_t    freezeCnt;           /**< Captures frozen, lsb */
+} APP_MICRF_CapInfoRsp_T;
+
+/**@brief The structure contains a block of capture entries. */
+typedef struct __attribute__ ((packed))
+{
+    uint8_t    offsetMsb;           /**< Offset of the 1st entry, 0 = oldest */
+    uint8_t    offsetLsb;
+    uint8_t    cnt;                 /**< Entries in data, 0 = past the end */
+    uint8_t    data[APP_MICRF_CAP_READ_MAX];
+} APP_MICRF_CapReadRsp_T;
+
+/**@brief The structure contains the execution time of one ISR path, CPU cycles. */
+typedef struct __attribute__ ((packed))
+{
+    uint8_t    path;                /**< ISR path, eMICRF_prof_t */
+    uint8_t    cnt[4];              /**< Times the path ran, MSB first */
+    uint8_t    minMsb;              /**< Fewest cycles, saturated at 0xFFFF */
+    uint8_t    minLsb;
+    uint8_t    aveMsb;              /**< Average cycles, saturated at 0xFFFF */
+    uint8_t    aveLsb;
+    uint8_t    max[4];              /**< Most cycles, MSB first */
+} APP_MICRF_ProfRsp_T;
+
+#if RX_ENG_DATA_ON == 1
+/**@brief The structure contains the receiver statistics block, sent in pages by MICRF_STATS_NFY.  All counters are
+ *        MSB first. */
+typedef struct __attribute__ ((packed))
+{
+    uint8_t    version;             /**< APP_MICRF_STATS_VERSION */
+    uint8_t    rssiBins;            /**< RX_ENG_RSSI_BINS */
+    int8_t     rssiMinDbm;          /**< RX_ENG_RSSI_MIN_DBM, lower edge of RSSI bin 1 */
+    uint8_t    rssiStepDb;          /**< RX_ENG_RSSI_STEP_DB */
+    uint8_t    lenBins;             /**< RX_ENG_LEN_BINS */
+    uint8_t    gapBins;             /**< RX_ENG_GAP_BINS */
+    uint8_t    validPackets[4];     /**< Frames delivered, packets and fragments */
+    uint8_t    crcFailures[4];      /**< Failures, by reason */
+    uint8_t    protocolFailures[4];
+    uint8_t    cntFailures[4];
+    uint8_t    bufferOverflows[4];
+    uint8_t    duplicates[4];
+    uint8_t    serialRejected[4];
+    uint8_t    syncs[4];            /**< Preambles detected */
+    uint8_t    shortFrames[4];      /**< Frames too short to be a packet */
+    uint8_t    frames[4];           /**< Frames passed to the receiver */
+    uint8_t    goodFrames[4];       /**< Frames that passed the CRC, the times and histograms below are of these */
+    uint8_t    gapMinMs[4];         /**< Inter-arrival time, mS */
+    uint8_t    gapAveMs[4];
+    uint8_t    gapMaxMs[4];
+    uint8_t    latencyAveMs[4];     /**< Decode latency, mS */
+    uint8_t    latencyMaxMs[4];
+    uint8_t    rssiHist[RX_ENG_RSSI_BINS][4];   /**< Message RSSI */
+    uint8_t    noiseHist[RX_ENG_RSSI_BINS][4];  /**< Noise floor */
+    uint8_t    lenHist[RX_ENG_LEN_BINS][4];     /**< Data bytes */
+    uint8_t    gapHist[RX_ENG_GAP_BINS][4];     /**< Inter-arrival time */
+} APP_MICRF_StatsBlock_T;
+
+#define    APP_MICRF_STATS_PAGES        ((sizeof(APP_MICRF_StatsBlock_T) + APP_MICRF_STATS_PAGE_LEN - 1) / APP_MICRF_STATS_PAGE_LEN)
+#endif
+
+/**@brief The structure contains one page of the receiver statistics block. */
+typedef struct __attribute__ ((packed))
+{
+    uint8_t    page;                /**< Page number, 0 = start of the block */
+    uint8_t    pages;               /**< Pages in the block */
+    uint8_t    data[APP_MICRF_STATS_PAGE_LEN];  /**< Bytes of the block, the last page is padded with 0 */
+} APP_MICRF_StatsNfy_T;
+
+/**@brief The structure contains the RSSI calibration response. */
+typedef struct __attribute__ ((packed))
+{
+    uint8_t    codeMsb;             /**< RSSI ADC code measured for the point */
+    uint8_t    codeLsb;
+    uint8_t    points;              /**< Bit 0/1 = point 0/1 measured, APP_MICRF_RSSI_CAL_APPLIED = calibration in use */
+} APP_MICRF_RssiCalRsp_T;
+
+/**@brief The structure contains a block of the log2 histogram of one ISR path. */
+typedef struct __attribute__ ((packed))
+{
+    uint8_t    path;                /**< ISR path, eMICRF_prof_t */
+    uint8_t    first;               /**< 1st bin in bins, 0 = past the end */
+    uint8_t    bins[APP_MICRF_PROF_HIST_MAX][4];   /**< Counts, MSB first */
+} APP_MICRF_ProfHistRsp_T;
+
+/**@brief The structure contains one frame forwarded by the gateway, only the first cnt data bytes are sent. */
+typedef struct __attribute__ ((packed))
+{
+    uint8_t    serialNumMsb;        /**< Serial number of the transmitter */
+    uint8_t    serialNumLsb;
+    uint8_t    seq;                 /**< Sequence number, 0 if the transmitter sends none */
+    int8_t     msgRssi;             /**< RSSI of the frame, dBm */
+    int8_t     noiseRssi;           /**< Noise floor, dBm */
+    uint8_t    lqi;                 /**< Link quality indicator, 0 to 100 */
+    uint8_t    rxMs[4];             /**< Time the frame was received, mS since start-up, MSB first */
+    uint8_t    cnt;                 /**< Data bytes */
+    uint8_t    data[sizeof(((rxDataPacket_t *)0)->data)];
+} APP_MICRF_GwRecord_T;
+
+#define MICRF_CMD_RESP_LST_SIZE   16
+#define MICRF_DEFINE_CTRL_CMD_RESP()                \
+        { MICRF_RATE_SET_CMD, MICRF_RATE_SET_RSP, MICRF_RATE_SET_RSP_LEN, NULL , APP_MICRF_Rate_Set},      \
+        { MICRF_RATE_GET_CMD, MICRF_RATE_GET_RSP, MICRF_RATE_GET_RSP_LEN, (uint8_t *)&s_rateRsp , APP_MICRF_Rate_Get},       \
+        { MICRF_BENCH_GET_CMD, MICRF_BENCH_GET_RSP, MICRF_BENCH_GET_RSP_LEN, (uint8_t *)&s_benchRsp , APP_MICRF_Bench_Get},      \
+        { MICRF_BENCH_RESET_CMD, MICRF_BENCH_RESET_RSP, MICRF_BENCH_RESET_RSP_LEN, NULL , APP_MICRF_Bench_Reset},      \
+        { MICRF_REASM_GET_CMD, MICRF_REASM_GET_RSP, MICRF_REASM_GET_RSP_LEN, (uint8_t *)&s_reasmRsp , APP_MICRF_Reasm_Get},      \
+        { MICRF_REASM_RESET_CMD, MICRF_REASM_RESET_RSP, MICRF_REASM_RESET_RSP_LEN, NULL , APP_MICRF_Reasm_Reset},      \
+        { MICRF_CAP_ARM_CMD, MICRF_CAP_ARM_RSP, MICRF_CAP_ARM_RSP_LEN, NULL , APP_MICRF_Cap_Arm},      \
+        { MICRF_CAP_INFO_CMD, MICRF_CAP_INFO_RSP, MICRF_CAP_INFO_RSP_LEN, (uint8_t *)&s_capInfoRsp , APP_MICRF_Cap_Info},      \
+        { MICRF_CAP_READ_CMD, MICRF_CAP_READ_RSP, MICRF_CAP_READ_RSP_LEN, (uint8_t *)&s_capReadRsp , APP_MICRF_Cap_Read},      \
+        { MICRF_PROF_GET_CMD, MICRF_PROF_GET_RSP, MICRF_PROF_GET_RSP_LEN, (uint8_t *)&s_profRsp , APP_MICRF_Prof_Get},      \
+        { MICRF_PROF_HIST_CMD, MICRF_PROF_HIST_RSP, MICRF_PROF_HIST_RSP_LEN, (uint8_t *)&s_profHistRsp , APP_MICRF_Prof_Hist},      \
+        { MICRF_PROF_RESET_CMD, MICRF_PROF_RESET_RSP, MICRF_PROF_RESET_RSP_LEN, NULL , APP_MICRF_Prof_Reset},      \
+        { MICRF_STATS_GET_CMD, MICRF_STATS_GET_RSP, MICRF_STATS_GET_RSP_LEN, (uint8_t *)&s_statsPages , APP_MICRF_Stats_Get},      \
+        { MICRF_STATS_RESET_CMD, MICRF_STATS_RESET_RSP, MICRF_STATS_RESET_RSP_LEN, NULL , APP_MICRF_Stats_Reset},      \
+        { MICRF_RSSI_CAL_SET_CMD, MICRF_RSSI_CAL_SET_RSP, MICRF_RSSI_CAL_SET_RSP_LEN, (uint8_t *)&s_rssiCalRsp , APP_MICRF_RssiCal_Set},      \
+        { MICRF_RSSI_CAL_CLEAR_CMD, MICRF_RSSI_CAL_CLEAR_RSP, MICRF_RSSI_CAL_CLEAR_RSP_LEN, NULL , APP_MICRF_RssiCal_Clear}
+
+#define MICRF_NOTIFY_LST_SIZE   1
+#define MICRF_DEFINE_CTRL_NOTIFY()                   \
+        { MICRF_STATS_NFY, MICRF_STATS_NFY_LEN, (uint8_t *)&s_statsNfy}
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Function Prototypes
+// *****************************************************************************
+// *****************************************************************************
+void APP_MICRF_Init(void);
+
+bool APP_MICRF_BenchFrame(const rxDataPacket_t *p_packet);
+void APP_MICRF_CaptureDump(void);
+void APP_MICRF_ProfilePrint(void);
+void APP_MICRF_StatsNotify(void);
+void APP_MICRF_GatewayFrame(const rxDataPacket_t *p_packet);
+void APP_MICRF_GatewayFlush(void);
+void APP_MICRF_GatewayTxStatus(uint16_t connHandle, uint8_t status);
+void APP_MICRF_GatewayDisconnect(uint16_t connHandle);
+void APP_MICRF_AdvFrame(const rxDataPacket_t *p_packet);
+void APP_MICRF_AdvTelemetry(uint8_t *p_data);
+#endif
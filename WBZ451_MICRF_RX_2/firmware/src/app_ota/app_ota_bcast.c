@@ -0,0 +1,499 @@
+/*******************************************************************************
+  Application OTA Broadcast Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_ota_bcast.c
+
+  Summary:
+    This file contains the fountain code of the sub-GHz firmware broadcast.
+
+  Description:
+    Random linear code over GF(2): the coefficients of a symbol are the 64 bits
+    of a uint64_t, bit b selecting source symbol b of the generation.  With 64
+    symbols a generation the dense code needs ~1.6 more symbols than the source
+    on average, where an LT code (peeling decoder) needs far more at this size,
+    and Gaussian elimination on 64 bit rows is cheap: a receiver reduces each
+    symbol against the rows it holds, a row with its lowest bit at b being
+    stored at index b, and back substitutes once it holds 64 rows.
+ *******************************************************************************/
+
+//DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2023 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+//DOM-IGNORE-END
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "app_ota_bcast.h"
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+#define APP_OTA_BCAST_PAGE_SIZE         4096
+#define APP_OTA_BCAST_GENS_PAGE         (APP_OTA_BCAST_PAGE_SIZE / APP_OTA_BCAST_GEN_SIZE)
+#define APP_OTA_BCAST_HEAD_SIZE         16      /**< Written last, the bootloader finds no image before */
+#define APP_OTA_BCAST_CRC_CHUNK         64
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Local Variables
+// *****************************************************************************
+// *****************************************************************************
+static const uint32_t s_crcNibble[16] =
+{
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Functions
+// *****************************************************************************
+// *****************************************************************************
+
+/* Coefficients of a symbol of a generation of syms source symbols.  Seeds below syms select one source symbol, the
+ * others are a splitmix64 hash of the image, the generation and the seed, never 0. */
+static uint64_t APP_OTA_BcastCoef(uint8_t imgId, uint16_t gen, uint16_t seed, uint8_t syms)
+{
+    uint64_t x;
+    uint64_t mask = (syms < APP_OTA_BCAST_K) ? (((uint64_t)1 << syms) - 1) : ~(uint64_t)0;
+
+    if (seed < syms)
+    {
+        return (uint64_t)1 << seed;
+    }
+    x = ((uint64_t)imgId << 48) ^ ((uint64_t)gen << 24) ^ seed;
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    x &= mask;
+    return (x != 0) ? x : 1;
+}
+
+/* Big endian field of a frame */
+static uint32_t APP_OTA_BcastGet(const uint8_t *p_data, uint8_t len)
+{
+    uint32_t val = 0;
+
+    while (len-- != 0)
+    {
+        val = (val << 8) | *p_data++;
+    }
+    return val;
+}
+
+static void APP_OTA_BcastPut(uint8_t *p_data, uint32_t val, uint8_t len)
+{
+    while (len-- != 0)
+    {
+        p_data[len] = (uint8_t)val;
+        val >>= 8;
+    }
+}
+
+/* Bytes of a generation, the last one is shorter */
+static uint16_t APP_OTA_BcastGenLen(uint32_t size, uint16_t gen)
+{
+    uint32_t len = size - ((uint32_t)gen * APP_OTA_BCAST_GEN_SIZE);
+
+    return (uint16_t)((len > APP_OTA_BCAST_GEN_SIZE) ? APP_OTA_BCAST_GEN_SIZE : len);
+}
+
+/* Source symbols of a generation.  The padding of the last one is known to be 0, so it is not coded. */
+static uint8_t APP_OTA_BcastGenSyms(uint32_t size, uint16_t gen)
+{
+    return (uint8_t)((APP_OTA_BcastGenLen(size, gen) + APP_OTA_BCAST_SYM_SIZE - 1) / APP_OTA_BCAST_SYM_SIZE);
+}
+
+uint32_t APP_OTA_BcastCrc32(uint32_t crc, const uint8_t *p_data, uint32_t len)
+{
+    crc = ~crc;
+    while (len-- != 0)
+    {
+        crc ^= *p_data++;
+        crc = (crc >> 4) ^ s_crcNibble[crc & 0x0F];
+        crc = (crc >> 4) ^ s_crcNibble[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+/* Read the source symbols of a generation, zero padded */
+static bool APP_OTA_BcastTxRead(const APP_OTA_BcastTx_T *p_tx, uint16_t gen, uint64_t *p_src)
+{
+    memset(p_src, 0, APP_OTA_BCAST_GEN_SIZE);
+    return APP_OTA_HDL_FlashRead((uint32_t)gen * APP_OTA_BCAST_GEN_SIZE, (uint8_t *)p_src,
+                                 APP_OTA_BcastGenLen(p_tx->size, gen));
+}
+
+/* Read the generations of the group to send */
+static bool APP_OTA_BcastTxLoad(APP_OTA_BcastTx_T *p_tx)
+{
+    uint8_t i;
+
+    p_tx->groupGens = (uint8_t)(((p_tx->gens - p_tx->group) < APP_OTA_BCAST_INTERLEAVE) ? (p_tx->gens - p_tx->group) :
+                                                                                         APP_OTA_BCAST_INTERLEAVE);
+    for (i = 0; i < p_tx->groupGens; i++)
+    {
+        if (!APP_OTA_BcastTxRead(p_tx, p_tx->group + i, p_tx->src[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Symbols per generation on this pass */
+static uint16_t APP_OTA_BcastTxVisit(const APP_OTA_BcastTx_T *p_tx)
+{
+    uint32_t extra = (p_tx->pass < 8) ? ((uint32_t)p_tx->extra << p_tx->pass) : APP_OTA_BCAST_VISIT_MAX;
+
+    return (uint16_t)(((APP_OTA_BCAST_K + extra) < APP_OTA_BCAST_VISIT_MAX) ? (APP_OTA_BCAST_K + extra) :
+                                                                               APP_OTA_BCAST_VISIT_MAX);
+}
+
+bool APP_OTA_BcastTxStart(APP_OTA_BcastTx_T *p_tx, uint8_t imgId, uint32_t size, uint8_t extraPct)
+{
+    uint16_t gen;
+
+    memset(p_tx, 0, sizeof(APP_OTA_BcastTx_T));
+    if ((size == 0) || ((size % APP_OTA_BCAST_HEAD_SIZE) != 0) ||
+        (size > ((uint32_t)APP_OTA_BCAST_GEN_MAX * APP_OTA_BCAST_GEN_SIZE)))
+    {
+        return false;
+    }
+    p_tx->imgId = imgId;
+    p_tx->size = size;
+    p_tx->gens = (uint16_t)((size + APP_OTA_BCAST_GEN_SIZE - 1) / APP_OTA_BCAST_GEN_SIZE);
+    for (gen = 0; gen < p_tx->gens; gen++)
+    {
+        if (!APP_OTA_BcastTxRead(p_tx, gen, p_tx->src[0]))
+        {
+            return false;
+        }
+        p_tx->crc = APP_OTA_BcastCrc32(p_tx->crc, (const uint8_t *)p_tx->src[0], APP_OTA_BcastGenLen(size, gen));
+    }
+    p_tx->extra = (uint16_t)((((uint32_t)APP_OTA_BCAST_K * extraPct) + 99) / 100);
+    p_tx->extra = (p_tx->extra != 0) ? p_tx->extra : 1;     // Else the passes would not grow
+    p_tx->visit = APP_OTA_BcastTxVisit(p_tx);
+    p_tx->active = true;
+    return true;
+}
+
+/* Next symbol of the group, next group or next pass */
+static void APP_OTA_BcastTxAdvance(APP_OTA_BcastTx_T *p_tx)
+{
+    if (++p_tx->sym >= ((uint32_t)p_tx->visit * p_tx->groupGens))
+    {
+        p_tx->sym = 0;
+        p_tx->group += p_tx->groupGens;
+        if (p_tx->group >= p_tx->gens)
+        {
+            p_tx->group = 0;
+            p_tx->seedBase += p_tx->visit;
+            p_tx->pass++;
+            p_tx->visit = APP_OTA_BcastTxVisit(p_tx);
+        }
+    }
+}
+
+uint8_t APP_OTA_BcastTxNext(APP_OTA_BcastTx_T *p_tx, uint8_t *p_frame)
+{
+    uint16_t seed, gen;
+    uint8_t idx, syms;
+    bool bSend;
+    uint64_t coef, sym = 0;
+
+    if (!p_tx->active)
+    {
+        return 0;
+    }
+    p_tx->frames++;
+    if (p_tx->descWait == 0)
+    {   // Also the 1st frame, a receiver that joins late needs it before any symbol
+        p_frame[0] = APP_OTA_BCAST_DESC_MAGIC;
+        p_frame[1] = p_tx->imgId;
+        APP_OTA_BcastPut(&p_frame[2], p_tx->size, 3);
+        APP_OTA_BcastPut(&p_frame[5], p_tx->crc, 4);
+        APP_OTA_BcastPut(&p_frame[9], p_tx->gens, 2);
+        p_tx->descWait = APP_OTA_BCAST_DESC_PERIOD;
+        return APP_OTA_BCAST_DESC_LEN;
+    }
+    p_tx->descWait--;
+
+    // The generations of the group take turns, the short last one drops out once it got its share of the visit.
+    // Seeds go on from pass to pass, the 1st pass starts with the source symbols.
+    do
+    {
+        if ((p_tx->sym == 0) && !APP_OTA_BcastTxLoad(p_tx))
+        {
+            p_tx->active = false;
+            return 0;
+        }
+        idx = (uint8_t)(p_tx->sym % p_tx->groupGens);
+        gen = p_tx->group + idx;
+        seed = (uint16_t)(p_tx->sym / p_tx->groupGens);
+        syms = APP_OTA_BcastGenSyms(p_tx->size, gen);
+        bSend = (seed < ((((uint32_t)p_tx->visit * syms) + APP_OTA_BCAST_K - 1) / APP_OTA_BCAST_K));
+        seed += p_tx->seedBase;
+        APP_OTA_BcastTxAdvance(p_tx);
+    } while (!bSend);
+    for (coef = APP_OTA_BcastCoef(p_tx->imgId, gen, seed, syms); coef != 0; coef &= coef - 1)
+    {
+        sym ^= p_tx->src[idx][__builtin_ctzll(coef)];
+    }
+    p_frame[0] = APP_OTA_BCAST_SYM_MAGIC;
+    p_frame[1] = p_tx->imgId;
+    APP_OTA_BcastPut(&p_frame[2], gen, 2);
+    APP_OTA_BcastPut(&p_frame[4], seed, 2);
+    memcpy(&p_frame[6], &sym, APP_OTA_BCAST_SYM_SIZE);
+    return APP_OTA_BCAST_SYM_LEN;
+}
+
+void APP_OTA_BcastRxReset(APP_OTA_BcastRx_T *p_rx)
+{
+    uint8_t i;
+
+    memset(p_rx, 0, sizeof(APP_OTA_BcastRx_T));
+    for (i = 0; i < APP_OTA_BCAST_SLOTS; i++)
+    {
+        p_rx->slot[i].gen = APP_OTA_BCAST_GEN_NONE;
+    }
+}
+
+/* New image on a descriptor, anything else of it is ignored */
+static APP_OTA_BcastRes_T APP_OTA_BcastRxDesc(APP_OTA_BcastRx_T *p_rx, const uint8_t *p_frame)
+{
+    uint32_t size = APP_OTA_BcastGet(&p_frame[2], 3);
+    uint32_t crc = APP_OTA_BcastGet(&p_frame[5], 4);
+    uint16_t gens = (uint16_t)APP_OTA_BcastGet(&p_frame[9], 2);
+
+    if ((size == 0) || ((size % APP_OTA_BCAST_HEAD_SIZE) != 0) || (gens > APP_OTA_BCAST_GEN_MAX) ||
+        (gens != ((size + APP_OTA_BCAST_GEN_SIZE - 1) / APP_OTA_BCAST_GEN_SIZE)))
+    {
+        return APP_OTA_BCAST_RES_USED;
+    }
+    if (p_rx->active && (p_rx->imgId == p_frame[1]) && (p_rx->size == size) && (p_rx->crc == crc))
+    {
+        return APP_OTA_BCAST_RES_USED;
+    }
+    APP_OTA_BcastRxReset(p_rx);
+    p_rx->active = true;
+    p_rx->imgId = p_frame[1];
+    p_rx->size = size;
+    p_rx->crc = crc;
+    p_rx->gens = gens;
+    return APP_OTA_BCAST_RES_START;
+}
+
+/* Slot of a generation.  If none has it, a free slot is taken or else the one with the fewest rows outside the group
+ * being sent: the generations closest to complete are kept until the next pass sends them again. */
+static APP_OTA_BcastSlot_T *APP_OTA_BcastRxSlot(APP_OTA_BcastRx_T *p_rx, uint16_t gen)
+{
+    APP_OTA_BcastSlot_T *p_slot = NULL;
+    APP_OTA_BcastSlot_T *p_cand;
+    uint8_t i;
+
+    for (i = 0; i < APP_OTA_BCAST_SLOTS; i++)
+    {
+        p_cand = &p_rx->slot[i];
+        if (p_cand->gen == gen)
+        {
+            return p_cand;
+        }
+        if (((p_slot != NULL) && (p_slot->gen == APP_OTA_BCAST_GEN_NONE)) ||
+            ((p_cand->gen != APP_OTA_BCAST_GEN_NONE) &&
+             ((p_cand->gen / APP_OTA_BCAST_INTERLEAVE) == (gen / APP_OTA_BCAST_INTERLEAVE))))
+        {   // A free slot was found, or the candidate is in the group being sent
+            continue;
+        }
+        if ((p_slot == NULL) || (p_cand->gen == APP_OTA_BCAST_GEN_NONE) || (p_cand->rank < p_slot->rank) ||
+            ((p_cand->rank == p_slot->rank) && (p_cand->lastUse < p_slot->lastUse)))
+        {
+            p_slot = p_cand;
+        }
+    }
+    p_slot->gen = gen;
+    p_slot->rank = 0;
+    p_slot->rows = 0;
+    return p_slot;
+}
+
+/* Write a decoded generation, erasing its flash page first if needed */
+static bool APP_OTA_BcastRxWrite(APP_OTA_BcastRx_T *p_rx, const APP_OTA_BcastSlot_T *p_slot)
+{
+    uint32_t offset = (uint32_t)p_slot->gen * APP_OTA_BCAST_GEN_SIZE;
+    uint16_t page = p_slot->gen / APP_OTA_BCAST_GENS_PAGE;
+    uint16_t len = APP_OTA_BcastGenLen(p_rx->size, p_slot->gen);
+    const uint8_t *p_data = (const uint8_t *)p_slot->data;
+
+    if ((p_rx->pageErased[page / 8] & (1 << (page % 8))) == 0)
+    {   // Blocks for the page erase, the frames lost meanwhile are made up by the code
+        if (!APP_OTA_HDL_FlashErase((uint32_t)page * APP_OTA_BCAST_PAGE_SIZE))
+        {
+            return false;
+        }
+        p_rx->pageErased[page / 8] |= (uint8_t)(1 << (page % 8));
+    }
+    if (p_slot->gen == 0)
+    {
+        memcpy(p_rx->head, p_data, APP_OTA_BCAST_HEAD_SIZE);
+        offset += APP_OTA_BCAST_HEAD_SIZE;
+        p_data += APP_OTA_BCAST_HEAD_SIZE;
+        len -= APP_OTA_BCAST_HEAD_SIZE;
+    }
+    return (len == 0) || APP_OTA_HDL_FlashWrite(offset, p_data, len);
+}
+
+/* All generations are written: write the 1st quad word and check the image */
+static APP_OTA_BcastRes_T APP_OTA_BcastRxFinish(APP_OTA_BcastRx_T *p_rx)
+{
+    uint8_t buf[APP_OTA_BCAST_CRC_CHUNK];
+    uint32_t offset, crc = 0;
+    uint16_t len;
+
+    if (!APP_OTA_HDL_FlashWrite(0, p_rx->head, APP_OTA_BCAST_HEAD_SIZE))
+    {
+        return APP_OTA_BCAST_RES_FAIL;
+    }
+    for (offset = 0; offset < p_rx->size; offset += len)
+    {
+        len = (uint16_t)(((p_rx->size - offset) > sizeof(buf)) ? sizeof(buf) : (p_rx->size - offset));
+        if (!APP_OTA_HDL_FlashRead(offset, buf, len))
+        {
+            return APP_OTA_BCAST_RES_FAIL;
+        }
+        crc = APP_OTA_BcastCrc32(crc, buf, len);
+    }
+    return (crc == p_rx->crc) ? APP_OTA_BCAST_RES_DONE : APP_OTA_BCAST_RES_FAIL;
+}
+
+/* Reduce a symbol against the rows of its generation, decode the generation once it has a row per source symbol */
+static APP_OTA_BcastRes_T APP_OTA_BcastRxSymbol(APP_OTA_BcastRx_T *p_rx, const uint8_t *p_frame)
+{
+    APP_OTA_BcastSlot_T *p_slot;
+    uint16_t gen = (uint16_t)APP_OTA_BcastGet(&p_frame[2], 2);
+    uint16_t seed = (uint16_t)APP_OTA_BcastGet(&p_frame[4], 2);
+    uint64_t coef, data, mask;
+    uint8_t b, syms;
+
+    if (!p_rx->active || p_rx->complete || (p_rx->imgId != p_frame[1]) || (gen >= p_rx->gens) ||
+        ((p_rx->genDone[gen / 8] & (1 << (gen % 8))) != 0))
+    {
+        return APP_OTA_BCAST_RES_USED;
+    }
+    p_rx->frames++;
+    p_slot = APP_OTA_BcastRxSlot(p_rx, gen);
+    p_slot->lastUse = p_rx->frames;
+
+    syms = APP_OTA_BcastGenSyms(p_rx->size, gen);
+    coef = APP_OTA_BcastCoef(p_rx->imgId, gen, seed, syms);
+    memcpy(&data, &p_frame[6], APP_OTA_BCAST_SYM_SIZE);
+    while (coef != 0)
+    {
+        b = (uint8_t)__builtin_ctzll(coef);
+        mask = (uint64_t)1 << b;
+        if ((p_slot->rows & mask) == 0)
+        {
+            p_slot->coef[b] = coef;
+            p_slot->data[b] = data;
+            p_slot->rows |= mask;
+            p_slot->rank++;
+            p_rx->useful++;
+            break;
+        }
+        coef ^= p_slot->coef[b];
+        data ^= p_slot->data[b];
+    }
+    if ((coef == 0) || (p_slot->rank < syms))
+    {   // Nothing new, or not enough yet
+        return APP_OTA_BCAST_RES_USED;
+    }
+
+    // Back substitution from the last row, the rows after row b are single bits once done
+    b = syms;
+    while (b-- != 0)
+    {
+        for (coef = p_slot->coef[b] & ~((uint64_t)1 << b); coef != 0; coef &= coef - 1)
+        {
+            p_slot->data[b] ^= p_slot->data[__builtin_ctzll(coef)];
+        }
+        p_slot->coef[b] = (uint64_t)1 << b;
+    }
+    if (!APP_OTA_BcastRxWrite(p_rx, p_slot))
+    {
+        APP_OTA_BcastRxReset(p_rx);
+        return APP_OTA_BCAST_RES_FAIL;
+    }
+    p_slot->gen = APP_OTA_BCAST_GEN_NONE;
+    p_rx->genDone[gen / 8] |= (uint8_t)(1 << (gen % 8));
+    if (++p_rx->done < p_rx->gens)
+    {
+        return APP_OTA_BCAST_RES_GEN;
+    }
+    if (APP_OTA_BcastRxFinish(p_rx) != APP_OTA_BCAST_RES_DONE)
+    {   // Received again from the next descriptor
+        APP_OTA_BcastRxReset(p_rx);
+        return APP_OTA_BCAST_RES_FAIL;
+    }
+    p_rx->complete = true;
+    return APP_OTA_BCAST_RES_DONE;
+}
+
+bool APP_OTA_BcastIsFrame(const uint8_t *p_frame, uint8_t len)
+{
+    return ((len == APP_OTA_BCAST_DESC_LEN) && (p_frame[0] == APP_OTA_BCAST_DESC_MAGIC)) ||
+           ((len == APP_OTA_BCAST_SYM_LEN) && (p_frame[0] == APP_OTA_BCAST_SYM_MAGIC));
+}
+
+APP_OTA_BcastRes_T APP_OTA_BcastRxFrame(APP_OTA_BcastRx_T *p_rx, const uint8_t *p_frame, uint8_t len)
+{
+    if ((len == APP_OTA_BCAST_DESC_LEN) && (p_frame[0] == APP_OTA_BCAST_DESC_MAGIC))
+    {
+        return APP_OTA_BcastRxDesc(p_rx, p_frame);
+    }
+    if ((len == APP_OTA_BCAST_SYM_LEN) && (p_frame[0] == APP_OTA_BCAST_SYM_MAGIC))
+    {
+        return APP_OTA_BcastRxSymbol(p_rx, p_frame);
+    }
+    return APP_OTA_BCAST_RES_NONE;
+}
+
+/*******************************************************************************
+ End of File
+ */
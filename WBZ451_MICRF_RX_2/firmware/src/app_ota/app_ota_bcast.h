@@ -0,0 +1,318 @@
+/*******************************************************************************
+  Application OTA Broadcast Header File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_ota_bcast.h
+
+  Summary:
+    This file contains the fountain coded firmware broadcast over the sub-GHz link.
+
+  Description:
+    The transmitter sends the image staged in its OTA slot, without a
+    back-channel, to any number of receivers.  The image is split in
+    generations of APP_OTA_BCAST_K symbols of APP_OTA_BCAST_SYM_SIZE bytes.  A
+    symbol frame carries the XOR of the source symbols selected by its seed:
+    seeds below APP_OTA_BCAST_K select one symbol (systematic), the others a
+    pseudo random set, so a transmitter can send as many different symbols of a
+    generation as the channel needs.  A receiver decodes a generation from any
+    APP_OTA_BCAST_K independent symbols, whatever frames it missed, and writes
+    it to its OTA slot, so the generations complete in any order.  The last
+    generation codes only the symbols of the image, its padding being 0.
+
+    Frames (TX_sendData() payload):
+      Symbol:     [0xF0][Image ID][Gen MSB][Gen LSB][Seed MSB][Seed LSB][Symbol, 8 bytes]
+      Descriptor: [0xF1][Image ID][Size, 3 bytes MSB first][CRC-32, 4 bytes MSB first][Generations MSB][LSB]
+
+    The transmitter sends the generations in groups of APP_OTA_BCAST_INTERLEAVE,
+    the symbols of a group in turns so a burst of losses is spread over it, and
+    starts over with new seeds once all were sent.  Each generation gets
+    APP_OTA_BCAST_K + extra symbols on the 1st pass, and the extra symbols double
+    on every pass up to APP_OTA_BCAST_VISIT_MAX, so without feedback the later
+    passes complete the generations of the receivers that lose the most frames.
+    A receiver decodes the group being sent and keeps the partly decoded
+    generations closest to complete in its other slots, so a generation it missed
+    a few symbols of is completed on the next pass.  host_sim/bcast_sim.c
+    measures the completion time against the frame loss.
+ *******************************************************************************/
+
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2023 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+#ifndef APP_OTA_BCAST_H
+#define APP_OTA_BCAST_H
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdint.h>
+#include <stdbool.h>
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+#define    APP_OTA_BCAST_K              64      /**< Symbols per generation, one bit of a uint64_t each */
+#define    APP_OTA_BCAST_SYM_SIZE       8       /**< Bytes per symbol, a uint64_t */
+#define    APP_OTA_BCAST_GEN_SIZE       (APP_OTA_BCAST_K * APP_OTA_BCAST_SYM_SIZE)
+#define    APP_OTA_BCAST_INTERLEAVE     4       /**< Generations sent in turns, a burst of losses is spread over them */
+#define    APP_OTA_BCAST_SLOTS          (APP_OTA_BCAST_INTERLEAVE + 2)  /**< Generations a receiver decodes at a time */
+#define    APP_OTA_BCAST_GEN_MAX        1024    /**< Generations of the largest image */
+#define    APP_OTA_BCAST_VISIT_MAX      (4 * APP_OTA_BCAST_K)   /**< Symbols per generation and pass, at most */
+#define    APP_OTA_BCAST_DESC_PERIOD    32      /**< Symbol frames between two descriptors */
+#define    APP_OTA_BCAST_GEN_NONE       0xFFFF
+
+#define    APP_OTA_BCAST_SYM_MAGIC      0xF0
+#define    APP_OTA_BCAST_DESC_MAGIC     0xF1
+#define    APP_OTA_BCAST_SYM_LEN        (6 + APP_OTA_BCAST_SYM_SIZE)
+#define    APP_OTA_BCAST_DESC_LEN       11
+#define    APP_OTA_BCAST_FRAME_MAX      APP_OTA_BCAST_SYM_LEN
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+
+/**@brief Result of APP_OTA_BcastRxFrame(). */
+typedef enum APP_OTA_BcastRes_T
+{
+    APP_OTA_BCAST_RES_NONE,         /**< Not a broadcast frame */
+    APP_OTA_BCAST_RES_USED,         /**< Broadcast frame */
+    APP_OTA_BCAST_RES_START,        /**< Descriptor of a new image, the previous one is dropped */
+    APP_OTA_BCAST_RES_GEN,          /**< A generation was decoded and written */
+    APP_OTA_BCAST_RES_DONE,         /**< The image is complete and its CRC-32 is right */
+    APP_OTA_BCAST_RES_FAIL          /**< The image is complete but its CRC-32 is wrong, or flash failed */
+} APP_OTA_BcastRes_T;
+
+/**@brief A generation being decoded: row b has its lowest coefficient bit at b. */
+typedef struct APP_OTA_BcastSlot_T
+{
+    uint16_t            gen;            /**< Generation, APP_OTA_BCAST_GEN_NONE if the slot is free */
+    uint8_t             rank;           /**< Rows held */
+    uint32_t            lastUse;        /**< Frame count of the last symbol */
+    uint64_t            rows;           /**< Bit b set: coef[b] and data[b] are held */
+    uint64_t            coef[APP_OTA_BCAST_K];
+    uint64_t            data[APP_OTA_BCAST_K];
+} APP_OTA_BcastSlot_T;
+
+/**@brief Receiver state. */
+typedef struct APP_OTA_BcastRx_T
+{
+    bool                active;         /**< A descriptor was received */
+    bool                complete;       /**< Every generation was written */
+    uint8_t             imgId;
+    uint32_t            size;           /**< Image bytes */
+    uint32_t            crc;            /**< CRC-32 of the image */
+    uint16_t            gens;           /**< Generations of the image */
+    uint16_t            done;           /**< Generations written */
+    uint32_t            frames;         /**< Symbol frames of the image received */
+    uint32_t            useful;         /**< Symbol frames that added a row */
+    uint8_t             genDone[APP_OTA_BCAST_GEN_MAX / 8];
+    uint8_t             pageErased[APP_OTA_BCAST_GEN_MAX / 64];    /**< 4 KB flash pages, 8 generations each */
+    uint8_t             head[16];       /**< 1st quad word of the image, written last */
+    APP_OTA_BcastSlot_T slot[APP_OTA_BCAST_SLOTS];
+} APP_OTA_BcastRx_T;
+
+/**@brief Transmitter state. */
+typedef struct APP_OTA_BcastTx_T
+{
+    bool                active;
+    uint8_t             imgId;
+    uint16_t            extra;          /**< Symbols per generation on top of APP_OTA_BCAST_K on the 1st pass */
+    uint32_t            size;
+    uint32_t            crc;
+    uint16_t            gens;
+    uint16_t            group;          /**< 1st generation of the group being sent */
+    uint8_t             groupGens;      /**< Generations of the group, APP_OTA_BCAST_INTERLEAVE but the last group */
+    uint16_t            visit;          /**< Symbols per generation on this pass */
+    uint16_t            sym;            /**< Symbols of the group sent on this pass */
+    uint16_t            seedBase;       /**< Seed of the 1st symbol of a generation on this pass */
+    uint8_t             descWait;       /**< Symbol frames until the next descriptor */
+    uint16_t            pass;           /**< Times all generations were sent */
+    uint32_t            frames;         /**< Frames sent */
+    uint64_t            src[APP_OTA_BCAST_INTERLEAVE][APP_OTA_BCAST_K];   /**< Source symbols of the group */
+} APP_OTA_BcastTx_T;
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Function Prototypes
+// *****************************************************************************
+// *****************************************************************************
+
+/*******************************************************************************
+  Function:
+     bool APP_OTA_BcastTxStart(APP_OTA_BcastTx_T *p_tx, uint8_t imgId, uint32_t size, uint8_t extraPct)
+
+  Summary:
+     Starts the broadcast of the image in the OTA slot
+
+  Description:
+     Computes the CRC-32 of the image.  Every generation is sent with
+     extraPct % more symbols than needed on a loss free link on the 1st pass,
+     the extra symbols double on every pass.
+
+  Precondition:
+     The image is in the OTA slot, see APP_OTA_HDL_FlashRead().
+
+  Parameters:
+    p_tx     - Transmitter state.
+    imgId    - Image ID, a receiver drops what it has when it changes.
+    size     - Image bytes, a multiple of 16.
+    extraPct - Repair symbols per generation on the 1st pass, % of APP_OTA_BCAST_K.
+
+  Returns:
+    false if the size is not valid.
+
+*/
+bool APP_OTA_BcastTxStart(APP_OTA_BcastTx_T *p_tx, uint8_t imgId, uint32_t size, uint8_t extraPct);
+
+/*******************************************************************************
+  Function:
+     uint8_t APP_OTA_BcastTxNext(APP_OTA_BcastTx_T *p_tx, uint8_t *p_frame)
+
+  Summary:
+     Builds the next frame of the broadcast
+
+  Description:
+     A descriptor every APP_OTA_BCAST_DESC_PERIOD symbol frames, otherwise the
+     next symbol of the generation being sent.
+
+  Precondition:
+     APP_OTA_BcastTxStart().
+
+  Parameters:
+    p_tx    - Transmitter state.
+    p_frame - APP_OTA_BCAST_FRAME_MAX bytes.
+
+  Returns:
+    Frame length, 0 if no broadcast is running.
+
+*/
+uint8_t APP_OTA_BcastTxNext(APP_OTA_BcastTx_T *p_tx, uint8_t *p_frame);
+
+/*******************************************************************************
+  Function:
+     bool APP_OTA_BcastIsFrame(const uint8_t *p_frame, uint8_t len)
+
+  Summary:
+     Tells a broadcast frame from the other sub-GHz frames
+
+  Description:
+
+  Precondition:
+
+  Parameters:
+    p_frame - Frame data.
+    len     - Frame length.
+
+  Returns:
+    true for a descriptor or a symbol frame.
+
+*/
+bool APP_OTA_BcastIsFrame(const uint8_t *p_frame, uint8_t len);
+
+/*******************************************************************************
+  Function:
+     void APP_OTA_BcastRxReset(APP_OTA_BcastRx_T *p_rx)
+
+  Summary:
+     Drops the image being received
+
+  Description:
+     Call it when something else writes the OTA slot.
+
+  Precondition:
+
+  Parameters:
+    p_rx - Receiver state.
+
+  Returns:
+    None.
+
+*/
+void APP_OTA_BcastRxReset(APP_OTA_BcastRx_T *p_rx);
+
+/*******************************************************************************
+  Function:
+     APP_OTA_BcastRes_T APP_OTA_BcastRxFrame(APP_OTA_BcastRx_T *p_rx, const uint8_t *p_frame, uint8_t len)
+
+  Summary:
+     Handles a received frame
+
+  Description:
+     A decoded generation is written to the OTA slot at once.  Once all are, the
+     1st quad word is written and the CRC-32 of the slot is checked.
+
+  Precondition:
+
+  Parameters:
+    p_rx    - Receiver state.
+    p_frame - Frame data.
+    len     - Frame length.
+
+  Returns:
+    APP_OTA_BcastRes_T.
+
+*/
+APP_OTA_BcastRes_T APP_OTA_BcastRxFrame(APP_OTA_BcastRx_T *p_rx, const uint8_t *p_frame, uint8_t len);
+
+/*******************************************************************************
+  Function:
+     uint32_t APP_OTA_BcastCrc32(uint32_t crc, const uint8_t *p_data, uint32_t len)
+
+  Summary:
+     Updates a CRC-32 (IEEE 802.3, as zlib)
+
+  Description:
+     Start with 0.
+
+  Precondition:
+
+  Parameters:
+    crc    - CRC-32 of the previous bytes.
+    p_data - Bytes.
+    len    - Number of bytes.
+
+  Returns:
+    CRC-32.
+
+*/
+uint32_t APP_OTA_BcastCrc32(uint32_t crc, const uint8_t *p_data, uint32_t len);
+
+/* OTA slot access, implemented by app_ota_handler.c.  Offsets are from APP_OTA_FLASH_ADDR. */
+bool APP_OTA_HDL_FlashRead(uint32_t offset, uint8_t *p_data, uint16_t len);
+bool APP_OTA_HDL_FlashErase(uint32_t offset);
+bool APP_OTA_HDL_FlashWrite(uint32_t offset, const uint8_t *p_data, uint16_t len);
+
+#endif  // End of APP_OTA_BCAST_H
+/*******************************************************************************
+ End of File
+ */
@@ -59,12 +59,40 @@
 #include "ble_dis/ble_dis.h"
 #include "app_ble/app_ble_utility.h"
 #include "ble_dm/ble_dm.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "ble_util/mw_dfu.h"
+#include "peripheral/nvm/plib_nvm.h"
+#include "crypto/crypto.h"
+#include "app.h"
+#include "app_log.h"
+#include "app_ota_inflate.h"
+#include "app_ota_bcast.h"
 
 // *****************************************************************************
 // *****************************************************************************
 // Section: Macros
 // *****************************************************************************
 // *****************************************************************************
+#define APP_OTA_PAGE_SIZE               NVM_FLASH_PAGESIZE      /**< Erase unit */
+#define APP_OTA_ROW_SIZE                NVM_FLASH_ROWSIZE       /**< Program unit */
+#define APP_OTA_PAGE_NONE               0xFF
+#define APP_OTA_WATCHDOG_MS             1000    /**< Period of the OTA timeout check */
+
+//  Compressed image (host_sim/ota_pack.py): header, then for every page of the image [Length, 2 bytes][Block].  A block
+//  is a zlib stream of the page, or the page itself if Length has APP_OTA_ZIP_STORED set.  Little endian.
+#define APP_OTA_ZIP_MAGIC               0x5A41544FUL    /**< "OTAZ" */
+#define APP_OTA_ZIP_VERSION             1
+#define APP_OTA_ZIP_PAGE_LOG2           12      /**< log2(APP_OTA_PAGE_SIZE) */
+#define APP_OTA_ZIP_HDR_LEN             16      /**< Magic, version, log2(page size), pages, image size, reserved */
+#define APP_OTA_ZIP_STORED              0x8000U
+#define APP_OTA_ZIP_LEN_MASK            0x7FFFU
+
+#define APP_OTA_ZIP_HDR                 0       /**< Waiting for the 1st bytes of the image */
+#define APP_OTA_ZIP_RAW                 1       /**< Not compressed */
+#define APP_OTA_ZIP_LEN                 2       /**< Waiting for a block length */
+#define APP_OTA_ZIP_DATA                3       /**< Waiting for a block */
+#define APP_OTA_ZIP_PAD                 4       /**< Every block received, padding to 16 bytes follows */
 
 
 // *****************************************************************************
@@ -72,6 +100,29 @@
 // Section: Data Types
 // *****************************************************************************
 // *****************************************************************************
+typedef struct APP_OTA_Stream_T
+{
+    bool                active;         /**< A streamed image is being received */
+    bool                error;          /**< Image too large or flash failure */
+    uint8_t             fill;           /**< Page buffer being filled */
+    uint8_t             prog;           /**< Page buffer being programmed, APP_OTA_PAGE_NONE if none */
+    uint8_t             progStep;       /**< 0: erase, n: program row n - 1 */
+    uint8_t             progRows;       /**< Rows of the page to program */
+    bool                flashPosted;    /**< APP_MSG_OTA_FLASH is in the queue */
+    uint16_t            fillLen;        /**< Bytes in the page buffer being filled */
+    uint32_t            fillAddr;       /**< Flash address of the page being filled */
+    uint32_t            progAddr;       /**< Flash address of the page being programmed */
+    uint32_t            size;           /**< Image size of the update request */
+    uint32_t            written;        /**< Image bytes given to APP_OTA_HDL_StreamWrite() */
+} APP_OTA_Stream_T;
+
+typedef struct APP_OTA_Zip_T
+{
+    uint8_t             state;          /**< APP_OTA_ZIP_xxx */
+    uint16_t            blocks;         /**< Blocks still to come */
+    uint16_t            len;            /**< Length field of the block being received */
+    uint16_t            fill;           /**< Bytes of the header, length field or block received */
+} APP_OTA_Zip_T;
 
 
 // *****************************************************************************
@@ -89,6 +140,26 @@
 static uint8_t s_OTAMode;
 static APP_BLE_ConnList_T *s_pOTAConnLink = NULL;
 static uint16_t s_connHandle;
+static uint32_t s_otaLastTick;          /**< Time of the last OTA activity, ms */
+static uint32_t s_otaStartTick;         /**< Time of the update start, ms */
+static uint32_t s_otaBytes;             /**< Image bytes received since the update start */
+static bool s_otaStreamed;              /**< The image of the update request is streamed (file type APP) */
+static CRYPT_SHA256_CTX s_otaSha;       /**< Digest of the bytes received */
+
+#if APP_OTA_STREAM_ON == 1
+static APP_OTA_Stream_T s_otaStream;
+static uint32_t s_otaPage[2][APP_OTA_PAGE_SIZE / sizeof(uint32_t)];
+static uint32_t s_otaHdrRow[APP_OTA_ROW_SIZE / sizeof(uint32_t)];  /**< 1st row of the image, programmed last */
+#if APP_OTA_COMPRESS_ON == 1
+static APP_OTA_Zip_T s_otaZip;
+static uint8_t s_otaZipBuf[APP_OTA_PAGE_SIZE];    /**< Header, then one compressed block */
+#endif
+#if APP_OTA_BCAST_ON == 1
+static bool s_otaStage;                 /**< The next streamed image is staged for the broadcast */
+static uint32_t s_otaStagedSize;        /**< Size of the staged image, 0 if none */
+static APP_OTA_BcastRx_T s_otaBcastRx;
+#endif
+#endif
 
 
 // *****************************************************************************
@@ -97,6 +168,527 @@ static uint16_t s_connHandle;
 // *****************************************************************************
 // *****************************************************************************
 
+static uint32_t APP_OTA_Now(void)
+{
+    return xTaskGetTickCount() * portTICK_PERIOD_MS;
+}
+
+/* Restart the OTA timeout.  Only a time stamp: the periodic check runs every APP_OTA_WATCHDOG_MS, so the timer is not
+ * recreated for each fragment. */
+static void APP_OTA_Kick(void)
+{
+    s_otaLastTick = APP_OTA_Now();
+    if (!APP_TIMER_IsTimerExisted(APP_TIMER_OTA_TIMEOUT))
+    {
+        APP_TIMER_SetTimer(APP_TIMER_OTA_TIMEOUT, APP_OTA_WATCHDOG_MS, true);
+    }
+}
+
+#if APP_OTA_STREAM_ON == 1
+/* Post APP_MSG_OTA_FLASH once */
+static void APP_OTA_PostFlash(void)
+{
+    APP_Msg_T appMsg;
+
+    if (!s_otaStream.flashPosted)
+    {
+        appMsg.msgId = APP_MSG_OTA_FLASH;
+        s_otaStream.flashPosted = (OSAL_QUEUE_Send(&appData.appQueue, &appMsg, 0) == OSAL_RESULT_TRUE);
+    }
+}
+
+/* Start the next flash operation of the queued page.  Returns true while the page is not programmed. */
+static bool APP_OTA_FlashStep(void)
+{
+    uint8_t row;
+
+    if (s_otaStream.prog == APP_OTA_PAGE_NONE)
+    {
+        return false;
+    }
+    if (NVM_IsBusy())
+    {
+        return true;
+    }
+    if ((s_otaStream.progStep != 0) && (NVM_ErrorGet() != NVM_ERROR_NONE))
+    {
+        APP_LOG(APP_LOG_OTA_FLASH_ERR, NVM_ErrorGet(), s_otaStream.progAddr);
+        s_otaStream.error = true;
+        s_otaStream.prog = APP_OTA_PAGE_NONE;
+        return false;
+    }
+    if (s_otaStream.progStep == 0)
+    {
+        (void)NVM_PageErase(s_otaStream.progAddr);
+        s_otaStream.progStep = (s_otaStream.progAddr == APP_OTA_FLASH_ADDR) ? 2 : 1;    // 1st row of the image is kept
+        return true;
+    }
+    if (s_otaStream.progStep > s_otaStream.progRows)
+    {
+        s_otaStream.prog = APP_OTA_PAGE_NONE;
+        return false;
+    }
+    row = s_otaStream.progStep - 1;
+    (void)NVM_RowWrite(&s_otaPage[s_otaStream.prog][row * (APP_OTA_ROW_SIZE / sizeof(uint32_t))],
+                       s_otaStream.progAddr + ((uint32_t)row * APP_OTA_ROW_SIZE));
+    s_otaStream.progStep++;
+    return true;
+}
+
+/* Wait until the queued page is programmed */
+static void APP_OTA_FlashWait(void)
+{
+    while (APP_OTA_FlashStep())
+    {
+    }
+}
+
+/* Queue the page buffer being filled for programming and switch to the other buffer */
+static void APP_OTA_QueuePage(void)
+{
+    uint32_t len;
+
+    APP_OTA_FlashWait();                // Only blocks if the flash is slower than the link
+    if (s_otaStream.error)
+    {
+        return;
+    }
+    s_otaStream.progRows = (uint8_t)((s_otaStream.fillLen + APP_OTA_ROW_SIZE - 1) / APP_OTA_ROW_SIZE);
+    len = (uint32_t)s_otaStream.progRows * APP_OTA_ROW_SIZE;
+    memset((uint8_t *)s_otaPage[s_otaStream.fill] + s_otaStream.fillLen, 0xFF, len - s_otaStream.fillLen);
+    if (s_otaStream.fillAddr == APP_OTA_FLASH_ADDR)
+    {
+        memcpy(s_otaHdrRow, s_otaPage[s_otaStream.fill], APP_OTA_ROW_SIZE);
+    }
+    s_otaStream.prog = s_otaStream.fill;
+    s_otaStream.progAddr = s_otaStream.fillAddr;
+    s_otaStream.progStep = 0;
+    s_otaStream.fill ^= 1;
+    s_otaStream.fillLen = 0;
+    s_otaStream.fillAddr += APP_OTA_PAGE_SIZE;
+    APP_OTA_PostFlash();
+}
+
+/* Prepare a streamed image of size bytes.  Returns false if it does not fit the image slot. */
+static bool APP_OTA_StreamInit(uint32_t size)
+{
+    if ((size == 0) || (size > MW_DFU_MAX_SIZE_FW_IMAGE) || ((size & 0x0F) != 0))
+    {
+        return false;
+    }
+    APP_OTA_FlashWait();
+    memset(&s_otaStream, 0, sizeof(s_otaStream));
+    s_otaStream.prog = APP_OTA_PAGE_NONE;
+    s_otaStream.fillAddr = APP_OTA_FLASH_ADDR;
+    s_otaStream.size = size;
+    s_otaStream.active = true;
+#if APP_OTA_COMPRESS_ON == 1
+    memset(&s_otaZip, 0, sizeof(s_otaZip));
+    s_otaZip.state = APP_OTA_ZIP_HDR;
+#endif
+    return true;
+}
+
+/* Program what is left of the streamed image, then its 1st row.  Returns false on error. */
+static bool APP_OTA_StreamFinish(void)
+{
+    if (!s_otaStream.active || (s_otaStream.written != s_otaStream.size))
+    {
+        return false;
+    }
+    if (s_otaStream.fillLen != 0)
+    {
+        APP_OTA_QueuePage();
+    }
+    APP_OTA_FlashWait();
+    if (s_otaStream.error)
+    {
+        return false;
+    }
+#if APP_OTA_COMPRESS_ON == 1
+    if (s_otaZip.state != APP_OTA_ZIP_RAW)
+    {
+        APP_LOG(APP_LOG_OTA_UNPACKED, s_otaBytes, s_otaStream.size);
+    }
+#endif
+#if APP_OTA_BCAST_ON == 1
+    if (s_otaStage)
+    {   // The 1st row stays in s_otaHdrRow, the bootloader finds no image
+        s_otaStage = false;
+        s_otaStagedSize = s_otaStream.size;
+        s_otaStream.active = false;
+        return true;
+    }
+#endif
+    (void)NVM_RowWrite(s_otaHdrRow, APP_OTA_FLASH_ADDR);
+    while (NVM_IsBusy())
+    {
+    }
+    s_otaStream.active = false;
+    return (NVM_ErrorGet() == NVM_ERROR_NONE);
+}
+
+bool APP_OTA_HDL_StreamWrite(const uint8_t *p_data, uint16_t len)
+{
+    uint16_t copyLen;
+
+    if (!s_otaStream.active || s_otaStream.error || ((s_otaStream.written + len) > s_otaStream.size))
+    {
+        s_otaStream.error = true;
+        return false;
+    }
+    s_otaStream.written += len;
+    while (len != 0)
+    {
+        copyLen = APP_OTA_PAGE_SIZE - s_otaStream.fillLen;
+        if (copyLen > len)
+        {
+            copyLen = len;
+        }
+        memcpy((uint8_t *)s_otaPage[s_otaStream.fill] + s_otaStream.fillLen, p_data, copyLen);
+        s_otaStream.fillLen += copyLen;
+        p_data += copyLen;
+        len -= copyLen;
+        if (s_otaStream.fillLen == APP_OTA_PAGE_SIZE)
+        {
+            APP_OTA_QueuePage();
+        }
+    }
+    return !s_otaStream.error;
+}
+
+#if APP_OTA_COMPRESS_ON == 1
+/* Decode one block of a compressed image */
+static int32_t APP_OTA_Decompress(uint8_t *p_out, uint32_t outSz, const uint8_t *p_in, uint32_t inSz)
+{
+#ifdef HAVE_LIBZ
+    return CRYPT_HUFFMAN_DeCompress(p_out, outSz, p_in, inSz);
+#else
+    return APP_OTA_Inflate(p_out, outSz, p_in, inSz);
+#endif
+}
+
+/* Check the 1st bytes of the image.  Without the header of a compressed image, they are the start of a plain one. */
+static void APP_OTA_ZipHeader(void)
+{
+    const uint8_t *p_hdr = s_otaZipBuf;
+    uint32_t magic, size;
+    uint16_t pages;
+
+    magic = p_hdr[0] | ((uint32_t)p_hdr[1] << 8) | ((uint32_t)p_hdr[2] << 16) | ((uint32_t)p_hdr[3] << 24);
+    if (magic != APP_OTA_ZIP_MAGIC)
+    {
+        s_otaZip.state = APP_OTA_ZIP_RAW;
+        (void)APP_OTA_HDL_StreamWrite(s_otaZipBuf, APP_OTA_ZIP_HDR_LEN);
+        return;
+    }
+    pages = (uint16_t)(p_hdr[6] | (p_hdr[7] << 8));
+    size = p_hdr[8] | ((uint32_t)p_hdr[9] << 8) | ((uint32_t)p_hdr[10] << 16) | ((uint32_t)p_hdr[11] << 24);
+    if ((p_hdr[4] != APP_OTA_ZIP_VERSION) || (p_hdr[5] != APP_OTA_ZIP_PAGE_LOG2) || (size == 0) ||
+        (size > MW_DFU_MAX_SIZE_FW_IMAGE) || ((size & 0x0F) != 0) ||
+        (pages != ((size + APP_OTA_PAGE_SIZE - 1) / APP_OTA_PAGE_SIZE)))
+    {
+        s_otaStream.error = true;
+        return;
+    }
+    s_otaStream.size = size;            // From now on the size of the image in flash, not of the file
+    s_otaZip.blocks = pages;
+    s_otaZip.fill = 0;
+    s_otaZip.state = APP_OTA_ZIP_LEN;
+}
+
+/* Decode the block in s_otaZipBuf to the page buffer being filled, which is empty since a block is one page */
+static void APP_OTA_ZipBlock(void)
+{
+    uint32_t pageLen = s_otaStream.size - s_otaStream.written;
+    uint16_t blockLen = s_otaZip.len & APP_OTA_ZIP_LEN_MASK;
+
+    if (pageLen > APP_OTA_PAGE_SIZE)
+    {
+        pageLen = APP_OTA_PAGE_SIZE;
+    }
+    if (s_otaZip.len & APP_OTA_ZIP_STORED)
+    {
+        if (blockLen != pageLen)
+        {
+            s_otaStream.error = true;
+            return;
+        }
+        (void)APP_OTA_HDL_StreamWrite(s_otaZipBuf, blockLen);
+        return;
+    }
+    if (APP_OTA_Decompress((uint8_t *)s_otaPage[s_otaStream.fill], pageLen, s_otaZipBuf, blockLen) != (int32_t)pageLen)
+    {
+        APP_LOG(APP_LOG_OTA_ZIP_ERR, s_otaStream.written / APP_OTA_PAGE_SIZE, blockLen);
+        s_otaStream.error = true;
+        return;
+    }
+    s_otaStream.fillLen = (uint16_t)pageLen;
+    s_otaStream.written += pageLen;
+    if (s_otaStream.fillLen == APP_OTA_PAGE_SIZE)
+    {
+        APP_OTA_QueuePage();
+    }
+}
+
+/* Take the bytes of a streamed image as they arrive: a plain image goes to flash as it is, the blocks of a compressed
+ * one are collected in s_otaZipBuf and decoded one page at a time. */
+static bool APP_OTA_StreamFeed(const uint8_t *p_data, uint16_t len)
+{
+    uint16_t copyLen;
+
+    while ((len != 0) && !s_otaStream.error)
+    {
+        switch (s_otaZip.state)
+        {
+            case APP_OTA_ZIP_HDR:
+            case APP_OTA_ZIP_DATA:
+            {
+                copyLen = ((s_otaZip.state == APP_OTA_ZIP_HDR) ? APP_OTA_ZIP_HDR_LEN :
+                           (s_otaZip.len & APP_OTA_ZIP_LEN_MASK)) - s_otaZip.fill;
+                if (copyLen > len)
+                {
+                    copyLen = len;
+                }
+                memcpy(&s_otaZipBuf[s_otaZip.fill], p_data, copyLen);
+                s_otaZip.fill += copyLen;
+                p_data += copyLen;
+                len -= copyLen;
+                if (s_otaZip.state == APP_OTA_ZIP_HDR)
+                {
+                    if (s_otaZip.fill == APP_OTA_ZIP_HDR_LEN)
+                    {
+                        APP_OTA_ZipHeader();
+                    }
+                }
+                else if (s_otaZip.fill == (s_otaZip.len & APP_OTA_ZIP_LEN_MASK))
+                {
+                    APP_OTA_ZipBlock();
+                    s_otaZip.fill = 0;
+                    s_otaZip.len = 0;
+                    s_otaZip.state = (--s_otaZip.blocks != 0) ? APP_OTA_ZIP_LEN : APP_OTA_ZIP_PAD;
+                }
+            }
+            break;
+
+            case APP_OTA_ZIP_LEN:
+            {
+                s_otaZip.len |= (uint16_t)(*p_data++ << (8 * s_otaZip.fill));
+                len--;
+                if (++s_otaZip.fill == 2)
+                {
+                    s_otaZip.fill = 0;
+                    if (((s_otaZip.len & APP_OTA_ZIP_LEN_MASK) == 0) ||
+                        ((s_otaZip.len & APP_OTA_ZIP_LEN_MASK) > sizeof(s_otaZipBuf)))
+                    {
+                        s_otaStream.error = true;
+                    }
+                    s_otaZip.state = APP_OTA_ZIP_DATA;
+                }
+            }
+            break;
+
+            case APP_OTA_ZIP_RAW:
+                return APP_OTA_HDL_StreamWrite(p_data, len);
+
+            default:
+                len = 0;                // Padding of the file
+            break;
+        }
+    }
+    return !s_otaStream.error;
+}
+#else
+static bool APP_OTA_StreamFeed(const uint8_t *p_data, uint16_t len)
+{
+    return APP_OTA_HDL_StreamWrite(p_data, len);
+}
+#endif
+
+void APP_OTA_HDL_FlashTask(void)
+{
+    s_otaStream.flashPosted = false;
+    if (APP_OTA_FlashStep())
+    {
+        APP_OTA_PostFlash();
+    }
+}
+#else
+bool APP_OTA_HDL_StreamWrite(const uint8_t *p_data, uint16_t len)
+{
+    (void)p_data;
+    (void)len;
+    return false;
+}
+
+static bool APP_OTA_StreamFeed(const uint8_t *p_data, uint16_t len)
+{
+    return APP_OTA_HDL_StreamWrite(p_data, len);
+}
+
+void APP_OTA_HDL_FlashTask(void)
+{
+}
+#endif
+
+#if APP_OTA_BCAST_ON == 1
+void APP_OTA_HDL_Stage(bool stage)
+{
+    s_otaStage = stage;
+}
+
+uint32_t APP_OTA_HDL_GetStaged(void)
+{
+    return s_otaStagedSize;
+}
+
+/* Read the slot, the 1st row of a staged image comes from RAM */
+bool APP_OTA_HDL_FlashRead(uint32_t offset, uint8_t *p_data, uint16_t len)
+{
+    uint16_t hdrLen = 0;
+
+    if ((offset + len) > MW_DFU_MAX_SIZE_FW_IMAGE)
+    {
+        return false;
+    }
+    if ((s_otaStagedSize != 0) && (offset < APP_OTA_ROW_SIZE))
+    {
+        hdrLen = (uint16_t)(((APP_OTA_ROW_SIZE - offset) < len) ? (APP_OTA_ROW_SIZE - offset) : len);
+        memcpy(p_data, (const uint8_t *)s_otaHdrRow + offset, hdrLen);
+    }
+    memcpy(&p_data[hdrLen], (const void *)(APP_OTA_FLASH_ADDR + offset + hdrLen), len - hdrLen);   // Memory mapped
+    return true;
+}
+
+bool APP_OTA_HDL_FlashErase(uint32_t offset)
+{
+    if ((offset % APP_OTA_PAGE_SIZE) != 0)
+    {
+        return false;
+    }
+    (void)NVM_PageErase(APP_OTA_FLASH_ADDR + offset);
+    while (NVM_IsBusy())
+    {
+    }
+    return (NVM_ErrorGet() == NVM_ERROR_NONE);
+}
+
+/* Program quad words, the slot must be erased */
+bool APP_OTA_HDL_FlashWrite(uint32_t offset, const uint8_t *p_data, uint16_t len)
+{
+    uint32_t quad[4];
+
+    if (((offset % sizeof(quad)) != 0) || ((len % sizeof(quad)) != 0))
+    {
+        return false;
+    }
+    for (; len != 0; len -= sizeof(quad), offset += sizeof(quad), p_data += sizeof(quad))
+    {
+        memcpy(quad, p_data, sizeof(quad));
+        (void)NVM_QuadWordWrite(quad, APP_OTA_FLASH_ADDR + offset);
+        while (NVM_IsBusy())
+        {
+        }
+        if (NVM_ErrorGet() != NVM_ERROR_NONE)
+        {
+            APP_LOG(APP_LOG_OTA_FLASH_ERR, NVM_ErrorGet(), APP_OTA_FLASH_ADDR + offset);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool APP_OTA_HDL_BcastFrame(const uint8_t *p_frame, uint8_t len)
+{
+    APP_OTA_BcastRx_T *p_rx = &s_otaBcastRx;
+    uint32_t ms;
+
+    if (!APP_OTA_BcastIsFrame(p_frame, len))
+    {
+        return false;
+    }
+    if ((APP_OTA_HDL_GetOTAMode() == APP_OTA_MODE_OTA) || s_otaStream.active || (s_otaStagedSize != 0))
+    {   // The slot is taken by a BLE update or by the image this device sends
+        return true;
+    }
+    switch (APP_OTA_BcastRxFrame(p_rx, p_frame, len))
+    {
+        case APP_OTA_BCAST_RES_START:
+            s_otaStartTick = APP_OTA_Now();
+            APP_LOG(APP_LOG_OTA_BCAST_START, p_rx->imgId, p_rx->size, p_rx->gens, p_rx->crc);
+            break;
+
+        case APP_OTA_BCAST_RES_GEN:
+            if ((p_rx->done % 32) == 0)
+            {
+                APP_LOG(APP_LOG_OTA_BCAST_PROGRESS, p_rx->done, p_rx->gens, p_rx->frames, p_rx->useful);
+            }
+            break;
+
+        case APP_OTA_BCAST_RES_DONE:
+            ms = APP_OTA_Now() - s_otaStartTick;
+            APP_LOG(APP_LOG_OTA_BCAST_DONE, p_rx->imgId, p_rx->frames, p_rx->useful, ms);
+            if (APP_ImageValidation() == true)
+            {   // Same as the end of a BLE update
+                APP_OTA_HDL_SetOTAMode(APP_OTA_MODE_OTA);
+                APP_OTA_HDL_Reset();
+            }
+            else
+            {
+                APP_LOG(APP_LOG_OTA_BCAST_FAIL, p_rx->imgId, 1);
+            }
+            break;
+
+        case APP_OTA_BCAST_RES_FAIL:
+            APP_LOG(APP_LOG_OTA_BCAST_FAIL, p_rx->imgId, 0);
+            break;
+
+        default:
+            break;
+    }
+    return true;
+}
+#else
+void APP_OTA_HDL_Stage(bool stage)
+{
+    (void)stage;
+}
+
+uint32_t APP_OTA_HDL_GetStaged(void)
+{
+    return 0;
+}
+
+bool APP_OTA_HDL_BcastFrame(const uint8_t *p_frame, uint8_t len)
+{
+    (void)p_frame;
+    (void)len;
+    return false;
+}
+#endif
+
+/* Log the transfer rate and, for a streamed image, the digest of the bytes received */
+static void APP_OTA_Report(void)
+{
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    uint32_t words[SHA256_DIGEST_SIZE / 4];
+    uint32_t ms = APP_OTA_Now() - s_otaStartTick;
+    uint8_t i;
+
+    APP_LOG(APP_LOG_OTA_RATE, s_otaBytes, ms, (ms != 0) ? ((s_otaBytes * 1000UL) / ms) : 0, s_otaStreamed);
+    if (!s_otaStreamed)
+    {
+        return;                         // The profile programs the fragments itself and does not pass them
+    }
+    CRYPT_SHA256_Finalize(&s_otaSha, digest);
+    for (i = 0; i < (SHA256_DIGEST_SIZE / 4); i++)
+    {
+        words[i] = ((uint32_t)digest[i * 4] << 24) | ((uint32_t)digest[(i * 4) + 1] << 16) |
+                   ((uint32_t)digest[(i * 4) + 2] << 8) | digest[(i * 4) + 3];
+    }
+    APP_LOG(APP_LOG_OTA_SHA256, words[0], words[1], words[2], words[3], words[4], words[5], words[6], words[7]);
+}
+
 void APP_OTA_HDL_SetOTAMode(APP_OTA_HDL_Mode_T mode)
 {
     s_OTAMode = mode;
@@ -149,19 +741,20 @@ void APP_OTA_HDL_Prepare(uint16_t OTAHandle)
         BLE_DM_ConnectionParameterUpdate(s_pOTAConnLink->connData.handle, &params);
     }
 
-    APP_TIMER_SetTimer(APP_TIMER_OTA_TIMEOUT, APP_TIMER_5S, false);
+    APP_OTA_Kick();
 }
 
 void APP_OTA_HDL_Start(void)
 {
-    APP_TIMER_StopTimer(APP_TIMER_OTA_TIMEOUT);
-    APP_TIMER_SetTimer(APP_TIMER_OTA_TIMEOUT, APP_TIMER_5S, false);
+    APP_OTA_Kick();
+    s_otaStartTick = s_otaLastTick;
+    s_otaBytes = 0;
+    (void)CRYPT_SHA256_Initialize(&s_otaSha);
 }
 
 void APP_OTA_HDL_Updating(void)
 {
-    APP_TIMER_StopTimer(APP_TIMER_OTA_TIMEOUT);
-    APP_TIMER_SetTimer(APP_TIMER_OTA_TIMEOUT, APP_TIMER_5S, false);
+    s_otaLastTick = APP_OTA_Now();
 }
 
 void APP_OTA_HDL_Complete(void)
@@ -177,6 +770,10 @@ void APP_OTA_HDL_ErrorHandle(uint16_t OTAHandle)
 
     APP_TIMER_StopTimer(APP_TIMER_OTA_TIMEOUT);
     APP_OTA_HDL_SetOTAMode(APP_OTA_MODE_IDLE);
+#if APP_OTA_STREAM_ON == 1
+    APP_OTA_FlashWait();
+    s_otaStream.active = false;
+#endif
     
     if (OTAHandle)
     {
@@ -201,7 +798,11 @@ void APP_OTA_HDL_Reset(void)
 
 void APP_OTA_Timeout_Handler(void)
 {
-    if (APP_OTA_HDL_GetOTAMode() == APP_OTA_MODE_OTA)
+    if (APP_OTA_HDL_GetOTAMode() != APP_OTA_MODE_OTA)
+    {
+        APP_TIMER_StopTimer(APP_TIMER_OTA_TIMEOUT);
+    }
+    else if ((APP_OTA_Now() - s_otaLastTick) >= APP_OTA_TIMEOUT_MS)
         {
             APP_OTA_HDL_ErrorHandle(s_pOTAConnLink->connData.handle);
         }
@@ -228,6 +829,7 @@ void APP_OTA_EvtHandler(BLE_OTAPS_Event_T *p_event)
             /* TODO: implement your application code.*/
             uint8_t appVerison[BLE_ATT_DEFAULT_MTU_LEN] = {'\0'};
             uint16_t result = APP_RES_FAIL, appVerisonLength = BLE_ATT_DEFAULT_MTU_LEN;			
+            bool allow;
             BLE_OTAPS_DevInfo_T devInfo = {0};
 
             result = GATTS_GetHandleValue(DIS_HDL_CHARVAL_FW_REV, &appVerison[0], &appVerisonLength);
@@ -237,12 +839,31 @@ void APP_OTA_EvtHandler(BLE_OTAPS_Event_T *p_event)
             }
             
             s_connHandle = p_event->eventField.evtUpdateReq.connHandle;
+            s_otaStreamed = (p_event->eventField.evtUpdateReq.fwImageFileType == BLE_OTAPS_IMG_FILE_TYPE_APP);
+#if APP_OTA_STREAM_ON == 1
+            allow = (!s_otaStreamed || APP_OTA_StreamInit(p_event->eventField.evtUpdateReq.fwImageSize));
+#else
+            allow = !s_otaStreamed;
+#endif
+#if APP_OTA_BCAST_ON == 1
+            allow = allow && (s_otaStreamed || !s_otaStage);    // Only a streamed image can be staged
+            if (allow)
+            {   // The slot is overwritten
+                s_otaStagedSize = 0;
+                APP_OTA_BcastRxReset(&s_otaBcastRx);
+            }
+#endif
 			
+            if (allow)
             {
                 APP_OTA_HDL_SetOTAMode(APP_OTA_MODE_OTA);
                 BLE_OTAPS_UpdateResponse(s_connHandle, true, &devInfo);
                 APP_OTA_HDL_Prepare(s_connHandle);
-            }            
+            }
+            else
+            {
+                BLE_OTAPS_UpdateResponse(s_connHandle, false, &devInfo);
+            }
         }
         break;
         
@@ -258,6 +879,23 @@ void APP_OTA_EvtHandler(BLE_OTAPS_Event_T *p_event)
         {
             /* TODO: implement your application code.*/
             APP_OTA_HDL_Updating();            
+            s_otaBytes += p_event->eventField.evtUpdatingInd.length;
+        }
+        break;
+
+        case BLE_OTAPS_EVT_UPDATING_REQ:
+        {
+            /* Streamed image: the fragment is acknowledged once it is in a page buffer, so the client sends the next
+             * one while the previous page is programmed. */
+            bool ok;
+
+            APP_OTA_HDL_Updating();
+            s_otaBytes += p_event->eventField.evtUpdatingInd.length;
+            (void)CRYPT_SHA256_DataAdd(&s_otaSha, p_event->eventField.evtUpdatingInd.p_fragment,
+                                       p_event->eventField.evtUpdatingInd.length);
+            ok = APP_OTA_StreamFeed(p_event->eventField.evtUpdatingInd.p_fragment,
+                                    p_event->eventField.evtUpdatingInd.length);
+            BLE_OTAPS_UpdatingResponse(ok);
         }
         break;
         
@@ -267,6 +905,24 @@ void APP_OTA_EvtHandler(BLE_OTAPS_Event_T *p_event)
             if (p_event->eventField.evtCompleteInd.errStatus == false)
             {
                 APP_OTA_HDL_Complete();
+#if APP_OTA_STREAM_ON == 1
+                if (s_otaStreamed && !APP_OTA_StreamFinish())
+                {
+                    BLE_OTAPS_CompleteResponse(false);
+                    APP_OTA_HDL_ErrorHandle(s_connHandle);
+                    break;
+                }
+#endif
+#if APP_OTA_BCAST_ON == 1
+                if (s_otaStagedSize != 0)
+                {   // Kept for the broadcast, no validation nor reboot.  Back to idle as after an error.
+                    APP_OTA_Report();
+                    BLE_OTAPS_CompleteResponse(true);
+                    APP_OTA_HDL_ErrorHandle(s_connHandle);
+                    break;
+                }
+#endif
+                APP_OTA_Report();
                 if (APP_ImageValidation() == true)
                 {
                     BLE_OTAPS_CompleteResponse(true);
@@ -307,6 +963,12 @@ void APP_OTA_HDL_Init(void)
 					
 
     APP_OTA_HDL_SetOTAMode(APP_OTA_MODE_IDLE);
+#if APP_OTA_STREAM_ON == 1
+    s_otaStream.prog = APP_OTA_PAGE_NONE;
+#endif
+#if APP_OTA_BCAST_ON == 1
+    APP_OTA_BcastRxReset(&s_otaBcastRx);
+#endif
 
 }	
 /*******************************************************************************
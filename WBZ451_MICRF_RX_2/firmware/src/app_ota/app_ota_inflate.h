@@ -0,0 +1,91 @@
+/*******************************************************************************
+  Application OTA Inflate Header File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_ota_inflate.h
+
+  Summary:
+    This file contains the zlib block decoder of the compressed OTA images.
+
+  Description:
+    Decodes one zlib stream (RFC 1950/1951) held in RAM into a RAM buffer, with
+    the same contract as CRYPT_HUFFMAN_DeCompress().  It is used when the crypto
+    library is built without HAVE_LIBZ.  There is no sliding window: a stream may
+    only refer back to bytes it decoded itself, which holds for the blocks made
+    by host_sim/ota_pack.py since every block is a stream of its own.
+ *******************************************************************************/
+
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2023 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+#ifndef APP_OTA_INFLATE_H
+#define APP_OTA_INFLATE_H
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdint.h>
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Function Prototypes
+// *****************************************************************************
+// *****************************************************************************
+
+/*******************************************************************************
+  Function:
+     int32_t APP_OTA_Inflate(uint8_t *p_out, uint32_t outSz, const uint8_t *p_in, uint32_t inSz)
+
+  Summary:
+     Decompresses a zlib stream
+
+  Description:
+     Decodes the stored, fixed and dynamic Huffman blocks of the stream and
+     checks its Adler-32.  The decoder tables are static, about 1 KB.
+
+  Precondition:
+     Not reentrant.
+
+  Parameters:
+    p_out - Destination buffer.
+    outSz - Size of the destination buffer.
+    p_in  - zlib stream.
+    inSz  - Size of the zlib stream.
+
+  Returns:
+    Bytes stored in p_out, or -1 if the stream is corrupted or does not fit.
+
+*/
+int32_t APP_OTA_Inflate(uint8_t *p_out, uint32_t outSz, const uint8_t *p_in, uint32_t inSz);
+
+#endif  // End of APP_OTA_INFLATE_H
+/*******************************************************************************
+ End of File
+ */
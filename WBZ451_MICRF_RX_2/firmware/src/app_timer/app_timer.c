@@ -129,14 +129,14 @@ static void APP_TIMER_OneShotTimerExpiredHandle(TimerHandle_t xTimer)
             appMsg.msgId = APP_TIMER_ADV_CTRL_MSG;
         }
         break;
-        case APP_TIMER_ID_4:
+        case APP_TIMER_BLE_CONN:
         {
-           //appMsg.msgId = APP_TIMER_ID_4_MSG;
+            appMsg.msgId = APP_TIMER_BLE_CONN_MSG;
         }
         break;
-        case APP_TIMER_ID_5:
+        case APP_TIMER_ADV_TLM:
         {
-           //appMsg.msgId = APP_TIMER_ID_5_MSG;
+            appMsg.msgId = APP_TIMER_ADV_TLM_MSG;
         }
         break;	
 
@@ -177,14 +177,14 @@ static void APP_TIMER_PeriodicTimerExpiredHandle(TimerHandle_t xTimer)
             appMsg.msgId = APP_TIMER_ADV_CTRL_MSG;
         }
         break;
-        case APP_TIMER_ID_4:
+        case APP_TIMER_BLE_CONN:
         {
-           //appMsg.msgId = APP_TIMER_ID_4_MSG;
+            appMsg.msgId = APP_TIMER_BLE_CONN_MSG;
         }
         break;
-        case APP_TIMER_ID_5:
+        case APP_TIMER_ADV_TLM:
         {
-           //appMsg.msgId = APP_TIMER_ID_5_MSG;
+            appMsg.msgId = APP_TIMER_ADV_TLM_MSG;
         }
         break;
         default:
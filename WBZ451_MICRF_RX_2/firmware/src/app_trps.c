@@ -52,6 +52,8 @@
 #include "ble_trsps/ble_trsps.h"
 #include "app_trps.h"
 #include "app_error_defs.h"
+#include "app_ble_conn_handler.h"
+#include "app.h"
 
 
 // *****************************************************************************
@@ -59,8 +61,15 @@
 // Section: Local Variables
 // *****************************************************************************
 // *****************************************************************************
-static APP_TRPS_ConnList_T       s_trpsConnList_t;
+static APP_TRPS_ConnList_T       s_trpsConnList[BLE_GAP_MAX_LINK_NBR];
+static bool             s_ntfFlushPosted;                       /**< APP_MSG_TRPS_NTF_FLUSH is in the application queue */
+static uint16_t         s_rspConnHandle;                        /**< Link the responses go to */
 static APP_TRPS_Ctrl_T  s_trpsCtrl[APP_TRPS_CTRL_LST_SIZE];
+static uint8_t          s_ntfBuf[APP_TRPS_NTF_BUF_LEN];
+static uint8_t          s_opcodeIdx[256];                       /**< s_trpsCtrl[] index + 1 of each opcode, 0: none */
+static uint8_t          s_cmdBuf[APP_TRPS_NTF_BUF_LEN + 1];     /**< One command of a batch, [Opcode][Length][CtrlID][Data] */
+static uint8_t          s_rspBuf[APP_TRPS_NTF_BUF_LEN];
+static uint8_t          s_rspLen;
 
 // *****************************************************************************
 // *****************************************************************************
@@ -74,25 +83,18 @@ static APP_TRPS_Ctrl_T  s_trpsCtrl[APP_TRPS_CTRL_LST_SIZE];
 // Section: Functions
 // *****************************************************************************
 // *****************************************************************************
-static uint16_t APP_TRPS_NotifyHandler(APP_TRPS_NotifyData_T* p_notify, uint8_t opcode);
-static uint16_t APP_TRPS_SendCmdRsp(APP_TRPS_CmdResp_T* p_resp, uint8_t opcode, uint8_t status);
 static void APP_ClearCtrlList(uint8_t opCode);
 static APP_TRPS_Ctrl_T *APP_GetFreeCtrlList(void);
 static APP_TRPS_Ctrl_T *APP_GetCtrlListByOpcode(uint8_t opCode);
-static uint16_t APP_TRPS_SendErrorRsp(uint8_t opcode, uint8_t RspID, uint8_t status);
 
 static void APP_ClearCtrlList(uint8_t opCode)
 {
-    uint8_t i;
+    APP_TRPS_Ctrl_T *p_trpsCtrl = APP_GetCtrlListByOpcode(opCode);
 
-    for (i = 0; i < APP_TRPS_CTRL_LST_SIZE; i++)
+    if (p_trpsCtrl != NULL)
     {
-        if (s_trpsCtrl[i].opcode == opCode)
-        {
-            memset((uint8_t *)(&s_trpsCtrl[i]), 0, sizeof(APP_TRPS_Ctrl_T));
-
-            s_trpsCtrl[i].opcode= 0;
-        }
+        memset((uint8_t *)p_trpsCtrl, 0, sizeof(APP_TRPS_Ctrl_T));
+        s_opcodeIdx[opCode] = 0;
     }
 }
 
@@ -111,28 +113,144 @@ static APP_TRPS_Ctrl_T *APP_GetFreeCtrlList(void)
 }
 
 static APP_TRPS_Ctrl_T *APP_GetCtrlListByOpcode(uint8_t opCode)
+{
+    if (s_opcodeIdx[opCode] == 0)
+    {
+        return NULL;
+    }
+    return (&s_trpsCtrl[s_opcodeIdx[opCode] - 1]);
+}
+
+static APP_TRPS_CmdResp_T *APP_GetCmdRespByCtrlId(APP_TRPS_Ctrl_T *p_trpsCtrl, uint8_t ctrlID)
+{
+    uint8_t off = ctrlID - p_trpsCtrl->cmdBase;
+
+    if ((ctrlID < p_trpsCtrl->cmdBase) || (off >= APP_TRPS_CMD_SPAN) || (p_trpsCtrl->cmdIdx[off] == 0))
+    {
+        return NULL;
+    }
+    return (&p_trpsCtrl->appTrpsCmdResp[p_trpsCtrl->cmdIdx[off] - 1]);
+}
+
+/* Returns the TRPS state of a link, NULL if its control notifications are off.  connHandle 0 returns a free entry. */
+static APP_TRPS_ConnList_T *APP_TRPS_GetConn(uint16_t connHandle)
 {
     uint8_t i;
 
-    for (i = 0; i < APP_TRPS_CTRL_LST_SIZE; i++)
+    for (i = 0; i < BLE_GAP_MAX_LINK_NBR; i++)
     {
-        if (s_trpsCtrl[i].opcode == opCode && opCode != 0)
-        {
-            return (&s_trpsCtrl[i]);
-        }
+        if (s_trpsConnList[i].connHandle == connHandle)
+            return (&s_trpsConnList[i]);
     }
     return NULL;
 }
 
+/* Longest vendor command payload of the ATT MTU of a link, less the opcode */
+static uint16_t APP_TRPS_MaxPayloadLen(uint16_t connHandle)
+{
+    APP_BLE_ConnList_T *p_bleConn = APP_GetConnInfoByConnHandle(connHandle);
+    uint16_t maxLen = BLE_ATT_DEFAULT_MTU_LEN - ATT_HANDLE_VALUE_HEADER_SIZE - 1;
+
+    if ((connHandle != 0) && p_bleConn && (p_bleConn->mgr.attMtu > BLE_ATT_DEFAULT_MTU_LEN))
+        maxLen = p_bleConn->mgr.attMtu - ATT_HANDLE_VALUE_HEADER_SIZE - 1;
+    if (maxLen > APP_TRPS_NTF_BUF_LEN)
+        maxLen = APP_TRPS_NTF_BUF_LEN;
+    return maxLen;
+}
+
+/* Send the responses collected by APP_TRPS_RspAppend() to the link of the command */
+static uint16_t APP_TRPS_RspSend(uint8_t opcode)
+{
+    uint16_t result = APP_RES_SUCCESS;
+
+    if (s_rspLen != 0)
+    {
+        result = BLE_TRSPS_SendVendorCommand(s_rspConnHandle, opcode, s_rspLen, s_rspBuf);
+        if (result == APP_RES_SUCCESS)
+            APP_BLE_ConnMgrTx(s_rspConnHandle, s_rspLen);
+        s_rspLen = 0;
+    }
+    return result;
+}
+
+/* Add a response [Length][RspID][Status][Payload] to the PDU, which is sent first if the response does not fit */
+static void APP_TRPS_RspAppend(uint8_t opcode, uint8_t rspId, uint8_t status, const uint8_t *p_payload, uint8_t len)
+{
+    uint16_t recLen = (uint16_t)len + APP_TRPS_CTRL_RSP_ID_STATUS_LEN + 1;
+
+    if ((s_rspLen + recLen) > APP_TRPS_MaxPayloadLen(s_rspConnHandle))
+        APP_TRPS_RspSend(opcode);
+    s_rspBuf[s_rspLen] = len + APP_TRPS_CTRL_RSP_ID_STATUS_LEN;    // Length byte includes size of RspID and Status
+    s_rspBuf[s_rspLen + 1] = rspId;
+    s_rspBuf[s_rspLen + 2] = status;
+    if (len != 0)
+        memcpy(&s_rspBuf[s_rspLen + 3], p_payload, len);
+    s_rspLen += recLen;
+}
+
+/* Run one command, p_cmd is [Opcode][Length][CtrlID][Data] */
+static void APP_TRPS_RunCmd(APP_TRPS_Ctrl_T *p_trpsCtrl, uint8_t *p_cmd)
+{
+    APP_TRPS_CmdResp_T *p_resp = APP_GetCmdRespByCtrlId(p_trpsCtrl, p_cmd[2]);
+    uint8_t status = SUCCESS;
+
+    if (p_resp == NULL)
+    {
+        APP_TRPS_RspAppend(p_trpsCtrl->opcode, p_cmd[2], INVALID_PARAMETER, NULL, 0);
+        return;
+    }
+    if (p_resp->fnPtr)
+        status = p_resp->fnPtr(p_cmd);
+    APP_TRPS_RspAppend(p_trpsCtrl->opcode, p_resp->RspId, status, p_resp->p_Payload, p_resp->Length);
+}
+
+/* True if the write holds more than one [Length][CtrlID][Data] command and the chain ends exactly at the end of the
+ * write.  Length includes the CtrlID. */
+static bool APP_TRPS_IsBatch(const uint8_t *p_payload, uint16_t len)
+{
+    uint16_t off = 1;
+    uint8_t cmdCnt = 0;
+
+    while ((off + 2) <= len)
+    {
+        if (p_payload[off] == 0)
+            return false;
+        off += 1 + p_payload[off];
+        cmdCnt++;
+    }
+    return ((off == len) && (cmdCnt > 1));
+}
+
 /* Init TRPS data structure */
 uint16_t APP_TRPS_Init(uint8_t opcode, APP_TRPS_CmdResp_T *p_cmd, APP_TRPS_NotifyData_T *p_ntfy,uint8_t cmdRspSize,uint8_t ntfySize)
 {
     APP_TRPS_Ctrl_T *p_trpsCtrl = NULL;
-    
+    uint8_t idx, cmdBase = 0xFF;
+
+    if ((opcode == 0) || (s_opcodeIdx[opcode] != 0) || (ntfySize > APP_TRPS_NTF_MAX))
+        return APP_RES_FAIL;
+    for (idx = 0; idx < cmdRspSize; idx++)
+    {
+        if (p_cmd[idx].CmdId < cmdBase)
+            cmdBase = p_cmd[idx].CmdId;
+    }
+    for (idx = 0; idx < cmdRspSize; idx++)
+    {
+        if ((p_cmd[idx].CmdId - cmdBase) >= APP_TRPS_CMD_SPAN)
+            return APP_RES_FAIL;
+    }
+
     p_trpsCtrl = APP_GetFreeCtrlList();
     
     if(p_trpsCtrl != NULL)
     {
+        memset(p_trpsCtrl->cmdIdx, 0, sizeof(p_trpsCtrl->cmdIdx));
+        p_trpsCtrl->cmdBase = cmdBase;
+        for (idx = 0; idx < cmdRspSize; idx++)
+        {
+            p_trpsCtrl->cmdIdx[p_cmd[idx].CmdId - cmdBase] = idx + 1;
+        }
+        s_opcodeIdx[opcode] = (uint8_t)(p_trpsCtrl - s_trpsCtrl) + 1;
         p_trpsCtrl->appTrpsCmdResp = p_cmd;
         p_trpsCtrl->appTrpsNotify = p_ntfy;
         p_trpsCtrl->opcode = opcode;
@@ -153,66 +271,81 @@ void APP_TRPS_deInit(uint8_t opCode)
 /* Do the BLE Sensor specific on connection  */
 void APP_TRPS_ConnEvtProc(BLE_GAP_Event_T *p_event)
 {
-   // s_trpsConnList_t.connHandle = p_event->eventField.evtConnect.connHandle;
+    // The link gets its entry when the central turns the control notifications on (BLE_TRSPS_EVT_CTRL_STATUS)
 }
 
 /* Do the BLE Sensor specific on disconnection  */
 void APP_TRPS_DiscEvtProc(uint16_t connHandle)
 {
-    if (s_trpsConnList_t.connHandle == connHandle)
+    APP_TRPS_ConnList_T *p_trpsConn = APP_TRPS_GetConn(connHandle);
+
+    if ((connHandle != 0) && (p_trpsConn != NULL))
     {
-        s_trpsConnList_t.connHandle = 0;
+        memset((uint8_t *)p_trpsConn, 0, sizeof(APP_TRPS_ConnList_T));
     }
 }
 
-/* TRPS Event handler called from BLE Stack */
+/* TRPS Event handler called from BLE Stack.  A write can carry several commands of one opcode,
+ * [Opcode]([Length][CtrlID][Data])..., run in order and answered with as few PDUs of [Length][RspID][Status][Payload]
+ * records as the MTU allows.  Any other write is run as one command, as before. */
 void APP_TRPS_EventHandler(BLE_TRSPS_Event_T *p_event)
 { 
-    uint8_t idx=0, status = SUCCESS;
-    bool cmdFound = false;
-    APP_TRPS_CtrlCmd_T *p_Cmd = (APP_TRPS_CtrlCmd_T*)p_event->eventField.onVendorCmd.p_payLoad;
+    uint8_t *p_payload = p_event->eventField.onVendorCmd.p_payLoad;
+    uint16_t len = p_event->eventField.onVendorCmd.length, off;
     APP_TRPS_Ctrl_T *p_trpsCtrl = NULL;
+    APP_TRPS_ConnList_T *p_trpsConn = NULL;
     
     switch(p_event->eventId)
     {
         case BLE_TRSPS_EVT_CTRL_STATUS:
-        {
-            s_trpsConnList_t.connHandle = p_event->eventField.onCtrlStatus.connHandle;
+        {   // Each central that turns the control notifications on gets its own entry
+            if (p_event->eventField.onCtrlStatus.connHandle == 0)
+                break;
+            p_trpsConn = APP_TRPS_GetConn(p_event->eventField.onCtrlStatus.connHandle);
+            if (p_event->eventField.onCtrlStatus.status == BLE_TRSPS_STATUS_CTRL_OPENED)
+            {
+                if ((p_trpsConn == NULL) && ((p_trpsConn = APP_TRPS_GetConn(0)) != NULL))
+                {
+                    memset((uint8_t *)p_trpsConn, 0, sizeof(APP_TRPS_ConnList_T));
+                    p_trpsConn->connHandle = p_event->eventField.onCtrlStatus.connHandle;
+                }
+            }
+            else if (p_trpsConn != NULL)
+            {
+                memset((uint8_t *)p_trpsConn, 0, sizeof(APP_TRPS_ConnList_T));
+            }
         }
         break;
         
         case BLE_TRSPS_EVT_VENDOR_CMD:
         {
-            p_trpsCtrl = APP_GetCtrlListByOpcode(p_Cmd->Opcode);
-            if ((s_trpsConnList_t.connHandle == p_event->eventField.onVendorCmd.connHandle)
-                && (p_trpsCtrl != NULL))
+            p_trpsCtrl = APP_GetCtrlListByOpcode(p_payload[0]);
+            s_rspConnHandle = p_event->eventField.onVendorCmd.connHandle;
+            s_rspLen = 0;
+            if (s_rspConnHandle != 0)
+                p_trpsConn = APP_TRPS_GetConn(s_rspConnHandle);
+            if ((p_trpsConn != NULL) && (p_trpsCtrl != NULL))
             {
-                s_trpsConnList_t.connHandle = p_event->eventField.onVendorCmd.connHandle;
-                
-                for(idx =0; idx<p_trpsCtrl->cmdRspSize; idx++)
+                if (APP_TRPS_IsBatch(p_payload, len))
                 {
-                    if(p_trpsCtrl->appTrpsCmdResp[idx].CmdId == p_Cmd->ctrlID)
-                    {
-                        cmdFound = true;
-                        break;
+                    for (off = 1; off < len; off += 1 + p_payload[off])
+                    {   // The handlers expect the opcode in front of the command
+                        s_cmdBuf[0] = p_payload[0];
+                        memcpy(&s_cmdBuf[1], &p_payload[off], 1 + p_payload[off]);
+                        APP_TRPS_RunCmd(p_trpsCtrl, s_cmdBuf);
                     }
-                }
-                
-                if(cmdFound)
-                {
-                    if(p_trpsCtrl->appTrpsCmdResp[idx].fnPtr)
-                        status = p_trpsCtrl->appTrpsCmdResp[idx].fnPtr(p_event->eventField.onVendorCmd.p_payLoad);
-                    APP_TRPS_SendCmdRsp(&p_trpsCtrl->appTrpsCmdResp[idx],p_trpsCtrl->opcode,status);                    
+                    p_trpsConn->cmdBatches++;
                 }
                 else
                 {
-                    APP_TRPS_SendErrorRsp(p_trpsCtrl->opcode,p_Cmd->ctrlID,INVALID_PARAMETER);
+                    APP_TRPS_RunCmd(p_trpsCtrl, p_payload);
                 }
-
+                APP_TRPS_RspSend(p_trpsCtrl->opcode);
             }
             else
             {
-                APP_TRPS_SendErrorRsp(p_Cmd->Opcode,0x00,OPCODE_NOT_SUPPORTED);
+                APP_TRPS_RspAppend(p_payload[0], 0x00, OPCODE_NOT_SUPPORTED, NULL, 0);
+                APP_TRPS_RspSend(p_payload[0]);
             }
         }
         break;
@@ -222,74 +355,160 @@ void APP_TRPS_EventHandler(BLE_TRSPS_Event_T *p_event)
     }
 }
 
-/* Send Control notify data through TRPS control service */
-uint16_t APP_TRPS_SendNotification(uint8_t opcode, uint8_t ntfyId)
+/* Returns the bit of a notification in ntfPending[*p_ctrl], false if it is not in the tables */
+static bool APP_TRPS_FindNotification(uint8_t opcode, uint8_t ntfyId, uint8_t *p_ctrl, uint32_t *p_bit)
 {
-    uint16_t result = APP_RES_FAIL;
-    APP_TRPS_Ctrl_T *p_trpsCtrl = NULL;
+    APP_TRPS_Ctrl_T *p_trpsCtrl = APP_GetCtrlListByOpcode(opcode);
     uint8_t idx;
-    
-    p_trpsCtrl = APP_GetCtrlListByOpcode(opcode);
-    
-    if(p_trpsCtrl != NULL){
-        for(idx =0; idx<p_trpsCtrl->ntfySize; idx++)
+
+    if (p_trpsCtrl == NULL)
+        return false;
+    for (idx = 0; idx < p_trpsCtrl->ntfySize; idx++)
+    {
+        if (p_trpsCtrl->appTrpsNotify[idx].NtfID == ntfyId)
         {
-            if(p_trpsCtrl->appTrpsNotify[idx].NtfID == ntfyId)
-            {
-                result = APP_TRPS_NotifyHandler(&p_trpsCtrl->appTrpsNotify[idx],opcode);            
-                break;
-            }
+            *p_ctrl = (uint8_t)(p_trpsCtrl - s_trpsCtrl);
+            *p_bit = 1UL << idx;
+            return true;
         }
     }
-    return result;
+    return false;
 }
 
-/* Send Control command response through TRPS control service */
-static uint16_t APP_TRPS_SendCmdRsp(APP_TRPS_CmdResp_T* p_resp, uint8_t opcode, uint8_t status)
+/* Queue a notification for the TRPS control service, on every central with the control notifications on.  The
+ * payload is read when the PDU is built, so a notification that is still pending is not queued twice and the centrals
+ * get the latest value.  The queue is sent by APP_TRPS_NotifyFlush() from APP_MSG_TRPS_NTF_FLUSH, after the events
+ * already in the application queue, so the notifications they raise share the PDU. */
+uint16_t APP_TRPS_SendNotification(uint8_t opcode, uint8_t ntfyId)
 {
-    uint8_t resp[20];
-    uint16_t result;
+    APP_Msg_T appMsg;
+    uint32_t bit;
+    uint8_t ctrl, i;
+    bool queued = false;
 
-    resp[0] = p_resp->Length+APP_TRPS_CTRL_RSP_ID_STATUS_LEN;  // Length byte includes size of RspID and Status
-    resp[1] = p_resp->RspId;
-    resp[2] = status;
-    
-    if(p_resp->Length != 0)
-        memcpy(&resp[3],p_resp->p_Payload,p_resp->Length);
+    if (!APP_TRPS_FindNotification(opcode, ntfyId, &ctrl, &bit))
+        return APP_RES_FAIL;
 
-    result = BLE_TRSPS_SendVendorCommand(s_trpsConnList_t.connHandle, opcode, resp[0]+1, resp);      
+    for (i = 0; i < BLE_GAP_MAX_LINK_NBR; i++)
+    {
+        if (s_trpsConnList[i].connHandle == 0)
+            continue;
+        if (s_trpsConnList[i].ntfPending[ctrl] & bit)
+            s_trpsConnList[i].ntfCoalesced++;
+        s_trpsConnList[i].ntfPending[ctrl] |= bit;
+        queued = true;
+    }
+    if (!queued)
+        return APP_RES_FAIL;
 
-    return result;
+    if (!s_ntfFlushPosted)
+    {
+        appMsg.msgId = APP_MSG_TRPS_NTF_FLUSH;
+        if (OSAL_QUEUE_Send(&appData.appQueue, &appMsg, 0) == OSAL_RESULT_TRUE)
+            s_ntfFlushPosted = true;
+    }
+    return APP_RES_SUCCESS;
 }
 
-/* Send Control command error response through TRPS control service */
-static uint16_t APP_TRPS_SendErrorRsp(uint8_t opcode, uint8_t RspID, uint8_t status)
+/* True while a notification queued by APP_TRPS_SendNotification() has not been sent to every central.  For a payload
+ * that must not change until it is sent (one page of a longer block). */
+bool APP_TRPS_IsNotificationPending(uint8_t opcode, uint8_t ntfyId)
 {
-    uint8_t resp[3];
-    uint16_t result;
+    uint32_t bit;
+    uint8_t ctrl, i;
 
-    resp[0] = APP_TRPS_CTRL_RSP_ID_STATUS_LEN;  // Length byte includes size of RspID and Status
-    resp[1] = RspID;
-    resp[2] = status;
+    if (!APP_TRPS_FindNotification(opcode, ntfyId, &ctrl, &bit))
+        return false;
+    for (i = 0; i < BLE_GAP_MAX_LINK_NBR; i++)
+    {
+        if ((s_trpsConnList[i].connHandle != 0) && (s_trpsConnList[i].ntfPending[ctrl] & bit))
+            return true;
+    }
+    return false;
+}
 
-    result = BLE_TRSPS_SendVendorCommand(s_trpsConnList_t.connHandle, opcode, resp[0]+1, resp);
+/* Build a PDU of the pending notifications of p_trpsConn in s_ntfBuf, as many as maxLen allows.  A notification
+ * that does not fit the MTU of the link is dropped.  Returns the notifications in the PDU, *p_len is its length. */
+static uint32_t APP_TRPS_NotifyBuild(APP_TRPS_ConnList_T *p_trpsConn, uint8_t ctrl, uint16_t maxLen, uint8_t *p_len)
+{
+    APP_TRPS_NotifyData_T *p_notify;
+    uint32_t sent = 0;
+    uint8_t idx, len = 0, recLen;
 
-    return result;
+    for (idx = 0; idx < s_trpsCtrl[ctrl].ntfySize; idx++)
+    {
+        if ((p_trpsConn->ntfPending[ctrl] & (1UL << idx)) == 0)
+            continue;
+        p_notify = &s_trpsCtrl[ctrl].appTrpsNotify[idx];
+        recLen = p_notify->Length + 2;          // Length byte includes size of NtyID
+        if (recLen > maxLen)
+        {   // Does not fit the MTU, as before the queue
+            p_trpsConn->ntfPending[ctrl] &= ~(1UL << idx);
+            continue;
+        }
+        if ((len + recLen) > maxLen)
+            break;
+        s_ntfBuf[len] = p_notify->Length + 1;
+        s_ntfBuf[len + 1] = p_notify->NtfID;
+        if (p_notify->Length != 0)
+            memcpy(&s_ntfBuf[len + 2], p_notify->p_Payload, p_notify->Length);
+        len += recLen;
+        sent |= (1UL << idx);
+#if APP_TRPS_NTF_PACK_ON == 0
+        break;
+#endif
+    }
+    *p_len = len;
+    return sent;
 }
 
-/* Send Control notify data through TRPS control service */
-static uint16_t APP_TRPS_NotifyHandler(APP_TRPS_NotifyData_T* p_notify, uint8_t opcode)
+/* Send the pending notifications, as many of an opcode per PDU as the ATT MTU allows.  A PDU is built once and sent
+ * to every central waiting for all the notifications in it, so the payloads are formatted once per change and not
+ * once per link.  Called from APP_MSG_TRPS_NTF_FLUSH and when the stack has TX buffers again
+ * (BLE_GAP_EVT_TX_BUF_AVAILABLE).  On full buffers the rest stays pending for that link, which is the back-pressure: a
+ * busy link merges updates instead of queuing them, without holding back the other links. */
+void APP_TRPS_NotifyFlush(void)
 {
-    uint8_t resp[20];
+    APP_TRPS_ConnList_T *p_trpsConn, *p_dst;
+    uint32_t sent, bits, busy = 0;              // Bit n: s_trpsConnList[n] has no TX buffers left
     uint16_t result;
+    uint8_t i, link, dst, len;
 
-    resp[0] = p_notify->Length+1; // Length byte includes size of NtyID
-    resp[1] = p_notify->NtfID;
-
-    if(p_notify->Length != 0)
-        memcpy(&resp[2],p_notify->p_Payload,p_notify->Length);
-
-    result = BLE_TRSPS_SendVendorCommand(s_trpsConnList_t.connHandle, opcode, resp[0]+1, resp);
+    s_ntfFlushPosted = false;
+    for (i = 0; i < APP_TRPS_CTRL_LST_SIZE; i++)
+    {
+        for (link = 0; link < BLE_GAP_MAX_LINK_NBR; link++)
+        {
+            p_trpsConn = &s_trpsConnList[link];
+            while ((p_trpsConn->connHandle != 0) && (p_trpsConn->ntfPending[i] != 0) && ((busy & (1UL << link)) == 0))
+            {
+                sent = APP_TRPS_NotifyBuild(p_trpsConn, i, APP_TRPS_MaxPayloadLen(p_trpsConn->connHandle), &len);
+                if (sent == 0)
+                    break;
 
-    return result;
+                /* The links before this one have nothing of this opcode left to send */
+                for (dst = link; dst < BLE_GAP_MAX_LINK_NBR; dst++)
+                {
+                    p_dst = &s_trpsConnList[dst];
+                    if ((p_dst->connHandle == 0) || (busy & (1UL << dst)) || ((p_dst->ntfPending[i] & sent) != sent)
+                        || (APP_TRPS_MaxPayloadLen(p_dst->connHandle) < len))
+                        continue;
+                    result = BLE_TRSPS_SendVendorCommand(p_dst->connHandle, s_trpsCtrl[i].opcode, len, s_ntfBuf);
+                    if ((result == APP_RES_OOM) || (result == APP_RES_NO_RESOURCE) || (result == APP_RES_BUSY))
+                    {   // Sent again on BLE_GAP_EVT_TX_BUF_AVAILABLE
+                        busy |= (1UL << dst);
+                        continue;
+                    }
+                    p_dst->ntfPending[i] &= ~sent;
+                    if (result == APP_RES_SUCCESS)
+                    {
+                        APP_BLE_ConnMgrTx(p_dst->connHandle, len);
+                        p_dst->ntfPdus++;
+                        for (bits = sent; bits != 0; bits >>= 1)
+                            p_dst->ntfRecords += (bits & 1U);
+                    }
+                }
+            }
+        }
+    }
 }
\ No newline at end of file
@@ -28,6 +28,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "dvr_prof.h"
 
 /* ****************************************************************************************************************** */
 /* GLOBAL DEFINTION */
@@ -45,6 +46,26 @@ typedef enum
     eMICRF_dataLength   // Failed due to data length error
 }eMICRF_response_t;
 
+/* Rate profiles.  Each profile sets the bit timer prescaler/period and the number of training bytes together.  The
+ * receiver (MICRF219A driver) uses the same enumeration, so both ends can be selected with the same index. */
+typedef enum
+{
+    eMICRF_RATE_500BPS = 0,     // Legacy rate, ~500bps (1k chips/s)
+    eMICRF_RATE_1KBPS,          // 1kbps (2k chips/s)
+    eMICRF_RATE_2KBPS,          // 2kbps (4k chips/s)
+    eMICRF_RATE_4KBPS,          // 4kbps (8k chips/s)
+    eMICRF_RATE_CNT             // Number of rate profiles, must be last
+}eMICRF_rate_t;
+
+/* Paths through MICRF_isr() that are profiled separately when DVR_PROF_ON is 1. */
+typedef enum
+{
+    eMICRF_PROF_BIT = 0,        // Next bit of a byte set on the pin
+    eMICRF_PROF_BYTE,           // Last bit of a byte, the next byte is loaded (and Manchester encoded)
+    eMICRF_PROF_GAP,            // Carrier off between copies or after the last one, end of a copy
+    eMICRF_PROF_CNT             // Number of paths, must be last
+}eMICRF_prof_t;
+
 /* ****************************************************************************************************************** */
 /* CONSTANTS */
 
@@ -77,6 +98,34 @@ void MICRF_init(void);
  */
 eMICRF_response_t MICRF_transmit(volatile void *pData, uint8_t cnt);
 
+/**
+ * MICRF_transmitBurst - Transmits copies of a packet of data from the timer interrupt, without blocking.  A gap of
+ *                       gapMs plus a random 0 to jitterMs is left between copies.
+ *
+ * @see:  MICRF_isTxIdle
+ *
+ * @param  void *pData - Pointer to data packet to send, must not change until MICRF_isTxIdle() returns true
+ * @param  uint8_t cnt - Number of bytes to send
+ * @param  uint8_t copies - Number of times the packet is sent, 1 or more
+ * @param  uint16_t gapMs - Gap between copies
+ * @param  uint16_t jitterMs - Largest random time added to each gap
+ * 
+ * @return eMICRF_response_t - Status, eMICRF_failure if busy
+ */
+eMICRF_response_t MICRF_transmitBurst(volatile void *pData, uint8_t cnt, uint8_t copies, uint16_t gapMs,
+                                      uint16_t jitterMs);
+
+/**
+ * MICRF_setRandomSeed - Seeds the random gap jitter, use something unique to the device
+ *
+ * @see:  MICRF_transmitBurst
+ *
+ * @param  uint32_t seed
+ * 
+ * @return None
+ */
+void MICRF_setRandomSeed( uint32_t seed );
+
 /**
  * MICRF_isTxIdle - Returns true if the TX is complete or false if not complete
  *
@@ -88,5 +137,61 @@ eMICRF_response_t MICRF_transmit(volatile void *pData, uint8_t cnt);
  */
 bool MICRF_isTxIdle( void );
 
+/**
+ * MICRF_setRateProfile - Selects the rate profile used by the next transmission
+ *
+ * @see:  eMICRF_rate_t
+ *
+ * @param  eMICRF_rate_t eRate - Rate profile to use
+ * 
+ * @return eMICRF_response_t - eMICRF_success, eMICRF_failure if busy or the profile is invalid
+ */
+eMICRF_response_t MICRF_setRateProfile( eMICRF_rate_t eRate );
+
+/**
+ * MICRF_getRateProfile - Returns the rate profile currently in use
+ *
+ * @see:  eMICRF_rate_t
+ *
+ * @param  None
+ * 
+ * @return eMICRF_rate_t - Current rate profile
+ */
+eMICRF_rate_t MICRF_getRateProfile( void );
+
+/**
+ * MICRF_getBitRate - Returns the nominal data bit rate of a rate profile
+ *
+ * @see:  eMICRF_rate_t
+ *
+ * @param  eMICRF_rate_t eRate - Rate profile
+ * 
+ * @return uint16_t - Nominal data rate in bits/second, 0 if the profile is invalid
+ */
+uint16_t MICRF_getBitRate( eMICRF_rate_t eRate );
+
+/**
+ * MICRF_getProfile - Returns the execution time statistics of a path through the bit timer ISR, in CPU cycles.
+ *
+ * @see:  DVR_PROF_ON
+ *
+ * @param  eMICRF_prof_t ePath - ISR path
+ * @param  profStat_t *pStat - Location to store the statistics
+ *
+ * @return bool - false if profiling isn't built in (DVR_PROF_ON is 0) or the path is invalid
+ */
+bool MICRF_getProfile( eMICRF_prof_t ePath, profStat_t *pStat );
+
+/**
+ * MICRF_clearProfile - Clears the execution time statistics of all paths.
+ *
+ * @see:  N/A
+ *
+ * @param  None
+ *
+ * @return None
+ */
+void MICRF_clearProfile( void );
+
 
 #endif  /* MICRF112_H */
@@ -39,7 +39,10 @@
 /* ****************************************************************************************************************** */
 /* MACRO DEFINITIONS */
 
-#define TX_PROTOCOLVER  ((uint8_t)1)
+#define TX_PROTOCOLVER      ((uint8_t)1)
+#define TX_PROTOCOLVER_FRAG ((uint8_t)2)    /* Packet is a fragment of a message */
+#define TX_PROTOCOLVER_SEQ  ((uint8_t)3)    /* Same as TX_PROTOCOLVER, the 1st data byte is a sequence number */
+#define TX_FRAG_HDR_SIZE    ((uint8_t)2)    /* [message ID][index:4 | count - 1:4] */
 
 // </editor-fold>
 
@@ -57,6 +60,39 @@ typedef struct
 }txPacket_t;                    // Packet of information to be sent to the receiver.  Notice the structure is "packed".
 
 #pragma pack()
+
+typedef struct
+{
+    uint8_t     data[TX_MESSAGE_MAX_SIZE];  // Copy of the message
+    uint16_t    len;                        // Number of bytes in the message
+    uint8_t     msgId;                      // Incremented for every message
+    uint8_t     fragIdx;                    // Next fragment to send
+    uint8_t     fragCnt;                    // Number of fragments in the message
+}txMessage_t;                               // Message being sent in fragments
+
+typedef struct
+{
+    uint8_t     copies;                     // Times each packet is sent
+    uint16_t    gapMs;                      // Gap between copies
+    uint16_t    jitterMs;                   // Largest random time added to each gap
+}txRedundancy_t;                            // Repeats of a packet
+
+#if TX_QUEUE_ON == 1
+typedef struct
+{
+    serialNum_t serialNum;                  // Serial number sent with the packet
+    uint8_t     cnt;                        // Number of data bytes
+    uint8_t     copies;                     // Times the packet is sent, TX_COPIES_DEFAULT = redundancy_.copies
+    uint8_t     data[TX_DATA_MAX_SIZE];     // Data to be sent
+}txQueueEntry_t;                            // Packet waiting in a queue
+
+typedef struct
+{
+    txQueueEntry_t entry[TX_QUEUE_DEPTH];
+    uint8_t     head;                       // Packets added, the queue index is head % TX_QUEUE_DEPTH
+    uint8_t     tail;                       // Packets sent
+}txQueue_t;                                 // Packets of one priority
+#endif
 // </editor-fold>
 
 // <editor-fold defaultstate="collapsed" desc="Constant Definitions">
@@ -70,6 +106,13 @@ typedef struct
 /* FILE VARIABLE DEFINITIONS */
 
 static volatile txPacket_t packet_;  /* Contains the packet data that will be transmitted. */
+static txMessage_t message_;         /* Message being sent in fragments */
+static uint8_t     seq_;             /* Sequence number of the last packet sent by TX_sendData() */
+static txRedundancy_t redundancy_ = { 1, 0, 0 };    /* Used by TX_sendData() and TX_sendMessage() */
+static serialNum_t serialNum_;       /* Set by TX_setSerialNumber() */
+#if TX_QUEUE_ON == 1
+static txQueue_t   queue_[eTX_PRIORITY_CNT];    /* Packets queued by TX_queueData() */
+#endif
 
 // </editor-fold>
 
@@ -77,6 +120,11 @@ static volatile txPacket_t packet_;  /* Contains the packet data that will be tr
 /* ****************************************************************************************************************** */
 /* FUNCTION PROTOTYPES */
 
+static void transmitPacket(serialNum_t sn, uint8_t protocolVer, uint8_t cnt, const txRedundancy_t *pRedundancy);
+#if TX_QUEUE_ON == 1
+static bool queueSend(eTX_priority_t ePriority);
+#endif
+
 // </editor-fold>
 
 /* ****************************************************************************************************************** */
@@ -102,11 +150,12 @@ static volatile txPacket_t packet_;  /* Contains the packet data that will be tr
  **********************************************************************************************************************/
 void TX_init(void)
 {
-    uint16_t sn;    /* Temp variable to hold the serial number.  Re-initializing the module will not lose the sn. */
-    
-    sn = packet_.serialNum;
-    (void)memset((void *)&packet_, 0, sizeof(packet_));     // Clear the data
-    packet_.serialNum = sn;                         // Restore the SN
+    (void)memset((void *)&packet_, 0, sizeof(packet_));     // Clear the data, serialNum_ keeps the SN
+    message_.fragIdx = 0;                           // No message pending, the message ID keeps counting
+    message_.fragCnt = 0;
+#if TX_QUEUE_ON == 1
+    (void)memset(queue_, 0, sizeof(queue_));        // Queued packets are dropped
+#endif
     MICRF_init();                                   // Initialize the driver
 }
 /* ****************************************************************************************************************** */
@@ -130,8 +179,12 @@ void TX_init(void)
  **********************************************************************************************************************/
 void TX_setSerialNumber(serialNum_t sn)
 {
+    uint32_t seed = 0;
+
     // memcpy is used so that it doesn't matter how the typedef serialNum_t is defined.  It could be an array.
-    (void)memcpy((void *)&packet_.serialNum, &sn, sizeof(packet_.serialNum));
+    (void)memcpy(&serialNum_, &sn, sizeof(serialNum_));
+    (void)memcpy(&seed, &sn, (sizeof(sn) < sizeof(seed)) ? sizeof(sn) : sizeof(seed));
+    MICRF_setRandomSeed(seed);  // Each transmitter picks different gaps between repeats
 }
 /* ****************************************************************************************************************** */
 // </editor-fold>
@@ -154,20 +207,112 @@ void TX_setSerialNumber(serialNum_t sn)
  **********************************************************************************************************************/
 bool TX_sendData(void *pData, uint8_t cnt)
 {
-    bool bRetVal = false;   // Assume the data cannot be sent
+    return(TX_sendDataBurst(pData, cnt, redundancy_.copies, redundancy_.gapMs, redundancy_.jitterMs));
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="bool TX_sendDataBurst(...)">
+/***********************************************************************************************************************
+ *
+ * Function Name: TX_sendDataBurst
+ *
+ * Purpose: Builds a packet of data and sends it copies times.  The driver sends the copies from the timer interrupt
+ *          with a gap of gapMs plus a random 0 to jitterMs between them.  All copies carry the same sequence number.
+ *
+ * Arguments: void *pData, uint8_t cnt, uint8_t copies, uint16_t gapMs, uint16_t jitterMs
+ *
+ * Returns: bool - true = Success, false = Failure
+ *
+ * Side Effects: Hardware CRC is invoked.
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+bool TX_sendDataBurst(void *pData, uint8_t cnt, uint8_t copies, uint16_t gapMs, uint16_t jitterMs)
+{
+    bool           bRetVal = false;   // Assume the data cannot be sent
+    txRedundancy_t redundancy = { copies, gapMs, jitterMs };
     
-    if (sizeof(packet_.data) >= cnt)    // Validate the number of bytes meets the minimum payload
+    if ((TX_DATA_MAX_SIZE >= cnt) && (0 != copies))     // Validate the number of bytes meets the minimum payload
     {
         if (MICRF_isTxIdle())           // Only the previous transmission is complete can the next transmission be started.
         {
-            (void)memcpy((void *)&packet_.data[0], pData, cnt);                     // Copy the data 
-            packet_.protocolVer = TX_PROTOCOLVER;                                   // Set the protocol version
-            packet_.cnt = cnt;                                                      // Set the count
-            // Calculate and set the CRC (generates a compiler warning, but has be verified to be okay.)
-            packet_.crc = crc16(&packet_, (uint8_t)(sizeof(packet_) - sizeof(packet_.crc) - 
-                                       sizeof(packet_.data) + cnt));
-            (void)memcpy((void *)&packet_.data[cnt], (void *)&packet_.crc, sizeof(packet_.crc)); // Move CRC to end of data.
-            MICRF_transmit(&packet_, (sizeof(packet_) - sizeof(packet_.data)) + cnt); // Transmit the data
+            packet_.data[0] = ++seq_;                                               // Receivers drop repeated seq.
+            (void)memcpy((void *)&packet_.data[1], pData, cnt);                     // Copy the data 
+            transmitPacket(serialNum_, TX_PROTOCOLVER_SEQ, cnt + 1, &redundancy);
+            bRetVal = true;
+        }
+    }
+    return(bRetVal);
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="bool TX_setRedundancy(uint8_t copies, uint16_t gapMs, uint16_t jitterMs)">
+/***********************************************************************************************************************
+ *
+ * Function Name: TX_setRedundancy
+ *
+ * Purpose: Sets the number of copies, gap and jitter used by TX_sendData() and TX_sendMessage().
+ *
+ * Arguments: uint8_t copies, uint16_t gapMs, uint16_t jitterMs
+ *
+ * Returns: bool - true = Success, false = invalid parameter (copies is 0)
+ *
+ * Side Effects: Applies to the next packet sent.
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+bool TX_setRedundancy(uint8_t copies, uint16_t gapMs, uint16_t jitterMs)
+{
+    bool bRetVal = false;
+
+    if (0 != copies)
+    {
+        redundancy_.copies = copies;
+        redundancy_.gapMs = gapMs;
+        redundancy_.jitterMs = jitterMs;
+        bRetVal = true;
+    }
+    return(bRetVal);
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="bool TX_sendMessage(void *pData, uint16_t len)">
+/***********************************************************************************************************************
+ *
+ * Function Name: TX_sendMessage
+ *
+ * Purpose: Sends a message of up to TX_MESSAGE_MAX_SIZE bytes in fragments.  The message is copied, the 1st fragment is
+ *          sent and TX_process() sends the rest.  Every fragment carries the message ID and the fragment index/count,
+ *          so the receiver can put the message back together.
+ *
+ * Arguments: void *pData, uint16_t len
+ *
+ * Returns: bool - true = Success, false = Failure (a message or packet is being sent, or the length is invalid)
+ *
+ * Side Effects: Hardware CRC is invoked.
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+bool TX_sendMessage(void *pData, uint16_t len)
+{
+    bool bRetVal = false;   // Assume the message cannot be sent
+
+    if ((0 != len) && (sizeof(message_.data) >= len))
+    {
+        if ((message_.fragIdx >= message_.fragCnt) && MICRF_isTxIdle()) // Previous message and packet complete?
+        {
+            (void)memcpy(&message_.data[0], pData, len);
+            message_.len = len;
+            message_.msgId++;
+            message_.fragIdx = 0;
+            message_.fragCnt = (uint8_t)((len + (TX_FRAG_PAYLOAD_SIZE - 1)) / TX_FRAG_PAYLOAD_SIZE);
+            (void)TX_process();             // Send the 1st fragment
             bRetVal = true;
         }
     }
@@ -176,6 +321,131 @@ bool TX_sendData(void *pData, uint8_t cnt)
 /* ****************************************************************************************************************** */
 // </editor-fold>
 
+#if TX_QUEUE_ON == 1
+// <editor-fold defaultstate="collapsed" desc="bool TX_queueData(...)">
+/***********************************************************************************************************************
+ *
+ * Function Name: TX_queueData
+ *
+ * Purpose: Copies a packet to the queue of its priority, TX_process() sends it with the serial number sn once the
+ *          driver is idle.
+ *
+ * Arguments: serialNum_t sn, void *pData, uint8_t cnt, uint8_t copies, eTX_priority_t ePriority
+ *
+ * Returns: bool - true = Success, false = Failure (queue full or invalid parameter)
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+bool TX_queueData(serialNum_t sn, void *pData, uint8_t cnt, uint8_t copies, eTX_priority_t ePriority)
+{
+    bool            bRetVal = false;   // Assume the packet cannot be queued
+    txQueue_t       *pQueue;
+    txQueueEntry_t  *pEntry;
+
+    if ((TX_DATA_MAX_SIZE >= cnt) && (eTX_PRIORITY_CNT > ePriority))
+    {
+        pQueue = &queue_[ePriority];
+        if ((uint8_t)(pQueue->head - pQueue->tail) < TX_QUEUE_DEPTH)
+        {
+            pEntry = &pQueue->entry[pQueue->head % TX_QUEUE_DEPTH];
+            pEntry->serialNum = sn;
+            pEntry->cnt = cnt;
+            pEntry->copies = copies;
+            (void)memcpy(&pEntry->data[0], pData, cnt);
+            pQueue->head++;
+            bRetVal = true;
+        }
+    }
+    return(bRetVal);
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="uint8_t TX_getQueueCnt(eTX_priority_t ePriority)">
+/***********************************************************************************************************************
+ *
+ * Function Name: TX_getQueueCnt
+ *
+ * Purpose: Returns the number of queued packets not sent yet
+ *
+ * Arguments: eTX_priority_t ePriority - Queue, eTX_PRIORITY_CNT = all queues
+ *
+ * Returns: uint8_t - Packets waiting
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+uint8_t TX_getQueueCnt(eTX_priority_t ePriority)
+{
+    uint8_t cnt = 0;
+    uint8_t i;
+
+    for (i = 0; i < (uint8_t)eTX_PRIORITY_CNT; i++)
+    {
+        if ((ePriority == (eTX_priority_t)i) || (eTX_PRIORITY_CNT == ePriority))
+        {
+            cnt += (uint8_t)(queue_[i].head - queue_[i].tail);
+        }
+    }
+    return(cnt);
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+#endif
+
+// <editor-fold defaultstate="collapsed" desc="bool TX_process(void)">
+/***********************************************************************************************************************
+ *
+ * Function Name: TX_process
+ *
+ * Purpose: Sends the next packet once the driver is idle: a high priority queued packet, the next fragment of the
+ *          message, then a normal or low priority queued packet.
+ *
+ * Arguments: None
+ *
+ * Returns: bool - true = packets or fragments left to send, false = nothing pending
+ *
+ * Side Effects: Hardware CRC is invoked.
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+bool TX_process(void)
+{
+    uint16_t offset;
+    uint8_t  cnt;
+
+#if TX_QUEUE_ON == 1
+    if (MICRF_isTxIdle() && !queueSend(eTX_PRIORITY_HIGH) && (message_.fragIdx >= message_.fragCnt) &&
+        !queueSend(eTX_PRIORITY_NORMAL))
+    {
+        (void)queueSend(eTX_PRIORITY_LOW);
+    }
+#endif
+    if ((message_.fragIdx < message_.fragCnt) && MICRF_isTxIdle())
+    {
+        offset = (uint16_t)message_.fragIdx * TX_FRAG_PAYLOAD_SIZE;
+        cnt = (uint8_t)(((message_.len - offset) > TX_FRAG_PAYLOAD_SIZE) ? TX_FRAG_PAYLOAD_SIZE : (message_.len - offset));
+        packet_.data[0] = message_.msgId;
+        packet_.data[1] = (uint8_t)((message_.fragIdx << 4) | (message_.fragCnt - 1));
+        (void)memcpy((void *)&packet_.data[TX_FRAG_HDR_SIZE], &message_.data[offset], cnt);
+        transmitPacket(serialNum_, TX_PROTOCOLVER_FRAG, TX_FRAG_HDR_SIZE + cnt, &redundancy_);
+        message_.fragIdx++;
+    }
+#if TX_QUEUE_ON == 1
+    return((message_.fragIdx < message_.fragCnt) || (0 != TX_getQueueCnt(eTX_PRIORITY_CNT)));
+#else
+    return(message_.fragIdx < message_.fragCnt);
+#endif
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
 // <editor-fold defaultstate="collapsed" desc="bool TX_isIdle(void)">
 /***********************************************************************************************************************
  *
@@ -199,9 +469,128 @@ bool TX_isIdle(void)
 /* ****************************************************************************************************************** */
 // </editor-fold>
 
+// <editor-fold defaultstate="collapsed" desc="bool TX_setRateProfile(eMICRF_rate_t eRate)">
+/***********************************************************************************************************************
+ *
+ * Function Name: TX_setRateProfile
+ *
+ * Purpose: Selects the transmitter rate profile.  The receiver must be set to the same profile.
+ *
+ * Arguments: eMICRF_rate_t eRate
+ *
+ * Returns: bool - true = Success, false = Failure (busy or invalid profile)
+ *
+ * Side Effects: Applies to the next packet sent.
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+bool TX_setRateProfile(eMICRF_rate_t eRate)
+{
+    return(eMICRF_success == MICRF_setRateProfile(eRate));
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="eMICRF_rate_t TX_getRateProfile(void)">
+/***********************************************************************************************************************
+ *
+ * Function Name: TX_getRateProfile
+ *
+ * Purpose: Returns the transmitter rate profile
+ *
+ * Arguments: None
+ *
+ * Returns: eMICRF_rate_t
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: Yes
+ *
+ **********************************************************************************************************************/
+eMICRF_rate_t TX_getRateProfile(void)
+{
+    return(MICRF_getRateProfile());
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
 /* ****************************************************************************************************************** */
 /* Local Functions */
 
+// <editor-fold defaultstate="collapsed" desc="static void transmitPacket(...)">
+/***********************************************************************************************************************
+ *
+ * Function Name: transmitPacket
+ *
+ * Purpose: Completes the header and CRC of the packet and transmits it.  The data must already be in packet_.data.
+ *
+ * Arguments: serialNum_t sn - Serial number sent, uint8_t protocolVer, uint8_t cnt - Number of data bytes,
+ *            const txRedundancy_t *pRedundancy - Copies
+ *
+ * Returns: None
+ *
+ * Side Effects: Hardware CRC is invoked.
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+static void transmitPacket(serialNum_t sn, uint8_t protocolVer, uint8_t cnt, const txRedundancy_t *pRedundancy)
+{
+    (void)memcpy((void *)&packet_.serialNum, &sn, sizeof(packet_.serialNum));
+    packet_.protocolVer = protocolVer;                                      // Set the protocol version
+    packet_.cnt = cnt;                                                      // Set the count
+    // Calculate and set the CRC (generates a compiler warning, but has be verified to be okay.)
+    packet_.crc = crc16(&packet_, (uint8_t)(sizeof(packet_) - sizeof(packet_.crc) - sizeof(packet_.data) + cnt));
+    (void)memcpy((void *)&packet_.data[cnt], (void *)&packet_.crc, sizeof(packet_.crc)); // Move CRC to end of data.
+    (void)MICRF_transmitBurst(&packet_, (sizeof(packet_) - sizeof(packet_.data)) + cnt,    // Transmit the data
+                              pRedundancy->copies, pRedundancy->gapMs, pRedundancy->jitterMs);
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+#if TX_QUEUE_ON == 1
+// <editor-fold defaultstate="collapsed" desc="static bool queueSend(eTX_priority_t ePriority)">
+/***********************************************************************************************************************
+ *
+ * Function Name: queueSend
+ *
+ * Purpose: Sends the oldest packet of a queue.  The driver must be idle.
+ *
+ * Arguments: eTX_priority_t ePriority - Queue
+ *
+ * Returns: bool - true = a packet was sent, false = the queue is empty
+ *
+ * Side Effects: Hardware CRC is invoked.
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+static bool queueSend(eTX_priority_t ePriority)
+{
+    txQueue_t       *pQueue = &queue_[ePriority];
+    txQueueEntry_t  *pEntry;
+    txRedundancy_t  redundancy = redundancy_;
+
+    if (pQueue->head == pQueue->tail)
+    {
+        return(false);
+    }
+    pEntry = &pQueue->entry[pQueue->tail % TX_QUEUE_DEPTH];
+    if (TX_COPIES_DEFAULT != pEntry->copies)
+    {
+        redundancy.copies = pEntry->copies;
+    }
+    packet_.data[0] = ++seq_;                                               // Receivers drop repeated seq.
+    (void)memcpy((void *)&packet_.data[1], &pEntry->data[0], pEntry->cnt);
+    transmitPacket(pEntry->serialNum, TX_PROTOCOLVER_SEQ, pEntry->cnt + 1, &redundancy);
+    pQueue->tail++;
+    return(true);
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+#endif
+
 /* ****************************************************************************************************************** */
 /* Event Handlers */
 
@@ -28,6 +28,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "dvr_micrf114.h"
 
 /* ****************************************************************************************************************** */
 /* GLOBAL DEFINTION */
@@ -35,6 +36,20 @@
 /* ****************************************************************************************************************** */
 /* MACRO DEFINITIONS */
 
+#define TX_DATA_MAX_SIZE        14  /* TX_sendData() payload, the 1st of the 15 packet data bytes is the sequence number */
+
+/* Messages larger than a packet are sent in fragments.  A fragment uses 2 bytes of the packet data for the fragment
+ * header: [message ID][index:4 | count - 1:4] */
+#define TX_FRAG_PAYLOAD_SIZE    13                                      /* Message bytes per fragment */
+#define TX_FRAG_MAX             16                                      /* Fragments per message */
+#define TX_MESSAGE_MAX_SIZE     (TX_FRAG_PAYLOAD_SIZE * TX_FRAG_MAX)    /* Largest message, 208 bytes */
+
+/* Packets queued by TX_queueData() wait for the driver in one queue per priority.  TX_process() sends the high priority
+ * queue first, then the fragments of a message, then the normal and the low priority queues. */
+#define TX_QUEUE_ON             1
+#define TX_QUEUE_DEPTH          8                                       /* Packets per priority, a power of 2 */
+#define TX_COPIES_DEFAULT       0                                       /* TX_queueData(): use TX_setRedundancy() */
+
 /* ****************************************************************************************************************** */
 /* TYPE DEFINITIONS */
 
@@ -42,6 +57,14 @@
  * serial number.  So, this typedef will allow the customer to easily change the size to something for their product. */
 typedef uint16_t serialNum_t;   // Used to easily define the serial number length
 
+typedef enum
+{
+    eTX_PRIORITY_LOW = 0,
+    eTX_PRIORITY_NORMAL,
+    eTX_PRIORITY_HIGH,
+    eTX_PRIORITY_CNT
+}eTX_priority_t;                // Queue of a packet, see TX_queueData()
+
 /* ****************************************************************************************************************** */
 /* CONSTANTS */
 
@@ -74,17 +97,102 @@ void TX_init(void);
 void TX_setSerialNumber(serialNum_t sn);
 
 /**
- * TX_sendData - Builds a packet of data to send.  The *pData contains the data that will be sent.
+ * TX_sendData - Builds a packet of data to send.  The *pData contains the data that will be sent.  Every packet gets the
+ *               next sequence number.
  *
  * @see:  N/A
  *
  * @param  void *pData - Pointer to data to be sent
- * @param  uint8_t cnt - Number of bytes to send (number of bytes in pData)
+ * @param  uint8_t cnt - Number of bytes to send (number of bytes in pData), up to TX_DATA_MAX_SIZE
  * 
  * @return bool - true = Success, false = Failure
  */
 bool TX_sendData(void *pData, uint8_t cnt);
 
+/**
+ * TX_sendDataBurst - Same as TX_sendData(), but the packet is sent copies times with a gap of gapMs plus a random 0 to
+ *                    jitterMs between copies.  All copies have the same sequence number, so the receiver drops the
+ *                    repeats.  The copies are sent from the timer interrupt, this doesn't block.
+ *
+ * @see:  TX_isIdle
+ *
+ * @param  void *pData - Pointer to data to be sent
+ * @param  uint8_t cnt - Number of bytes to send, up to TX_DATA_MAX_SIZE
+ * @param  uint8_t copies - Number of times the packet is sent, 1 or more
+ * @param  uint16_t gapMs - Gap between copies
+ * @param  uint16_t jitterMs - Largest random time added to each gap
+ * 
+ * @return bool - true = Success, false = Failure (busy or invalid parameter)
+ */
+bool TX_sendDataBurst(void *pData, uint8_t cnt, uint8_t copies, uint16_t gapMs, uint16_t jitterMs);
+
+/**
+ * TX_setRedundancy - Sets the number of copies, gap and jitter used by TX_sendData() and TX_sendMessage().  The
+ *                    default is a single copy.
+ *
+ * @see:  TX_sendDataBurst
+ *
+ * @param  uint8_t copies - Number of times each packet is sent, 1 or more
+ * @param  uint16_t gapMs - Gap between copies
+ * @param  uint16_t jitterMs - Largest random time added to each gap
+ * 
+ * @return bool - true = Success, false = invalid parameter
+ */
+bool TX_setRedundancy(uint8_t copies, uint16_t gapMs, uint16_t jitterMs);
+
+/**
+ * TX_sendMessage - Sends a message of up to TX_MESSAGE_MAX_SIZE bytes in fragments.  The 1st fragment is sent now, call
+ *                  TX_process() until it returns false to send the rest.
+ *
+ * @see:  TX_process
+ *
+ * @param  void *pData - Pointer to data to be sent, copied before returning
+ * @param  uint16_t len - Number of bytes to send
+ * 
+ * @return bool - true = Success, false = Failure (busy or invalid length)
+ */
+bool TX_sendMessage(void *pData, uint16_t len);
+
+#if TX_QUEUE_ON == 1
+/**
+ * TX_queueData - Queues a packet for TX_process() to send, with the serial number sn instead of the one set by
+ *                TX_setSerialNumber().  Like TX_sendData(), every packet gets the next sequence number.
+ *
+ * @see:  TX_process, TX_getQueueCnt
+ *
+ * @param  serialNum_t sn - Serial number sent with the packet, the receivers filter on it
+ * @param  void *pData - Pointer to data to be sent, copied before returning
+ * @param  uint8_t cnt - Number of bytes to send, up to TX_DATA_MAX_SIZE
+ * @param  uint8_t copies - Number of times the packet is sent, TX_COPIES_DEFAULT = as set by TX_setRedundancy()
+ * @param  eTX_priority_t ePriority - Queue of the packet
+ * 
+ * @return bool - true = Success, false = Failure (queue full or invalid parameter)
+ */
+bool TX_queueData(serialNum_t sn, void *pData, uint8_t cnt, uint8_t copies, eTX_priority_t ePriority);
+
+/**
+ * TX_getQueueCnt - Returns the number of queued packets not sent yet
+ *
+ * @see:  TX_queueData
+ *
+ * @param  eTX_priority_t ePriority - Queue, eTX_PRIORITY_CNT = all queues
+ * 
+ * @return uint8_t - Packets waiting
+ */
+uint8_t TX_getQueueCnt(eTX_priority_t ePriority);
+#endif
+
+/**
+ * TX_process - Sends the next queued packet or fragment of the message once the driver is idle.
+ *
+ * @see:  TX_sendMessage, TX_queueData
+ *
+ * @param  None
+ * 
+ * @return bool - true = packets or fragments left to send, false = nothing pending
+ */
+bool TX_process(void);
+
 /**
  * TX_isIdle - Returns status of the driver
  *
@@ -96,4 +204,26 @@ bool TX_sendData(void *pData, uint8_t cnt);
  */
 bool TX_isIdle(void);
 
+/**
+ * TX_setRateProfile - Selects the transmitter rate profile (bit rate and training length)
+ *
+ * @see:  eMICRF_rate_t
+ *
+ * @param  eMICRF_rate_t eRate - Rate profile to use
+ * 
+ * @return bool - true = Success, false = Failure (busy or invalid profile)
+ */
+bool TX_setRateProfile(eMICRF_rate_t eRate);
+
+/**
+ * TX_getRateProfile - Returns the transmitter rate profile
+ *
+ * @see:  eMICRF_rate_t
+ *
+ * @param  None
+ * 
+ * @return eMICRF_rate_t - Rate profile in use
+ */
+eMICRF_rate_t TX_getRateProfile(void);
+
 #endif  /* TRANSMITTER_H */
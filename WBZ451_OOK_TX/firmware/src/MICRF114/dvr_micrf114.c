@@ -61,6 +61,19 @@
 #define TIMER_INIT()            TC0_TimerInitialize()       /* Initialize the timer used for transmitting */
 #define TIMER_ENABLE()          TC0_TimerStart()              /* Starts the transmitter */
 #define TIMER_DISABLE()         TC0_TimerStop()               /* Stops the transmitter */
+#define TIMER_PERIOD_SET(x)     TC0_Timer16bitPeriodSet(x)    /* Sets the bit timer period (CC0) */
+/* The prescaler is enable protected, only change it while the timer is stopped (i.e. after TIMER_INIT()). */
+#define TIMER_PRESCALER_SET(x)  TC0_REGS->COUNT16.TC_CTRLA = \
+            ((TC0_REGS->COUNT16.TC_CTRLA & ~TC_CTRLA_PRESCALER_Msk) | TC_CTRLA_PRESCALER(x))
+
+#define MICRF_TRAINING_MAX      ((uint8_t)12)                   /* Largest number of training bytes in a profile */
+#define MICRF_PRNG_SEED_DEFAULT ((uint32_t)0x2545F491)          /* Jitter PRNG seed until MICRF_setRandomSeed() */
+#if DVR_PROF_ON == 1
+#define PROF_PATH(x)            eProfPath = (x)                 /* Path the ISR took, the deepest one is recorded */
+#else
+#define PROF_PATH(x)
+#endif
+#define MICRF_GUARD_BITS        ((uint32_t)4)   /* Carrier off after each copy, the receiver needs 3 for the end */
 //#define TIMER_CALLBACK(x)       TC0_TimerCallbackRegister(x)     /* Sets the interrupt handler or call-back */
 
 
@@ -74,13 +87,20 @@ typedef enum
 {
     eTRAINING,                              // Transmission State - Sending Training Bytes
     ePREAMBLE,                              // Transmission State - Sending the Preamble
-    eDATA                                   // Transmission State - Sending the data bytes
+    eDATA,                                  // Transmission State - Sending the data bytes
+    eGAP,                                   // Transmission State - Carrier off, waiting to send the next copy
+    eGUARD                                  // Transmission State - Carrier off after the last copy
 }eState_t;                                  // State machine for the transmission interrupt routine
 
 typedef struct
 {
     uint8_t *pData;                         // Pointer to data buffer
     uint8_t cnt;                            // Number of bytes in the data field
+    uint8_t *pStart;                        // Start of the data buffer, each copy is sent from here
+    uint8_t len;                            // Number of bytes in the data buffer
+    uint8_t copiesLeft;                     // Copies left to send after the current one
+    uint16_t gapMs;                         // Gap between copies
+    uint16_t jitterMs;                      // Random 0 to jitterMs added to every gap
 }appData_t;                                 // Packet to transmit
 
 typedef struct
@@ -91,20 +111,43 @@ typedef struct
     uint8_t         cnt;                    // Number of bytes left to send
     uint8_t         byteToSend;             // Current byte being sent
     uint8_t         bitCnt;                 // Bit number being sent
+    uint32_t        gapCnt;                 // Bit periods left in the gap between copies
     bool            bNextBit;               // Contains the next bit to send
     bool            bStopTx;                // Stops the transmitting of data
     bool            bComplete;              // Data complete.
 }transmit_t;
 
+typedef struct
+{
+    uint16_t        bitRate;                // Nominal data rate, bits/second
+    uint8_t         prescaler;              // TC_CTRLA_PRESCALER_xxx_Val
+    uint16_t        period;                 // Timer period (CC0), one Manchester bit per period
+    uint8_t         trainingCnt;            // Number of training bytes, 1 to MICRF_TRAINING_MAX
+}rateProfile_t;                             // Bit timer settings for a rate profile
+
 // </editor-fold>
 
 // <editor-fold defaultstate="collapsed" desc="Constant Definitions">
 /* ****************************************************************************************************************** */
 /* CONSTANTS */
 
-static const uint8_t training_[] = {0xAA, 0xAA, 0xAA, 0xAA};    /* Training bytes */
+static const uint8_t training_[MICRF_TRAINING_MAX] =            /* Training bytes, trainingCnt of these are sent */
+{
+    0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA
+};
 static const uint8_t preamble_[] = {0x3A};                      /* Preamble */
 
+/* TC0 is clocked at 48MHz.  Bit rate = 48MHz / prescaler / (period + 1).  The data rate is half of that (Manchester).
+ * The MICRF219A data slicer needs a few mS of training to settle, so the faster profiles send more training bytes.
+ * The MICRF219A driver has the matching receive table. */
+static const rateProfile_t rateProfiles_[eMICRF_RATE_CNT] =
+{
+    {  500, TC_CTRLA_PRESCALER_DIV256_Val, 186,  4 },  /* 1003 chips/s (legacy) */
+    { 1000, TC_CTRLA_PRESCALER_DIV64_Val,  374,  6 },  /* 2000 chips/s */
+    { 2000, TC_CTRLA_PRESCALER_DIV64_Val,  186,  8 },  /* 4011 chips/s */
+    { 4000, TC_CTRLA_PRESCALER_DIV16_Val,  374, 12 },  /* 8000 chips/s */
+};
+
 // </editor-fold>
 
 // <editor-fold defaultstate="collapsed" desc="File Variables - Static">
@@ -113,6 +156,11 @@ static const uint8_t preamble_[] = {0x3A};                      /* Preamble */
 
 static volatile transmit_t   txInfo_;   // Transmitter status information
 static          appData_t    appData_;  // Data to transmit
+static          eMICRF_rate_t eRate_;   // Rate profile used for transmitting
+static          uint32_t     prng_ = MICRF_PRNG_SEED_DEFAULT;  // xorshift32 state for the gap jitter
+#if DVR_PROF_ON == 1
+static volatile profStat_t   prof_[eMICRF_PROF_CNT];           // ISR execution times
+#endif
 
 // </editor-fold>
 
@@ -121,6 +169,8 @@ static          appData_t    appData_;  // Data to transmit
 /* FUNCTION PROTOTYPES */
 
 static void transmitData(void);
+static void frameStart(void);
+static uint32_t gapBitPeriods(void);
 static uint16_t manchesterEncode(uint8_t data);
 
 /* Not really a local function, because the ISR calls it. */
@@ -152,6 +202,7 @@ void MICRF_init(void)
     MICRF_SCL_ENABLE();
     MICRF_SDA_PIN_CFG();
     TIMER_DISABLE();
+    DVR_PROF_init();        // Start the cycle counter (if profiling is built in)
     txInfo_.bComplete = true;
 }
 /* ****************************************************************************************************************** */
@@ -174,21 +225,79 @@ void MICRF_init(void)
  *
  **********************************************************************************************************************/
 eMICRF_response_t MICRF_transmit(volatile void *pData, uint8_t cnt)
+{
+    return(MICRF_transmitBurst(pData, cnt, 1, 0, 0));
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="eMICRF_response_t MICRF_transmitBurst(...)">
+/***********************************************************************************************************************
+ *
+ * Function Name: MICRF_transmitBurst
+ *
+ * Purpose: Transmits copies of a packet of data.  The copies are sent back to back from the timer interrupt with a gap
+ *          of gapMs plus a random 0 to jitterMs between them, so transmitters repeating at the same time drift apart.
+ *          Returns once the 1st copy has started, MICRF_isTxIdle() returns true after the last copy.
+ *
+ * Arguments: volatile void *pData - Must not change until MICRF_isTxIdle() returns true
+ *            uint8_t cnt, uint8_t copies - 1 = single copy, uint16_t gapMs, uint16_t jitterMs
+ *
+ * Returns: eMICRF_response_t - eMICRF_failure if busy
+ *
+ * Side Effects: Transmitter is enabled
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+eMICRF_response_t MICRF_transmitBurst(volatile void *pData, uint8_t cnt, uint8_t copies, uint16_t gapMs,
+                                      uint16_t jitterMs)
 {
     eMICRF_response_t retVal = eMICRF_dataLength; // Assume the data length will be incorrect.
     
-    if (MICRF_TX_LEN_MIN <= cnt)    // Validate the data length
+    if ((MICRF_TX_LEN_MIN <= cnt) && (0 != copies))    // Validate the data length
     {
-        appData_.pData = (uint8_t *)pData;  // Store the pointer info
-        appData_.cnt = cnt;                 // Store the counter info
-        transmitData();                     // Start transmitting the data
-        retVal = eMICRF_success;            // Return success!
+        retVal = eMICRF_failure;
+        if (txInfo_.bComplete)              // The buffer of the last packet is used until all copies are sent.
+        {
+            appData_.pStart = (uint8_t *)pData; // Store the pointer info
+            appData_.len = cnt;                 // Store the counter info
+            appData_.copiesLeft = copies - 1;
+            appData_.gapMs = gapMs;
+            appData_.jitterMs = jitterMs;
+            transmitData();                     // Start transmitting the data
+            retVal = eMICRF_success;            // Return success!
+        }
     }
     return(retVal);
 }
 /* ****************************************************************************************************************** */
 // </editor-fold>
 
+// <editor-fold defaultstate="collapsed" desc="void MICRF_setRandomSeed( uint32_t seed )">
+/***********************************************************************************************************************
+ *
+ * Function Name: MICRF_setRandomSeed
+ *
+ * Purpose: Seeds the random gap jitter.  Use something unique to the device (the serial number), so the transmitters
+ *          don't pick the same gaps.
+ *
+ * Arguments: uint32_t seed
+ *
+ * Returns: None
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+void MICRF_setRandomSeed( uint32_t seed )
+{
+    prng_ = (0 != seed) ? seed : MICRF_PRNG_SEED_DEFAULT;   // xorshift32 is stuck at 0
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
 // <editor-fold defaultstate="collapsed" desc="bit MICRF_isTxIdle( void )">
 /***********************************************************************************************************************
  *
@@ -212,6 +321,148 @@ bool MICRF_isTxIdle( void )
 /* ****************************************************************************************************************** */
 // </editor-fold>
 
+// <editor-fold defaultstate="collapsed" desc="eMICRF_response_t MICRF_setRateProfile( eMICRF_rate_t eRate )">
+/***********************************************************************************************************************
+ *
+ * Function Name: MICRF_setRateProfile
+ *
+ * Purpose: Selects the rate profile used by the next transmission.  The timer is programmed when a transmission starts.
+ *
+ * Arguments: eMICRF_rate_t eRate
+ *
+ * Returns: eMICRF_response_t - eMICRF_success, eMICRF_failure if busy or the profile is invalid
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+eMICRF_response_t MICRF_setRateProfile( eMICRF_rate_t eRate )
+{
+    eMICRF_response_t retVal = eMICRF_failure;  // Assume the profile cannot be changed
+    
+    if ((eRate < eMICRF_RATE_CNT) && txInfo_.bComplete) // Don't change the rate in the middle of a packet
+    {
+        eRate_ = eRate;
+        retVal = eMICRF_success;
+    }
+    return(retVal);
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="eMICRF_rate_t MICRF_getRateProfile( void )">
+/***********************************************************************************************************************
+ *
+ * Function Name: MICRF_getRateProfile
+ *
+ * Purpose: Returns the rate profile currently in use
+ *
+ * Arguments: None
+ *
+ * Returns: eMICRF_rate_t
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: Yes
+ *
+ **********************************************************************************************************************/
+eMICRF_rate_t MICRF_getRateProfile( void )
+{
+    return(eRate_);
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="uint16_t MICRF_getBitRate( eMICRF_rate_t eRate )">
+/***********************************************************************************************************************
+ *
+ * Function Name: MICRF_getBitRate
+ *
+ * Purpose: Returns the nominal data bit rate of a rate profile
+ *
+ * Arguments: eMICRF_rate_t eRate
+ *
+ * Returns: uint16_t - bits/second, 0 if the profile is invalid
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: Yes
+ *
+ **********************************************************************************************************************/
+uint16_t MICRF_getBitRate( eMICRF_rate_t eRate )
+{
+    uint16_t bitRate = 0;
+    
+    if (eRate < eMICRF_RATE_CNT)
+    {
+        bitRate = rateProfiles_[eRate].bitRate;
+    }
+    return(bitRate);
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="bool MICRF_getProfile( eMICRF_prof_t ePath, profStat_t *pStat )">
+/***********************************************************************************************************************
+ *
+ * Function Name: MICRF_getProfile
+ *
+ * Purpose: Returns the execution time statistics of a path through the bit timer ISR.
+ *
+ * Arguments: eMICRF_prof_t ePath - ISR path
+ *            profStat_t *pStat - Location to store the statistics
+ *
+ * Returns: bool - false if profiling isn't built in or the path is invalid, pStat is cleared
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: Yes.  The copy is repeated if the ISR updated the path while it was being copied.
+ *
+ **********************************************************************************************************************/
+bool MICRF_getProfile( eMICRF_prof_t ePath, profStat_t *pStat )
+{
+    (void)memset(pStat, 0, sizeof(*pStat));
+#if DVR_PROF_ON == 1
+    if (ePath < eMICRF_PROF_CNT)
+    {
+        do
+        {
+            (void)memcpy(pStat, (void *)&prof_[ePath], sizeof(*pStat));
+        } while (pStat->cnt != prof_[ePath].cnt);
+        return(true);
+    }
+#endif
+    return(false);
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="void MICRF_clearProfile( void )">
+/***********************************************************************************************************************
+ *
+ * Function Name: MICRF_clearProfile
+ *
+ * Purpose: Clears the execution time statistics of all paths through the bit timer ISR.
+ *
+ * Arguments: None
+ *
+ * Returns: None
+ *
+ * Side Effects: A path recorded while clearing may keep its old values.
+ *
+ * Reentrant Code: No
+ *
+ **********************************************************************************************************************/
+void MICRF_clearProfile( void )
+{
+#if DVR_PROF_ON == 1
+    (void)memset((void *)prof_, 0, sizeof(prof_));
+#endif
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
 /* ****************************************************************************************************************** */
 /* Local Functions */
 
@@ -226,7 +477,7 @@ bool MICRF_isTxIdle( void )
  *
  * Returns: None
  *
- * Side Effects: This is blocking code
+ * Side Effects: Returns once the timer is running.  The interrupt sends the packet and the copies.
  *
  * Reentrant Code: No
  *
@@ -252,12 +503,43 @@ static void transmitData(void)
     
     
     
+    txInfo_.bComplete = false;              // init the bComplete flag
+    frameStart();                           // Set up the 1st copy
+    TIMER_INIT();                           // Initialize the timer
+    TIMER_PRESCALER_SET(rateProfiles_[eRate_].prescaler);   // Apply the rate profile, the timer is still stopped
+    TIMER_PERIOD_SET(rateProfiles_[eRate_].period);
+    TC0_TimerCallbackRegister(MICRF_isr, (uintptr_t)NULL);              // Set the call-back function pointer
+    TIMER_ENABLE();                         // Start the timer which starts transmitting
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="static void frameStart(void)">
+/***********************************************************************************************************************
+ *
+ * Function Name: frameStart
+ *
+ * Purpose: Sets up the state machine to send a copy of the packet, starting with the training.  The next timer
+ *          interrupt sends the 1st bit.
+ *
+ * Arguments: None
+ *
+ * Returns: None
+ *
+ * Side Effects: None
+ *
+ * Reentrant Code: No (called by transmitData() and the ISR)
+ *
+ **********************************************************************************************************************/
+static void frameStart(void)
+{
+    appData_.pData = appData_.pStart;       // Every copy sends the same data (and sequence number)
+    appData_.cnt = appData_.len;
     txInfo_.pData = (uint8_t *)&training_[0];// The 1st set of data to transmit is actually training
-    txInfo_.cnt = sizeof(training_) - 1;    // Set the count
+    txInfo_.cnt = rateProfiles_[eRate_].trainingCnt - 1;    // Set the count, the training length is per profile
     txInfo_.byteToSend = *txInfo_.pData++;  // Set the next byte up to send.  Using local variable for speed!
     txInfo_.bitCnt = 0;                     // init the bit counter
     txInfo_.bStopTx = false;                // don't stop now!
-    txInfo_.bComplete = false;              // init the bComplete flag
     txInfo_.bNextBit = false;               // The next bit is assumed false
     if (txInfo_.byteToSend & 0x80)          // is the next bit going to be a 1 (true)
     {   
@@ -265,16 +547,39 @@ static void transmitData(void)
     }
     txInfo_.byteToSend <<= 1;               // Left-shift the data to get the next byte to send in the msb
     txInfo_.eState = eTRAINING;             // Start by sending training info.
-    TIMER_INIT();                           // Initialize the timer
-    TC0_TimerCallbackRegister(MICRF_isr, (uintptr_t)NULL);              // Set the call-back function pointer
-    TIMER_ENABLE();                         // Start the timer which starts transmitting
-    
-#if 1    
-    /* Note:  This could be removed and the application could monitor when the data is complete.  The function 
-       MICRF_isTxIdle() can be used to monitor. */
-    while(!txInfo_.bComplete)               // While not complete, wait here.
-    {}
-#endif
+}
+/* ****************************************************************************************************************** */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="static uint32_t gapBitPeriods(void)">
+/***********************************************************************************************************************
+ *
+ * Function Name: gapBitPeriods
+ *
+ * Purpose: Returns the gap before the next copy in bit timer periods.  The gap is gapMs plus a random 0 to jitterMs.
+ *
+ * Arguments: None
+ *
+ * Returns: uint32_t - Bit timer periods
+ *
+ * Side Effects: Advances the PRNG
+ *
+ * Reentrant Code: No (called by the ISR)
+ *
+ **********************************************************************************************************************/
+static uint32_t gapBitPeriods(void)
+{
+    uint32_t gapMs = appData_.gapMs;
+
+    if (0 != appData_.jitterMs)
+    {
+        prng_ ^= prng_ << 13;       // xorshift32
+        prng_ ^= prng_ >> 17;
+        prng_ ^= prng_ << 5;
+        gapMs += prng_ % ((uint32_t)appData_.jitterMs + 1);
+    }
+    // One timer period per Manchester bit, which is twice the data rate.
+    return((gapMs * 2 * rateProfiles_[eRate_].bitRate) / 1000);
 }
 /* ****************************************************************************************************************** */
 // </editor-fold>
@@ -338,7 +643,31 @@ static uint16_t manchesterEncode(uint8_t data)
  **********************************************************************************************************************/
 void MICRF_isr(TC_TIMER_STATUS status, uintptr_t context)
 {
-    if (!txInfo_.bStopTx)   // The last bit was already sent, then it is time to stop and disable the transmitter.
+#if DVR_PROF_ON == 1
+    uint32_t profStart = DVR_PROF_CYCLES();     // One register read, the bit edge moves by a couple of cycles
+    eMICRF_prof_t eProfPath = eMICRF_PROF_BIT;
+#endif
+
+    if ((eGAP == txInfo_.eState) || (eGUARD == txInfo_.eState)) // Carrier off between/after the copies.
+    {
+        PROF_PATH(eMICRF_PROF_GAP);
+        if (0 != txInfo_.gapCnt)
+        {
+            txInfo_.gapCnt--;
+        }
+        else if (eGAP == txInfo_.eState)
+        {
+            frameStart();       // The next interrupt sends the 1st bit of the copy
+        }
+        else    // The receiver has seen the end of the last copy, shut down.
+        {
+            txInfo_.bComplete = true;
+            MICRF_SCL_ENABLE();
+            MICRF_SDA_PIN_HIGH();
+            TIMER_DISABLE();
+        }
+    }
+    else if (!txInfo_.bStopTx)   // The last bit was already sent, then it is time to stop and disable the transmitter.
     {   // More bytes to send!
         /* Must set the next bit before doing anything else.  Can't afford any "gitter" on the TX line.  */
         if (txInfo_.bNextBit)       // Is the next bit high or low (its already been calculated and store in bNextBit)
@@ -352,6 +681,7 @@ void MICRF_isr(TC_TIMER_STATUS status, uintptr_t context)
         txInfo_.bitCnt++;                   // Increase the bit counter, we need to send the next bit
         if (BITS_IN_BYTE <= txInfo_.bitCnt) // Have all 8 bits been sent?   
         {   // Yes, now get the next byte of data to be sent.
+            PROF_PATH(eMICRF_PROF_BYTE);
             txInfo_.bitCnt = 0;             // Reset the bit counter
             if (0 != txInfo_.cnt)           // Are there bytes left to send?
             {   // Yes, collect the next byte to send
@@ -418,14 +748,24 @@ void MICRF_isr(TC_TIMER_STATUS status, uintptr_t context)
             txInfo_.byteToSend <<= 1;
         }
     }
-    else    // Time to stop transmitting and shut it down!
+    else if (0 != appData_.copiesLeft)  // Send another copy after the gap, the transmitter stays configured.
     {
-        txInfo_.bComplete = true;
+        PROF_PATH(eMICRF_PROF_GAP);
+        appData_.copiesLeft--;
         MICRF_SDA_PIN_LOW();
-        MICRF_SCL_ENABLE();
-        MICRF_SDA_PIN_HIGH();
-        TIMER_DISABLE();
+        txInfo_.gapCnt = MICRF_GUARD_BITS + gapBitPeriods();
+        txInfo_.eState = eGAP;
     }
+    else    // Time to stop transmitting.  The carrier stays off for the guard, so a packet sent right after this one
+    {       // isn't decoded as more data of this one.
+        PROF_PATH(eMICRF_PROF_GAP);
+        MICRF_SDA_PIN_LOW();
+        txInfo_.gapCnt = MICRF_GUARD_BITS;
+        txInfo_.eState = eGUARD;
+    }
+#if DVR_PROF_ON == 1
+    DVR_PROF_record((profStat_t *)&prof_[eProfPath], DVR_PROF_CYCLES() - profStart);
+#endif
 }
 /* ****************************************************************************************************************** */
 // </editor-fold>
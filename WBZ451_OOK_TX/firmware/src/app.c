@@ -58,7 +58,10 @@
 #include "ble_dis/ble_dis.h"
 #include "app_ble_conn_handler.h"
 #include "app_ble_sensor.h"
+#include "app_micrf.h"
+#include "app_log.h"
 #include "app_adv.h"
+#include "app_timer/app_timer.h"
 #include "system/console/sys_console.h"
 #include "ble_otaps/ble_otaps.h"
 #include "app_ota/app_ota_handler.h"
@@ -171,6 +174,10 @@ static void APP_Init(void)
 
     APP_TRPS_Sensor_Init();
     
+    APP_MICRF_Init();
+    
+    APP_LOG_Init();
+    
     APP_OTA_HDL_Init();
     
     wbz451_silicon_revision = 	DSU_REGS->DSU_DID;	
@@ -291,6 +298,22 @@ void APP_Tasks ( void )
                 {
                     APP_OTA_Reboot_Handler(); 
                 } 
+                else if(p_appMsg->msgId== APP_TIMER_BLE_CONN_MSG)
+                {
+                    APP_BLE_ConnMgrTimerHandler();
+                }
+                else if(p_appMsg->msgId== APP_MSG_TRPS_NTF_FLUSH)
+                {
+                    APP_TRPS_NotifyFlush();
+                }
+                else if(p_appMsg->msgId== APP_TIMER_ADV_TLM_MSG)
+                {
+                    APP_ADV_TlmTimerHandler();
+                }
+                else if(p_appMsg->msgId== APP_MSG_OTA_FLASH)
+                {
+                    APP_OTA_HDL_FlashTask();
+                }
                 else if(p_appMsg->msgId== APP_BLE_USART_WRITE_MSG)
                 {
                     update_ble_data();
@@ -298,8 +321,33 @@ void APP_Tasks ( void )
                 
                 else if( p_appMsg->msgId == APP_MSG_MICRF_EVT)
                 {                    
-                    (void)TX_sendData(&rgb_ble_data, sizeof(rgb_ble_data)); // Transmit the data
-                    
+                    if (TX_sendData(&rgb_ble_data, sizeof(rgb_ble_data))) // Transmit the data
+                    {
+                        if (APP_TIMER_IsTimerExisted(APP_TIMER_MICRF_TX))
+                        {
+                            APP_TIMER_StopTimer(APP_TIMER_MICRF_TX);
+                        }
+                    }
+                    else
+                    {   // The transmitter is still sending the last packet (or its copies), try again later.
+                        APP_TIMER_SetTimer(APP_TIMER_MICRF_TX, APP_MICRF_TX_RETRY_MS, false);
+                    }
+                }
+                else if( p_appMsg->msgId == APP_MSG_MICRF_BENCH_EVT)
+                {
+                    APP_MICRF_BenchHandler();
+                }
+                else if( p_appMsg->msgId == APP_MSG_MICRF_MSG_EVT)
+                {
+                    APP_MICRF_MsgHandler();
+                }
+                else if( p_appMsg->msgId == APP_MSG_MICRF_MODEM_EVT)
+                {
+                    APP_MICRF_ModemHandler();
+                }
+                else if( p_appMsg->msgId == APP_MSG_MICRF_BCAST_EVT)
+                {
+                    APP_MICRF_BcastHandler();
                 }
             }
             break;
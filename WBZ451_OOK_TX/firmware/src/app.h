@@ -104,8 +104,16 @@ typedef enum APP_MsgId_T
     APP_MSG_TRS_BLE_SENSOR_INT,
     APP_TIMER_OTA_TIMEOUT_MSG,
     APP_TIMER_OTA_REBOOT_MSG,
+    APP_TIMER_BLE_CONN_MSG,
+    APP_MSG_TRPS_NTF_FLUSH,
+    APP_TIMER_ADV_TLM_MSG,
+    APP_MSG_OTA_FLASH,
     APP_BLE_USART_WRITE_MSG,
     APP_MSG_MICRF_EVT,
+    APP_MSG_MICRF_BENCH_EVT,
+    APP_MSG_MICRF_MSG_EVT,
+    APP_MSG_MICRF_MODEM_EVT,
+    APP_MSG_MICRF_BCAST_EVT,
     APP_MSG_STACK_END
 } APP_MsgId_T;
 
@@ -53,6 +53,9 @@
 #include "peripheral/gpio/plib_gpio.h"
 #include "app_ble_sensor.h"
 #include "app_timer/app_timer.h"
+#if APP_ADV_TLM_ON == 1
+#include "app_micrf.h"
+#endif
 
 
 // *****************************************************************************
@@ -62,6 +65,13 @@
 // *****************************************************************************
 #define APP_BLE_NUM_ADDR_IN_DEV_NAME    2    /**< The number of bytes of device address included in the device name. */
 
+#if APP_ADV_TLM_ON == 1
+#define APP_ADV_TLM_LEN                 APP_MICRF_ADV_TLM_LEN
+#else
+#define APP_ADV_TLM_LEN                 0
+#endif
+#define APP_ADV_SRV_PAYLOAD_LEN         (APP_ADV_SRV_DATA_LEN - APP_ADV_SRV_UUID_LEN + APP_ADV_TLM_LEN)
+
 
 
 // *****************************************************************************
@@ -72,6 +82,7 @@
 //static APP_BLE_AdvParams_T                  s_bleAdvParam;
 static BLE_GAP_AdvDataParams_T   			  s_bleAdvData;
 static BLE_GAP_AdvDataParams_T                s_bleScanRspData;
+static uint8_t                                s_advPayloadIdx;    /**< Service data after the UUID in s_bleAdvData */
 
 
 
@@ -124,16 +135,43 @@ void APP_ADV_UpdateAdvData(void)
     s_bleAdvData.advData[idx++] = APP_ADV_FLAG_LE_GEN_DISCOV | APP_ADV_FLAG_BREDR_NOT_SUPPORTED;
 
     //Service Data
-    s_bleAdvData.advData[idx++] = (APP_ADV_TYPE_LEN + APP_ADV_SRV_DATA_LEN); //length
+    s_bleAdvData.advData[idx++] = (APP_ADV_TYPE_LEN + APP_ADV_SRV_DATA_LEN + APP_ADV_TLM_LEN); //length
     s_bleAdvData.advData[idx++] = APP_ADV_TYPE_SRV_DATA_16BIT_UUID;              //AD Type: Service Data
     s_bleAdvData.advData[idx++] = (uint8_t)APP_ADV_SERVICE_UUID_MCHP;
     s_bleAdvData.advData[idx++] = (uint8_t)(APP_ADV_SERVICE_UUID_MCHP >> 8);
     
+    s_advPayloadIdx = idx;
     APP_TRPS_Sensor_Beacon(&s_bleAdvData.advData[idx]);
+#if APP_ADV_TLM_ON == 1
+    APP_MICRF_AdvTelemetry(&s_bleAdvData.advData[idx + APP_ADV_SRV_DATA_LEN - APP_ADV_SRV_UUID_LEN]);
+#endif
 
     s_bleAdvData.advLen = APP_ADV_CalculateDataLength(&s_bleAdvData.advData[0]);
 }
 
+/* Patch the bytes of the service data that changed since the payload was built.  Returns true if one did. */
+static bool APP_ADV_PatchAdvData(void)
+{
+    uint8_t payload[APP_ADV_SRV_PAYLOAD_LEN];
+    uint8_t *p_adv = &s_bleAdvData.advData[s_advPayloadIdx];
+    uint8_t i;
+    bool changed = false;
+
+    APP_TRPS_Sensor_Beacon(payload);
+#if APP_ADV_TLM_ON == 1
+    APP_MICRF_AdvTelemetry(&payload[APP_ADV_SRV_DATA_LEN - APP_ADV_SRV_UUID_LEN]);
+#endif
+    for (i = 0; i < APP_ADV_SRV_PAYLOAD_LEN; i++)
+    {
+        if (p_adv[i] != payload[i])
+        {
+            p_adv[i] = payload[i];
+            changed = true;
+        }
+    }
+    return changed;
+}
+
 void APP_ADV_UpdateScanRspData(void)
 {
     uint8_t devNameLen;
@@ -156,7 +194,7 @@ uint16_t APP_ADV_Ctrl(uint8_t enable)
     
     if (enable)
     {
-        if (APP_GetBleState() == APP_BLE_STATE_STANDBY)
+        if (APP_GetAdvState() == APP_BLE_STATE_STANDBY)
         {
                 result = BLE_GAP_SetAdvEnable(true, 0);
 
@@ -169,7 +207,7 @@ uint16_t APP_ADV_Ctrl(uint8_t enable)
     }
     else
     {
-        if(APP_GetBleState() == APP_BLE_STATE_ADVERTISING)
+        if(APP_GetAdvState() == APP_BLE_STATE_ADVERTISING)
         {
             result = BLE_GAP_SetAdvEnable(false, 0);
             if(result == APP_RES_SUCCESS)
@@ -202,13 +240,41 @@ void APP_ADV_Stop(void)
 void APP_ADV_Init(void)
 {
     APP_ADV_Start();
+#if APP_ADV_TLM_ON == 1
+    if (!APP_TIMER_IsTimerExisted(APP_TIMER_ADV_TLM))
+    {
+        APP_TIMER_SetTimer(APP_TIMER_ADV_TLM, APP_ADV_TLM_PERIOD_MS, true);
+    }
+#endif
+}
+
+/* Update the advertising payload after the sensor data changed.  Starts advertising if it is not running. */
+void APP_ADV_Refresh(void)
+{
+    if (APP_GetAdvState() != APP_BLE_STATE_ADVERTISING)
+    {
+        APP_ADV_Start();
+    }
+    else if (APP_ADV_PatchAdvData())
+    {
+        BLE_GAP_SetAdvData(&s_bleAdvData);
+    }
+}
+
+/* Periodic telemetry timer handler, the payload is left alone while not advertising */
+void APP_ADV_TlmTimerHandler(void)
+{
+    if ((APP_GetAdvState() == APP_BLE_STATE_ADVERTISING) && APP_ADV_PatchAdvData())
+    {
+        BLE_GAP_SetAdvData(&s_bleAdvData);
+    }
 }
 
 /* User LED control for advertising indication */
 void APP_BLE_Adv_TimerHandler(void)
 {
 
-    if ( APP_GetBleState() == APP_BLE_STATE_ADVERTISING)
+    if (APP_GetAdvState() == APP_BLE_STATE_ADVERTISING)
     {
         USER_LED_Toggle();
     }
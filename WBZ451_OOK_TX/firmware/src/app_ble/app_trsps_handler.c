@@ -47,6 +47,7 @@
 #include <stdint.h>
 #include "ble_trsps/ble_trsps.h"
 #include "app_trps.h"
+#include "app_micrf.h"
 
 
 // *****************************************************************************
@@ -92,7 +93,7 @@ void APP_TrspsEvtHandler(BLE_TRSPS_Event_T *p_event)
         
         case BLE_TRSPS_EVT_RECEIVE_DATA:
         {
-            /* TODO: implement your application code.*/
+            APP_MICRF_ModemRxEvt(p_event->eventField.onReceiveData.connHandle);
         }
         break;
         
@@ -51,6 +51,7 @@
 // *****************************************************************************
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <string.h>
 #include "gap_defs.h"
 #include "ble_gap.h"
@@ -63,6 +64,37 @@ extern "C" {
 #endif
 // DOM-IGNORE-END
 
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+
+//  Set to 1 to let the connection manager negotiate the PHY, the ATT MTU and the connection interval of each link
+#define APP_BLE_CONN_MGR_ON                 1
+
+//  Set to 1 to keep advertising while a link is free, so several centrals can connect (BLE_GAP_MAX_LINK_NBR)
+#define APP_BLE_CONN_MULTI_ON               1
+
+#define APP_BLE_CONN_MGR_PERIOD_MS          1000        /**< Traffic window, see APP_TIMER_BLE_CONN */
+#define APP_BLE_CONN_MTU                    247         /**< 251 byte LL payload (DLE) less the L2CAP header */
+
+/* Low latency interval, used while there is traffic.  Within the limits most phones accept (min >= 15 ms, max >= min + 15 ms). */
+#define APP_BLE_CONN_FAST_INTERVAL_MIN      0x0C        /**< 15 ms, 1.25 ms units */
+#define APP_BLE_CONN_FAST_INTERVAL_MAX      0x18        /**< 30 ms */
+#define APP_BLE_CONN_FAST_LATENCY           0
+#define APP_BLE_CONN_FAST_TIMEOUT           0xC8        /**< 2 s, 10 ms units */
+
+/* Low power interval, used once the link has been idle for APP_BLE_CONN_IDLE_WINDOWS. */
+#define APP_BLE_CONN_SLOW_INTERVAL_MIN      0x48        /**< 90 ms */
+#define APP_BLE_CONN_SLOW_INTERVAL_MAX      0x60        /**< 120 ms */
+#define APP_BLE_CONN_SLOW_LATENCY           4           /**< Peripheral may skip 4 events, up to 600 ms between events */
+#define APP_BLE_CONN_SLOW_TIMEOUT           0x258       /**< 6 s, > 2 x (1 + latency) x interval max */
+
+#define APP_BLE_CONN_FAST_BYTES             64          /**< Bytes per window (both directions) that select the low latency interval */
+#define APP_BLE_CONN_IDLE_WINDOWS           5           /**< Windows below APP_BLE_CONN_FAST_BYTES before the low power interval */
+#define APP_BLE_CONN_UPDATE_WINDOWS         3           /**< Windows to wait for the result of a parameter update */
+
 // *****************************************************************************
 // *****************************************************************************
 /**@brief Enumeration type of BLE state. */
@@ -93,11 +125,54 @@ typedef struct APP_BLE_ConnData_T
     uint16_t               supervisionTimeout;                             /**< Supervision timeout for the LE Link, see @ref BLE_GAP_CP_RANGE. */
 } APP_BLE_ConnData_T;
 
+/**@brief Connection interval profile selected by the connection manager. */
+typedef enum APP_BLE_ConnMode_T
+{
+    APP_BLE_CONN_MODE_CENTRAL,                                            /**< Parameters chosen by the central, not changed yet */
+    APP_BLE_CONN_MODE_FAST,                                               /**< Low latency interval */
+    APP_BLE_CONN_MODE_SLOW,                                               /**< Low power interval */
+} APP_BLE_ConnMode_T;
+
+/**@brief Traffic and latency counters of a link, cleared on connection. */
+typedef struct APP_BLE_ConnStats_T
+{
+    uint32_t               txBytes;                                        /**< Bytes handed to the stack since the connection */
+    uint32_t               rxBytes;                                        /**< Bytes written by the central since the connection */
+    uint32_t               txPackets;                                      /**< Notifications sent */
+    uint32_t               rxPackets;                                      /**< Writes received */
+    uint16_t               txBps;                                          /**< Bytes/s of the last window */
+    uint16_t               rxBps;                                          /**< Bytes/s of the last window */
+    uint16_t               peakBps;                                        /**< Highest txBps + rxBps */
+    uint16_t               latLastMs;                                      /**< Write to the next notification, last request */
+    uint16_t               latMaxMs;                                       /**< Highest latLastMs */
+    uint32_t               latSumMs;                                       /**< Sum of the request latencies, average is latSumMs / latCnt */
+    uint32_t               latCnt;                                         /**< Requests timed */
+    uint16_t               paramUpdates;                                   /**< Connection parameter updates applied */
+} APP_BLE_ConnStats_T;
+
+/**@brief The structure contains the connection manager state of a link. */
+typedef struct APP_BLE_ConnMgr_T
+{
+    APP_BLE_ConnMode_T     mode;                                           /**< Interval profile in use, see @ref APP_BLE_ConnMode_T */
+    APP_BLE_ConnMode_T     modeReq;                                        /**< Interval profile requested, applied on BLE_GAP_EVT_CONN_PARAM_UPDATE */
+    uint8_t                updateWait;                                     /**< Windows left for a pending parameter update, 0: none pending */
+    uint8_t                idleWindows;                                    /**< Consecutive windows below APP_BLE_CONN_FAST_BYTES */
+    uint8_t                txPhy;                                          /**< See @ref BLE_GAP_PHY_TYPE */
+    uint8_t                rxPhy;                                          /**< See @ref BLE_GAP_PHY_TYPE */
+    uint16_t               attMtu;                                         /**< Exchanged ATT MTU */
+    bool                   latPending;                                     /**< A write is waiting for its first notification */
+    uint32_t               latStartMs;                                     /**< Time of that write */
+    uint32_t               windowTx;                                       /**< Bytes sent in the current window */
+    uint32_t               windowRx;                                       /**< Bytes received in the current window */
+} APP_BLE_ConnMgr_T;
+
 /**@brief The structure contains the BLE link related information maintained by the application Layer */
 typedef struct APP_BLE_ConnList_T
 {
     APP_BLE_LinkState_T         linkState;                                              /**< BLE link state. see @ref APP_BLE_LinkState_T */
     APP_BLE_ConnData_T          connData;                                               /**< BLE connection information. See @ref APP_BLE_ConnData_T */
+    APP_BLE_ConnMgr_T           mgr;                                                    /**< Connection manager state. See @ref APP_BLE_ConnMgr_T */
+    APP_BLE_ConnStats_T         stats;                                                  /**< Traffic and latency counters. See @ref APP_BLE_ConnStats_T */
 } APP_BLE_ConnList_T;
 
 // *****************************************************************************
@@ -158,6 +233,8 @@ void APP_InitConnList(void);
      Returns BLE link state.
 
   Description:
+     APP_BLE_STATE_CONNECTED while any central is connected, else the
+     advertising state.
 
   Precondition:
 
@@ -178,6 +255,8 @@ APP_BLE_LinkState_T APP_GetBleState(void);
      Sets BLE link state.
 
   Description:
+     Sets the advertising state, APP_BLE_STATE_STANDBY or
+     APP_BLE_STATE_ADVERTISING.  The links keep their own state.
 
   Precondition:
 
@@ -190,6 +269,28 @@ APP_BLE_LinkState_T APP_GetBleState(void);
 */
 void APP_SetBleState(APP_BLE_LinkState_T state);
 
+/*******************************************************************************
+  Function:
+     APP_BLE_LinkState_T APP_GetAdvState(void)
+
+  Summary:
+     Returns the advertising state.
+
+  Description:
+     APP_BLE_STATE_ADVERTISING while advertising, also with centrals
+     connected, else APP_BLE_STATE_STANDBY.
+
+  Precondition:
+
+  Parameters:
+    None.
+
+  Returns:
+    APP_BLE_LinkState_T.
+
+*/
+APP_BLE_LinkState_T APP_GetAdvState(void);
+
 /*******************************************************************************
   Function:
      uint16_t APP_GetConnHandleByIndex(uint8_t index)
@@ -230,6 +331,96 @@ uint16_t APP_GetConnHandleByIndex(uint8_t index);
 */
 APP_BLE_ConnList_T *APP_GetConnInfoByConnHandle(uint16_t connHandle);
 
+/*******************************************************************************
+  Function:
+     void APP_BLE_ConnMgrTx(uint16_t connHandle, uint16_t len)
+
+  Summary:
+     Counts a notification handed to the stack.
+
+  Description:
+     Called after each successful send to the central.  Adds to the traffic
+     window of the connection manager and, for the first notification after a
+     write of the central, to the request latency.
+
+  Precondition:
+
+  Parameters:
+    connHandle.
+    len - Bytes sent.
+
+  Returns:
+    None.
+
+*/
+void APP_BLE_ConnMgrTx(uint16_t connHandle, uint16_t len);
+
+/*******************************************************************************
+  Function:
+     void APP_BLE_ConnMgrRx(uint16_t connHandle, uint16_t len)
+
+  Summary:
+     Counts a write of the central, GATTS_EVT_WRITE.
+
+  Description:
+     Starts timing the request latency.  A write also moves an idle link back
+     to the low latency interval at the next window.
+
+  Precondition:
+
+  Parameters:
+    connHandle.
+    len - Bytes written.
+
+  Returns:
+    None.
+
+*/
+void APP_BLE_ConnMgrRx(uint16_t connHandle, uint16_t len);
+
+/*******************************************************************************
+  Function:
+     void APP_BLE_ConnMgrMtu(uint16_t connHandle, uint16_t mtu)
+
+  Summary:
+     Records the exchanged ATT MTU, ATT_EVT_UPDATE_MTU.
+
+  Description:
+
+  Precondition:
+
+  Parameters:
+    connHandle.
+    mtu - Exchanged MTU.
+
+  Returns:
+    None.
+
+*/
+void APP_BLE_ConnMgrMtu(uint16_t connHandle, uint16_t mtu);
+
+/*******************************************************************************
+  Function:
+     void APP_BLE_ConnMgrTimerHandler(void)
+
+  Summary:
+     Closes the traffic window of each link and picks its interval profile.
+
+  Description:
+     Called every APP_BLE_CONN_MGR_PERIOD_MS from APP_TIMER_BLE_CONN while a
+     link is up.
+
+  Precondition:
+
+  Parameters:
+    None.
+
+  Returns:
+    None.
+
+*/
+void APP_BLE_ConnMgrTimerHandler(void);
+
 #endif /* _APP_BLE_CONN_HANDLER_H */
 
 //DOM-IGNORE-BEGIN
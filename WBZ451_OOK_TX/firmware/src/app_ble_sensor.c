@@ -59,6 +59,7 @@
 #include "app_ble_conn_handler.h"
 #include "app_ble_sensor.h"
 #include "app_error_defs.h"
+#include "app_log.h"
 
 
 // *****************************************************************************
@@ -121,7 +122,7 @@ void update_ble_data(void)
     {
         rgb_ble_data += 1;
     }
-    SYS_CONSOLE_PRINT("Data Sent: %ld\n\r",rgb_ble_data);
+    APP_LOG(APP_LOG_TX_DATA, rgb_ble_data);
     APP_Msg_T    appMsg;
     appMsg.msgId = APP_MSG_MICRF_EVT;
     OSAL_QUEUE_Send(&appData.appQueue, &appMsg, 0);
@@ -205,7 +206,7 @@ void APP_TRPS_Sensor_Button_Handler(void)
     }
     else
     {       
-        APP_ADV_Init();  
+        APP_ADV_Refresh();  
     }
 }
 
@@ -250,7 +251,7 @@ void APP_TRPS_Sensor_TimerHandler(void)
         {
             if( (tempBack > (lastAdvTemp + 1)) || (tempBack < (lastAdvTemp-1)) )  //+/- 1C above, only then update advertisement payload
             {       
-                APP_ADV_Init();
+                APP_ADV_Refresh();
                 lastAdvTemp = tempBack;                
             }
         }
@@ -0,0 +1,196 @@
+/*******************************************************************************
+  Application Tokenized Log Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_log.c
+
+  Summary:
+    This file contains the Application tokenized (binary) log for this project.
+
+  Description:
+    APP_LOG_Write() is called by the application task only (one producer) and
+    the drain task is the only consumer, so the ring needs no lock: the producer
+    only moves s_head and the consumer only moves s_tail.
+ *******************************************************************************/
+
+//DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2023 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+//DOM-IGNORE-END
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdint.h>
+#include <string.h>
+#include "definitions.h"
+#include "system/console/sys_console.h"
+#include "app_log.h"
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Local Variables
+// *****************************************************************************
+// *****************************************************************************
+
+#if APP_LOG_ON == 1
+static uint8_t           s_ring[APP_LOG_RING_SIZE];
+static volatile uint32_t s_head;        /**< Bytes written, only changed by APP_LOG_Write() */
+static volatile uint32_t s_tail;        /**< Bytes sent, only changed by the drain task */
+static volatile uint32_t s_dropped;     /**< Records lost on a full ring, only changed by APP_LOG_Write() */
+static uint32_t          s_droppedSent; /**< Value of s_dropped last reported by the drain task */
+static SYS_CONSOLE_HANDLE s_consoleHandle;
+#else
+#define APP_LOG_MSG_FMT(name, fmt)  fmt,
+static const char * const s_fmt[APP_LOG_MSG_CNT] = { APP_LOG_MSG_LIST(APP_LOG_MSG_FMT) };
+#undef APP_LOG_MSG_FMT
+#endif
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Functions
+// *****************************************************************************
+// *****************************************************************************
+
+#if APP_LOG_ON == 1
+/* Build a record in p_rec.  Returns the record length. */
+static uint8_t APP_LOG_Encode(uint8_t *p_rec, APP_LOG_Msg_T id, const uint32_t *p_args, uint8_t argCnt)
+{
+    uint32_t timeMs = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    uint8_t len = 0, sum = 0, i;
+
+    p_rec[len++] = APP_LOG_SYNC;
+    p_rec[len++] = (uint8_t)id;
+    p_rec[len++] = argCnt;
+    memcpy(&p_rec[len], &timeMs, sizeof(timeMs));      // Cortex-M is little endian
+    len += sizeof(timeMs);
+    memcpy(&p_rec[len], p_args, (size_t)argCnt * sizeof(uint32_t));
+    len += argCnt * sizeof(uint32_t);
+    for (i = 1; i < len; i++)
+    {
+        sum += p_rec[i];
+    }
+    p_rec[len++] = sum;
+    return len;
+}
+
+/* Send the ring to the console, lowest priority work of the application */
+static void APP_LOG_Task(void *p_param)
+{
+    uint8_t rec[APP_LOG_REC_MAX_LEN];
+    uint32_t head, dropped, len, chunk;
+    ssize_t space;
+
+    (void)p_param;
+    for (;;)
+    {
+        dropped = s_dropped;
+        if ((dropped != s_droppedSent) && (s_head == s_tail) &&
+            (SYS_CONSOLE_WriteFreeBufferCountGet(s_consoleHandle) >= (APP_LOG_REC_HDR_LEN + 4 + 1)))
+        {   // Goes straight to the UART once the ring is empty (between records), the ring only has one producer
+            uint32_t lost = dropped - s_droppedSent;
+
+            len = APP_LOG_Encode(rec, APP_LOG_DROPPED, &lost, 1);
+            SYS_CONSOLE_Write(s_consoleHandle, rec, len);
+            s_droppedSent = dropped;
+        }
+
+        head = s_head;
+        len = head - s_tail;
+        space = SYS_CONSOLE_WriteFreeBufferCountGet(s_consoleHandle);
+        if ((len == 0) || (space <= 0))
+        {
+            vTaskDelay(APP_LOG_DRAIN_MS / portTICK_PERIOD_MS);
+            continue;
+        }
+        if (len > (uint32_t)space)
+        {
+            len = (uint32_t)space;
+        }
+        chunk = APP_LOG_RING_SIZE - (s_tail & (APP_LOG_RING_SIZE - 1));   // Bytes up to the end of the ring
+        if (chunk > len)
+        {
+            chunk = len;
+        }
+        SYS_CONSOLE_Write(s_consoleHandle, &s_ring[s_tail & (APP_LOG_RING_SIZE - 1)], chunk);
+        s_tail += chunk;
+    }
+}
+#endif
+
+/* Log a message, see APP_LOG().  Only the application task may call it.  The record is dropped if the ring is full. */
+void APP_LOG_Write(APP_LOG_Msg_T id, const uint32_t *p_args, uint8_t argCnt)
+{
+#if APP_LOG_ON == 1
+    uint8_t rec[APP_LOG_REC_MAX_LEN];
+    uint32_t head = s_head;
+    uint32_t len, chunk;
+
+    if (argCnt > APP_LOG_ARGS_MAX)
+    {
+        argCnt = APP_LOG_ARGS_MAX;
+    }
+    len = APP_LOG_Encode(rec, id, p_args, argCnt);
+    if ((APP_LOG_RING_SIZE - (head - s_tail)) < len)
+    {
+        s_dropped++;
+        return;
+    }
+    chunk = APP_LOG_RING_SIZE - (head & (APP_LOG_RING_SIZE - 1));
+    if (chunk > len)
+    {
+        chunk = len;
+    }
+    memcpy(&s_ring[head & (APP_LOG_RING_SIZE - 1)], rec, chunk);
+    memcpy(&s_ring[0], &rec[chunk], len - chunk);
+    __DMB();                            // The record is in the ring before the drain task can see it
+    s_head = head + len;
+#else
+    uint32_t args[APP_LOG_ARGS_MAX] = { 0 };
+
+    memcpy(args, p_args, (size_t)((argCnt < APP_LOG_ARGS_MAX) ? argCnt : APP_LOG_ARGS_MAX) * sizeof(uint32_t));
+    SYS_CONSOLE_PRINT(s_fmt[id], args[0], args[1], args[2], args[3], args[4], args[5], args[6], args[7]);
+#endif
+}
+
+/* Init the log and start the drain task */
+void APP_LOG_Init(void)
+{
+#if APP_LOG_ON == 1
+    s_head = 0;
+    s_tail = 0;
+    s_dropped = 0;
+    s_droppedSent = 0;
+    s_consoleHandle = SYS_CONSOLE_HandleGet(SYS_CONSOLE_INDEX_0);
+    /* Same priority as the application task, which never blocks while the radio is polled, so time slicing shares the
+     * CPU.  When there is nothing to send, the task sleeps APP_LOG_DRAIN_MS. */
+    (void)xTaskCreate(APP_LOG_Task, "APP_LOG", APP_LOG_TASK_STACK, NULL, 1, NULL);
+#endif
+}
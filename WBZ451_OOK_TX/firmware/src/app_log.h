@@ -0,0 +1,107 @@
+/*******************************************************************************
+  Application Tokenized Log Header File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_log.h
+
+  Summary:
+    This file contains the Application tokenized (binary) log for this project.
+
+  Description:
+    The format strings of the log messages are listed in app_log_msgs.h and are
+    replaced by their index at build time.  APP_LOG() only copies the message ID,
+    a time stamp and the raw arguments to a ring buffer.  A separate task drains
+    the ring to the console UART, where host_sim/app_log_decode.py rebuilds the text
+    from the same app_log_msgs.h.
+ *******************************************************************************/
+
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2023 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+
+#ifndef APP_LOG_H
+#define APP_LOG_H
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdint.h>
+#include "app_log_msgs.h"
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+
+//  Set to 1 for the binary log, 0 to print the same messages as text with SYS_CONSOLE_PRINT (no decoder needed)
+#define    APP_LOG_ON                   1
+
+#define    APP_LOG_RING_SIZE            1024    /**< Bytes, must be a power of 2 */
+#define    APP_LOG_ARGS_MAX             8       /**< Arguments per message */
+#define    APP_LOG_DRAIN_MS             10      /**< Drain task period when the ring is empty or the UART is busy */
+#define    APP_LOG_TASK_STACK           256     /**< Drain task stack, words */
+
+//  Record: [Sync][ID][Arg count][Time ms, 4 bytes][Args, 4 bytes each][Checksum], little endian.  The checksum is the
+//  sum of the bytes from the ID to the last argument.  ASCII text from SYS_CONSOLE_PRINT never contains the sync byte.
+#define    APP_LOG_SYNC                 0xA5
+#define    APP_LOG_REC_HDR_LEN          7
+#define    APP_LOG_REC_MAX_LEN          (APP_LOG_REC_HDR_LEN + (APP_LOG_ARGS_MAX * 4) + 1)
+
+/* Log a message of app_log_msgs.h.  All arguments are passed as 32 bit values, so %s and %f are not supported. */
+#define    APP_LOG(id, ...)             APP_LOG_Write((id), &((const uint32_t[]){ 0, ##__VA_ARGS__ })[1],          \
+                                                      (uint8_t)((sizeof((uint32_t[]){ 0, ##__VA_ARGS__ }) / sizeof(uint32_t)) - 1))
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+
+/**@brief Message IDs, in the order of APP_LOG_MSG_LIST.  The 1st message is APP_LOG_DROPPED. */
+#define APP_LOG_MSG_ID(name, fmt)   name,
+typedef enum
+{
+    APP_LOG_MSG_LIST(APP_LOG_MSG_ID)
+    APP_LOG_MSG_CNT
+} APP_LOG_Msg_T;
+#undef APP_LOG_MSG_ID
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Function Prototypes
+// *****************************************************************************
+// *****************************************************************************
+void APP_LOG_Init(void);
+
+void APP_LOG_Write(APP_LOG_Msg_T id, const uint32_t *p_args, uint8_t argCnt);
+#endif
@@ -0,0 +1,32 @@
+/*******************************************************************************
+  Application Tokenized Log Messages
+
+  File Name:
+    app_log_msgs.h
+
+  Summary:
+    Format strings of the transmitter log messages, see app_log.h.
+
+  Description:
+    The message ID is the position in the list, so host_sim/app_log_decode.py must
+    be given the app_log_msgs.h the firmware was built with.  Add new messages
+    at the end.  The 1st message must be APP_LOG_DROPPED.
+ *******************************************************************************/
+
+#ifndef APP_LOG_MSGS_H
+#define APP_LOG_MSGS_H
+
+#define APP_LOG_MSG_LIST(X)                                                                                 \
+    X(APP_LOG_DROPPED,      "[LOG] %lu records dropped\n\r")                                                \
+    X(APP_LOG_TX_DATA,      "Data Sent: %ld\n\r")                                                           \
+    X(APP_LOG_OTA_RATE,     "[OTA] %lu bytes in %lu ms, %lu B/s (streamed %d)\n\r")                         \
+    X(APP_LOG_OTA_SHA256,   "[OTA] SHA-256 %08lx%08lx%08lx%08lx%08lx%08lx%08lx%08lx\n\r")                   \
+    X(APP_LOG_OTA_FLASH_ERR, "[OTA] Flash error 0x%lx at 0x%08lx\n\r")                                      \
+    X(APP_LOG_OTA_ZIP_ERR,  "[OTA] Page %lu: block of %u bytes does not decode\n\r")                        \
+    X(APP_LOG_OTA_UNPACKED, "[OTA] %lu bytes unpacked to %lu\n\r")                                          \
+    X(APP_LOG_OTA_BCAST_START, "[OTA] Broadcast image %u: %lu bytes, %u generations, CRC 0x%08lx\n\r")      \
+    X(APP_LOG_OTA_BCAST_PROGRESS, "[OTA] Broadcast %u/%u generations, %lu symbols (%lu useful)\n\r")        \
+    X(APP_LOG_OTA_BCAST_DONE, "[OTA] Broadcast image %u received: %lu symbols (%lu useful) in %lu ms\n\r")  \
+    X(APP_LOG_OTA_BCAST_FAIL, "[OTA] Broadcast image %u failed (%d: 0 flash or CRC-32, 1 validation)\n\r")
+
+#endif
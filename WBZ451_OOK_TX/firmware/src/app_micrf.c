@@ -0,0 +1,673 @@
+/*******************************************************************************
+  Application MICRF Control Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_micrf.c
+
+  Summary:
+    This file contains the Application MICRF transmitter control functions for this project.
+
+  Description:
+    This file contains the TRPS vendor command set used to select the MICRF
+    rate profile and to run the throughput/PER benchmark on a rate profile.
+ *******************************************************************************/
+
+//DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2023 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+//DOM-IGNORE-END
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdint.h>
+#include <string.h>
+#include "definitions.h"
+#include "system/console/sys_console.h"
+#include "app.h"
+#include "app_trps.h"
+#include "app_micrf.h"
+#include "app_error_defs.h"
+#include "app_ota/app_ota_handler.h"
+#include "app_ota/app_ota_bcast.h"
+#include "app_timer/app_timer.h"
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Local Variables
+// *****************************************************************************
+// *****************************************************************************
+
+/**@brief Benchmark run state */
+typedef struct
+{
+    bool        bRunning;       /**< A benchmark run is in progress */
+    uint8_t     profile;        /**< Rate profile of the run */
+    uint16_t    sent;           /**< Frames sent */
+    uint16_t    total;          /**< Frames to send */
+    uint32_t    startTick;      /**< Tick count when the run started */
+    uint32_t    elapsedMs;      /**< Duration of the run */
+} APP_MICRF_Bench_T;
+
+/**@brief BLE to sub-GHz modem state */
+typedef struct
+{
+    uint8_t     buf[APP_MICRF_MODEM_BUF_LEN];   /**< Last write of the central */
+    uint16_t    len;            /**< Bytes in buf */
+    uint16_t    offset;         /**< Next packet in buf, len = all queued */
+    uint16_t    connHandle;     /**< Connection of the central */
+    bool        bEvtPending;    /**< APP_TIMER_MICRF_MODEM runs or APP_MSG_MICRF_MODEM_EVT is in the queue */
+    uint32_t    packets;        /**< Counters, see APP_MICRF_ModemRsp_T */
+    uint32_t    bytes;
+    uint16_t    rejected;
+    uint32_t    firstTick;      /**< Tick count the 1st packet was queued */
+    uint32_t    lastTick;       /**< Tick count the last packet was sent */
+} APP_MICRF_Modem_T;
+
+static APP_MICRF_Bench_T     s_bench;
+static APP_MICRF_Modem_T     s_modem;
+static APP_OTA_BcastTx_T     s_bcastTx;
+static bool                  s_bcastEvtPending;     /**< APP_TIMER_MICRF_BCAST runs or its event is in the queue */
+static APP_MICRF_BcastRsp_T  s_bcastRsp;
+static APP_MICRF_ModemRsp_T  s_modemRsp;
+static APP_MICRF_RateRsp_T   s_rateRsp;
+static APP_MICRF_BenchRsp_T  s_benchRsp;
+static APP_MICRF_ProfRsp_T  s_profRsp;
+static APP_MICRF_ProfHistRsp_T s_profHistRsp;
+
+/**@brief Console names of the ISR paths, eMICRF_prof_t order */
+static const char * const s_profPathName[eMICRF_PROF_CNT] = { "bit", "byte", "gap" };
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Global Variables
+// *****************************************************************************
+// *****************************************************************************
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Functions
+// *****************************************************************************
+// *****************************************************************************
+static uint8_t APP_MICRF_Rate_Set(uint8_t *p_cmd);
+static uint8_t APP_MICRF_Rate_Get(uint8_t *p_cmd);
+static uint8_t APP_MICRF_Bench_Start(uint8_t *p_cmd);
+static uint8_t APP_MICRF_Bench_Get(uint8_t *p_cmd);
+static uint8_t APP_MICRF_Msg_Send(uint8_t *p_cmd);
+static uint8_t APP_MICRF_Redundancy_Set(uint8_t *p_cmd);
+static uint8_t APP_MICRF_Prof_Get(uint8_t *p_cmd);
+static uint8_t APP_MICRF_Prof_Hist(uint8_t *p_cmd);
+static uint8_t APP_MICRF_Prof_Reset(uint8_t *p_cmd);
+static uint8_t APP_MICRF_Modem_Get(uint8_t *p_cmd);
+static uint8_t APP_MICRF_Modem_Reset(uint8_t *p_cmd);
+static uint8_t APP_MICRF_Bcast_Stage(uint8_t *p_cmd);
+static uint8_t APP_MICRF_Bcast_Start(uint8_t *p_cmd);
+static uint8_t APP_MICRF_Bcast_Stop(uint8_t *p_cmd);
+static uint8_t APP_MICRF_Bcast_Get(uint8_t *p_cmd);
+static uint32_t APP_MICRF_AirTimeMs(uint8_t len);
+
+APP_TRPS_CmdResp_T appTrpsMicrfCmdResp[] = 
+{
+    MICRF_DEFINE_CTRL_CMD_RESP()
+};
+
+/* Select the transmitter rate profile through Mobile app */
+static uint8_t APP_MICRF_Rate_Set(uint8_t *p_cmd)
+{
+    if (p_cmd[3] >= eMICRF_RATE_CNT)
+    {
+        return INVALID_PARAMETER;
+    }
+    if (s_bench.bRunning || !TX_setRateProfile((eMICRF_rate_t)p_cmd[3]))
+    {
+        return OPERATION_FAILED;
+    }
+    SYS_CONSOLE_PRINT("[MICRF] Rate %d bps\n\r", MICRF_getBitRate(TX_getRateProfile()));
+    return SUCCESS;
+}
+
+/* Read the transmitter rate profile through Mobile app */
+static uint8_t APP_MICRF_Rate_Get(uint8_t *p_cmd)
+{
+    eMICRF_rate_t eRate = TX_getRateProfile();
+    uint16_t bitRate = MICRF_getBitRate(eRate);
+
+    s_rateRsp.profile = (uint8_t)eRate;
+    s_rateRsp.bitRateMsb = (uint8_t)(bitRate >> 8);
+    s_rateRsp.bitRateLsb = (uint8_t)bitRate;
+    return SUCCESS;
+}
+
+/* Start a benchmark run of p_cmd[3..4] frames on the current rate profile through Mobile app */
+static uint8_t APP_MICRF_Bench_Start(uint8_t *p_cmd)
+{
+    APP_Msg_T appMsg;
+    uint16_t total = ((uint16_t)p_cmd[3] << 8) | p_cmd[4];
+
+    if (total == 0)
+    {
+        return INVALID_PARAMETER;
+    }
+    if (s_bench.bRunning || s_bcastTx.active)
+    {
+        return OPERATION_FAILED;
+    }
+    memset(&s_bench, 0, sizeof(s_bench));
+    s_bench.bRunning = true;
+    s_bench.profile = (uint8_t)TX_getRateProfile();
+    s_bench.total = total;
+    s_bench.startTick = xTaskGetTickCount();
+
+    appMsg.msgId = APP_MSG_MICRF_BENCH_EVT;
+    OSAL_QUEUE_Send(&appData.appQueue, &appMsg, 0);
+    return SUCCESS;
+}
+
+/* Read the results of the last benchmark run through Mobile app */
+static uint8_t APP_MICRF_Bench_Get(uint8_t *p_cmd)
+{
+    uint32_t elapsedMs = s_bench.elapsedMs;
+    uint16_t throughput = 0;
+
+    if (s_bench.bRunning)
+    {
+        elapsedMs = (xTaskGetTickCount() - s_bench.startTick) * portTICK_PERIOD_MS;
+    }
+    if (elapsedMs != 0)
+    {
+        throughput = (uint16_t)(((uint32_t)s_bench.sent * APP_MICRF_BENCH_FRAME_LEN * 8 * 1000) / elapsedMs);
+    }
+
+    s_benchRsp.profile = s_bench.profile;
+    s_benchRsp.sentMsb = (uint8_t)(s_bench.sent >> 8);
+    s_benchRsp.sentLsb = (uint8_t)s_bench.sent;
+    s_benchRsp.totalMsb = (uint8_t)(s_bench.total >> 8);
+    s_benchRsp.totalLsb = (uint8_t)s_bench.total;
+    s_benchRsp.elapsedMs[0] = (uint8_t)(elapsedMs >> 24);
+    s_benchRsp.elapsedMs[1] = (uint8_t)(elapsedMs >> 16);
+    s_benchRsp.elapsedMs[2] = (uint8_t)(elapsedMs >> 8);
+    s_benchRsp.elapsedMs[3] = (uint8_t)elapsedMs;
+    s_benchRsp.throughputMsb = (uint8_t)(throughput >> 8);
+    s_benchRsp.throughputLsb = (uint8_t)throughput;
+    return SUCCESS;
+}
+
+/* Send a test message of p_cmd[3] bytes in fragments through Mobile app.  Byte n of the message is n. */
+static uint8_t APP_MICRF_Msg_Send(uint8_t *p_cmd)
+{
+    uint8_t msg[TX_MESSAGE_MAX_SIZE];
+    uint16_t i;
+
+    if ((p_cmd[3] == 0) || (p_cmd[3] > TX_MESSAGE_MAX_SIZE))
+    {
+        return INVALID_PARAMETER;
+    }
+    for (i = 0; i < p_cmd[3]; i++)
+    {
+        msg[i] = (uint8_t)i;
+    }
+    if (!TX_sendMessage(msg, p_cmd[3]))
+    {
+        return OPERATION_FAILED;
+    }
+    // The 1st fragment is on air, the next one is sent from APP_MICRF_MsgHandler()
+    (void)APP_TIMER_SetTimer(APP_TIMER_MICRF_MSG, APP_MICRF_AirTimeMs(TX_DATA_MAX_SIZE), false);
+    return SUCCESS;
+}
+
+/* Set the copies [3], gap [4..5] and jitter [6..7] (mS) of every packet through Mobile app */
+static uint8_t APP_MICRF_Redundancy_Set(uint8_t *p_cmd)
+{
+    uint16_t gapMs = ((uint16_t)p_cmd[4] << 8) | p_cmd[5];
+    uint16_t jitterMs = ((uint16_t)p_cmd[6] << 8) | p_cmd[7];
+
+    if (!TX_setRedundancy(p_cmd[3], gapMs, jitterMs))
+    {
+        return INVALID_PARAMETER;
+    }
+    SYS_CONSOLE_PRINT("[MICRF] %d copies, gap %d+%d mS\n\r", p_cmd[3], gapMs, jitterMs);
+    return SUCCESS;
+}
+
+/* Store a 32 bit value MSB first */
+static void APP_MICRF_PutU32(uint8_t *p_dst, uint32_t val)
+{
+    p_dst[0] = (uint8_t)(val >> 24);
+    p_dst[1] = (uint8_t)(val >> 16);
+    p_dst[2] = (uint8_t)(val >> 8);
+    p_dst[3] = (uint8_t)val;
+}
+
+/* Read the ISR execution time of the path in p_cmd[3] through Mobile app.  Prints all paths to the console too. */
+static uint8_t APP_MICRF_Prof_Get(uint8_t *p_cmd)
+{
+    profStat_t stat;
+    uint32_t min, ave;
+
+    if (p_cmd[3] >= eMICRF_PROF_CNT)
+    {
+        return INVALID_PARAMETER;
+    }
+    if (!MICRF_getProfile((eMICRF_prof_t)p_cmd[3], &stat))
+    {
+        return OPERATION_FAILED;    // Profiling not built in, DVR_PROF_ON
+    }
+    min = (stat.min > UINT16_MAX) ? UINT16_MAX : stat.min;
+    ave = DVR_PROF_average(&stat);
+    ave = (ave > UINT16_MAX) ? UINT16_MAX : ave;
+
+    s_profRsp.path = p_cmd[3];
+    APP_MICRF_PutU32(s_profRsp.cnt, stat.cnt);
+    s_profRsp.minMsb = (uint8_t)(min >> 8);
+    s_profRsp.minLsb = (uint8_t)min;
+    s_profRsp.aveMsb = (uint8_t)(ave >> 8);
+    s_profRsp.aveLsb = (uint8_t)ave;
+    APP_MICRF_PutU32(s_profRsp.max, stat.max);
+    APP_MICRF_ProfilePrint();
+    return SUCCESS;
+}
+
+/* Read a block of the ISR histogram through Mobile app: [3] = path, [4] = 1st bin */
+static uint8_t APP_MICRF_Prof_Hist(uint8_t *p_cmd)
+{
+    profStat_t stat;
+    uint8_t i;
+
+    if (p_cmd[3] >= eMICRF_PROF_CNT)
+    {
+        return INVALID_PARAMETER;
+    }
+    if (!MICRF_getProfile((eMICRF_prof_t)p_cmd[3], &stat))
+    {
+        return OPERATION_FAILED;
+    }
+    memset(&s_profHistRsp, 0, sizeof(s_profHistRsp));
+    s_profHistRsp.path = p_cmd[3];
+    s_profHistRsp.first = p_cmd[4];
+    for (i = 0; (i < APP_MICRF_PROF_HIST_MAX) && ((p_cmd[4] + i) < DVR_PROF_HIST_BINS); i++)
+    {
+        APP_MICRF_PutU32(s_profHistRsp.bins[i], stat.hist[p_cmd[4] + i]);
+    }
+    return SUCCESS;
+}
+
+/* Clear the ISR execution times through Mobile app */
+static uint8_t APP_MICRF_Prof_Reset(uint8_t *p_cmd)
+{
+    MICRF_clearProfile();
+    return SUCCESS;
+}
+
+/* Read the BLE to sub-GHz modem counters through Mobile app */
+static uint8_t APP_MICRF_Modem_Get(uint8_t *p_cmd)
+{
+    uint8_t  pending = TX_getQueueCnt(eTX_PRIORITY_CNT);
+    uint32_t elapsedMs = 0, sentBytes = 0, throughput = 0;
+
+    if (s_modem.packets != 0)
+    {
+        elapsedMs = (((pending != 0) ? xTaskGetTickCount() : s_modem.lastTick) - s_modem.firstTick) * portTICK_PERIOD_MS;
+        // The queue does not keep the sizes, the packets still queued are taken to be of average size
+        sentBytes = (uint32_t)(((uint64_t)s_modem.bytes * (s_modem.packets - pending)) / s_modem.packets);
+    }
+    if (elapsedMs != 0)
+    {
+        throughput = (uint32_t)(((uint64_t)sentBytes * 8 * 1000) / elapsedMs);
+        throughput = (throughput > UINT16_MAX) ? UINT16_MAX : throughput;
+    }
+
+    APP_MICRF_PutU32(s_modemRsp.packets, s_modem.packets);
+    APP_MICRF_PutU32(s_modemRsp.bytes, s_modem.bytes);
+    s_modemRsp.rejectedMsb = (uint8_t)(s_modem.rejected >> 8);
+    s_modemRsp.rejectedLsb = (uint8_t)s_modem.rejected;
+    s_modemRsp.pending = pending;
+    APP_MICRF_PutU32(s_modemRsp.elapsedMs, elapsedMs);
+    s_modemRsp.throughputMsb = (uint8_t)(throughput >> 8);
+    s_modemRsp.throughputLsb = (uint8_t)throughput;
+    return SUCCESS;
+}
+
+/* Clear the BLE to sub-GHz modem counters through Mobile app */
+static uint8_t APP_MICRF_Modem_Reset(uint8_t *p_cmd)
+{
+    s_modem.packets = 0;
+    s_modem.bytes = 0;
+    s_modem.rejected = 0;
+    return SUCCESS;
+}
+
+/* Stage the next streamed BLE update for the broadcast (p_cmd[3] = 1) or install it (0) through Mobile app */
+static uint8_t APP_MICRF_Bcast_Stage(uint8_t *p_cmd)
+{
+    if (p_cmd[3] > 1)
+    {
+        return INVALID_PARAMETER;
+    }
+    if (s_bcastTx.active)
+    {
+        return OPERATION_FAILED;
+    }
+    APP_OTA_HDL_Stage(p_cmd[3] != 0);
+    return SUCCESS;
+}
+
+/* Start the broadcast of the staged image as image ID p_cmd[3], with p_cmd[4] % repair symbols, through Mobile app */
+static uint8_t APP_MICRF_Bcast_Start(uint8_t *p_cmd)
+{
+    APP_Msg_T appMsg;
+    uint8_t extraPct = (p_cmd[4] != 0) ? p_cmd[4] : APP_MICRF_BCAST_EXTRA_PCT;
+
+    if (s_bcastTx.active || s_bench.bRunning ||
+        !APP_OTA_BcastTxStart(&s_bcastTx, p_cmd[3], APP_OTA_HDL_GetStaged(), extraPct))
+    {
+        return OPERATION_FAILED;
+    }
+    SYS_CONSOLE_PRINT("[MICRF] Broadcast image %d: %lu bytes, %d generations, CRC 0x%08lx\n\r", s_bcastTx.imgId,
+                      (unsigned long)s_bcastTx.size, s_bcastTx.gens, (unsigned long)s_bcastTx.crc);
+    if (!s_bcastEvtPending)
+    {
+        s_bcastEvtPending = true;
+        appMsg.msgId = APP_MSG_MICRF_BCAST_EVT;
+        OSAL_QUEUE_Send(&appData.appQueue, &appMsg, 0);
+    }
+    return SUCCESS;
+}
+
+/* Stop the broadcast through Mobile app */
+static uint8_t APP_MICRF_Bcast_Stop(uint8_t *p_cmd)
+{
+    if (s_bcastTx.active)
+    {
+        s_bcastTx.active = false;
+        SYS_CONSOLE_PRINT("[MICRF] Broadcast stopped: %lu frames, %d passes\n\r", (unsigned long)s_bcastTx.frames,
+                          s_bcastTx.pass);
+    }
+    return SUCCESS;
+}
+
+/* Read the broadcast state through Mobile app */
+static uint8_t APP_MICRF_Bcast_Get(uint8_t *p_cmd)
+{
+    s_bcastRsp.running = s_bcastTx.active ? 1 : 0;
+    s_bcastRsp.imgId = s_bcastTx.imgId;
+    APP_MICRF_PutU32(s_bcastRsp.size, (s_bcastTx.size != 0) ? s_bcastTx.size : APP_OTA_HDL_GetStaged());
+    s_bcastRsp.gensMsb = (uint8_t)(s_bcastTx.gens >> 8);
+    s_bcastRsp.gensLsb = (uint8_t)s_bcastTx.gens;
+    s_bcastRsp.passMsb = (uint8_t)(s_bcastTx.pass >> 8);
+    s_bcastRsp.passLsb = (uint8_t)s_bcastTx.pass;
+    APP_MICRF_PutU32(s_bcastRsp.frames, s_bcastTx.frames);
+    return SUCCESS;
+}
+
+/* Queue the packets of the last write of the central in the transmitter.  Returns false if the transmitter queue is
+ * full, the rest of the write is queued on a later call. */
+static bool APP_MICRF_ModemQueue(void)
+{
+    uint8_t *p_pkt;
+    uint8_t prio, copies, cnt;
+
+    while ((s_modem.len - s_modem.offset) >= APP_MICRF_MODEM_HDR_LEN)
+    {
+        p_pkt = &s_modem.buf[s_modem.offset];
+        prio = p_pkt[2] >> APP_MICRF_MODEM_PRIO_SHIFT;
+        copies = p_pkt[2] & APP_MICRF_MODEM_COPIES_MASK;
+        cnt = p_pkt[3];
+        if ((prio >= eTX_PRIORITY_CNT) || (cnt > TX_DATA_MAX_SIZE) ||
+            ((s_modem.len - s_modem.offset) < (APP_MICRF_MODEM_HDR_LEN + cnt)))
+        {
+            break;
+        }
+        if (!TX_queueData((serialNum_t)(((uint16_t)p_pkt[0] << 8) | p_pkt[1]), &p_pkt[APP_MICRF_MODEM_HDR_LEN], cnt,
+                          copies, (eTX_priority_t)prio))
+        {
+            return false;
+        }
+        if (s_modem.packets == 0)
+        {
+            s_modem.firstTick = xTaskGetTickCount();
+        }
+        s_modem.packets++;
+        s_modem.bytes += cnt;
+        s_modem.offset += APP_MICRF_MODEM_HDR_LEN + cnt;
+    }
+    if (s_modem.offset != s_modem.len)
+    {   // Invalid or cut short, the rest of the write can't be parsed
+        s_modem.rejected++;
+        s_modem.offset = s_modem.len;
+    }
+    return true;
+}
+
+/* The central wrote to the TRP data channel, BLE_TRSPS_EVT_RECEIVE_DATA */
+void APP_MICRF_ModemRxEvt(uint16_t connHandle)
+{
+    APP_Msg_T appMsg;
+
+    s_modem.connHandle = connHandle;
+    if (!s_modem.bEvtPending)
+    {
+        s_modem.bEvtPending = true;
+        appMsg.msgId = APP_MSG_MICRF_MODEM_EVT;
+        OSAL_QUEUE_Send(&appData.appQueue, &appMsg, 0);
+    }
+}
+
+/* Queue the writes of the central in the transmitter and send them, called from the application task on
+ * APP_MSG_MICRF_MODEM_EVT.  Runs again until the writes are read and the transmitter queue is empty, from
+ * APP_TIMER_MICRF_MODEM while the transmitter is busy. */
+void APP_MICRF_ModemHandler(void)
+{
+    APP_Msg_T appMsg;
+    uint16_t len = 0;
+    uint32_t timeout = APP_TIMER_10MS;
+    bool bIdle;
+    bool bMore;
+
+    s_modem.bEvtPending = false;
+    while (APP_MICRF_ModemQueue())
+    {
+        BLE_TRSPS_GetDataLength(s_modem.connHandle, &len);
+        if ((len == 0) || (BLE_TRSPS_GetData(s_modem.connHandle, s_modem.buf) != APP_RES_SUCCESS))
+        {
+            break;                  // No write waiting
+        }
+        s_modem.len = len;
+        s_modem.offset = 0;
+    }
+    bIdle = TX_isIdle();
+    bMore = TX_process() || (s_modem.offset != s_modem.len) || !TX_isIdle();   // Also until the last packet is out
+    if (bIdle && !TX_isIdle())
+    {
+        timeout = APP_MICRF_AirTimeMs(1);   // A packet started, it has 1 byte at least
+    }
+    if (TX_isIdle() && (TX_getQueueCnt(eTX_PRIORITY_CNT) == 0))
+    {
+        s_modem.lastTick = xTaskGetTickCount();
+    }
+    if (len != 0)
+    {   // A write was read, the next one may be waiting.  One write per message, so the BLE stack events are serviced.
+        s_modem.bEvtPending = true;
+        appMsg.msgId = APP_MSG_MICRF_MODEM_EVT;
+        OSAL_QUEUE_Send(&appData.appQueue, &appMsg, 0);
+    }
+    else if (bMore)
+    {   // Woken up when the transmitter may take the next packet
+        s_modem.bEvtPending = (APP_TIMER_SetTimer(APP_TIMER_MICRF_MODEM, timeout, false) == APP_RES_SUCCESS);
+    }
+}
+
+/* Print the ISR execution time of each path to the console, CPU cycles:
+ *   [PROF] <path> cnt=<n> min=<c> ave=<c> max=<c> hist=<bin>:<count> ...
+ * Bin n holds 2^(n-1) to 2^n - 1 cycles, empty bins are left out. */
+void APP_MICRF_ProfilePrint(void)
+{
+    profStat_t stat;
+    uint8_t path, bin;
+
+    for (path = 0; path < eMICRF_PROF_CNT; path++)
+    {
+        if (!MICRF_getProfile((eMICRF_prof_t)path, &stat))
+        {
+            return;
+        }
+        SYS_CONSOLE_PRINT("[PROF] %s cnt=%lu min=%lu ave=%lu max=%lu hist=", s_profPathName[path],
+                          (unsigned long)stat.cnt, (unsigned long)stat.min,
+                          (unsigned long)DVR_PROF_average(&stat), (unsigned long)stat.max);
+        for (bin = 0; bin < DVR_PROF_HIST_BINS; bin++)
+        {
+            if (stat.hist[bin] != 0)
+            {
+                SYS_CONSOLE_PRINT(" %d:%lu", bin, (unsigned long)stat.hist[bin]);
+            }
+        }
+        SYS_CONSOLE_PRINT("\n\r");
+    }
+}
+
+/* Shortest air time of a frame of len bytes at the current rate profile, at least APP_TIMER_10MS */
+static uint32_t APP_MICRF_AirTimeMs(uint8_t len)
+{
+    uint16_t bitRate = MICRF_getBitRate(TX_getRateProfile());
+    uint32_t ms = APP_TIMER_10MS;
+
+    if (bitRate != 0)
+    {
+        ms = ((uint32_t)(len + APP_MICRF_FRAME_OVERHEAD) * 8U * 1000U) / bitRate;
+    }
+    return (ms > APP_TIMER_10MS) ? ms : APP_TIMER_10MS;
+}
+
+/* Send the next benchmark frame, called from the application task on APP_MSG_MICRF_BENCH_EVT */
+void APP_MICRF_BenchHandler(void)
+{
+    uint8_t frame[APP_MICRF_BENCH_FRAME_LEN];
+    uint32_t timeout = APP_TIMER_10MS;
+
+    if (!s_bench.bRunning)
+    {
+        return;
+    }
+    if (TX_isIdle() && (s_bench.sent == s_bench.total))
+    {   // The last frame is out
+        s_bench.bRunning = false;
+        s_bench.elapsedMs = (xTaskGetTickCount() - s_bench.startTick) * portTICK_PERIOD_MS;
+        SYS_CONSOLE_PRINT("[MICRF] Bench %d bps: %d frames in %ld mS\n\r",
+                          MICRF_getBitRate((eMICRF_rate_t)s_bench.profile), s_bench.sent, s_bench.elapsedMs);
+        APP_MICRF_ProfilePrint();
+        return;
+    }
+    if (TX_isIdle())
+    {
+        frame[0] = APP_MICRF_BENCH_MAGIC;
+        frame[1] = s_bench.profile;
+        frame[2] = (uint8_t)(s_bench.sent >> 8);
+        frame[3] = (uint8_t)s_bench.sent;
+        frame[4] = (uint8_t)(s_bench.total >> 8);
+        frame[5] = (uint8_t)s_bench.total;
+        if (TX_sendData(frame, sizeof(frame)))
+        {
+            s_bench.sent++;
+            timeout = APP_MICRF_AirTimeMs(sizeof(frame));
+        }
+    }
+    // Woken up when the frame is out, so the application task sleeps during a run.
+    if (APP_TIMER_SetTimer(APP_TIMER_MICRF_BENCH, timeout, false) != APP_RES_SUCCESS)
+    {
+        s_bench.bRunning = false;
+        SYS_CONSOLE_PRINT("[MICRF] Bench stopped, no timer\n\r");
+    }
+}
+
+/* Send the next fragment of the message, called from the application task on APP_MSG_MICRF_MSG_EVT */
+void APP_MICRF_MsgHandler(void)
+{
+    uint32_t timeout = APP_TIMER_10MS;
+
+    if (TX_isIdle())
+    {
+        if (!TX_process())
+        {
+            return;     // The last fragment is out
+        }
+        timeout = APP_MICRF_AirTimeMs(TX_DATA_MAX_SIZE);   // A fragment fills a packet, only the last one is shorter
+    }
+    // Woken up when the fragment is out, so the application task sleeps during the message.
+    (void)APP_TIMER_SetTimer(APP_TIMER_MICRF_MSG, timeout, false);
+}
+
+/* Send the next broadcast frame, called from the application task on APP_MSG_MICRF_BCAST_EVT */
+void APP_MICRF_BcastHandler(void)
+{
+    uint8_t frame[APP_OTA_BCAST_FRAME_MAX];
+    uint8_t len;
+    uint32_t timeout = APP_TIMER_10MS;
+
+    s_bcastEvtPending = false;
+    if (s_bcastTx.active && (APP_OTA_HDL_GetStaged() != s_bcastTx.size))
+    {   // A BLE update took the slot
+        s_bcastTx.active = false;
+        SYS_CONSOLE_PRINT("[MICRF] Broadcast stopped, image %d is no longer staged\n\r", s_bcastTx.imgId);
+    }
+    if (!s_bcastTx.active)
+    {
+        return;
+    }
+    if (TX_isIdle())
+    {   // One copy: the code is the redundancy, a frame that is not sent is a lost frame to the receivers
+        len = APP_OTA_BcastTxNext(&s_bcastTx, frame);
+        if ((len != 0) && TX_sendDataBurst(frame, len, 1, 0, 0))
+        {
+            timeout = APP_MICRF_AirTimeMs(len);
+        }
+    }
+    // Woken up when the frame is out, so the application task sleeps during the broadcast.
+    if (APP_TIMER_SetTimer(APP_TIMER_MICRF_BCAST, timeout, false) == APP_RES_SUCCESS)
+    {
+        s_bcastEvtPending = true;
+    }
+    else
+    {
+        s_bcastTx.active = false;
+        SYS_CONSOLE_PRINT("[MICRF] Broadcast stopped, no timer\n\r");
+    }
+}
+
+/* Init MICRF Specific */
+void APP_MICRF_Init(void)
+{
+    memset(&s_bench, 0, sizeof(s_bench));
+    memset(&s_modem, 0, sizeof(s_modem));
+    memset(&s_bcastTx, 0, sizeof(s_bcastTx));
+    s_bcastEvtPending = false;
+
+    /* Init TRPS profile with MICRF specific command structure*/
+    APP_TRPS_Init(APP_TRP_VENDOR_OPCODE_MICRF,appTrpsMicrfCmdResp,NULL,MICRF_CMD_RESP_LST_SIZE,0);
+}
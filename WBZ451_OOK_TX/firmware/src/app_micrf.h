@@ -0,0 +1,259 @@
+/*******************************************************************************
+  Application MICRF Control Header File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_micrf.h
+
+  Summary:
+    This file contains the Application MICRF transmitter control functions for this project.
+
+  Description:
+    This file contains the TRPS vendor command set used to select the MICRF
+    rate profile and to run the throughput/PER benchmark on a rate profile.
+ *******************************************************************************/
+
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2023 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+
+#ifndef APP_MICRF_H
+#define APP_MICRF_H
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include "gatt.h"
+#include "app_trps.h"
+#include "MICRF114/transmitter.h"
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+
+// Define for MICRF Ctrl Commands
+
+#define APP_TRP_VENDOR_OPCODE_MICRF  0x8B
+//  Defines MICRF Control Command Set APP_TRPS_CTRL_CMD
+#define    MICRF_RATE_SET_CMD       0x10
+#define    MICRF_RATE_GET_CMD       0x11
+#define    MICRF_BENCH_START_CMD    0x12
+#define    MICRF_BENCH_GET_CMD      0x13
+#define    MICRF_MSG_SEND_CMD       0x14
+#define    MICRF_REDUNDANCY_SET_CMD 0x15
+#define    MICRF_PROF_GET_CMD       0x16
+#define    MICRF_PROF_HIST_CMD      0x17
+#define    MICRF_PROF_RESET_CMD     0x18
+#define    MICRF_MODEM_GET_CMD      0x19
+#define    MICRF_MODEM_RESET_CMD    0x1A
+#define    MICRF_BCAST_STAGE_CMD    0x1B
+#define    MICRF_BCAST_START_CMD    0x1C
+#define    MICRF_BCAST_STOP_CMD     0x1D
+#define    MICRF_BCAST_GET_CMD      0x1E
+
+
+//  Defines MICRF Response Command Set APP_TRPS_CTRL_RSP
+#define    MICRF_RATE_SET_RSP       0x20
+#define    MICRF_RATE_GET_RSP       0x21
+#define    MICRF_BENCH_START_RSP    0x22
+#define    MICRF_BENCH_GET_RSP      0x23
+#define    MICRF_MSG_SEND_RSP       0x24
+#define    MICRF_REDUNDANCY_SET_RSP 0x25
+#define    MICRF_PROF_GET_RSP       0x26
+#define    MICRF_PROF_HIST_RSP      0x27
+#define    MICRF_PROF_RESET_RSP     0x28
+#define    MICRF_MODEM_GET_RSP      0x29
+#define    MICRF_MODEM_RESET_RSP    0x2A
+#define    MICRF_BCAST_STAGE_RSP    0x2B
+#define    MICRF_BCAST_START_RSP    0x2C
+#define    MICRF_BCAST_STOP_RSP     0x2D
+#define    MICRF_BCAST_GET_RSP      0x2E
+
+
+//  Defines MICRF Response Command length APP_TRPS_CTRL_RSP_LENGTH
+#define    MICRF_RATE_SET_RSP_LEN   0x0
+#define    MICRF_RATE_GET_RSP_LEN   0x3
+#define    MICRF_BENCH_START_RSP_LEN 0x0
+#define    MICRF_BENCH_GET_RSP_LEN  0xB
+#define    MICRF_MSG_SEND_RSP_LEN   0x0
+#define    MICRF_REDUNDANCY_SET_RSP_LEN 0x0
+#define    MICRF_PROF_GET_RSP_LEN   0xD
+#define    MICRF_PROF_HIST_RSP_LEN  0xE
+#define    MICRF_PROF_RESET_RSP_LEN 0x0
+#define    MICRF_MODEM_GET_RSP_LEN  0x11
+#define    MICRF_MODEM_RESET_RSP_LEN 0x0
+#define    MICRF_BCAST_STAGE_RSP_LEN 0x0
+#define    MICRF_BCAST_START_RSP_LEN 0x0
+#define    MICRF_BCAST_STOP_RSP_LEN 0x0
+#define    MICRF_BCAST_GET_RSP_LEN  0xE
+
+//  The color packet is sent again after this while the transmitter is busy with the last one (see APP_TIMER_MICRF_TX)
+#define    APP_MICRF_TX_RETRY_MS        10      /**< Unit: ms. */
+
+//  A frame is on air for at least its bytes plus this many bytes of training, sync, header and CRC.  The benchmark, the
+//  fragmented message and the broadcast sleep that long after each frame (APP_MICRF_AirTimeMs()), then every
+//  APP_TIMER_10MS until the transmitter is idle.
+#define    APP_MICRF_FRAME_OVERHEAD     8       /**< Unit: bytes. */
+
+//  Benchmark frame sent to the receiver: [Magic][Profile][Seq MSB][Seq LSB][Total MSB][Total LSB]
+#define    APP_MICRF_BENCH_MAGIC        0xB5
+#define    APP_MICRF_BENCH_FRAME_LEN    6
+
+//  ISR profiling (DVR_PROF_ON): [Path] for MICRF_PROF_GET_CMD, [Path][1st bin] for MICRF_PROF_HIST_CMD
+#define    APP_MICRF_PROF_HIST_MAX      3       /**< Histogram bins per MICRF_PROF_HIST_RSP */
+
+//  BLE to sub-GHz modem: the central writes packets to the TRP data channel, any number per write:
+//    [Serial MSB][Serial LSB][Priority:2 | 0:2 | Copies:4][Cnt][Data]
+//  The serial number is sent with the packet in place of this transmitter's.  Priority is eTX_priority_t, copies 0 =
+//  as set by MICRF_REDUNDANCY_SET_CMD.  Cnt is up to TX_DATA_MAX_SIZE.  A write that does not fit in the transmitter
+//  queue waits, and the next write is not read until it does, so the TRP flow control holds the central back.
+#define    APP_MICRF_MODEM_HDR_LEN      4
+#define    APP_MICRF_MODEM_PRIO_SHIFT   6
+#define    APP_MICRF_MODEM_COPIES_MASK  0x0F
+#define    APP_MICRF_MODEM_BUF_LEN      (BLE_ATT_MAX_MTU_LEN - ATT_HANDLE_VALUE_HEADER_SIZE)  /**< Largest write */
+
+//  Firmware broadcast (app_ota/app_ota_bcast.h) of the image staged in the OTA slot:
+//    MICRF_BCAST_STAGE_CMD [1: stage the next streamed BLE update, 0: install it]
+//    MICRF_BCAST_START_CMD [Image ID][Repair symbols, % of the source symbols, 0 = APP_MICRF_BCAST_EXTRA_PCT]
+//  The broadcast runs until MICRF_BCAST_STOP_CMD, receivers that join late or lose frames complete on later passes.
+#define    APP_MICRF_BCAST_EXTRA_PCT    25
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+
+/**@brief The structure contains the rate profile response. */
+typedef struct __attribute__ ((packed))
+{
+    uint8_t    profile;             /**< Rate profile, eMICRF_rate_t */
+    uint8_t    bitRateMsb;          /**< Nominal bit rate, bits/second */
+    uint8_t    bitRateLsb;
+} APP_MICRF_RateRsp_T;
+
+/**@brief The structure contains the benchmark response of the last run. */
+typedef struct __attribute__ ((packed))
+{
+    uint8_t    profile;             /**< Rate profile, eMICRF_rate_t */
+    uint8_t    sentMsb;             /**< Number of benchmark frames sent so far */
+    uint8_t    sentLsb;
+    uint8_t    totalMsb;            /**< Number of benchmark frames requested */
+    uint8_t    totalLsb;
+    uint8_t    elapsedMs[4];        /**< Duration of the run in mS, MSB first */
+    uint8_t    throughputMsb;       /**< Payload throughput, bits/second */
+    uint8_t    throughputLsb;
+} APP_MICRF_BenchRsp_T;
+
+/**@brief The structure contains the execution time of one ISR path, CPU cycles. */
+typedef struct __attribute__ ((packed))
+{
+    uint8_t    path;                /**< ISR path, eMICRF_prof_t */
+    uint8_t    cnt[4];              /**< Times the path ran, MSB first */
+    uint8_t    minMsb;              /**< Fewest cycles, saturated at 0xFFFF */
+    uint8_t    minLsb;
+    uint8_t    aveMsb;              /**< Average cycles, saturated at 0xFFFF */
+    uint8_t    aveLsb;
+    uint8_t    max[4];              /**< Most cycles, MSB first */
+} APP_MICRF_ProfRsp_T;
+
+/**@brief The structure contains a block of the log2 histogram of one ISR path. */
+typedef struct __attribute__ ((packed))
+{
+    uint8_t    path;                /**< ISR path, eMICRF_prof_t */
+    uint8_t    first;               /**< 1st bin in bins, 0 = past the end */
+    uint8_t    bins[APP_MICRF_PROF_HIST_MAX][4];   /**< Counts, MSB first */
+} APP_MICRF_ProfHistRsp_T;
+
+/**@brief The structure contains the BLE to sub-GHz modem counters since the last MICRF_MODEM_RESET_CMD. */
+typedef struct __attribute__ ((packed))
+{
+    uint8_t    packets[4];          /**< Packets queued, MSB first */
+    uint8_t    bytes[4];            /**< Data bytes of the packets queued, MSB first */
+    uint8_t    rejectedMsb;         /**< Writes with an invalid packet, the rest of the write is dropped */
+    uint8_t    rejectedLsb;
+    uint8_t    pending;             /**< Packets queued but not sent yet */
+    uint8_t    elapsedMs[4];        /**< From the 1st packet queued to the last one sent, MSB first */
+    uint8_t    throughputMsb;       /**< Data throughput of the packets sent, bits/second */
+    uint8_t    throughputLsb;
+} APP_MICRF_ModemRsp_T;
+
+/**@brief The structure contains the state of the firmware broadcast. */
+typedef struct __attribute__ ((packed))
+{
+    uint8_t    running;             /**< 1 while frames are sent */
+    uint8_t    imgId;               /**< Image ID of the last broadcast */
+    uint8_t    size[4];             /**< Image bytes, staged image if no broadcast was started, MSB first */
+    uint8_t    gensMsb;             /**< Generations of the image */
+    uint8_t    gensLsb;
+    uint8_t    passMsb;             /**< Times every generation was sent */
+    uint8_t    passLsb;
+    uint8_t    frames[4];           /**< Frames sent, MSB first */
+} APP_MICRF_BcastRsp_T;
+
+#define MICRF_CMD_RESP_LST_SIZE   15
+#define MICRF_DEFINE_CTRL_CMD_RESP()                \
+        { MICRF_RATE_SET_CMD, MICRF_RATE_SET_RSP, MICRF_RATE_SET_RSP_LEN, NULL , APP_MICRF_Rate_Set},      \
+        { MICRF_RATE_GET_CMD, MICRF_RATE_GET_RSP, MICRF_RATE_GET_RSP_LEN, (uint8_t *)&s_rateRsp , APP_MICRF_Rate_Get},       \
+        { MICRF_BENCH_START_CMD, MICRF_BENCH_START_RSP, MICRF_BENCH_START_RSP_LEN, NULL , APP_MICRF_Bench_Start},      \
+        { MICRF_MSG_SEND_CMD, MICRF_MSG_SEND_RSP, MICRF_MSG_SEND_RSP_LEN, NULL , APP_MICRF_Msg_Send},      \
+        { MICRF_REDUNDANCY_SET_CMD, MICRF_REDUNDANCY_SET_RSP, MICRF_REDUNDANCY_SET_RSP_LEN, NULL , APP_MICRF_Redundancy_Set},      \
+        { MICRF_BENCH_GET_CMD, MICRF_BENCH_GET_RSP, MICRF_BENCH_GET_RSP_LEN, (uint8_t *)&s_benchRsp , APP_MICRF_Bench_Get},      \
+        { MICRF_PROF_GET_CMD, MICRF_PROF_GET_RSP, MICRF_PROF_GET_RSP_LEN, (uint8_t *)&s_profRsp , APP_MICRF_Prof_Get},      \
+        { MICRF_PROF_HIST_CMD, MICRF_PROF_HIST_RSP, MICRF_PROF_HIST_RSP_LEN, (uint8_t *)&s_profHistRsp , APP_MICRF_Prof_Hist},      \
+        { MICRF_PROF_RESET_CMD, MICRF_PROF_RESET_RSP, MICRF_PROF_RESET_RSP_LEN, NULL , APP_MICRF_Prof_Reset},      \
+        { MICRF_MODEM_GET_CMD, MICRF_MODEM_GET_RSP, MICRF_MODEM_GET_RSP_LEN, (uint8_t *)&s_modemRsp , APP_MICRF_Modem_Get},      \
+        { MICRF_MODEM_RESET_CMD, MICRF_MODEM_RESET_RSP, MICRF_MODEM_RESET_RSP_LEN, NULL , APP_MICRF_Modem_Reset},      \
+        { MICRF_BCAST_STAGE_CMD, MICRF_BCAST_STAGE_RSP, MICRF_BCAST_STAGE_RSP_LEN, NULL , APP_MICRF_Bcast_Stage},      \
+        { MICRF_BCAST_START_CMD, MICRF_BCAST_START_RSP, MICRF_BCAST_START_RSP_LEN, NULL , APP_MICRF_Bcast_Start},      \
+        { MICRF_BCAST_STOP_CMD, MICRF_BCAST_STOP_RSP, MICRF_BCAST_STOP_RSP_LEN, NULL , APP_MICRF_Bcast_Stop},      \
+        { MICRF_BCAST_GET_CMD, MICRF_BCAST_GET_RSP, MICRF_BCAST_GET_RSP_LEN, (uint8_t *)&s_bcastRsp , APP_MICRF_Bcast_Get}
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Function Prototypes
+// *****************************************************************************
+// *****************************************************************************
+void APP_MICRF_Init(void);
+
+void APP_MICRF_BenchHandler(void);
+
+void APP_MICRF_MsgHandler(void);
+
+void APP_MICRF_ProfilePrint(void);
+
+void APP_MICRF_ModemRxEvt(uint16_t connHandle);
+
+void APP_MICRF_ModemHandler(void);
+
+void APP_MICRF_BcastHandler(void);
+#endif
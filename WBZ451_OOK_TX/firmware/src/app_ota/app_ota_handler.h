@@ -55,6 +55,22 @@
 // *****************************************************************************
 // *****************************************************************************
 
+//  Set to 1 to accept streamed images (OTAPS file type APP): fragments are acknowledged as soon as they are buffered
+//  and whole flash pages are programmed while the next fragments arrive.  Set to 0 to refuse that file type.
+#define    APP_OTA_STREAM_ON            1
+
+//  Set to 1 to also accept compressed streamed images (host_sim/ota_pack.py): every flash page of the image is a zlib
+//  stream of its own, decoded to the page buffer once received.  Needs APP_OTA_STREAM_ON.
+#define    APP_OTA_COMPRESS_ON          1
+
+//  Set to 1 for the sub-GHz firmware broadcast (app_ota_bcast.h): a streamed image can be staged in the slot of a
+//  transmitter instead of being installed, and receivers decode a broadcast image to their slot.  Needs
+//  APP_OTA_STREAM_ON.
+#define    APP_OTA_BCAST_ON             1
+
+#define    APP_OTA_TIMEOUT_MS           5000    /**< OTA aborted after this long without a fragment */
+#define    APP_OTA_FLASH_ADDR           0x01080000UL    /**< Image slot checked by the bootloader, as MW_DFU */
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: Data Types
@@ -318,6 +334,121 @@ void APP_OTA_EvtHandler(BLE_OTAPS_Event_T *p_event);
 */
 void APP_OTA_HDL_Init(void);
 
+/*******************************************************************************
+  Function:
+     bool APP_OTA_HDL_StreamWrite(const uint8_t *p_data, uint16_t len)
+
+  Summary:
+     Appends image bytes to the streamed image
+
+  Description:
+     The bytes are copied to one of two page buffers.  A full page is queued to
+     APP_OTA_HDL_FlashTask() and the other buffer is filled meanwhile.  The 1st
+     flash row of the image is programmed last, by APP_OTA_HDL_Complete().
+
+  Precondition:
+     A streamed image was accepted by the update request.
+
+  Parameters:
+    p_data - Image bytes.
+    len    - Number of bytes.
+
+  Returns:
+    false if the image is larger than announced or the flash failed.
+
+*/
+bool APP_OTA_HDL_StreamWrite(const uint8_t *p_data, uint16_t len);
+
+/*******************************************************************************
+  Function:
+     void APP_OTA_HDL_FlashTask(void)
+
+  Summary:
+     Runs the next step of the flash programming of a streamed image
+
+  Description:
+     Called on APP_MSG_OTA_FLASH.  Starts the page erase or the next row write
+     when the NVM is idle and posts APP_MSG_OTA_FLASH again until the queued page
+     is programmed, so the application task keeps serving BLE meanwhile.
+
+  Precondition:
+
+  Parameters:
+    None.
+
+  Returns:
+    None.
+
+*/
+void APP_OTA_HDL_FlashTask(void);
+
+/*******************************************************************************
+  Function:
+     void APP_OTA_HDL_Stage(bool stage)
+
+  Summary:
+     Keeps the next streamed image in the slot for the broadcast
+
+  Description:
+     The image is written but its 1st row is only kept in RAM, so the bootloader
+     does not install it, and the device does not reboot.  APP_OTA_HDL_FlashRead()
+     returns the whole image.
+
+  Precondition:
+
+  Parameters:
+    stage - true for the next streamed image, false to install it as usual.
+
+  Returns:
+    None.
+
+*/
+void APP_OTA_HDL_Stage(bool stage);
+
+/*******************************************************************************
+  Function:
+     uint32_t APP_OTA_HDL_GetStaged(void)
+
+  Summary:
+     Size of the image staged for the broadcast
+
+  Description:
+
+  Precondition:
+
+  Parameters:
+    None.
+
+  Returns:
+    Image bytes, 0 if no image is staged.
+
+*/
+uint32_t APP_OTA_HDL_GetStaged(void);
+
+/*******************************************************************************
+  Function:
+     bool APP_OTA_HDL_BcastFrame(const uint8_t *p_frame, uint8_t len)
+
+  Summary:
+     Handles a sub-GHz frame of a firmware broadcast
+
+  Description:
+     The image is decoded to the slot.  Once complete and validated the device
+     reboots to the bootloader, as after a BLE update.  Broadcast frames are
+     ignored during a BLE update and on a transmitter with a staged image.
+
+  Precondition:
+
+  Parameters:
+    p_frame - Frame data.
+    len     - Frame length.
+
+  Returns:
+    false if it is not a broadcast frame.
+
+*/
+bool APP_OTA_HDL_BcastFrame(const uint8_t *p_frame, uint8_t len);
+
 #endif  // End of APP_OTA_HANDLER_H
 /*******************************************************************************
  End of File
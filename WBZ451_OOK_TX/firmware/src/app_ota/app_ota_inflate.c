@@ -0,0 +1,442 @@
+/*******************************************************************************
+  Application OTA Inflate Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_ota_inflate.c
+
+  Summary:
+    This file contains the zlib block decoder of the compressed OTA images.
+
+  Description:
+    Canonical Huffman decoding as in RFC 1951: a code is read bit by bit and
+    compared with the number of codes of each length, so a table only holds the
+    code count per length and the symbols sorted by code.
+ *******************************************************************************/
+
+//DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2023 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+//DOM-IGNORE-END
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "app_ota_inflate.h"
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+#define APP_INF_MAX_BITS                15
+#define APP_INF_LIT_SYMS                288
+#define APP_INF_DIST_SYMS               30
+#define APP_INF_CL_SYMS                 19
+#define APP_INF_END_OF_BLOCK            256
+#define APP_INF_ADLER_MOD               65521UL
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+typedef struct APP_INF_Tree_T
+{
+    uint16_t    counts[APP_INF_MAX_BITS + 1];   /**< Number of codes of each length */
+    uint16_t    symbols[APP_INF_LIT_SYMS];      /**< Symbols in code order */
+} APP_INF_Tree_T;
+
+typedef struct APP_INF_State_T
+{
+    const uint8_t   *p_in;
+    const uint8_t   *p_inEnd;
+    uint32_t        bitBuf;
+    uint8_t         bitCnt;
+    bool            error;          /**< Read past the end of the stream */
+    uint8_t         *p_out;
+    uint32_t        outSz;
+    uint32_t        outLen;
+} APP_INF_State_T;
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Local Variables
+// *****************************************************************************
+// *****************************************************************************
+static APP_INF_Tree_T s_litTree;
+static APP_INF_Tree_T s_distTree;
+static uint8_t s_codeLens[APP_INF_LIT_SYMS + APP_INF_DIST_SYMS + 2];
+
+static const uint16_t s_lenBase[29] =
+{
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t s_lenBits[29] =
+{
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t s_distBase[APP_INF_DIST_SYMS] =
+{
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+    8193, 12289, 16385, 24577
+};
+static const uint8_t s_distBits[APP_INF_DIST_SYMS] =
+{
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+static const uint8_t s_clOrder[APP_INF_CL_SYMS] =
+{
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Functions
+// *****************************************************************************
+// *****************************************************************************
+
+/* Read cnt bits, LSB first.  Reading past the end returns 0 bits and flags the error. */
+static uint32_t APP_INF_Bits(APP_INF_State_T *p_st, uint8_t cnt)
+{
+    uint32_t val;
+
+    while (p_st->bitCnt < cnt)
+    {
+        if (p_st->p_in >= p_st->p_inEnd)
+        {
+            p_st->error = true;
+            return 0;
+        }
+        p_st->bitBuf |= (uint32_t)(*p_st->p_in++) << p_st->bitCnt;
+        p_st->bitCnt += 8;
+    }
+    val = p_st->bitBuf & ((1UL << cnt) - 1);
+    p_st->bitBuf >>= cnt;
+    p_st->bitCnt -= cnt;
+    return val;
+}
+
+/* Build a canonical tree from the code length of each symbol.  Returns false if a length set is oversubscribed. */
+static bool APP_INF_Build(APP_INF_Tree_T *p_tree, const uint8_t *p_lens, uint16_t num)
+{
+    uint16_t offs[APP_INF_MAX_BITS + 1];
+    uint16_t i, sum;
+    int32_t left = 1;
+
+    memset(p_tree->counts, 0, sizeof(p_tree->counts));
+    for (i = 0; i < num; i++)
+    {
+        p_tree->counts[p_lens[i]]++;
+    }
+    p_tree->counts[0] = 0;
+    for (i = 1; i <= APP_INF_MAX_BITS; i++)
+    {
+        left = (left * 2) - p_tree->counts[i];
+        if (left < 0)
+        {
+            return false;
+        }
+    }
+    for (sum = 0, i = 0; i <= APP_INF_MAX_BITS; i++)
+    {
+        offs[i] = sum;
+        sum += p_tree->counts[i];
+    }
+    for (i = 0; i < num; i++)
+    {
+        if (p_lens[i] != 0)
+        {
+            p_tree->symbols[offs[p_lens[i]]++] = i;
+        }
+    }
+    return true;
+}
+
+/* Decode one symbol.  Returns -1 on an invalid code. */
+static int32_t APP_INF_Symbol(APP_INF_State_T *p_st, const APP_INF_Tree_T *p_tree)
+{
+    int32_t code = 0, first = 0, index = 0;
+    uint8_t len;
+
+    for (len = 1; len <= APP_INF_MAX_BITS; len++)
+    {
+        code |= (int32_t)APP_INF_Bits(p_st, 1);
+        if ((code - first) < p_tree->counts[len])
+        {
+            return p_st->error ? -1 : p_tree->symbols[index + (code - first)];
+        }
+        index += p_tree->counts[len];
+        first = (first + p_tree->counts[len]) << 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+/* Stored block: LEN, NLEN and LEN raw bytes from the next byte boundary */
+static bool APP_INF_Stored(APP_INF_State_T *p_st)
+{
+    uint16_t len, nlen;
+
+    p_st->bitBuf = 0;
+    p_st->bitCnt = 0;
+    if ((p_st->p_inEnd - p_st->p_in) < 4)
+    {
+        return false;
+    }
+    len = (uint16_t)(p_st->p_in[0] | (p_st->p_in[1] << 8));
+    nlen = (uint16_t)(p_st->p_in[2] | (p_st->p_in[3] << 8));
+    p_st->p_in += 4;
+    if (((len ^ nlen) != 0xFFFF) || ((p_st->p_inEnd - p_st->p_in) < len) || ((p_st->outSz - p_st->outLen) < len))
+    {
+        return false;
+    }
+    memcpy(&p_st->p_out[p_st->outLen], p_st->p_in, len);
+    p_st->p_in += len;
+    p_st->outLen += len;
+    return true;
+}
+
+/* Literals and length/distance pairs up to the end of block code */
+static bool APP_INF_Codes(APP_INF_State_T *p_st)
+{
+    int32_t sym;
+    uint32_t len, dist;
+
+    for (;;)
+    {
+        sym = APP_INF_Symbol(p_st, &s_litTree);
+        if (sym < 0)
+        {
+            return false;
+        }
+        if (sym < APP_INF_END_OF_BLOCK)
+        {
+            if (p_st->outLen >= p_st->outSz)
+            {
+                return false;
+            }
+            p_st->p_out[p_st->outLen++] = (uint8_t)sym;
+            continue;
+        }
+        if (sym == APP_INF_END_OF_BLOCK)
+        {
+            return true;
+        }
+        sym -= APP_INF_END_OF_BLOCK + 1;
+        if (sym >= 29)
+        {
+            return false;
+        }
+        len = s_lenBase[sym] + APP_INF_Bits(p_st, s_lenBits[sym]);
+        sym = APP_INF_Symbol(p_st, &s_distTree);
+        if ((sym < 0) || (sym >= APP_INF_DIST_SYMS))
+        {
+            return false;
+        }
+        dist = s_distBase[sym] + APP_INF_Bits(p_st, s_distBits[sym]);
+        if (p_st->error || (dist > p_st->outLen) || (len > (p_st->outSz - p_st->outLen)))
+        {
+            return false;
+        }
+        while (len-- != 0)              // Byte by byte, the copy may overlap its source
+        {
+            p_st->p_out[p_st->outLen] = p_st->p_out[p_st->outLen - dist];
+            p_st->outLen++;
+        }
+    }
+}
+
+/* Trees of a fixed Huffman block */
+static void APP_INF_FixedTrees(void)
+{
+    uint16_t i;
+
+    for (i = 0; i < APP_INF_LIT_SYMS; i++)
+    {
+        s_codeLens[i] = (i < 144) ? 8 : ((i < 256) ? 9 : ((i < 280) ? 7 : 8));
+    }
+    (void)APP_INF_Build(&s_litTree, s_codeLens, APP_INF_LIT_SYMS);
+    memset(s_codeLens, 5, APP_INF_DIST_SYMS);
+    (void)APP_INF_Build(&s_distTree, s_codeLens, APP_INF_DIST_SYMS);
+}
+
+/* Trees of a dynamic Huffman block.  The code length tree is built in s_distTree, which is rebuilt last. */
+static bool APP_INF_DynamicTrees(APP_INF_State_T *p_st)
+{
+    uint16_t hlit, hdist, hclen, i, num;
+    uint8_t fill;
+    uint32_t rep;
+    int32_t sym;
+
+    hlit = (uint16_t)APP_INF_Bits(p_st, 5) + 257;
+    hdist = (uint16_t)APP_INF_Bits(p_st, 5) + 1;
+    hclen = (uint16_t)APP_INF_Bits(p_st, 4) + 4;
+    if ((hlit > 286) || (hdist > APP_INF_DIST_SYMS))
+    {
+        return false;
+    }
+    memset(s_codeLens, 0, APP_INF_CL_SYMS);
+    for (i = 0; i < hclen; i++)
+    {
+        s_codeLens[s_clOrder[i]] = (uint8_t)APP_INF_Bits(p_st, 3);
+    }
+    if (!APP_INF_Build(&s_distTree, s_codeLens, APP_INF_CL_SYMS))
+    {
+        return false;
+    }
+
+    num = hlit + hdist;
+    for (i = 0; i < num; )
+    {
+        sym = APP_INF_Symbol(p_st, &s_distTree);
+        if (sym < 0)
+        {
+            return false;
+        }
+        if (sym < 16)
+        {
+            s_codeLens[i++] = (uint8_t)sym;
+            continue;
+        }
+        if (sym == 16)
+        {
+            if (i == 0)
+            {
+                return false;
+            }
+            fill = s_codeLens[i - 1];
+            rep = 3 + APP_INF_Bits(p_st, 2);
+        }
+        else
+        {
+            fill = 0;
+            rep = (sym == 17) ? (3 + APP_INF_Bits(p_st, 3)) : (11 + APP_INF_Bits(p_st, 7));
+        }
+        if ((i + rep) > num)
+        {
+            return false;
+        }
+        while (rep-- != 0)
+        {
+            s_codeLens[i++] = fill;
+        }
+    }
+    if (p_st->error || (s_codeLens[APP_INF_END_OF_BLOCK] == 0))
+    {
+        return false;
+    }
+    return APP_INF_Build(&s_litTree, s_codeLens, hlit) && APP_INF_Build(&s_distTree, &s_codeLens[hlit], hdist);
+}
+
+static uint32_t APP_INF_Adler32(const uint8_t *p_data, uint32_t len)
+{
+    uint32_t a = 1, b = 0, chunk;
+
+    while (len != 0)
+    {
+        chunk = (len < 5552) ? len : 5552;      // Largest run without a 32 bit overflow of b
+        len -= chunk;
+        while (chunk-- != 0)
+        {
+            a += *p_data++;
+            b += a;
+        }
+        a %= APP_INF_ADLER_MOD;
+        b %= APP_INF_ADLER_MOD;
+    }
+    return (b << 16) | a;
+}
+
+int32_t APP_OTA_Inflate(uint8_t *p_out, uint32_t outSz, const uint8_t *p_in, uint32_t inSz)
+{
+    APP_INF_State_T st;
+    uint32_t last, type, adler;
+    bool ok;
+
+    if ((p_out == NULL) || (p_in == NULL) || (inSz < 6))
+    {
+        return -1;
+    }
+    // zlib header: deflate, no preset dictionary, check bits
+    if (((p_in[0] & 0x0F) != 8) || ((p_in[0] >> 4) > 7) || ((p_in[1] & 0x20) != 0) ||
+        ((((uint16_t)p_in[0] << 8) | p_in[1]) % 31) != 0)
+    {
+        return -1;
+    }
+
+    memset(&st, 0, sizeof(st));
+    st.p_in = &p_in[2];
+    st.p_inEnd = &p_in[inSz - 4];
+    st.p_out = p_out;
+    st.outSz = outSz;
+    do
+    {
+        last = APP_INF_Bits(&st, 1);
+        type = APP_INF_Bits(&st, 2);
+        if (type == 0)
+        {
+            ok = APP_INF_Stored(&st);
+        }
+        else if (type == 1)
+        {
+            APP_INF_FixedTrees();
+            ok = APP_INF_Codes(&st);
+        }
+        else if (type == 2)
+        {
+            ok = APP_INF_DynamicTrees(&st) && APP_INF_Codes(&st);
+        }
+        else
+        {
+            ok = false;
+        }
+        if (!ok || st.error)
+        {
+            return -1;
+        }
+    } while (last == 0);
+
+    adler = ((uint32_t)st.p_inEnd[0] << 24) | ((uint32_t)st.p_inEnd[1] << 16) |
+            ((uint32_t)st.p_inEnd[2] << 8) | st.p_inEnd[3];
+    if (APP_INF_Adler32(p_out, st.outLen) != adler)
+    {
+        return -1;
+    }
+    return (int32_t)st.outLen;
+}
+/*******************************************************************************
+ End of File
+ */
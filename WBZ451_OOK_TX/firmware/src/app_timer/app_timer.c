@@ -129,14 +129,39 @@ static void APP_TIMER_OneShotTimerExpiredHandle(TimerHandle_t xTimer)
             appMsg.msgId = APP_TIMER_ADV_CTRL_MSG;
         }
         break;
-        case APP_TIMER_ID_4:
+        case APP_TIMER_BLE_CONN:
         {
-           //appMsg.msgId = APP_TIMER_ID_4_MSG;
+            appMsg.msgId = APP_TIMER_BLE_CONN_MSG;
         }
         break;
-        case APP_TIMER_ID_5:
+        case APP_TIMER_ADV_TLM:
         {
-           //appMsg.msgId = APP_TIMER_ID_5_MSG;
+            appMsg.msgId = APP_TIMER_ADV_TLM_MSG;
+        }
+        break;
+        case APP_TIMER_MICRF_TX:
+        {
+            appMsg.msgId = APP_MSG_MICRF_EVT;
+        }
+        break;
+        case APP_TIMER_MICRF_BCAST:
+        {
+            appMsg.msgId = APP_MSG_MICRF_BCAST_EVT;
+        }
+        break;
+        case APP_TIMER_MICRF_BENCH:
+        {
+            appMsg.msgId = APP_MSG_MICRF_BENCH_EVT;
+        }
+        break;
+        case APP_TIMER_MICRF_MSG:
+        {
+            appMsg.msgId = APP_MSG_MICRF_MSG_EVT;
+        }
+        break;
+        case APP_TIMER_MICRF_MODEM:
+        {
+            appMsg.msgId = APP_MSG_MICRF_MODEM_EVT;
         }
         break;	
 
@@ -177,14 +202,39 @@ static void APP_TIMER_PeriodicTimerExpiredHandle(TimerHandle_t xTimer)
             appMsg.msgId = APP_TIMER_ADV_CTRL_MSG;
         }
         break;
-        case APP_TIMER_ID_4:
+        case APP_TIMER_BLE_CONN:
+        {
+            appMsg.msgId = APP_TIMER_BLE_CONN_MSG;
+        }
+        break;
+        case APP_TIMER_ADV_TLM:
+        {
+            appMsg.msgId = APP_TIMER_ADV_TLM_MSG;
+        }
+        break;
+        case APP_TIMER_MICRF_TX:
+        {
+            appMsg.msgId = APP_MSG_MICRF_EVT;
+        }
+        break;
+        case APP_TIMER_MICRF_BCAST:
+        {
+            appMsg.msgId = APP_MSG_MICRF_BCAST_EVT;
+        }
+        break;
+        case APP_TIMER_MICRF_BENCH:
+        {
+            appMsg.msgId = APP_MSG_MICRF_BENCH_EVT;
+        }
+        break;
+        case APP_TIMER_MICRF_MSG:
         {
-           //appMsg.msgId = APP_TIMER_ID_4_MSG;
+            appMsg.msgId = APP_MSG_MICRF_MSG_EVT;
         }
         break;
-        case APP_TIMER_ID_5:
+        case APP_TIMER_MICRF_MODEM:
         {
-           //appMsg.msgId = APP_TIMER_ID_5_MSG;
+            appMsg.msgId = APP_MSG_MICRF_MODEM_EVT;
         }
         break;
         default:
@@ -71,8 +71,13 @@ typedef enum APP_TIMER_TimerId_T
     APP_TIMER_OTA_REBOOT,
     APP_TIMER_BLE_SENSOR,
     APP_TIMER_ADV_CTRL,
-    APP_TIMER_ID_4,
-    APP_TIMER_ID_5,
+    APP_TIMER_BLE_CONN,
+    APP_TIMER_ADV_TLM,
+    APP_TIMER_MICRF_TX,
+    APP_TIMER_MICRF_BCAST,
+    APP_TIMER_MICRF_BENCH,
+    APP_TIMER_MICRF_MSG,
+    APP_TIMER_MICRF_MODEM,
     APP_TIMER_TOTAL,
 } APP_TIMER_TimerId_T;
 
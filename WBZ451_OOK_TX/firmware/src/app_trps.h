@@ -52,6 +52,8 @@
 // *****************************************************************************
 //#include "compiler.h"
 #include "ble_gap.h"
+#include <stdbool.h>
+#include "gatt.h"
 #include "ble_trsps/ble_trsps.h"
 
 // *****************************************************************************
@@ -59,10 +61,17 @@
 // Section: Macros
 // *****************************************************************************
 // *****************************************************************************
-#define APP_TRPS_CTRL_LST_SIZE   1
+#define APP_TRPS_CTRL_LST_SIZE   8      /**< Vendor opcodes */
+#define APP_TRPS_CMD_SPAN        32     /**< Command IDs of an opcode must be within CmdId of the lowest + 31 */
 
 #define APP_TRPS_CTRL_RSP_ID_STATUS_LEN 2
 
+//  Set to 1 to send the pending notifications of an opcode as one PDU: [Opcode]([Len][NtfID][Data])..., the length
+//  byte of each record delimits it.  0 sends one record per PDU, for centrals that only parse the first one.
+#define APP_TRPS_NTF_PACK_ON            1
+#define APP_TRPS_NTF_MAX                32      /**< Notifications per opcode, one pending bit each */
+#define APP_TRPS_NTF_BUF_LEN            (BLE_ATT_MAX_MTU_LEN - ATT_HANDLE_VALUE_HEADER_SIZE - 1)
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: Data Types
@@ -76,10 +85,16 @@ enum APP_TRPS_CTRL_STATUS_CODE_T
     OPERATION_FAILED = 0x03
 };
 
-/**@brief The structure contains information about APP transparent connection parameters for recording connection information. */
+/**@brief The structure contains information about APP transparent connection parameters for recording connection
+ *        information, one per central with the control notifications on. */
 typedef struct APP_TRPS_ConnList_T
 {
-    uint16_t                connHandle;         /**< Connection handle associated with this connection. */
+    uint16_t                connHandle;         /**< Connection handle associated with this connection, 0: free */
+    uint32_t                ntfPending[APP_TRPS_CTRL_LST_SIZE];    /**< Notifications waiting to be sent, bit n is appTrpsNotify[n] of s_trpsCtrl[] */
+    uint32_t                ntfCoalesced;       /**< Notifications merged into a pending one */
+    uint32_t                ntfPdus;            /**< PDUs sent */
+    uint32_t                ntfRecords;         /**< Notifications sent */
+    uint32_t                cmdBatches;         /**< Writes that carried more than one command */
 } APP_TRPS_ConnList_T;
 
 
@@ -118,6 +133,8 @@ typedef struct
     uint8_t    ntfySize;    /**<  Size of Notfy array */
     APP_TRPS_CmdResp_T *appTrpsCmdResp;
     APP_TRPS_NotifyData_T *appTrpsNotify;  
+    uint8_t    cmdBase;    /**<  Lowest CmdId of appTrpsCmdResp */
+    uint8_t    cmdIdx[APP_TRPS_CMD_SPAN];  /**<  appTrpsCmdResp index + 1 of CmdId cmdBase + n, 0: none */
 } APP_TRPS_Ctrl_T;
 
 // *****************************************************************************
@@ -131,4 +148,6 @@ void APP_TRPS_ConnEvtProc(BLE_GAP_Event_T *p_event);
 void APP_TRPS_DiscEvtProc(uint16_t connHandle);
 void APP_TRPS_EventHandler(BLE_TRSPS_Event_T *p_event);
 uint16_t APP_TRPS_SendNotification(uint8_t opcode, uint8_t idx);
+bool APP_TRPS_IsNotificationPending(uint8_t opcode, uint8_t ntfyId);
+void APP_TRPS_NotifyFlush(void);
 #endif
@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+# Decodes the tokenized console log of the firmware (see firmware/src/app_log.h) back to text.
+#   ./app_log_decode.py -m ../WBZ451_MICRF_RX_2/firmware/src/app_log_msgs.h [-t] [file | tty]
+# Reads stdin when no input is given.  A tty is read raw at -b baud (needs pyserial).  Console text that is not part of
+# a log record (SYS_CONSOLE_PRINT) is passed through unchanged.
+import argparse
+import re
+import struct
+import sys
+
+SYNC = 0xA5
+HDR_LEN = 7                 # Sync, ID, arg count, time ms
+ARGS_MAX = 8
+
+ESCAPES = {'n': '\n', 'r': '\r', 't': '\t', '\\': '\\', '"': '"', "'": "'", '0': '\0'}
+SPEC = re.compile(r'%([-+ #0]*\d*(?:\.\d+)?)(hh|h|ll|l|z)?([diouxXc%])')
+
+
+def load_messages(path):
+    """Returns the (name, format) list of APP_LOG_MSG_LIST, in ID order."""
+    text = open(path, encoding='latin1').read()
+    msgs = []
+    for name, fmt in re.findall(r'X\(\s*(\w+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)', text):
+        msgs.append((name, re.sub(r'\\(.)', lambda m: ESCAPES.get(m.group(1), m.group(1)), fmt)))
+    if not msgs:
+        sys.exit('%s: no X(NAME, "format") entries' % path)
+    return msgs
+
+
+def render(fmt, args):
+    """printf with 32 bit arguments: %d and %i are signed, the other conversions unsigned."""
+    it = iter(args)
+
+    def conv(m):
+        flags, conv_ch = m.group(1), m.group(3)
+        if conv_ch == '%':
+            return '%'
+        val = next(it, 0)
+        if conv_ch in 'di' and val & 0x80000000:
+            val -= 1 << 32
+        if conv_ch == 'c':
+            val &= 0xFF
+        return ('%' + flags + ('d' if conv_ch in 'iu' else conv_ch)) % val
+    return SPEC.sub(conv, fmt)
+
+
+def decode(stream, msgs, out, stamp):
+    buf = bytearray()
+    while True:
+        data = stream.read(256)
+        if not data:
+            break
+        buf += data
+        i = 0
+        while i < len(buf):
+            if buf[i] != SYNC:
+                j = buf.find(SYNC, i)
+                j = len(buf) if j < 0 else j
+                out.write(buf[i:j].decode('latin1'))
+                i = j
+                continue
+            if len(buf) - i < HDR_LEN:
+                break
+            msg_id, arg_cnt = buf[i + 1], buf[i + 2]
+            rec_len = HDR_LEN + arg_cnt * 4 + 1
+            if msg_id >= len(msgs) or arg_cnt > ARGS_MAX:
+                out.write(chr(buf[i]))          # Not a record
+                i += 1
+                continue
+            if len(buf) - i < rec_len:
+                break
+            rec = buf[i:i + rec_len]
+            if (sum(rec[1:-1]) & 0xFF) != rec[-1]:
+                out.write(chr(buf[i]))
+                i += 1
+                continue
+            time_ms = struct.unpack_from('<I', rec, 3)[0]
+            args = struct.unpack_from('<%dI' % arg_cnt, rec, HDR_LEN)
+            if stamp:
+                out.write('[%10.3f] ' % (time_ms / 1000.0))
+            out.write(render(msgs[msg_id][1], args))
+            i += rec_len
+        del buf[:i]
+        out.flush()
+    out.write(buf.decode('latin1'))
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Decode the tokenized firmware console log')
+    ap.add_argument('-m', '--msgs', required=True, help='app_log_msgs.h the firmware was built with')
+    ap.add_argument('-t', '--time', action='store_true', help='prefix each message with the target time in s')
+    ap.add_argument('-b', '--baud', type=int, default=115200, help='baud rate when the input is a serial port')
+    ap.add_argument('input', nargs='?', help='capture file or serial port, stdin if omitted')
+    a = ap.parse_args()
+
+    msgs = load_messages(a.msgs)
+    if a.input is None:
+        stream = sys.stdin.buffer
+    elif a.input.startswith('/dev/tty') or a.input.upper().startswith('COM'):
+        import serial
+
+        class Port:
+            def __init__(self, port):
+                self.port = port
+
+            def read(self, n):          # Blocks until at least one byte, so decode() runs until ^C
+                return self.port.read(max(1, min(n, self.port.in_waiting)))
+        stream = Port(serial.Serial(a.input, a.baud, timeout=None))
+    else:
+        stream = open(a.input, 'rb')
+    try:
+        decode(stream, msgs, sys.stdout, a.time)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == '__main__':
+    main()
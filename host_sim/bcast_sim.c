@@ -0,0 +1,417 @@
+/* ****************************************************************************************************************** */
+/***********************************************************************************************************************
+ *
+ * Filename: bcast_sim.c
+ *
+ * Contents: Sub-GHz firmware broadcast (app_ota/app_ota_bcast.c) from one transmitter to a population of receivers.
+ *           The transmitter runs the firmware encoder on an image, every receiver sees the frames through its own loss
+ *           process and runs the firmware decoder into its own RAM flash, which refuses to program a quad word twice
+ *           without an erase.  A completed image must pass the decoder's CRC-32 and match the source.
+ *           For each frame loss rate, reports the frames and the time until every receiver has the image, the mean per
+ *           receiver, and the symbols a receiver took per source symbol (1.0 is ideal).  As a reference, a plain
+ *           carousel sends the same 8 byte symbols uncoded, in order, with the same descriptor overhead: a receiver
+ *           completes once it got every symbol at least once.
+ *
+ *           bcast_sim [-s imageBytes | -i image.bin] [-n receivers] [-x extraPct] [-r profile | -R framesPerS]
+ *                     [-p lossPct,...] [-B burstLen] [-J] [-S seed] [-C] [-H]
+ *             -s  Size of a random image, a multiple of 16 (default 172240, the sample OTA image)
+ *             -i  Image file, padded with 0xFF to a multiple of 16
+ *             -n  Receivers
+ *             -x  Repair symbols per generation on the 1st pass, % (MICRF_BCAST_START_CMD, default 25)
+ *             -r  Rate profile for the times, 14 byte frames measured with micrf_sim: 0 = 2.73, 1 = 5.24, 2 = 10.0,
+ *                 3 = 18.5 frames/s
+ *             -R  Frames per second, overrides -r
+ *             -p  Frame loss rates in %, comma separated
+ *             -B  Mean length of a loss burst in frames (Gilbert model, same average loss), 1 = independent losses
+ *             -J  Receivers join at a random time of the 1st pass, else they all listen from the 1st frame
+ *             -S  Random seed
+ *             -C  Print one CSV row per loss rate instead of the report, -H prints the CSV header and exits
+ *
+ *           Exit code 0 when every receiver got the right image, 1 otherwise.
+ *
+ **********************************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "app_ota_bcast.h"
+
+#define SLOT_SIZE           ((uint32_t)APP_OTA_BCAST_GEN_MAX * APP_OTA_BCAST_GEN_SIZE)
+#define PAGE_SIZE           4096
+#define QUAD_SIZE           16
+#define LOSS_MAX            16
+#define PASS_LIMIT          64      /* Passes of the image before a run gives up */
+#define CSV_HEADER          "loss_pct,burst,receivers,extra_pct,image_bytes,fps,coded_all_frames,coded_all_s," \
+                            "coded_mean_frames,coded_sym_ratio,carousel_all_frames,carousel_all_s," \
+                            "carousel_mean_frames,failed"
+
+typedef struct
+{
+    uint8_t  flash[SLOT_SIZE];
+    uint8_t  programmed[SLOT_SIZE / QUAD_SIZE];     /* Quad word written since its page was erased */
+    APP_OTA_BcastRx_T rx;
+    uint32_t joinFrame;
+    uint32_t doneFrame;     /* Frame count when the image completed, 0 = not yet */
+    uint32_t symbols;       /* Symbol frames received, also after a generation is done */
+    bool     bBad;          /* Loss process in the bad state */
+    uint8_t  *pSeen;        /* Carousel: symbol received */
+    uint32_t seenCnt;
+}receiver_t;
+
+static uint64_t   rng_;
+static uint8_t    *pImage_;
+static uint32_t   imageSize_;
+static receiver_t *pFlashRx_;       /* Receiver whose flash the hooks access, NULL = the transmitter's image */
+static uint32_t   flashErrors_;
+
+static double uniform( void )
+{
+    rng_ ^= rng_ << 13;     /* xorshift64 */
+    rng_ ^= rng_ >> 7;
+    rng_ ^= rng_ << 17;
+    return((double)(rng_ >> 11) / (double)(1ULL << 53));
+}
+
+/* Gilbert model: no loss in the good state, every frame lost in the bad one.  The bad state lasts burst frames on
+ * average and is entered so the frames lost are loss of all. */
+static bool frameLost( receiver_t *pRx, double loss, double burst )
+{
+    if (burst <= 1.0)
+    {
+        return(uniform() < loss);
+    }
+    if (pRx->bBad)
+    {
+        pRx->bBad = (uniform() >= (1.0 / burst));
+    }
+    else
+    {
+        pRx->bBad = (uniform() < (loss / (burst * (1.0 - loss))));
+    }
+    return(pRx->bBad);
+}
+
+/* Flash of the firmware OTA slot, see app_ota_handler.c */
+bool APP_OTA_HDL_FlashRead( uint32_t offset, uint8_t *p_data, uint16_t len )
+{
+    if ((offset + len) > SLOT_SIZE)
+    {
+        return(false);
+    }
+    if (NULL == pFlashRx_)
+    {
+        memset(p_data, 0xFF, len);
+        if (offset < imageSize_)
+        {
+            memcpy(p_data, &pImage_[offset], ((imageSize_ - offset) < len) ? (imageSize_ - offset) : len);
+        }
+        return(true);
+    }
+    memcpy(p_data, &pFlashRx_->flash[offset], len);
+    return(true);
+}
+
+bool APP_OTA_HDL_FlashErase( uint32_t offset )
+{
+    if ((NULL == pFlashRx_) || ((offset % PAGE_SIZE) != 0) || (offset >= SLOT_SIZE))
+    {
+        flashErrors_++;
+        return(false);
+    }
+    memset(&pFlashRx_->flash[offset], 0xFF, PAGE_SIZE);
+    memset(&pFlashRx_->programmed[offset / QUAD_SIZE], 0, PAGE_SIZE / QUAD_SIZE);
+    return(true);
+}
+
+bool APP_OTA_HDL_FlashWrite( uint32_t offset, const uint8_t *p_data, uint16_t len )
+{
+    uint32_t quad;
+
+    if ((NULL == pFlashRx_) || ((offset % QUAD_SIZE) != 0) || ((len % QUAD_SIZE) != 0) || ((offset + len) > SLOT_SIZE))
+    {
+        flashErrors_++;
+        return(false);
+    }
+    for (quad = offset / QUAD_SIZE; quad < ((offset + len) / QUAD_SIZE); quad++)
+    {
+        if (pFlashRx_->programmed[quad])
+        {   // Programmed twice, or its page was never erased
+            flashErrors_++;
+            return(false);
+        }
+        pFlashRx_->programmed[quad] = 1;
+    }
+    memcpy(&pFlashRx_->flash[offset], p_data, len);
+    return(true);
+}
+
+/* Broadcast with the fountain code.  Returns the frames sent until every receiver completed, 0 if some did not. */
+static uint32_t runCoded( receiver_t *pRxs, uint32_t rxCnt, double loss, double burst, uint8_t extraPct,
+                          uint32_t passFrames, bool bJoin, uint32_t *pWrong )
+{
+    APP_OTA_BcastTx_T tx;
+    APP_OTA_BcastRes_T res;
+    uint8_t  frame[APP_OTA_BCAST_FRAME_MAX];
+    uint8_t  len;
+    uint32_t frames = 0, done = 0, i;
+    receiver_t *pRx;
+
+    pFlashRx_ = NULL;
+    if (!APP_OTA_BcastTxStart(&tx, 0x5A, imageSize_, extraPct))
+    {
+        fprintf(stderr, "image of %u bytes refused\n", imageSize_);
+        exit(2);
+    }
+    for (i = 0; i < rxCnt; i++)
+    {
+        pRx = &pRxs[i];
+        memset(pRx->flash, 0, sizeof(pRx->flash));  // Not erased, the decoder must erase every page it writes
+        memset(pRx->programmed, 1, sizeof(pRx->programmed));
+        APP_OTA_BcastRxReset(&pRx->rx);
+        pRx->joinFrame = bJoin ? (uint32_t)(uniform() * passFrames) : 0;
+        pRx->doneFrame = 0;
+        pRx->symbols = 0;
+        pRx->bBad = false;
+    }
+    while ((done < rxCnt) && (tx.pass < PASS_LIMIT))
+    {
+        pFlashRx_ = NULL;
+        len = APP_OTA_BcastTxNext(&tx, frame);
+        frames++;
+        for (i = 0; i < rxCnt; i++)
+        {
+            pRx = &pRxs[i];
+            if ((0 != pRx->doneFrame) || (frames <= pRx->joinFrame) || frameLost(pRx, loss, burst))
+            {
+                continue;
+            }
+            pFlashRx_ = pRx;
+            pRx->symbols += (APP_OTA_BCAST_SYM_LEN == len) ? 1 : 0;
+            res = APP_OTA_BcastRxFrame(&pRx->rx, frame, len);
+            if (APP_OTA_BCAST_RES_FAIL == res)
+            {
+                (*pWrong)++;
+            }
+            else if (APP_OTA_BCAST_RES_DONE == res)
+            {
+                pRx->doneFrame = frames;
+                done++;
+                if (0 != memcmp(pRx->flash, pImage_, imageSize_))
+                {
+                    (*pWrong)++;
+                }
+            }
+        }
+    }
+    return((done == rxCnt) ? frames : 0);
+}
+
+/* Uncoded carousel of the same symbols and descriptors.  Returns the frames sent until every receiver got every
+ * symbol, 0 if some did not. */
+static uint32_t runCarousel( receiver_t *pRxs, uint32_t rxCnt, double loss, double burst, uint32_t passFrames,
+                             bool bJoin )
+{
+    uint32_t symCnt = imageSize_ / APP_OTA_BCAST_SYM_SIZE;
+    uint32_t frames = 0, done = 0, sym = 0, descWait = 0, i;
+    receiver_t *pRx;
+
+    for (i = 0; i < rxCnt; i++)
+    {
+        pRx = &pRxs[i];
+        memset(pRx->pSeen, 0, symCnt);
+        pRx->seenCnt = 0;
+        pRx->joinFrame = bJoin ? (uint32_t)(uniform() * passFrames) : 0;
+        pRx->doneFrame = 0;
+        pRx->bBad = false;
+    }
+    while ((done < rxCnt) && (frames < (passFrames * PASS_LIMIT)))
+    {
+        frames++;
+        if (0 == descWait)
+        {
+            descWait = APP_OTA_BCAST_DESC_PERIOD;
+            for (i = 0; i < rxCnt; i++)
+            {
+                (void)frameLost(&pRxs[i], loss, burst);    // Same channel time as the coded run
+            }
+            continue;
+        }
+        descWait--;
+        for (i = 0; i < rxCnt; i++)
+        {
+            pRx = &pRxs[i];
+            if (frameLost(pRx, loss, burst) || (0 != pRx->doneFrame) || (frames <= pRx->joinFrame) ||
+                (0 != pRx->pSeen[sym]))
+            {
+                continue;
+            }
+            pRx->pSeen[sym] = 1;
+            if (++pRx->seenCnt == symCnt)
+            {
+                pRx->doneFrame = frames;
+                done++;
+            }
+        }
+        sym = (sym + 1) % symCnt;
+    }
+    return((done == rxCnt) ? frames : 0);
+}
+
+/* Mean frames from the join to the completion */
+static double meanFrames( const receiver_t *pRxs, uint32_t rxCnt )
+{
+    double sum = 0.0;
+    uint32_t i;
+
+    for (i = 0; i < rxCnt; i++)
+    {
+        sum += (double)(pRxs[i].doneFrame - pRxs[i].joinFrame);
+    }
+    return(sum / rxCnt);
+}
+
+static bool loadImage( const char *pFile, uint32_t size )
+{
+    FILE *pIn;
+    long len;
+    uint32_t i;
+
+    if (NULL == pFile)
+    {
+        imageSize_ = size;
+        pImage_ = malloc(size + QUAD_SIZE);
+        for (i = 0; (NULL != pImage_) && (i < size); i++)
+        {
+            pImage_[i] = (uint8_t)(uniform() * 256.0);
+        }
+        return(NULL != pImage_);
+    }
+    pIn = fopen(pFile, "rb");
+    if ((NULL == pIn) || (0 != fseek(pIn, 0, SEEK_END)) || ((len = ftell(pIn)) <= 0) || (len > (long)SLOT_SIZE))
+    {
+        return(false);
+    }
+    rewind(pIn);
+    imageSize_ = ((uint32_t)len + QUAD_SIZE - 1) & ~(uint32_t)(QUAD_SIZE - 1);
+    pImage_ = malloc(imageSize_);
+    if ((NULL == pImage_) || (fread(pImage_, 1, (size_t)len, pIn) != (size_t)len))
+    {
+        return(false);
+    }
+    memset(&pImage_[len], 0xFF, imageSize_ - (uint32_t)len);
+    fclose(pIn);
+    return(true);
+}
+
+int main( int argc, char **argv )
+{
+    static const double profileFps[] = { 2.73, 5.24, 10.0, 18.5 };
+    uint32_t size = 172240, rxCnt = 20, seed = 1, lossCnt = 0, gens, passFrames, i, l;
+    uint32_t codedFrames, carouselFrames, wrong, failed = 0;
+    uint8_t  extraPct = 25, profile = 2;
+    double   fps = 0.0, burst = 1.0, loss[LOSS_MAX];
+    double   codedMean, carouselMean, symRatio;
+    bool     bJoin = false, bCsv = false;
+    const char *pFile = NULL, *pLoss = "0,5,10,20,30,40,50";
+    char     *pEnd;
+    receiver_t *pRxs;
+    int      opt;
+
+    while ((opt = getopt(argc, argv, "s:i:n:x:r:R:p:B:JS:CH")) != -1)
+    {
+        switch (opt)
+        {
+            case 's': size = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'i': pFile = optarg; break;
+            case 'n': rxCnt = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'x': extraPct = (uint8_t)atoi(optarg); break;
+            case 'r': profile = (uint8_t)atoi(optarg); break;
+            case 'R': fps = atof(optarg); break;
+            case 'p': pLoss = optarg; break;
+            case 'B': burst = atof(optarg); break;
+            case 'J': bJoin = true; break;
+            case 'S': seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'C': bCsv = true; break;
+            case 'H': printf("%s\n", CSV_HEADER); return(0);
+            default:
+                fprintf(stderr, "usage: %s [-s imageBytes | -i image.bin] [-n receivers] [-x extraPct] "
+                                "[-r profile | -R framesPerS]\n"
+                                "       [-p lossPct,...] [-B burstLen] [-J] [-S seed] [-C] [-H]\n", argv[0]);
+                return(2);
+        }
+    }
+    for (pEnd = (char *)pLoss; (lossCnt < LOSS_MAX) && ('\0' != *pEnd); lossCnt++)
+    {
+        loss[lossCnt] = strtod(pEnd, &pEnd) / 100.0;
+        pEnd += (',' == *pEnd) ? 1 : 0;
+    }
+    if (fps <= 0.0)
+    {
+        fps = profileFps[(profile < 4) ? profile : 2];
+    }
+    rng_ = 0x9E3779B97F4A7C15ULL ^ seed;
+    if ((0 == rxCnt) || (0 == lossCnt) || !loadImage(pFile, size))
+    {
+        fprintf(stderr, "invalid image, receivers or loss rates\n");
+        return(2);
+    }
+    pRxs = calloc(rxCnt, sizeof(receiver_t));
+    for (i = 0; (NULL != pRxs) && (i < rxCnt); i++)
+    {
+        pRxs[i].pSeen = malloc(imageSize_ / APP_OTA_BCAST_SYM_SIZE);
+        if (NULL == pRxs[i].pSeen)
+        {
+            pRxs = NULL;
+        }
+    }
+    if (NULL == pRxs)
+    {
+        fprintf(stderr, "out of memory\n");
+        return(2);
+    }
+
+    gens = (imageSize_ + APP_OTA_BCAST_GEN_SIZE - 1) / APP_OTA_BCAST_GEN_SIZE;
+    passFrames = gens * (APP_OTA_BCAST_K + ((APP_OTA_BCAST_K * extraPct) + 99) / 100);
+    passFrames += passFrames / APP_OTA_BCAST_DESC_PERIOD;
+    if (!bCsv)
+    {
+        printf("image %u bytes, %u generations of %u x %u bytes, %u%% repair on the 1st pass, %u decoder slots\n"
+               "%u receivers%s, %s, %.2f frames/s\n",
+               imageSize_, gens, APP_OTA_BCAST_K, APP_OTA_BCAST_SYM_SIZE, extraPct, APP_OTA_BCAST_SLOTS,
+               rxCnt, bJoin ? " joining during the 1st pass" : "", (burst > 1.0) ? "bursts of losses" : "independent losses",
+               fps);
+        if (burst > 1.0)
+        {
+            printf("mean loss burst %.1f frames\n", burst);
+        }
+    }
+    for (l = 0; l < lossCnt; l++)
+    {
+        wrong = 0;
+        flashErrors_ = 0;
+        codedFrames = runCoded(pRxs, rxCnt, loss[l], burst, extraPct, passFrames, bJoin, &wrong);
+        codedMean = (0 != codedFrames) ? meanFrames(pRxs, rxCnt) : 0.0;
+        for (symRatio = 0.0, i = 0; i < rxCnt; i++)
+        {
+            symRatio += (double)pRxs[i].symbols / ((imageSize_ + APP_OTA_BCAST_SYM_SIZE - 1) / APP_OTA_BCAST_SYM_SIZE);
+        }
+        symRatio /= rxCnt;
+        carouselFrames = runCarousel(pRxs, rxCnt, loss[l], burst, passFrames, bJoin);
+        carouselMean = (0 != carouselFrames) ? meanFrames(pRxs, rxCnt) : 0.0;
+        wrong += flashErrors_ + ((0 == codedFrames) ? 1 : 0);
+        failed += wrong;
+        if (bCsv)
+        {
+            printf("%.1f,%.1f,%u,%u,%u,%.2f,%u,%.1f,%.0f,%.3f,%u,%.1f,%.0f,%u\n", loss[l] * 100.0, burst, rxCnt,
+                   extraPct, imageSize_, fps, codedFrames, codedFrames / fps, codedMean, symRatio, carouselFrames,
+                   carouselFrames / fps, carouselMean, wrong);
+            continue;
+        }
+        printf("loss %4.1f%%: coded all %7u frames %8.1f s (mean %7.0f, %.2f symbols/source symbol), "
+               "carousel all %7u frames %8.1f s (mean %7.0f)%s\n",
+               loss[l] * 100.0, codedFrames, codedFrames / fps, codedMean, symRatio, carouselFrames,
+               carouselFrames / fps, carouselMean, (0 != wrong) ? "  FAILED" : "");
+    }
+    return((0 == failed) ? 0 : 1);
+}
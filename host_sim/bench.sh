@@ -0,0 +1,26 @@
+#!/bin/sh
+# Sweeps the channel model and writes CSV to stdout, one row per run.  The first column names the swept parameter.
+#   ./bench.sh [frames] > bench.csv
+N=${1:-100}
+SIM=./micrf_sim
+
+run() {     # sweep name, then micrf_sim arguments
+    name=$1; shift
+    printf '%s,' "$name"
+    $SIM -n "$N" -C "$@" || exit 1
+}
+
+printf 'sweep,'; $SIM -H
+for r in 0 1 2 3; do
+    for ab in "" "-f"; do
+        for snr in 16 14 12 11 10 9 8 7 6; do run snr -r $r $ab -s $snr; done
+        for e in 0.0003 0.001 0.003 0.01 0.03; do run chip_flip -r $r $ab -e $e; done
+        for w in -200 -150 -100 -50 50 100 150 200; do run stretch -r $r $ab -w $w; done
+        for b in 0.5 1 2 5 10; do run burst -r $r $ab -b $b; done
+        for l in 10 20 50 100 200; do run lead_noise -r $r $ab -L $l; done
+        for p in -40000 -20000 -10000 10000 20000 40000; do run ppm -r $r $ab -p $p; done
+        for q in 0 3 6; do      # Idle time between frames, the squelch only saves CPU on an idle channel
+            for snr in 99 12 10 8 7 6 5; do run squelch -r $r $ab -i 500 -s $snr -q $q; done
+        done
+    done
+done
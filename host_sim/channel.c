@@ -0,0 +1,175 @@
+/* ****************************************************************************************************************** */
+/***********************************************************************************************************************
+ *
+ * Filename: channel.c
+ *
+ * Contents: Channel model.  The TX carrier is turned into the level the receiver samples:
+ *           - chip flips, applied to the transmitted chips
+ *           - pulse width distortion, the falling (or rising) edge of every mark is moved by stretchUs
+ *           - noise bursts (Poisson) and noise before each frame, random pulses of noisePulseUs on average
+ *           - slicer noise, independent flips of every RX sample, set from the SNR
+ *           Clock drift is the scheduler's TX ppm.
+ *           The RSSI output follows the carrier energy: the noise floor (with some jitter) plus the SNR times the
+ *           fraction of the time the carrier was on.  Bursts add energy, the lead noise doesn't (it is the slicer
+ *           chattering on an idle channel).  Levels use the MICRF219A datasheet curve, see RSSI_xxx.
+ *
+ **********************************************************************************************************************/
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "channel.h"
+
+#define NS_PER_US           ((uint64_t)1000)
+#define NS_PER_S            ((uint64_t)1000000000)
+#define NEVER               UINT64_MAX
+#define RSSI_FLOOR_dBm      (-105.0)
+#define RSSI_JITTER_dB      1.0         /* Standard deviation of a RSSI sample on the noise floor */
+#define RSSI_STRONG_dB      40.0        /* Carrier level above the floor with the slicer noise off */
+#define RSSI_BURST_dB       10.0
+#define RSSI_mV(dBm)        (500.0 + (((dBm) + 110.0) * 25.0))  /* Datasheet, 25mV/dB from 0.5V at -110dBm */
+#define RSSI_CODE(mV)       ((mV) * 4095.0 / 3000.0)            /* 12 bit ADC, 3V reference */
+
+static channelCfg_t cfg_;
+static uint64_t     rng_;
+static double       sampleFlip_;    /* From the SNR */
+static uint8_t      txLevel_;       /* Carrier after the chip flips */
+static uint64_t     txEdgeNs_;      /* Time of the last carrier edge */
+static uint64_t     burstStart_, burstEnd_;
+static uint64_t     leadStart_, leadEnd_;
+static uint8_t      noiseLevel_;
+static uint64_t     noiseToggle_;
+static uint64_t     carrierOnNs_;   /* Carrier on time up to txEdgeNs_ */
+static uint64_t     rssiNs_, rssiOnNs_; /* Time and carrier on time of the previous RSSI sample */
+static uint64_t     rssiRng_;       /* Own generator, the RSSI samples don't change the rest of the channel */
+
+static double uniformFrom( uint64_t *pRng )
+{
+    *pRng ^= *pRng << 13;   /* xorshift64 */
+    *pRng ^= *pRng >> 7;
+    *pRng ^= *pRng << 17;
+    return((double)(*pRng >> 11) / (double)(1ULL << 53));
+}
+
+static double uniform( void )
+{
+    return(uniformFrom(&rng_));
+}
+
+static uint64_t exponentialNs( double meanNs )
+{
+    return((uint64_t)(-meanNs * log(1.0 - uniform())) + 1);
+}
+
+static void nextBurst( uint64_t fromNs )
+{
+    if (cfg_.burstPerS <= 0.0)
+    {
+        burstStart_ = burstEnd_ = NEVER;
+        return;
+    }
+    burstStart_ = fromNs + exponentialNs((double)NS_PER_S / cfg_.burstPerS);
+    burstEnd_ = burstStart_ + (cfg_.burstUs * NS_PER_US);
+}
+
+void channel_init( const channelCfg_t *pCfg )
+{
+    cfg_ = *pCfg;
+    rng_ = 0x9E3779B97F4A7C15ULL ^ cfg_.seed;
+    if (0 == cfg_.noisePulseUs)
+    {
+        cfg_.noisePulseUs = 1;
+    }
+    sampleFlip_ = (cfg_.snrDb > 99.0) ? 0.0 : (0.5 * erfc(sqrt(pow(10.0, cfg_.snrDb / 10.0)) / sqrt(2.0)));
+    txLevel_ = 0;
+    txEdgeNs_ = 0;
+    leadStart_ = leadEnd_ = NEVER;
+    noiseLevel_ = 0;
+    noiseToggle_ = 0;
+    carrierOnNs_ = 0;
+    rssiNs_ = rssiOnNs_ = 0;
+    rssiRng_ = 0xD1B54A32D192ED03ULL ^ cfg_.seed;
+    nextBurst(0);
+}
+
+void channel_tx( uint8_t level, bool bRunning, uint64_t timeNs )
+{
+    if (bRunning && (cfg_.chipFlip > 0.0) && (uniform() < cfg_.chipFlip))
+    {
+        level ^= 1;     /* Only while the bit timer runs, a stopped transmitter doesn't send chips */
+    }
+    if (level != txLevel_)
+    {
+        if (0 != txLevel_)
+        {
+            carrierOnNs_ += timeNs - txEdgeNs_;
+        }
+        txLevel_ = level;
+        txEdgeNs_ = timeNs;
+    }
+}
+
+void channel_lead( uint64_t startNs, uint64_t endNs )
+{
+    leadStart_ = startNs;
+    leadEnd_ = endNs;
+}
+
+bool channel_noise( uint64_t timeNs )
+{
+    while (timeNs >= burstEnd_)
+    {
+        nextBurst(burstEnd_);
+    }
+    return(((timeNs >= burstStart_) && (timeNs < burstEnd_)) || ((timeNs >= leadStart_) && (timeNs < leadEnd_)));
+}
+
+uint8_t channel_rx( uint64_t timeNs )
+{
+    uint8_t  level = txLevel_;
+    uint64_t sinceEdge = timeNs - txEdgeNs_;
+    uint64_t distortNs = (uint64_t)llabs((long long)cfg_.stretchUs) * NS_PER_US;
+
+    // The slicer holds the previous level for a while after the edge it distorts.
+    if ((cfg_.stretchUs > 0) && (0 == level) && (sinceEdge < distortNs))
+    {
+        level = 1;
+    }
+    else if ((cfg_.stretchUs < 0) && (0 != level) && (sinceEdge < distortNs))
+    {
+        level = 0;
+    }
+    if (channel_noise(timeNs))
+    {
+        while (timeNs >= noiseToggle_)
+        {
+            noiseLevel_ ^= 1;
+            noiseToggle_ = timeNs + exponentialNs((double)cfg_.noisePulseUs * NS_PER_US);
+        }
+        level = noiseLevel_;
+    }
+    if ((sampleFlip_ > 0.0) && (uniform() < sampleFlip_))
+    {
+        level ^= 1;
+    }
+    return(level);
+}
+
+uint16_t channel_rssi( uint64_t timeNs )
+{
+    uint64_t onNs = carrierOnNs_ + ((0 != txLevel_) ? (timeNs - txEdgeNs_) : 0);
+    double   frac = (timeNs > rssiNs_) ? ((double)(onNs - rssiOnNs_) / (double)(timeNs - rssiNs_)) : 0.0;
+    double   snr = pow(10.0, ((cfg_.snrDb > 99.0) ? RSSI_STRONG_dB : cfg_.snrDb) / 10.0);
+    double   dBm, code, gauss;
+    bool     bBurst;
+
+    (void)channel_noise(timeNs);
+    bBurst = (timeNs >= burstStart_) && (timeNs < burstEnd_);
+    rssiNs_ = timeNs;
+    rssiOnNs_ = onNs;
+    gauss = sqrt(-2.0 * log(1.0 - uniformFrom(&rssiRng_))) * cos(2.0 * M_PI * uniformFrom(&rssiRng_)); /* Box-Muller */
+    dBm = RSSI_FLOOR_dBm + (10.0 * log10(1.0 + (frac * snr) + (bBurst ? pow(10.0, RSSI_BURST_dB / 10.0) : 0.0))) +
+          (RSSI_JITTER_dB * gauss);
+    code = RSSI_CODE(RSSI_mV(dBm));
+    return((uint16_t)((code < 0.0) ? 0.0 : ((code > 4095.0) ? 4095.0 : code)));
+}
@@ -0,0 +1,34 @@
+/* ****************************************************************************************************************** */
+/***********************************************************************************************************************
+ *
+ * Filename: channel.h
+ *
+ * Contents: Impairments between the TX carrier and the RX data pin (the MICRF219A data slicer output).
+ *
+ **********************************************************************************************************************/
+#ifndef CHANNEL_H
+#define CHANNEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct
+{
+    double   snrDb;         /* Slicer noise, every RX sample flips with Q(sqrt(SNR)), > 99 = off */
+    double   chipFlip;      /* Probability a transmitted chip (half bit) is inverted */
+    int32_t  stretchUs;     /* Marks are stretched (negative = shortened) by this, the slicer's pulse width error */
+    double   burstPerS;     /* Noise bursts per second */
+    uint32_t burstUs;       /* Length of a burst */
+    uint32_t noisePulseUs;  /* Average pulse length of the noise in bursts and before frames */
+    uint32_t leadMs;        /* Noise before every frame, like a receiver without squelch */
+    uint32_t seed;
+}channelCfg_t;
+
+void    channel_init( const channelCfg_t *pCfg );
+void    channel_tx( uint8_t level, bool bRunning, uint64_t timeNs );  /* Carrier after a TX ISR */
+void    channel_lead( uint64_t startNs, uint64_t endNs ); /* Noise window before a frame */
+uint8_t channel_rx( uint64_t timeNs );                    /* Level the RX ISR samples */
+bool    channel_noise( uint64_t timeNs );                 /* true while a burst or lead noise is on */
+uint16_t channel_rssi( uint64_t timeNs );                 /* RSSI ADC code, averaged since the previous call */
+
+#endif  /* CHANNEL_H */
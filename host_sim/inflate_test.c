@@ -0,0 +1,401 @@
+/* ****************************************************************************************************************** */
+/***********************************************************************************************************************
+ *
+ * Filename: inflate_test.c
+ *
+ * Contents: Regression test of the zlib decoder of the compressed streamed OTA (app_ota/app_ota_inflate.c).
+ *
+ *           inflate_test -w image.bin [-S seed]
+ *             Writes a test image: random pages (kept as they are by ota_pack.py), erased pages, pages of a few
+ *             repeated words, text, runs and long back references, half random pages and a short last page.
+ *           inflate_test image.bin image.otaz [-S seed]
+ *             Decodes every compressed page of the ota_pack.py file with APP_OTA_Inflate() and compares it with the
+ *             image, as APP_OTA_ZipBlock() does.  Then checks that every page fails cleanly when its stream is cut
+ *             short, has a bit flipped or does not fit the output buffer, that random data after a zlib header fails,
+ *             and decodes streams of stored deflate blocks, which ota_pack.py never makes.  Nothing may be written
+ *             past the output buffer.
+ *
+ *           Exit code 0 when every check passed, 1 otherwise.
+ *
+ **********************************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include "app_ota_inflate.h"
+
+#define PAGE_LOG2           12
+#define PAGE_SIZE           (1U << PAGE_LOG2)
+#define HDR_LEN             16          /* "OTAZ", version, log2(page size), pages, image size, reserved */
+#define STORED              0x8000U
+#define LEN_MASK            0x7FFFU
+#define CANARY_LEN          64
+#define CANARY              0xA5
+#define TEST_PAGES          18
+#define TEST_SIZE           ((TEST_PAGES - 1) * PAGE_SIZE + 2064)   /* The last page is short */
+#define CUTS                48          /* Truncated lengths tried per page, besides the last 8 bytes */
+#define FLIPS               96          /* Single bit flips tried per page */
+#define GARBAGE_RUNS        2000
+
+static uint64_t rng_;
+static uint8_t  out_[PAGE_SIZE + CANARY_LEN];
+static uint32_t failed_;
+static uint32_t collisions_;
+
+static uint32_t rnd( void )
+{
+    rng_ ^= rng_ << 13;     /* xorshift64 */
+    rng_ ^= rng_ >> 7;
+    rng_ ^= rng_ << 17;
+    return((uint32_t)(rng_ >> 32));
+}
+
+static void fail( const char *pWhat, uint32_t page, uint32_t arg )
+{
+    if (failed_++ < 20)
+    {
+        fprintf(stderr, "page %u: %s (%u)\n", page, pWhat, arg);
+    }
+}
+
+/* Decode into out_ with the bytes after outSz set to the canary, returns the decoder result.  Fails on a write past
+ * outSz. */
+static int32_t inflate( const uint8_t *pIn, uint32_t inSz, uint32_t outSz, uint32_t page )
+{
+    int32_t res;
+    uint32_t i;
+
+    memset(out_, 0, outSz);
+    memset(&out_[outSz], CANARY, sizeof(out_) - outSz);
+    res = APP_OTA_Inflate(out_, outSz, pIn, inSz);
+    for (i = outSz; i < sizeof(out_); i++)
+    {
+        if (CANARY != out_[i])
+        {
+            fail("written past the output buffer", page, i - outSz);
+            break;
+        }
+    }
+    if ((res < -1) || (res > (int32_t)outSz))
+    {
+        fail("result out of range", page, (uint32_t)res);
+    }
+    return(res);
+}
+
+static uint32_t adler32( const uint8_t *pData, uint32_t len )
+{
+    uint32_t a = 1, b = 0;
+
+    while (len-- != 0)
+    {
+        a = (a + *pData++) % 65521;
+        b = (b + a) % 65521;
+    }
+    return((b << 16) | a);
+}
+
+/* Adler-32 at the end of a zlib stream, big endian */
+static uint32_t trailer( const uint8_t *p )
+{
+    return(((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3]);
+}
+
+/* Test image, the kind of a page is its index modulo 8 */
+static void makeImage( uint8_t *pImage, uint32_t size )
+{
+    static const char text[] = "[MICRF] Broadcast image %d: %lu bytes, %d generations, CRC 0x%08lx\n\r";
+    uint32_t words[16], page, i, j, run;
+    uint8_t *p;
+
+    for (i = 0; i < 16; i++)
+    {
+        words[i] = rnd();
+    }
+    for (page = 0; (page * PAGE_SIZE) < size; page++)
+    {
+        p = &pImage[page * PAGE_SIZE];
+        switch (page % 8)
+        {
+            case 0:     /* Random, does not compress */
+                for (i = 0; i < PAGE_SIZE; i++)
+                {
+                    p[i] = (uint8_t)rnd();
+                }
+                break;
+            case 1:     /* Erased flash */
+                memset(p, 0xFF, PAGE_SIZE);
+                break;
+            case 2:     /* Instruction like: a few words repeated */
+                for (i = 0; i < PAGE_SIZE; i += 4)
+                {
+                    memcpy(&p[i], &words[rnd() % 16], 4);
+                }
+                break;
+            case 3:     /* Text with numbers */
+                for (i = 0; i < PAGE_SIZE; i++)
+                {
+                    p[i] = ((i % 97) < 8) ? (uint8_t)('0' + (rnd() % 10)) : (uint8_t)text[i % (sizeof(text) - 1)];
+                }
+                break;
+            case 4:     /* Runs of random length */
+                for (i = 0; i < PAGE_SIZE; i += run)
+                {
+                    run = 1 + (rnd() % 300);
+                    memset(&p[i], (int)(rnd() & 0x0F), ((PAGE_SIZE - i) < run) ? (PAGE_SIZE - i) : run);
+                }
+                break;
+            case 5:     /* Random start copied to the end, the longest distances of a page */
+                for (i = 0; i < 64; i++)
+                {
+                    p[i] = (uint8_t)rnd();
+                }
+                memset(&p[64], 0, PAGE_SIZE - 128);
+                memcpy(&p[PAGE_SIZE - 64], p, 64);
+                break;
+            case 6:     /* Half random */
+                for (i = 0; i < PAGE_SIZE; i++)
+                {
+                    p[i] = (i < (PAGE_SIZE / 2)) ? (uint8_t)rnd() : (uint8_t)(i >> 5);
+                }
+                break;
+            default:    /* Every byte value, with small random edits */
+                for (i = 0, j = 0; i < PAGE_SIZE; i++)
+                {
+                    p[i] = ((rnd() % 16) == 0) ? (uint8_t)rnd() : (uint8_t)(j++);
+                }
+                break;
+        }
+    }
+}
+
+/* Streams of stored deflate blocks of 1 to 5 blocks, one of them empty */
+static void testStoredBlocks( const uint8_t *pImage )
+{
+    static uint8_t stream[PAGE_SIZE + 64];
+    uint32_t blocks, b, len, pos, in, blockLen;
+
+    for (blocks = 1; blocks <= 5; blocks++)
+    {
+        len = PAGE_SIZE - (blocks * 100);
+        stream[0] = 0x78;
+        stream[1] = 0x01;
+        pos = 2;
+        for (b = 0, in = 0; b < blocks; b++)
+        {
+            blockLen = (b == (blocks - 1)) ? (len - in) : ((b == 1) ? 0 : (len / blocks));
+            stream[pos++] = (b == (blocks - 1)) ? 1 : 0;     /* BFINAL, BTYPE 00, byte aligned after it */
+            stream[pos++] = (uint8_t)blockLen;
+            stream[pos++] = (uint8_t)(blockLen >> 8);
+            stream[pos++] = (uint8_t)~blockLen;
+            stream[pos++] = (uint8_t)(~blockLen >> 8);
+            memcpy(&stream[pos], &pImage[in], blockLen);
+            pos += blockLen;
+            in += blockLen;
+        }
+        stream[pos++] = (uint8_t)(adler32(pImage, len) >> 24);
+        stream[pos++] = (uint8_t)(adler32(pImage, len) >> 16);
+        stream[pos++] = (uint8_t)(adler32(pImage, len) >> 8);
+        stream[pos++] = (uint8_t)adler32(pImage, len);
+        if ((inflate(stream, pos, PAGE_SIZE, blocks) != (int32_t)len) || (0 != memcmp(out_, pImage, len)))
+        {
+            fail("stored blocks not decoded", blocks, len);
+        }
+        stream[7] ^= 0x01;      /* NLEN of the 1st block */
+        if (inflate(stream, pos, PAGE_SIZE, blocks) != -1)
+        {
+            fail("stored block with a bad NLEN decoded", blocks, len);
+        }
+    }
+}
+
+/* Random data after a valid zlib header, with a random 1st block type */
+static void testGarbage( void )
+{
+    uint8_t  stream[512];
+    uint32_t run, i, len;
+
+    for (run = 0; run < GARBAGE_RUNS; run++)
+    {
+        len = 3 + (rnd() % (sizeof(stream) - 3));
+        stream[0] = 0x78;
+        stream[1] = 0x9C;
+        for (i = 2; i < len; i++)
+        {
+            stream[i] = (uint8_t)rnd();
+        }
+        (void)inflate(stream, len, PAGE_SIZE, run);
+    }
+}
+
+/* The checks of one compressed page */
+static void testPage( const uint8_t *pBlock, uint32_t blockLen, const uint8_t *pPage, uint32_t pageLen, uint32_t page )
+{
+    static uint8_t stream[LEN_MASK];
+    uint32_t i, cut, bit;
+    int32_t res;
+
+    res = inflate(pBlock, blockLen, pageLen, page);
+    if ((res != (int32_t)pageLen) || (0 != memcmp(out_, pPage, pageLen)))
+    {
+        fail("not decoded", page, (uint32_t)res);
+        return;
+    }
+    if ((pageLen > 0) && (inflate(pBlock, blockLen, pageLen - 1, page) != -1))
+    {
+        fail("decoded into a buffer 1 byte short", page, pageLen);
+    }
+    for (i = 0; i < (CUTS + 8); i++)
+    {   /* Evenly spread lengths, then the last 8 bytes one by one: the Adler-32 is always missing or short */
+        cut = (i < CUTS) ? ((blockLen * i) / CUTS) : (blockLen - (i - CUTS) - 1);
+        if (inflate(pBlock, cut, pageLen, page) != -1)
+        {
+            fail("truncated stream decoded", page, cut);
+        }
+    }
+    memcpy(stream, pBlock, blockLen);
+    for (i = 0; i < FLIPS; i++)
+    {   /* Most flips must fail.  A flip in the padding bits of the last deflate byte still decodes right, and now and
+         * then a flip makes another valid stream of the same Adler-32 (zlib takes it too), but what is decoded must
+         * always match the Adler-32 at the end of the stream. */
+        bit = rnd() % (blockLen * 8);
+        stream[bit / 8] ^= (uint8_t)(1 << (bit % 8));
+        res = inflate(stream, blockLen, pageLen, page);
+        if ((res != -1) && (adler32(out_, (uint32_t)res) != trailer(&stream[blockLen - 4])))
+        {
+            fail("corrupted stream decoded against its Adler-32", page, bit);
+        }
+        else if ((res != -1) && ((res != (int32_t)pageLen) || (0 != memcmp(out_, pPage, pageLen))))
+        {
+            collisions_++;
+        }
+        stream[bit / 8] ^= (uint8_t)(1 << (bit % 8));
+    }
+}
+
+static uint8_t *readFile( const char *pName, uint32_t *pLen )
+{
+    FILE *pIn = fopen(pName, "rb");
+    uint8_t *pData = NULL;
+    long len;
+
+    if ((NULL != pIn) && (0 == fseek(pIn, 0, SEEK_END)) && ((len = ftell(pIn)) > 0))
+    {
+        rewind(pIn);
+        pData = malloc((size_t)len);
+        if ((NULL != pData) && (fread(pData, 1, (size_t)len, pIn) != (size_t)len))
+        {
+            free(pData);
+            pData = NULL;
+        }
+        *pLen = (uint32_t)len;
+    }
+    if (NULL != pIn)
+    {
+        fclose(pIn);
+    }
+    return(pData);
+}
+
+int main( int argc, char **argv )
+{
+    uint32_t seed = 1, imageLen = 0, fileLen = 0, size, pages, page, pos, len, pageLen;
+    uint32_t stored = 0, types[4] = { 0 };
+    const char *pWrite = NULL;
+    uint8_t *pImage, *pFile;
+    FILE *pOut;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "w:S:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'w': pWrite = optarg; break;
+            case 'S': seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "usage: %s -w image.bin [-S seed] | image.bin image.otaz [-S seed]\n", argv[0]);
+                return(2);
+        }
+    }
+    rng_ = 0x9E3779B97F4A7C15ULL ^ seed;
+    if (NULL != pWrite)
+    {
+        pImage = malloc(TEST_PAGES * PAGE_SIZE);
+        pOut = fopen(pWrite, "wb");
+        if ((NULL == pImage) || (NULL == pOut))
+        {
+            fprintf(stderr, "%s: cannot write\n", pWrite);
+            return(2);
+        }
+        makeImage(pImage, TEST_SIZE);
+        if (fwrite(pImage, 1, TEST_SIZE, pOut) != TEST_SIZE)
+        {
+            return(2);
+        }
+        fclose(pOut);
+        free(pImage);
+        return(0);
+    }
+    if ((optind + 2) != argc)
+    {
+        fprintf(stderr, "usage: %s -w image.bin [-S seed] | image.bin image.otaz [-S seed]\n", argv[0]);
+        return(2);
+    }
+    pImage = readFile(argv[optind], &imageLen);
+    pFile = readFile(argv[optind + 1], &fileLen);
+    if ((NULL == pImage) || (NULL == pFile) || (fileLen < HDR_LEN) || (0 != memcmp(pFile, "OTAZ", 4)) ||
+        (pFile[5] != PAGE_LOG2))
+    {
+        fprintf(stderr, "cannot read the image or the OTAZ file\n");
+        return(2);
+    }
+    pages = pFile[6] | ((uint32_t)pFile[7] << 8);
+    size = pFile[8] | ((uint32_t)pFile[9] << 8) | ((uint32_t)pFile[10] << 16) | ((uint32_t)pFile[11] << 24);
+    if ((size != imageLen) || (pages != ((size + PAGE_SIZE - 1) / PAGE_SIZE)))
+    {
+        fprintf(stderr, "the OTAZ file is not of the image\n");
+        return(1);
+    }
+
+    for (page = 0, pos = HDR_LEN; page < pages; page++)
+    {
+        pageLen = ((size - (page * PAGE_SIZE)) < PAGE_SIZE) ? (size - (page * PAGE_SIZE)) : PAGE_SIZE;
+        if ((pos + 2) > fileLen)
+        {
+            fail("file too short", page, pos);
+            break;
+        }
+        len = (pFile[pos] | ((uint32_t)pFile[pos + 1] << 8)) & LEN_MASK;
+        if ((pos + 2 + len) > fileLen)
+        {
+            fail("file too short", page, pos);
+            break;
+        }
+        if ((pFile[pos + 1] << 8) & STORED)
+        {
+            stored++;
+            if ((len != pageLen) || (0 != memcmp(&pFile[pos + 2], &pImage[page * PAGE_SIZE], len)))
+            {
+                fail("stored page differs", page, len);
+            }
+        }
+        else
+        {
+            types[(pFile[pos + 4] >> 1) & 0x03]++;  /* BTYPE of the 1st deflate block */
+            testPage(&pFile[pos + 2], len, &pImage[page * PAGE_SIZE], pageLen, page);
+        }
+        pos += 2 + len;
+    }
+    testStoredBlocks(pImage);
+    testGarbage();
+
+    printf("%u pages: %u kept as they are, %u fixed, %u dynamic Huffman, %u stored deflate blocks 1st; "
+           "%u Adler-32 collisions, %u checks failed\n",
+           pages, stored, types[1], types[2], types[0], collisions_, failed_);
+    free(pImage);
+    free(pFile);
+    return((0 == failed_) ? 0 : 1);
+}
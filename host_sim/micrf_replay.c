@@ -0,0 +1,193 @@
+/* ****************************************************************************************************************** */
+/***********************************************************************************************************************
+ *
+ * Filename: micrf_replay.c
+ *
+ * Contents: Replays a raw sample capture of the MICRF219A driver through MICRF_sampleTimerISR().  Every captured
+ *           sample is put on the data pin and the ISR is called once, so the slicer sees exactly what it saw in the
+ *           field (the replay starts with the receiver reset, the first frame in the capture may be cut off).
+ *
+ *           micrf_replay [-v] file
+ *             file  Console log or micrf_sim -W output, the MICRF-CAP 1 ... MICRF-CAP END block is used
+ *             -v    Print every run of the capture
+ *
+ *           Exit code 0 if the capture was read, 1 otherwise.
+ *
+ **********************************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "sim_hal.h"
+#include "sim_node.h"
+
+#define CAP_ENTRIES_MAX     ((uint32_t)65536)
+#define TICKS_PER_MS        (SIM_TC_CLOCK_HZ / 1000)
+
+typedef struct
+{
+    int      profile;
+    int      autoBaud;
+    int      trigger;
+    int      len;
+    int      trig;
+    uint8_t  *pEntries;
+    uint32_t cnt;
+}capture_t;
+
+volatile uint8_t sim_rfLevel;
+static uint64_t  ticks_;    /* Virtual time, SIM_TC_CLOCK_HZ ticks */
+
+uint32_t sim_timeMs( void )
+{
+    return((uint32_t)(ticks_ / TICKS_PER_MS));
+}
+
+static int hexNibble( int c )
+{
+    if ((c >= '0') && (c <= '9'))
+    {
+        return(c - '0');
+    }
+    if ((c >= 'a') && (c <= 'f'))
+    {
+        return(c - 'a' + 10);
+    }
+    if ((c >= 'A') && (c <= 'F'))
+    {
+        return(c - 'A' + 10);
+    }
+    return(-1);
+}
+
+static bool readCapture( FILE *pFile, capture_t *pCap )
+{
+    char line[512];
+    char *pHeader;
+    bool bInside = false;
+    int  hi, lo;
+    size_t i;
+
+    while (NULL != fgets(line, sizeof(line), pFile))
+    {
+        if (!bInside)
+        {
+            pHeader = strstr(line, "MICRF-CAP 1 ");
+            if ((NULL != pHeader) && (5 == sscanf(pHeader, "MICRF-CAP 1 profile=%d autobaud=%d trigger=%d len=%d trig=%d",
+                                                  &pCap->profile, &pCap->autoBaud, &pCap->trigger, &pCap->len,
+                                                  &pCap->trig)))
+            {
+                bInside = true;
+                pCap->cnt = 0;
+            }
+            continue;
+        }
+        if (NULL != strstr(line, "MICRF-CAP END"))
+        {
+            return((uint32_t)pCap->len == pCap->cnt);
+        }
+        for (i = 0; (hi = hexNibble(line[i])) >= 0; i += 2)
+        {
+            lo = hexNibble(line[i + 1]);
+            if ((lo < 0) || (pCap->cnt >= CAP_ENTRIES_MAX))
+            {
+                return(false);
+            }
+            pCap->pEntries[pCap->cnt++] = (uint8_t)((hi << 4) | lo);
+        }
+    }
+    return(false);
+}
+
+static void poll( void )
+{
+    uint16_t serialNum;
+    uint8_t  seq, cnt, i;
+    uint8_t  data[32];
+
+    while (simrx_pollPacket(&serialNum, &seq, data, &cnt))
+    {
+        printf("%8.2f ms  SN 0x%04x seq %3u, %2u bytes:", (double)ticks_ / TICKS_PER_MS, serialNum, seq, cnt);
+        for (i = 0; i < cnt; i++)
+        {
+            printf(" %02x", data[i]);
+        }
+        printf("\n");
+    }
+}
+
+int main( int argc, char *argv[] )
+{
+    capture_t cap;
+    simRxStats_t stats;
+    FILE     *pFile;
+    bool     bVerbose = false;
+    uint64_t nextPollTicks = TICKS_PER_MS;
+    uint32_t i, samples = 0;
+    uint8_t  level, n;
+    int      opt;
+
+    while ((opt = getopt(argc, argv, "v")) != -1)
+    {
+        if ('v' == opt)
+        {
+            bVerbose = true;
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [-v] file\n", argv[0]);
+            return(1);
+        }
+    }
+    if (optind >= argc)
+    {
+        fprintf(stderr, "usage: %s [-v] file\n", argv[0]);
+        return(1);
+    }
+    pFile = fopen(argv[optind], "r");
+    cap.pEntries = malloc(CAP_ENTRIES_MAX);
+    if ((NULL == pFile) || (NULL == cap.pEntries) || !readCapture(pFile, &cap))
+    {
+        fprintf(stderr, "%s: no complete MICRF-CAP block\n", argv[optind]);
+        return(1);
+    }
+    fclose(pFile);
+    if (!simrx_init((uint8_t)cap.profile, 0 != cap.autoBaud))
+    {
+        fprintf(stderr, "invalid profile %d\n", cap.profile);
+        return(1);
+    }
+    printf("capture: profile %d, auto-baud %s, trigger 0x%02x at entry %d of %d\n",
+           cap.profile, cap.autoBaud ? "on" : "off", cap.trigger, cap.trig, cap.len);
+
+    for (i = 0; i < cap.cnt; i++)
+    {
+        level = (uint8_t)(cap.pEntries[i] >> 7);
+        n = (uint8_t)((cap.pEntries[i] & 0x7F) + 1);
+        if (bVerbose)
+        {
+            printf("%8.2f ms  %5u: %u x %u%s\n", (double)ticks_ / TICKS_PER_MS, i, level, n,
+                   ((int)i == cap.trig) ? "  <- trigger" : "");
+        }
+        while (0 != n--)
+        {
+            sim_rfLevel = level;
+            rxhal_timerIsr();
+            samples++;
+            ticks_ += rxhal_timerPeriod();  // The ISR may have changed the period (auto-baud), time follows it
+            if (ticks_ >= nextPollTicks)
+            {
+                nextPollTicks += TICKS_PER_MS;
+                poll();
+            }
+        }
+    }
+    poll();
+    simrx_stats(&stats);
+    printf("replayed %u samples (%.2f ms): crc %u, protocol %u, cnt %u, dup %u\n", samples,
+           (double)ticks_ / TICKS_PER_MS, stats.crcFailures, stats.protocolFailures, stats.cntFailure,
+           stats.duplicates);
+    free(cap.pEntries);
+    return(0);
+}
@@ -0,0 +1,313 @@
+/* ****************************************************************************************************************** */
+/***********************************************************************************************************************
+ *
+ * Filename: micrf_sim.c
+ *
+ * Contents: Virtual time loopback of the MICRF114 transmitter and the MICRF219A receiver.  The TX and RX TC0 interrupts
+ *           are scheduled at their programmed periods (48MHz ticks), the TX carrier is fed to the RX data pin, and both
+ *           applications run every mS.  Reports delivered vs. sent frames, frames per second and the ISR cost.  The RX
+ *           application also takes one RSSI sample of the channel every mS.  The link quality indicator (LQI) of the
+ *           delivered frames is reported as an average and a minimum.
+ *
+ *           micrf_sim [-r profile] [-n frames] [-f] [-p ppm] [-c copies] [-g gapMs] [-j jitterMs] [-i intervalMs]
+ *                     [-s snrDb] [-e chipFlip] [-w stretchUs] [-b burstPerS] [-u burstUs] [-N noisePulseUs]
+ *                     [-L leadMs] [-S seed] [-q squelchDb] [-C] [-H] [-W file [-T triggers] [-P postCnt]]
+ *             -r  Rate profile, 0 = 500bps, 1 = 1kbps, 2 = 2kbps, 3 = 4kbps (both nodes)
+ *             -n  Frames to send
+ *             -f  Fixed rate receiver (auto-baud off)
+ *             -p  TX clock error in ppm, positive = TX fast
+ *             -c/-g/-j  TX copies per frame, gap and jitter
+ *             -i  Time between frames, 0 = send as soon as the transmitter is idle
+ *             -s/-e/-w/-b/-u/-N/-L/-S  Channel model, see channel.h
+ *             -q  RX squelch threshold in dB above the noise floor, 0 = off (MICRF_setSquelch())
+ *             -C  Print one CSV row instead of the report, -H prints the CSV header and exits
+ *             -W  Arm the RX raw sample capture and write it to file once frozen, for micrf_replay.  -T sets the
+ *                 triggers (MICRF_CAP_TRIG_xxx, default 3 = sync or CRC) and -P the entries after the trigger.
+ *
+ *           Exit code 0 when every frame was delivered once, 1 otherwise.  With channel impairments or -C, only the
+ *           settings are checked.
+ *
+ **********************************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLES()            __rdtsc()
+#define CYCLES_UNIT         "cycles"
+#else
+#define CYCLES()            nowNs()
+#define CYCLES_UNIT         "ns"
+#endif
+#include "sim_hal.h"
+#include "sim_node.h"
+#include "channel.h"
+
+#define SUB_TICKS           ((uint64_t)1000)                    /* Virtual time resolution, 1/1000 of a TC tick */
+#define TIME_NEVER          UINT64_MAX
+#define MS_TO_TIME(ms)      ((uint64_t)(ms) * (SIM_TC_CLOCK_HZ / 1000) * SUB_TICKS)
+#define TIME_TO_NS(t)       ((t) / ((SIM_TC_CLOCK_HZ * SUB_TICKS) / 1000000000))
+#define DRAIN_MS            ((uint32_t)500)                     /* Time after the last frame for it to be delivered */
+#define CSV_HEADER          "profile,bitrate,autobaud,ppm,snr_db,chip_flip,stretch_us,burst_per_s,burst_us,lead_ms," \
+                            "squelch_db,sent,delivered,per,rejected,wrong,false_sync,false_sync_per_s," \
+                            "squelch_closed,lqi_avg,lqi_min,rx_isr_avg,rx_isr_max,rx_cost_per_s,unit"
+
+typedef struct
+{
+    uint64_t calls;
+    uint64_t total;
+    uint64_t max;
+}isrCost_t;
+
+volatile uint8_t sim_rfLevel;
+static uint64_t  now_;
+
+uint32_t sim_timeMs( void )
+{
+    return((uint32_t)(now_ / MS_TO_TIME(1)));
+}
+
+#if !(defined(__x86_64__) || defined(__i386__))
+static uint64_t nowNs( void )
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return(((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec);
+}
+#endif
+
+static void runIsr( void (*isr)( void ), isrCost_t *pCost )
+{
+    uint64_t start = CYCLES();
+    uint64_t cost;
+
+    isr();
+    cost = CYCLES() - start;
+    pCost->calls++;
+    pCost->total += cost;
+    if (cost > pCost->max)
+    {
+        pCost->max = cost;
+    }
+}
+
+int main( int argc, char *argv[] )
+{
+    uint8_t  profile = 0, copies = 1, squelchDb = 0;
+    uint16_t gapMs = 0, jitterMs = 0;
+    uint32_t frames = 100, intervalMs = 0;
+    int32_t  ppm = 0;
+    bool     bAutoBaud = true, bCsv = false, bLead = false;
+    channelCfg_t channel = { .snrDb = 100.0, .burstUs = 2000, .noisePulseUs = 500, .seed = 1 };
+    uint64_t nextTx = TIME_NEVER, nextRx = TIME_NEVER, nextApp = 0, nextSend = 0, endTime = TIME_NEVER;
+    uint32_t sent = 0, delivered = 0, wrong = 0, repeated = 0, counter;
+    uint16_t bitRate, lastBitRate = 0;
+    uint8_t  lqi, lqiMin = 100;
+    uint32_t lqiSum = 0;
+    uint8_t  *pSeen;
+    isrCost_t txCost = { 0 }, rxCost = { 0 };
+    uint64_t squelchedCalls = 0;
+    simRxStats_t rxStats;
+    double   seconds;
+    uint32_t rejected, falseSync;
+    bool     bImpaired;
+    const char *pCapFile = NULL;
+    uint8_t  capTriggers = 3;
+    uint16_t capPost = 512;
+    FILE     *pFile;
+    int      opt;
+
+    while ((opt = getopt(argc, argv, "r:n:fp:c:g:j:i:s:e:w:b:u:N:L:S:q:CHW:T:P:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'r': profile = (uint8_t)atoi(optarg); break;
+            case 'n': frames = (uint32_t)atol(optarg); break;
+            case 'f': bAutoBaud = false; break;
+            case 'p': ppm = (int32_t)atol(optarg); break;
+            case 'c': copies = (uint8_t)atoi(optarg); break;
+            case 'g': gapMs = (uint16_t)atoi(optarg); break;
+            case 'j': jitterMs = (uint16_t)atoi(optarg); break;
+            case 'i': intervalMs = (uint32_t)atol(optarg); break;
+            case 's': channel.snrDb = atof(optarg); break;
+            case 'e': channel.chipFlip = atof(optarg); break;
+            case 'w': channel.stretchUs = (int32_t)atol(optarg); break;
+            case 'b': channel.burstPerS = atof(optarg); break;
+            case 'u': channel.burstUs = (uint32_t)atol(optarg); break;
+            case 'N': channel.noisePulseUs = (uint32_t)atol(optarg); break;
+            case 'L': channel.leadMs = (uint32_t)atol(optarg); break;
+            case 'S': channel.seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'q': squelchDb = (uint8_t)atoi(optarg); break;
+            case 'C': bCsv = true; break;
+            case 'H': printf("%s\n", CSV_HEADER); return(0);
+            case 'W': pCapFile = optarg; break;
+            case 'T': capTriggers = (uint8_t)strtoul(optarg, NULL, 0); break;
+            case 'P': capPost = (uint16_t)atoi(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-r profile] [-n frames] [-f] [-p ppm] [-c copies] [-g gapMs] "
+                                "[-j jitterMs] [-i intervalMs]\n"
+                                "       [-s snrDb] [-e chipFlip] [-w stretchUs] [-b burstPerS] [-u burstUs] "
+                                "[-N noisePulseUs] [-L leadMs] [-S seed] [-q squelchDb] [-C] [-H]\n"
+                                "       [-W file [-T triggers] [-P postCnt]]\n", argv[0]);
+                return(2);
+        }
+    }
+    pSeen = calloc(frames + 1, 1);
+    if ((NULL == pSeen) || !simtx_init(profile, copies, gapMs, jitterMs) || !simrx_init(profile, bAutoBaud))
+    {
+        fprintf(stderr, "invalid settings\n");
+        return(2);
+    }
+    simrx_setSquelch(squelchDb);
+    channel_init(&channel);
+    if (NULL != pCapFile)
+    {
+        simrx_captureArm(capTriggers, capPost);
+    }
+    bImpaired = (channel.snrDb <= 99.0) || (0.0 != channel.chipFlip) || (0 != channel.stretchUs) ||
+                (0.0 != channel.burstPerS) || (0 != channel.leadMs);
+
+    while (now_ < endTime)
+    {
+        // Run the earliest event.  At the same time, TX goes first so the RX samples the new level.
+        if ((nextTx <= nextRx) && (nextTx <= nextApp))
+        {
+            now_ = nextTx;
+            runIsr(txhal_timerIsr, &txCost);
+            channel_tx(txhal_carrier(), txhal_timerRunning(), TIME_TO_NS(now_));
+            nextTx = txhal_timerRunning() ?
+                     (nextTx + ((uint64_t)txhal_timerPeriod() * (SUB_TICKS * 1000000 - (uint64_t)(ppm * 1000)) /
+                                1000000)) : TIME_NEVER;
+        }
+        else if (nextRx <= nextApp)
+        {
+            now_ = nextRx;
+            sim_rfLevel = channel_rx(TIME_TO_NS(now_));
+            if (!simrx_squelchOpen())
+            {
+                squelchedCalls++;
+            }
+            runIsr(rxhal_timerIsr, &rxCost);
+            nextRx = rxhal_timerRunning() ? (nextRx + ((uint64_t)rxhal_timerPeriod() * SUB_TICKS)) : TIME_NEVER;
+        }
+        else
+        {   // Application tick, the receiver is polled and the next frame is queued like the firmware's app task.
+            now_ = nextApp;
+            nextApp += MS_TO_TIME(1);
+            simrx_rssi(channel_rssi(TIME_TO_NS(now_)));
+            while (simrx_poll(&counter, &bitRate, &lqi))
+            {
+                if (counter >= sent)
+                {
+                    wrong++;
+                }
+                else if (0 != pSeen[counter])
+                {
+                    repeated++;
+                }
+                else
+                {
+                    pSeen[counter] = 1;
+                    delivered++;
+                    lqiSum += lqi;
+                    lqiMin = (lqi < lqiMin) ? lqi : lqiMin;
+                }
+                lastBitRate = bitRate;
+            }
+            if ((sent < frames) && (now_ >= nextSend) && simtx_idle())
+            {
+                if ((0 != channel.leadMs) && !bLead)
+                {   // Noise first, the frame goes out after it.
+                    bLead = true;
+                    nextSend = now_ + MS_TO_TIME(channel.leadMs);
+                    channel_lead(TIME_TO_NS(now_), TIME_TO_NS(nextSend));
+                }
+                else if (simtx_send(sent))
+                {
+                    sent++;
+                    bLead = false;
+                    nextSend = now_ + MS_TO_TIME(intervalMs);
+                }
+            }
+            if ((TIME_NEVER == endTime) && (sent == frames) && simtx_idle())
+            {
+                endTime = now_ + MS_TO_TIME(DRAIN_MS);
+            }
+        }
+        // A timer (re)started by the ISR or the application interrupts one period later.
+        if (txhal_timerStarted())
+        {
+            nextTx = now_ + ((uint64_t)txhal_timerPeriod() * SUB_TICKS);
+        }
+        if (rxhal_timerStarted())
+        {
+            nextRx = now_ + ((uint64_t)rxhal_timerPeriod() * SUB_TICKS);
+        }
+    }
+
+    simrx_stats(&rxStats);
+    if (NULL != pCapFile)
+    {
+        pFile = fopen(pCapFile, "w");
+        if ((NULL == pFile) || !simrx_captureWrite(pFile))
+        {
+            fprintf(stderr, "%s: no capture\n", pCapFile);
+        }
+        if (NULL != pFile)
+        {
+            fclose(pFile);
+        }
+    }
+    seconds = (double)(endTime - MS_TO_TIME(DRAIN_MS)) / (double)MS_TO_TIME(1000);
+    // A lost frame shows up as (at most) one rejected or wrong frame.  Anything beyond that was synced on noise.
+    rejected = rxStats.crcFailures + rxStats.protocolFailures + rxStats.cntFailure;
+    falseSync = rejected + wrong;
+    falseSync = (falseSync > (sent - delivered)) ? (falseSync - (sent - delivered)) : 0;
+    if (bCsv)
+    {
+        printf("%u,%u,%u,%d,%.1f,%g,%d,%g,%u,%u,%u,%u,%u,%.4f,%u,%u,%u,%.3f,%.4f,%.1f,%u,%.1f,%llu,%.0f,%s\n",
+               profile, simtx_bitRate(), bAutoBaud ? 1 : 0, (int)ppm, (channel.snrDb > 99.0) ? 99.0 : channel.snrDb,
+               channel.chipFlip, (int)channel.stretchUs, channel.burstPerS, channel.burstUs, channel.leadMs, squelchDb,
+               sent, delivered, (0 != sent) ? (1.0 - ((double)delivered / sent)) : 0.0, rejected, wrong, falseSync,
+               (seconds > 0.0) ? (falseSync / seconds) : 0.0,
+               rxCost.calls ? ((double)squelchedCalls / rxCost.calls) : 0.0,
+               (0 != delivered) ? ((double)lqiSum / delivered) : 0.0, (0 != delivered) ? lqiMin : 0,
+               rxCost.calls ? (double)rxCost.total / rxCost.calls : 0.0, (unsigned long long)rxCost.max,
+               (seconds > 0.0) ? ((double)rxCost.total / seconds) : 0.0, CYCLES_UNIT);
+        free(pSeen);
+        return(0);
+    }
+    printf("profile %u (%u bps), auto-baud %s, %d ppm, %u copies: sent %u, delivered %u (%.1f%%), "
+           "wrong %u, repeated %u, crc %u, dropped dup %u, rx rate %u bps\n",
+           profile, simtx_bitRate(), bAutoBaud ? "on" : "off", (int)ppm, copies, sent, delivered,
+           (0 != sent) ? (100.0 * delivered / sent) : 0.0, wrong, repeated, rxStats.crcFailures,
+           rxStats.duplicates, lastBitRate);
+    if (bImpaired)
+    {
+        printf("  channel: SNR %.1f dB, chip flip %g, stretch %d us, %g bursts/s x %u us, lead noise %u ms, "
+               "rejected %u, false sync %u\n", channel.snrDb, channel.chipFlip, (int)channel.stretchUs,
+               channel.burstPerS, channel.burstUs, channel.leadMs, rejected, falseSync);
+    }
+    if (0 != squelchDb)
+    {
+        printf("  squelch %u dB: closed %.1f%% of the RX ISRs\n", squelchDb,
+               rxCost.calls ? (100.0 * squelchedCalls / rxCost.calls) : 0.0);
+    }
+    if (0 != delivered)
+    {
+        printf("  LQI avg %.1f, min %u\n", (double)lqiSum / delivered, lqiMin);
+    }
+    printf("  %.2f frames/s over %.2f s virtual, TX ISR %llu x %.0f %s (max %llu), "
+           "RX ISR %llu x %.0f %s (max %llu)\n",
+           (seconds > 0.0) ? (delivered / seconds) : 0.0, seconds,
+           (unsigned long long)txCost.calls, txCost.calls ? (double)txCost.total / txCost.calls : 0.0, CYCLES_UNIT,
+           (unsigned long long)txCost.max,
+           (unsigned long long)rxCost.calls, rxCost.calls ? (double)rxCost.total / rxCost.calls : 0.0, CYCLES_UNIT,
+           (unsigned long long)rxCost.max);
+    free(pSeen);
+    return((bImpaired || ((delivered == sent) && (0 == wrong) && (0 == repeated))) ? 0 : 1);
+}
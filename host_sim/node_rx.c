@@ -0,0 +1,119 @@
+/* ****************************************************************************************************************** */
+/***********************************************************************************************************************
+ *
+ * Filename: node_rx.c
+ *
+ * Contents: Application of the simulated RX node, built with the MICRF219A sources.
+ *
+ **********************************************************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "receiver.h"
+#include "dvr_micrf219a.h"
+#include "sim_node.h"
+
+bool simrx_init( uint8_t profile, bool bAutoBaud )
+{
+    RX_init();
+    RX_setAutoBaud(bAutoBaud);
+    return(RX_setRateProfile((eMICRF_rate_t)profile));
+}
+
+/* Same as the firmware's APP_MSG_MICRF_DATA_EVT handler.  Returns true with the counter of a new packet. */
+bool simrx_poll( uint32_t *pCounter, uint16_t *pBitRate, uint8_t *pLqi )
+{
+    rxDataPacket_t packet;
+
+    if (!RX_process(&packet))
+    {
+        return(false);
+    }
+    if ((SIM_SERIAL_NUM != packet.serialNum) || (sizeof(*pCounter) != packet.cnt))
+    {
+        *pCounter = UINT32_MAX;     // Not what was sent, passed the CRC
+    }
+    else
+    {
+        (void)memcpy(pCounter, &packet.data[0], sizeof(*pCounter));
+    }
+    *pBitRate = packet.bitRate;
+    *pLqi = packet.lqi;
+    return(true);
+}
+
+void simrx_stats( simRxStats_t *pStats )
+{
+    engData_t engData;
+
+    RX_getEngData(&engData);
+    pStats->crcFailures = engData.crcFailures;
+    pStats->protocolFailures = engData.protocolFailures;
+    pStats->bufferOverflow = engData.bufferOverflow;
+    pStats->cntFailure = engData.cntFailure;
+    pStats->duplicates = engData.duplicates;
+}
+
+/* Any packet, for the replay */
+bool simrx_pollPacket( uint16_t *pSerialNum, uint8_t *pSeq, uint8_t *pData, uint8_t *pCnt )
+{
+    rxDataPacket_t packet;
+
+    if (!RX_process(&packet))
+    {
+        return(false);
+    }
+    *pSerialNum = packet.serialNum;
+    *pSeq = packet.seq;
+    *pCnt = packet.cnt;
+    (void)memcpy(pData, &packet.data[0], packet.cnt);
+    return(true);
+}
+
+/* RSSI ADC conversion, like the firmware's APP_MSG_MICRF_ADC_EVT handler */
+void simrx_rssi( uint16_t adcCode )
+{
+    MICRF_setAdcValue(adcCode);
+}
+
+void simrx_setSquelch( uint8_t thresholdDb )
+{
+    MICRF_setSquelch(thresholdDb);
+}
+
+bool simrx_squelchOpen( void )
+{
+    return(MICRF_getSquelchOpen());
+}
+
+void simrx_captureArm( uint8_t triggers, uint16_t postCnt )
+{
+    MICRF_captureArm(triggers, postCnt);
+}
+
+/* Writes a frozen capture in the format of the firmware's console dump (APP_MICRF_CaptureDump()). */
+bool simrx_captureWrite( FILE *pFile )
+{
+    MICRF_captureInfo_t info;
+    uint8_t  entries[32];
+    uint16_t offset = 0, cnt, i;
+
+    MICRF_captureGetInfo(&info);
+    if (eMICRF_CAP_FROZEN != info.eState)
+    {
+        return(false);
+    }
+    fprintf(pFile, "MICRF-CAP 1 profile=%d autobaud=%d trigger=%d len=%d trig=%d\n",
+            info.eRate, info.bAutoBaud ? 1 : 0, info.trigger, info.len, info.trigIdx);
+    while (0 != (cnt = MICRF_captureRead(offset, entries, sizeof(entries))))
+    {
+        for (i = 0; i < cnt; i++)
+        {
+            fprintf(pFile, "%02x", entries[i]);
+        }
+        fprintf(pFile, "\n");
+        offset += cnt;
+    }
+    fprintf(pFile, "MICRF-CAP END\n");
+    return(true);
+}
@@ -0,0 +1,37 @@
+/* ****************************************************************************************************************** */
+/***********************************************************************************************************************
+ *
+ * Filename: node_tx.c
+ *
+ * Contents: Application of the simulated TX node, built with the MICRF114 sources.
+ *
+ **********************************************************************************************************************/
+
+#include "transmitter.h"
+#include "dvr_micrf114.h"
+#include "sim_node.h"
+
+static uint32_t counter_;   /* TX_sendData() copies the data, but keep it alive like the firmware's rgb_ble_data */
+
+bool simtx_init( uint8_t profile, uint8_t copies, uint16_t gapMs, uint16_t jitterMs )
+{
+    TX_init();
+    TX_setSerialNumber((serialNum_t)SIM_SERIAL_NUM);
+    return(TX_setRateProfile((eMICRF_rate_t)profile) && TX_setRedundancy(copies, gapMs, jitterMs));
+}
+
+bool simtx_send( uint32_t counter )
+{
+    counter_ = counter;
+    return(TX_sendData(&counter_, sizeof(counter_)));
+}
+
+bool simtx_idle( void )
+{
+    return(TX_isIdle());
+}
+
+uint16_t simtx_bitRate( void )
+{
+    return(MICRF_getBitRate(TX_getRateProfile()));
+}
@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+# Packs an application image for the compressed streamed OTA (APP_OTA_COMPRESS_ON in firmware/src/app_ota).
+#   ./ota_pack.py [-l level] image.bin image.otaz
+#   ./ota_pack.py -x image.otaz [image.bin]
+# Every 4 KB flash page of the image is compressed as a zlib stream of its own, or kept as it is when that is not
+# smaller, so the device decodes one page at a time with no window beyond the page.  Pack the plain image: an encrypted
+# one does not compress, and the streamed OTA does not decrypt.  -x unpacks a file and checks it against the image.
+import argparse
+import hashlib
+import struct
+import sys
+import zlib
+
+MAGIC = b'OTAZ'
+VERSION = 1
+PAGE_LOG2 = 12
+PAGE = 1 << PAGE_LOG2                   # NVM_FLASH_PAGESIZE
+HDR = struct.Struct('<4sBBHI4x')         # Magic, version, log2(page size), pages, image size
+STORED = 0x8000
+IMAGE_MAX = 507904                      # MW_DFU_MAX_SIZE_FW_IMAGE
+
+
+def pack(image, level):
+    if not image or len(image) % 16 or len(image) > IMAGE_MAX:
+        sys.exit('image must be 16 to %d bytes, a multiple of 16 (got %d)' % (IMAGE_MAX, len(image)))
+    pages = (len(image) + PAGE - 1) // PAGE
+    out = bytearray(HDR.pack(MAGIC, VERSION, PAGE_LOG2, pages, len(image)))
+    stored = 0
+    for i in range(pages):
+        page = image[i * PAGE:(i + 1) * PAGE]
+        block = zlib.compress(page, level)
+        if len(block) >= len(page):
+            block = page
+            stored += 1
+            out += struct.pack('<H', len(block) | STORED)
+        else:
+            out += struct.pack('<H', len(block))
+        out += block
+    out += b'\xff' * (-len(out) % 16)    # The OTA profile takes 16 byte multiples
+    return bytes(out), stored
+
+
+def unpack(data):
+    magic, version, page_log2, pages, size = HDR.unpack_from(data)
+    if magic != MAGIC or version != VERSION or page_log2 != PAGE_LOG2:
+        sys.exit('not a version %d OTAZ file with %d byte pages' % (VERSION, PAGE))
+    pos, image = HDR.size, bytearray()
+    for i in range(pages):
+        (length,) = struct.unpack_from('<H', data, pos)
+        block = data[pos + 2:pos + 2 + (length & ~STORED)]
+        pos += 2 + len(block)
+        page = block if length & STORED else zlib.decompress(block)
+        if len(page) != min(PAGE, size - len(image)):
+            sys.exit('page %d: %d bytes' % (i, len(page)))
+        image += page
+    return bytes(image)
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Pack an image for the compressed streamed OTA')
+    ap.add_argument('-l', '--level', type=int, default=9, help='zlib level, 1 to 9')
+    ap.add_argument('-x', '--unpack', action='store_true', help='unpack the 1st file, compare with the 2nd if given')
+    ap.add_argument('input')
+    ap.add_argument('output', nargs='?')
+    a = ap.parse_args()
+
+    data = open(a.input, 'rb').read()
+    if a.unpack:
+        image = unpack(data)
+        if a.output:
+            if image != open(a.output, 'rb').read():
+                sys.exit('%s does not unpack to %s' % (a.input, a.output))
+            print('%s unpacks to %s' % (a.input, a.output))
+        return
+    if not a.output:
+        ap.error('output file needed')
+    packed, stored = pack(data, a.level)
+    if unpack(packed) != data:
+        sys.exit('internal error: the packed file does not unpack to the image')
+    open(a.output, 'wb').write(packed)
+    print('%d -> %d bytes (%.1f %%), %d of %d pages stored' %
+          (len(data), len(packed), 100.0 * len(packed) / len(data), stored, (len(data) + PAGE - 1) // PAGE))
+    print('SHA-256 %s (the device logs it after the transfer)' % hashlib.sha256(packed).hexdigest())
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,210 @@
+/* ****************************************************************************************************************** */
+/***********************************************************************************************************************
+ *
+ * Filename: sim_hal.c
+ *
+ * Contents: Host stand-ins for the TC0, GPIO, ADCHS and FreeRTOS calls made by the MICRF drivers.  The file is built
+ *           once for each node (SIM_NODE_TX or SIM_NODE_RX) and linked into that node's relocatable object, so each
+ *           node has its own TC0.  The scheduler in micrf_sim.c drives the node through the txhal_xxx / rxhal_xxx API.
+ *
+ **********************************************************************************************************************/
+
+#include "definitions.h"
+#include "sim_hal.h"
+
+#if defined(SIM_NODE_TX)
+#define HAL_API(name)           txhal_##name
+#define TC0_RESET_PRESCALER     TC_CTRLA_PRESCALER_DIV256_Val   /* Harmony TC0 settings of the TX project */
+#define TC0_RESET_PERIOD        ((uint16_t)186)
+#elif defined(SIM_NODE_RX)
+#define HAL_API(name)           rxhal_##name
+#define TC0_RESET_PRESCALER     TC_CTRLA_PRESCALER_DIV256_Val   /* Harmony TC0 settings of the RX project */
+#define TC0_RESET_PERIOD        ((uint16_t)17)
+#else
+#error "Define SIM_NODE_TX or SIM_NODE_RX"
+#endif
+
+/* TC_CTRLA_PRESCALER_xxx_Val to divider */
+static const uint16_t prescalerDiv_[] = { 1, 2, 4, 8, 16, 64, 256, 1024 };
+
+tc_registers_t           sim_tc0Regs;           /* Localized by objcopy, each node has its own */
+static TC_TIMER_CALLBACK tcCallback_;
+static uintptr_t         tcContext_;
+static bool              bTcRunning_;
+static bool              bTcStarted_;           /* Started since the last HAL_API(timerStarted)() */
+static bool              bSda_;
+static bool              bScl_ = true;
+
+/* ****************************************************************************************************************** */
+/* TC0 */
+
+void TC0_TimerInitialize( void )
+{
+    bTcRunning_ = false;
+    sim_tc0Regs.COUNT16.TC_CTRLA = TC_CTRLA_PRESCALER(TC0_RESET_PRESCALER);
+    sim_tc0Regs.COUNT16.TC_CC[0] = TC0_RESET_PERIOD;
+    sim_tc0Regs.COUNT16.TC_COUNT = 0;
+}
+
+void TC0_TimerStart( void )
+{
+    bTcRunning_ = true;
+    bTcStarted_ = true;
+    sim_tc0Regs.COUNT16.TC_COUNT = 0;
+}
+
+void TC0_TimerStop( void )
+{
+    bTcRunning_ = false;
+}
+
+void TC0_Timer16bitPeriodSet( uint16_t period )
+{
+    sim_tc0Regs.COUNT16.TC_CC[0] = period;
+}
+
+uint16_t TC0_Timer16bitCounterGet( void )
+{
+    return(sim_tc0Regs.COUNT16.TC_COUNT);
+}
+
+void TC0_TimerCallbackRegister( TC_TIMER_CALLBACK callback, uintptr_t context )
+{
+    tcCallback_ = callback;
+    tcContext_ = context;
+}
+
+/* ****************************************************************************************************************** */
+/* GPIO */
+
+uint8_t RF_DATA_IN_Get( void )
+{
+    return(sim_rfLevel);
+}
+
+void RF_DATA_IN_InputEnable( void )
+{
+}
+
+void MICRF_SCL_Set( void )
+{
+    bScl_ = true;
+}
+
+void MICRF_SCL_Clear( void )
+{
+    bScl_ = false;
+}
+
+void MICRF_SCL_OutputEnable( void )
+{
+}
+
+void MICRF_SDA_Set( void )
+{
+    bSda_ = true;
+}
+
+void MICRF_SDA_Clear( void )
+{
+    bSda_ = false;
+}
+
+void MICRF_SDA_OutputEnable( void )
+{
+}
+
+/* ****************************************************************************************************************** */
+/* ADCHS, the RSSI input isn't simulated */
+
+void ADCHS_ChannelConversionStart( ADCHS_CHANNEL_NUM channel )
+{
+    (void)channel;
+}
+
+void ADCHS_GlobalLevelConversionStop( void )
+{
+}
+
+void ADCHS_CallbackRegister( ADCHS_CHANNEL_NUM channel, ADCHS_CALLBACK callback, uintptr_t context )
+{
+    (void)channel;
+    (void)callback;
+    (void)context;
+}
+
+uint16_t ADCHS_ChannelResultGet( ADCHS_CHANNEL_NUM channel )
+{
+    (void)channel;
+    return(0);
+}
+
+bool ADCHS_ChannelResultIsReady( ADCHS_CHANNEL_NUM channel )
+{
+    (void)channel;
+    return(false);
+}
+
+void ADCHS_ChannelResultInterruptEnable( ADCHS_CHANNEL_NUM channel )
+{
+    (void)channel;
+}
+
+void ADCHS_ChannelResultInterruptDisable( ADCHS_CHANNEL_NUM channel )
+{
+    (void)channel;
+}
+
+/* ****************************************************************************************************************** */
+/* FreeRTOS */
+
+TickType_t xTaskGetTickCount( void )
+{
+    return((TickType_t)sim_timeMs());
+}
+
+TickType_t xTaskGetTickCountFromISR( void )
+{
+    return((TickType_t)sim_timeMs());
+}
+
+void vTaskDelay( TickType_t xTicksToDelay )
+{
+    (void)xTicksToDelay;    // The delays in the drivers are 0 ticks, a yield
+}
+
+/* ****************************************************************************************************************** */
+/* Scheduler interface */
+
+bool HAL_API(timerRunning)( void )
+{
+    return(bTcRunning_);
+}
+
+bool HAL_API(timerStarted)( void )
+{
+    bool bStarted = bTcStarted_;
+
+    bTcStarted_ = false;
+    return(bStarted);
+}
+
+uint32_t HAL_API(timerPeriod)( void )
+{
+    uint32_t prescaler = (sim_tc0Regs.COUNT16.TC_CTRLA & TC_CTRLA_PRESCALER_Msk) >> TC_CTRLA_PRESCALER_Pos;
+
+    return((uint32_t)prescalerDiv_[prescaler] * ((uint32_t)sim_tc0Regs.COUNT16.TC_CC[0] + 1));
+}
+
+void HAL_API(timerIsr)( void )
+{
+    if (NULL != tcCallback_)
+    {
+        tcCallback_(0, tcContext_);
+    }
+}
+
+uint8_t HAL_API(carrier)( void )
+{
+    return((uint8_t)(!bScl_ && bSda_));    // The MICRF114 sends the carrier while SCL is low and SDA is high
+}
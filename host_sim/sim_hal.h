@@ -0,0 +1,33 @@
+/* ****************************************************************************************************************** */
+/***********************************************************************************************************************
+ *
+ * Filename: sim_hal.h
+ *
+ * Contents: Interface between the node stand-ins (sim_hal.c) and the scheduler (micrf_sim.c).
+ *
+ **********************************************************************************************************************/
+#ifndef SIM_HAL_H
+#define SIM_HAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SIM_TC_CLOCK_HZ     48000000UL  /* TC0 clock, timer periods are in these ticks */
+
+/* Provided by the scheduler */
+extern volatile uint8_t sim_rfLevel;    /* Level on the receiver's data pin */
+uint32_t sim_timeMs( void );            /* Virtual time */
+
+/* Provided by each node, see sim_hal.c */
+bool     txhal_timerRunning( void );
+bool     txhal_timerStarted( void );    /* true once after every TC0_TimerStart() */
+uint32_t txhal_timerPeriod( void );     /* SIM_TC_CLOCK_HZ ticks */
+void     txhal_timerIsr( void );
+uint8_t  txhal_carrier( void );
+
+bool     rxhal_timerRunning( void );
+bool     rxhal_timerStarted( void );
+uint32_t rxhal_timerPeriod( void );
+void     rxhal_timerIsr( void );
+
+#endif  /* SIM_HAL_H */
@@ -0,0 +1,45 @@
+/* ****************************************************************************************************************** */
+/***********************************************************************************************************************
+ *
+ * Filename: sim_node.h
+ *
+ * Contents: Application side of the simulated nodes.  The TX and RX driver headers can't be included in the same file
+ *           (both declare the MICRF types), so node_tx.c and node_rx.c wrap them with plain C types.
+ *
+ **********************************************************************************************************************/
+#ifndef SIM_NODE_H
+#define SIM_NODE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#define SIM_SERIAL_NUM      ((uint16_t)0x1234)
+
+typedef struct
+{
+    uint32_t crcFailures;
+    uint32_t protocolFailures;
+    uint32_t bufferOverflow;
+    uint32_t cntFailure;
+    uint32_t duplicates;
+}simRxStats_t;
+
+/* node_tx.c */
+bool simtx_init( uint8_t profile, uint8_t copies, uint16_t gapMs, uint16_t jitterMs );
+bool simtx_send( uint32_t counter );
+bool simtx_idle( void );
+uint16_t simtx_bitRate( void );
+
+/* node_rx.c */
+bool simrx_init( uint8_t profile, bool bAutoBaud );
+bool simrx_poll( uint32_t *pCounter, uint16_t *pBitRate, uint8_t *pLqi );
+void simrx_stats( simRxStats_t *pStats );
+bool simrx_pollPacket( uint16_t *pSerialNum, uint8_t *pSeq, uint8_t *pData, uint8_t *pCnt );
+void simrx_rssi( uint16_t adcCode );
+void simrx_setSquelch( uint8_t thresholdDb );
+bool simrx_squelchOpen( void );
+void simrx_captureArm( uint8_t triggers, uint16_t postCnt );
+bool simrx_captureWrite( FILE *pFile );
+
+#endif  /* SIM_NODE_H */
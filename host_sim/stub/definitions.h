@@ -0,0 +1,87 @@
+/* ****************************************************************************************************************** */
+/***********************************************************************************************************************
+ *
+ * Filename: definitions.h
+ *
+ * Contents: Host build stand-in for the Harmony definitions.h.  Only what the MICRF drivers use is declared, the
+ *           functions are implemented by sim_hal.c.
+ *
+ **********************************************************************************************************************/
+#ifndef DEFINITIONS_H
+#define DEFINITIONS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* FreeRTOS */
+typedef uint32_t TickType_t;
+#define portTICK_PERIOD_MS          ((TickType_t)1)
+TickType_t xTaskGetTickCount( void );
+TickType_t xTaskGetTickCountFromISR( void );
+void       vTaskDelay( TickType_t xTicksToDelay );
+
+/* TC0 */
+typedef uint32_t TC_TIMER_STATUS;
+typedef void (*TC_TIMER_CALLBACK)( TC_TIMER_STATUS status, uintptr_t context );
+
+typedef struct
+{
+    volatile uint32_t TC_CTRLA;
+    volatile uint16_t TC_CC[2];
+    volatile uint16_t TC_COUNT;
+}tc_count16_registers_t;
+
+typedef struct
+{
+    tc_count16_registers_t COUNT16;
+}tc_registers_t;
+
+extern tc_registers_t sim_tc0Regs;
+#define TC0_REGS                    (&sim_tc0Regs)
+
+#define TC_CTRLA_PRESCALER_Pos      8U
+#define TC_CTRLA_PRESCALER_Msk      (0x7UL << TC_CTRLA_PRESCALER_Pos)
+#define TC_CTRLA_PRESCALER(value)   (TC_CTRLA_PRESCALER_Msk & ((uint32_t)(value) << TC_CTRLA_PRESCALER_Pos))
+#define TC_CTRLA_PRESCALER_DIV1_Val     0x0U
+#define TC_CTRLA_PRESCALER_DIV2_Val     0x1U
+#define TC_CTRLA_PRESCALER_DIV4_Val     0x2U
+#define TC_CTRLA_PRESCALER_DIV8_Val     0x3U
+#define TC_CTRLA_PRESCALER_DIV16_Val    0x4U
+#define TC_CTRLA_PRESCALER_DIV64_Val    0x5U
+#define TC_CTRLA_PRESCALER_DIV256_Val   0x6U
+#define TC_CTRLA_PRESCALER_DIV1024_Val  0x7U
+
+void     TC0_TimerInitialize( void );
+void     TC0_TimerStart( void );
+void     TC0_TimerStop( void );
+void     TC0_Timer16bitPeriodSet( uint16_t period );
+uint16_t TC0_Timer16bitCounterGet( void );
+void     TC0_TimerCallbackRegister( TC_TIMER_CALLBACK callback, uintptr_t context );
+
+/* GPIO */
+uint8_t RF_DATA_IN_Get( void );
+void    RF_DATA_IN_InputEnable( void );
+void    MICRF_SCL_Set( void );
+void    MICRF_SCL_Clear( void );
+void    MICRF_SCL_OutputEnable( void );
+void    MICRF_SDA_Set( void );
+void    MICRF_SDA_Clear( void );
+void    MICRF_SDA_OutputEnable( void );
+
+/* ADCHS */
+typedef enum
+{
+    ADCHS_CH5 = 5
+}ADCHS_CHANNEL_NUM;
+typedef void (*ADCHS_CALLBACK)( ADCHS_CHANNEL_NUM channel, uintptr_t context );
+
+void     ADCHS_ChannelConversionStart( ADCHS_CHANNEL_NUM channel );
+void     ADCHS_GlobalLevelConversionStop( void );
+void     ADCHS_CallbackRegister( ADCHS_CHANNEL_NUM channel, ADCHS_CALLBACK callback, uintptr_t context );
+uint16_t ADCHS_ChannelResultGet( ADCHS_CHANNEL_NUM channel );
+bool     ADCHS_ChannelResultIsReady( ADCHS_CHANNEL_NUM channel );
+void     ADCHS_ChannelResultInterruptEnable( ADCHS_CHANNEL_NUM channel );
+void     ADCHS_ChannelResultInterruptDisable( ADCHS_CHANNEL_NUM channel );
+
+#endif  /* DEFINITIONS_H */